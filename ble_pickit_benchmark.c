@@ -0,0 +1,122 @@
+#include "sdk_common.h"
+#include "nrf.h"
+#include "ble_pickit_board.h"
+#include "ble_vsd.h"
+#include "ble_pickit_schema.h"
+#include "ble_pickit_lz.h"
+#include "ble_pickit_benchmark.h"
+
+#define BENCHMARK_FRAME_SIZE				258									// ID - Type - Length - 255 bytes of data
+
+/**@brief LZ stream: 8 literals then 8 matches (offset 8, length 18). */
+static const uint8_t m_lz_stream[] =
+{
+	0xff, 'B', 'L', 'E', ' ', 'P', 'I', 'C', 'K',
+	0x00, 0x00, 0x7f, 0x00, 0x7f, 0x00, 0x7f, 0x00, 0x7f, 0x00, 0x7f, 0x00, 0x7f, 0x00, 0x7f, 0x00, 0x7f,
+};
+
+static uint8_t m_input[BENCHMARK_FRAME_SIZE];
+static uint8_t m_output[8 + 8 * LZ_MAX_MATCH];
+static ble_pickit_params m_params;
+static ble_gap_conn_params_t m_conn_params;
+static volatile uint16_t m_crc;
+
+/**@brief Function for starting the DWT cycle counter if the profiler or a debug session did not.
+ */
+static void cycle_counter_start(void)
+{
+	if ((DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) == 0)
+	{
+		CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+		DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+	}
+}
+
+/**@brief Function for running a kernel once.
+ *
+ * @return Number of bytes processed.
+ */
+static uint16_t kernel_run(benchmark_kernel_t kernel)
+{
+	ble_pickit_lz_t lz;
+	uint16_t length = 0;
+
+	switch (kernel)
+	{
+		case BENCHMARK_KERNEL_CRC_16_SHORT:
+			m_crc = fu_crc_16_ibm(m_input, 4);
+			return 4;
+
+		case BENCHMARK_KERNEL_CRC_16:
+			m_crc = fu_crc_16_ibm(m_input, BENCHMARK_FRAME_SIZE);
+			return BENCHMARK_FRAME_SIZE;
+
+		case BENCHMARK_KERNEL_PARAMS_ENCODE:
+			return ble_pickit_params_encode(&m_params, m_output);
+
+		case BENCHMARK_KERNEL_CONN_PARAMS_DECODE:
+			ble_pickit_conn_params_decode(m_input, &m_conn_params);
+			return BLE_PICKIT_CONN_PARAMS_SIZE;
+
+		case BENCHMARK_KERNEL_LZ_DECODE:
+			ble_pickit_lz_init(&lz);
+			(void) ble_pickit_lz_decode(&lz, m_lz_stream, sizeof(m_lz_stream), m_output, &length, sizeof(m_output));
+			return length;
+
+		default:
+			return 0;
+	}
+}
+
+static uint8_t * encode_u32(uint8_t * p_buffer, uint32_t value)
+{
+	*p_buffer++ = (value >> 24) & 0xff;
+	*p_buffer++ = (value >> 16) & 0xff;
+	*p_buffer++ = (value >> 8) & 0xff;
+	*p_buffer++ = (value >> 0) & 0xff;
+	return p_buffer;
+}
+
+/**@brief Function for running all the kernels (see ble_pickit_benchmark.h).
+ *
+ * @return Number of bytes encoded (BENCHMARK_KERNEL_COUNT records).
+ */
+uint8_t ble_pickit_benchmark_run(uint8_t * p_buffer)
+{
+	uint8_t * p_record = p_buffer;
+	uint8_t kernel;
+	uint16_t i;
+
+	cycle_counter_start();
+
+	for (i = 0 ; i < BENCHMARK_FRAME_SIZE ; i++)
+	{
+		m_input[i] = (uint8_t) i;
+	}
+
+	for (kernel = 0 ; kernel < BENCHMARK_KERNEL_COUNT ; kernel++)
+	{
+		uint32_t min = UINT32_MAX;
+		uint32_t sum = 0;
+		uint16_t bytes = 0;
+
+		for (i = 0 ; i < BENCHMARK_REPEAT ; i++)
+		{
+			uint32_t start = DWT->CYCCNT;
+			uint32_t cycles;
+
+			bytes = kernel_run((benchmark_kernel_t) kernel);
+			cycles = DWT->CYCCNT - start;
+			min = MIN(min, cycles);
+			sum += cycles;
+		}
+
+		*p_record++ = kernel;
+		*p_record++ = (bytes >> 8) & 0xff;
+		*p_record++ = (bytes >> 0) & 0xff;
+		p_record = encode_u32(p_record, min);
+		p_record = encode_u32(p_record, sum / BENCHMARK_REPEAT);
+	}
+
+	return BENCHMARK_KERNEL_COUNT * BENCHMARK_RECORD_SIZE;
+}
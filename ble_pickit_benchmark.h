@@ -0,0 +1,29 @@
+#ifndef BLE_PICKIT_BENCHMARK_H
+#define BLE_PICKIT_BENCHMARK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * On-target micro-benchmarks: each kernel runs BENCHMARK_REPEAT times on a fixed input, timed with the DWT cycle
+ * counter (64 MHz). The minimum is the cost without interrupt, the average includes the SoftDevice preemptions.
+ * The run blocks the main loop for a few milliseconds. The hot paths in their context are covered by the profiler.
+ *  - UART: ID_BENCHMARK - Length (0) returns Kernel - Bytes (2B) - Min (4B) - Avg (4B) for each kernel (cycles per
+ *    call, big endian).
+ */
+#define BENCHMARK_REPEAT					32
+#define BENCHMARK_RECORD_SIZE				11									// Kernel - Bytes - Min - Avg
+
+typedef enum
+{
+	BENCHMARK_KERNEL_CRC_16_SHORT,			/**< fu_crc_16_ibm() of a control frame header and data (4 bytes) */
+	BENCHMARK_KERNEL_CRC_16,				/**< fu_crc_16_ibm() of a full standard frame (258 bytes) */
+	BENCHMARK_KERNEL_PARAMS_ENCODE,			/**< ble_pickit_params_encode() */
+	BENCHMARK_KERNEL_CONN_PARAMS_DECODE,	/**< ble_pickit_conn_params_decode() */
+	BENCHMARK_KERNEL_LZ_DECODE,				/**< ble_pickit_lz_decode() of a 26 bytes stream (152 bytes) */
+	BENCHMARK_KERNEL_COUNT
+} benchmark_kernel_t;
+
+uint8_t ble_pickit_benchmark_run(uint8_t * p_buffer);
+
+#endif
@@ -42,9 +42,19 @@
 
 #define RX_PIN_NUMBER  			2
 #define TX_PIN_NUMBER  			3
-#define CTS_PIN_NUMBER 			UART_PIN_DISCONNECTED	// not used
+#define CTS_PIN_NUMBER 			UART_PIN_DISCONNECTED	// not used (RTS / CTS flow control enabled if RTS_PIN_NUMBER is wired)
 #define RTS_PIN_NUMBER 			UART_PIN_DISCONNECTED	// not used
 
+//#define TRANSPARENT_MODE_PIN	11						// Active low: transparent mode while the pin is held low (not wired by default)
+
+// SPI slave transport (instead of the UART) if SPIS_CSN_PIN is defined: the UART pins are reused for MOSI / MISO
+// (NRFX_SPIS_ENABLED, NRFX_SPIS1_ENABLED, SPIS_ENABLED and SPIS1_ENABLED must be set to 1 in sdk_config.h as well)
+//#define SPIS_SCK_PIN			4
+//#define SPIS_MOSI_PIN			RX_PIN_NUMBER
+//#define SPIS_MISO_PIN			TX_PIN_NUMBER
+//#define SPIS_CSN_PIN			5
+//#define SPIS_DRDY_PIN			7						// High: the bridge has bytes to send
+
 #elif defined(B_PCA10040)
 
 #define LEDS_NUMBER 			4
@@ -77,9 +87,19 @@
 
 #define RX_PIN_NUMBER  			2
 #define TX_PIN_NUMBER  			3
-#define CTS_PIN_NUMBER 			UART_PIN_DISCONNECTED	// not used
+#define CTS_PIN_NUMBER 			UART_PIN_DISCONNECTED	// not used (RTS / CTS flow control enabled if RTS_PIN_NUMBER is wired)
 #define RTS_PIN_NUMBER 			UART_PIN_DISCONNECTED	// not used
 
+//#define TRANSPARENT_MODE_PIN	11						// Active low: transparent mode while the pin is held low (not wired by default)
+
+// SPI slave transport (instead of the UART) if SPIS_CSN_PIN is defined
+// (NRFX_SPIS_ENABLED, NRFX_SPIS1_ENABLED, SPIS_ENABLED and SPIS1_ENABLED must be set to 1 in sdk_config.h as well)
+//#define SPIS_SCK_PIN			3
+//#define SPIS_MOSI_PIN			4
+//#define SPIS_MISO_PIN			28
+//#define SPIS_CSN_PIN			29
+//#define SPIS_DRDY_PIN			30						// High: the bridge has bytes to send
+
 #endif
 
 nrfx_rtc_t						rtc;
@@ -0,0 +1,198 @@
+#include "sdk_common.h"
+#include "nrf_log.h"
+#include "nrf_sdh_ble.h"
+#include "ble_pickit_broadcast.h"
+
+typedef struct
+{
+	ble_advertising_t *			p_advertising;
+	ble_advdata_t				advdata;							/**< Advertising data of the connectable advertising (without broadcast). */
+	ble_advdata_t				srdata;								/**< Scan response data of the connectable advertising. */
+	uint32_t					adv_interval;
+
+	uint8_t						data[1 + BROADCAST_MAX_PAYLOAD_EXTENDED];	/**< Sequence number (1B) - Payload */
+	uint8_t						length;
+	bool						is_enabled;
+	bool						is_update_pending;
+
+	bool						is_connected;
+	bool						is_non_connectable_adv_on_going;
+	bool						is_extended_supported;
+	uint8_t						enc_data[2][BLE_GAP_ADV_SET_DATA_SIZE_EXTENDED_MAX_SUPPORTED];	/**< The SoftDevice requires a new buffer for each update of an advertising set in use. */
+	uint8_t						enc_index;
+} ble_pickit_broadcast_t;
+
+static ble_pickit_broadcast_t m_broadcast;
+
+static void on_ble_evt(ble_evt_t const * p_ble_evt, void * p_context);
+NRF_SDH_BLE_OBSERVER(m_broadcast_obs, BLE_PICKIT_BROADCAST_OBSERVER_PRIO, on_ble_evt, NULL);
+
+void ble_pickit_broadcast_init(ble_advertising_t * p_advertising, ble_advdata_t const * p_advdata, ble_advdata_t const * p_srdata, uint32_t adv_interval)
+{
+	memset(&m_broadcast, 0, sizeof(m_broadcast));
+
+	m_broadcast.p_advertising = p_advertising;
+	m_broadcast.advdata = *p_advdata;
+	m_broadcast.srdata = *p_srdata;
+	m_broadcast.adv_interval = adv_interval;
+	m_broadcast.is_extended_supported = true;
+}
+
+void ble_pickit_broadcast_set(uint8_t const * p_data, uint8_t length)
+{
+	length = MIN(length, BROADCAST_MAX_PAYLOAD_EXTENDED);
+
+	m_broadcast.data[0]++;
+	memcpy(&m_broadcast.data[1], p_data, length);
+	m_broadcast.length = length;
+	m_broadcast.is_enabled = (length > 0);
+	m_broadcast.is_update_pending = true;
+}
+
+static uint32_t connectable_adv_update(void)
+{
+	ble_advdata_t advdata = m_broadcast.advdata;
+	ble_advdata_manuf_data_t manuf_data;
+
+	if (m_broadcast.is_enabled)
+	{
+		manuf_data.company_identifier = BLE_PICKIT_COMPANY_IDENTIFIER;
+		manuf_data.data.p_data = m_broadcast.data;
+		manuf_data.data.size = 1 + MIN(m_broadcast.length, BROADCAST_MAX_PAYLOAD_CONNECTABLE);
+		advdata.p_manuf_specific_data = &manuf_data;
+	}
+
+	return ble_advertising_advdata_update(m_broadcast.p_advertising, &advdata, &m_broadcast.srdata);
+}
+
+static uint32_t non_connectable_adv_stop(void)
+{
+	if (m_broadcast.is_non_connectable_adv_on_going)
+	{
+		m_broadcast.is_non_connectable_adv_on_going = false;
+		return sd_ble_gap_adv_stop(m_broadcast.p_advertising->adv_handle);
+	}
+
+	return NRF_SUCCESS;
+}
+
+static uint32_t non_connectable_adv_update(void)
+{
+	uint32_t err_code;
+	ble_advdata_t advdata;
+	ble_advdata_manuf_data_t manuf_data;
+	ble_gap_adv_data_t gap_adv_data;
+	ble_gap_adv_params_t adv_params;
+
+	if (!m_broadcast.is_enabled)
+	{
+		return non_connectable_adv_stop();
+	}
+
+	memset(&advdata, 0, sizeof(advdata));
+	advdata.name_type = BLE_ADVDATA_NO_NAME;
+
+	manuf_data.company_identifier = BLE_PICKIT_COMPANY_IDENTIFIER;
+	manuf_data.data.p_data = m_broadcast.data;
+	manuf_data.data.size = 1 + MIN(m_broadcast.length, (m_broadcast.is_extended_supported ? BROADCAST_MAX_PAYLOAD_EXTENDED : BROADCAST_MAX_PAYLOAD_LEGACY));
+	advdata.p_manuf_specific_data = &manuf_data;
+
+	m_broadcast.enc_index ^= 1;
+	memset(&gap_adv_data, 0, sizeof(gap_adv_data));
+	gap_adv_data.adv_data.p_data = m_broadcast.enc_data[m_broadcast.enc_index];
+	gap_adv_data.adv_data.len = m_broadcast.is_extended_supported ? BLE_GAP_ADV_SET_DATA_SIZE_EXTENDED_MAX_SUPPORTED : BLE_GAP_ADV_SET_DATA_SIZE_MAX;
+
+	err_code = ble_advdata_encode(&advdata, gap_adv_data.adv_data.p_data, &gap_adv_data.adv_data.len);
+	VERIFY_SUCCESS(err_code);
+
+	if (m_broadcast.is_non_connectable_adv_on_going)
+	{
+		// Update in place (the new data is sent from the next advertising event).
+		return sd_ble_gap_adv_set_configure(&m_broadcast.p_advertising->adv_handle, &gap_adv_data, NULL);
+	}
+
+	memset(&adv_params, 0, sizeof(adv_params));
+	adv_params.properties.type = m_broadcast.is_extended_supported ? BLE_GAP_ADV_TYPE_EXTENDED_NONCONNECTABLE_NONSCANNABLE_UNDIRECTED : BLE_GAP_ADV_TYPE_NONCONNECTABLE_NONSCANNABLE_UNDIRECTED;
+	adv_params.p_peer_addr = NULL;
+	adv_params.filter_policy = BLE_GAP_ADV_FP_ANY;
+	adv_params.interval = m_broadcast.adv_interval;
+	adv_params.duration = BLE_GAP_ADV_TIMEOUT_GENERAL_UNLIMITED;
+	adv_params.primary_phy = BLE_GAP_PHY_1MBPS;
+	adv_params.secondary_phy = m_broadcast.is_extended_supported ? BLE_GAP_PHY_2MBPS : BLE_GAP_PHY_1MBPS;
+
+	err_code = sd_ble_gap_adv_set_configure(&m_broadcast.p_advertising->adv_handle, &gap_adv_data, &adv_params);
+	if ((err_code != NRF_SUCCESS) && m_broadcast.is_extended_supported)
+	{
+		// Extended advertising not supported: fall back to legacy advertising (shorter payload).
+		NRF_LOG_INFO("Broadcast: extended advertising not supported (0x%x), use legacy advertising.", err_code);
+		m_broadcast.is_extended_supported = false;
+		return non_connectable_adv_update();
+	}
+	VERIFY_SUCCESS(err_code);
+
+	err_code = sd_ble_gap_adv_start(m_broadcast.p_advertising->adv_handle, BLE_CONN_CFG_TAG_DEFAULT);
+	if (err_code == NRF_SUCCESS)
+	{
+		m_broadcast.is_non_connectable_adv_on_going = true;
+	}
+
+	return err_code;
+}
+
+void ble_pickit_broadcast_tasks(void)
+{
+	uint32_t err_code;
+
+	if (!m_broadcast.is_update_pending || (m_broadcast.p_advertising == NULL))
+	{
+		return;
+	}
+
+	if (m_broadcast.is_connected)
+	{
+		err_code = non_connectable_adv_update();
+	}
+	else if ((m_broadcast.p_advertising->adv_mode_current == BLE_ADV_MODE_FAST) || (m_broadcast.p_advertising->adv_mode_current == BLE_ADV_MODE_SLOW))
+	{
+		err_code = connectable_adv_update();
+	}
+	else
+	{
+		// Directed advertising (no advertising data) or idle: wait for the next fast advertising.
+		return;
+	}
+
+	if (err_code != NRF_ERROR_INVALID_STATE)
+	{
+		m_broadcast.is_update_pending = false;
+
+		if (err_code != NRF_SUCCESS)
+		{
+			NRF_LOG_ERROR("ble_pickit_broadcast_tasks - update failed: 0x%x", err_code);
+		}
+	}
+}
+
+static void on_ble_evt(ble_evt_t const * p_ble_evt, void * p_context)
+{
+	UNUSED_PARAMETER(p_context);
+
+	switch (p_ble_evt->header.evt_id)
+	{
+		case BLE_GAP_EVT_CONNECTED:
+			// The connectable advertising is over: the broadcast goes on with a non connectable advertising.
+			m_broadcast.is_connected = true;
+			m_broadcast.is_update_pending = m_broadcast.is_enabled;
+			break;
+
+		case BLE_GAP_EVT_DISCONNECTED:
+			// Release the advertising set before the Advertising module restarts the connectable advertising.
+			m_broadcast.is_connected = false;
+			(void) non_connectable_adv_stop();
+			m_broadcast.is_update_pending = m_broadcast.is_enabled;
+			break;
+
+		default:
+			break;
+	}
+}
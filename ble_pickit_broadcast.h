@@ -0,0 +1,33 @@
+#ifndef BLE_PICKIT_BROADCAST_H
+#define BLE_PICKIT_BROADCAST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ble_advdata.h"
+#include "ble_advertising.h"
+
+// <o> BLE_PICKIT_BROADCAST_OBSERVER_PRIO
+// <i> Must be dispatched before the Advertising module (BLE_ADV_BLE_OBSERVER_PRIO) in order to release
+// <i> the advertising set used by the broadcast before the connectable advertising is restarted on disconnection.
+#ifndef BLE_PICKIT_BROADCAST_OBSERVER_PRIO
+#define BLE_PICKIT_BROADCAST_OBSERVER_PRIO 			0
+#endif
+
+#define BLE_PICKIT_COMPANY_IDENTIFIER				0x01ee		// Valeo Service company ID (scan response and broadcast)
+
+/*
+ * Broadcast frame (manufacturer specific data): Company ID (2B) - Sequence number (1B) - Payload
+ * Maximum payload for each mode:
+ *  - Connectable advertising (not connected): 31B - Flags (3B) - Manuf. header (4B) - Sequence (1B)
+ *  - Non connectable legacy advertising (connected): 31B - Manuf. header (4B) - Sequence (1B)
+ *  - Non connectable extended advertising (connected): 255B - Manuf. header (4B) - Sequence (1B), limited to an ID_CHAR_BUFFER
+ */
+#define BROADCAST_MAX_PAYLOAD_CONNECTABLE			23
+#define BROADCAST_MAX_PAYLOAD_LEGACY				26
+#define BROADCAST_MAX_PAYLOAD_EXTENDED				242
+
+void ble_pickit_broadcast_init(ble_advertising_t * p_advertising, ble_advdata_t const * p_advdata, ble_advdata_t const * p_srdata, uint32_t adv_interval);
+void ble_pickit_broadcast_set(uint8_t const * p_data, uint8_t length);
+void ble_pickit_broadcast_tasks(void);
+
+#endif
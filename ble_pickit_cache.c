@@ -0,0 +1,161 @@
+#include "sdk_common.h"
+#include "nrf_log.h"
+#include "ble_pickit_board.h"
+#include "ble_vsd.h"
+#include "ble_pickit_service.h"
+#include "ble_pickit_cache.h"
+#include "ble_pickit_profiler.h"
+
+static ble_pickit_cache_entry_t m_entries[CACHE_ENTRY_COUNT];
+static uint8_t m_selected_key;
+static bool m_is_read_pending;											/**< Authorized read waiting for the host MCU. */
+static uint64_t m_read_tick;
+static bool m_is_request_pending;										/**< ID_CACHE_REQUEST waiting for the UART. */
+
+static ble_pickit_cache_entry_t * entry_find(uint8_t key)
+{
+	uint8_t i;
+
+	for (i = 0 ; i < CACHE_ENTRY_COUNT ; i++)
+	{
+		if (m_entries[i].is_valid && (m_entries[i].key == key))
+		{
+			return &m_entries[i];
+		}
+	}
+	return NULL;
+}
+
+/**@brief Function for getting the entry of a new key: a free entry or the least recently updated one.
+ */
+static ble_pickit_cache_entry_t * entry_alloc(void)
+{
+	ble_pickit_cache_entry_t * p_entry = &m_entries[0];
+	uint8_t i;
+
+	for (i = 0 ; i < CACHE_ENTRY_COUNT ; i++)
+	{
+		if (!m_entries[i].is_valid)
+		{
+			return &m_entries[i];
+		}
+		if (m_entries[i].tick < p_entry->tick)
+		{
+			p_entry = &m_entries[i];
+		}
+	}
+	return p_entry;
+}
+
+static bool entry_is_fresh(ble_pickit_cache_entry_t const * p_entry)
+{
+	return (p_entry != NULL) && ((p_entry->max_age == 0) || (mTickCompare(p_entry->tick) < (p_entry->max_age * TICK_1MS)));
+}
+
+static void read_reply(uint8_t status)
+{
+	ble_pickit_cache_entry_t * p_entry = entry_find(m_selected_key);
+	uint8_t value[CACHE_VALUE_SIZE + 2];
+	uint16_t length = 2;
+
+	value[0] = m_selected_key;
+	value[1] = (p_entry == NULL) ? CACHE_STATUS_MISS : status;
+	if (p_entry != NULL)
+	{
+		memcpy(&value[2], p_entry->value, p_entry->length);
+		length += p_entry->length;
+	}
+
+	m_is_read_pending = false;
+	ble_pickit_cache_read_reply(value, length);
+}
+
+/**@brief Function for updating a key published by the host MCU (ID_CACHE_UPDATE: Key - Max age (2B) - Value).
+ */
+void ble_pickit_cache_update(uint8_t const * p_data, uint8_t length)
+{
+	ble_pickit_cache_entry_t * p_entry;
+
+	if ((length < 3) || ((length - 3) > CACHE_VALUE_SIZE))
+	{
+		NRF_LOG_INFO("ID_CACHE_UPDATE: invalid length %d.", length);
+		return;
+	}
+
+	p_entry = entry_find(p_data[0]);
+	if (p_entry == NULL)
+	{
+		p_entry = entry_alloc();
+	}
+
+	p_entry->key = p_data[0];
+	p_entry->max_age = (p_data[1] << 8) | (p_data[2] << 0);
+	p_entry->length = length - 3;
+	memcpy(p_entry->value, &p_data[3], p_entry->length);
+	p_entry->tick = mGetTick();
+	p_entry->is_valid = true;
+
+	if (m_is_read_pending && (p_entry->key == m_selected_key))
+	{
+		read_reply(CACHE_STATUS_FRESH);
+	}
+}
+
+void ble_pickit_cache_select(uint8_t key)
+{
+	m_selected_key = key;
+}
+
+/**@brief Function for answering an authorized read of the cache characteristic (SERVICE_EVT_CACHE_READ).
+ *
+ * @details A fresh key is answered at once. Otherwise the reply is delayed (the SoftDevice keeps the ATT read
+ *          pending) until the host MCU publishes the key or CACHE_READ_THROUGH_TIMEOUT elapses.
+ */
+void ble_pickit_cache_read(void)
+{
+	uint8_t value[PROFILER_RECORD_SIZE + 2];
+	uint8_t length;
+
+	if (m_selected_key >= CACHE_KEY_PROFILER)
+	{
+		length = ble_pickit_profiler_encode(m_selected_key - CACHE_KEY_PROFILER, &value[2]);
+		value[0] = m_selected_key;
+		value[1] = (length > 0) ? CACHE_STATUS_FRESH : CACHE_STATUS_MISS;
+		ble_pickit_cache_read_reply(value, length + 2);
+	}
+	else if (entry_is_fresh(entry_find(m_selected_key)))
+	{
+		read_reply(CACHE_STATUS_FRESH);
+	}
+	else
+	{
+		m_is_read_pending = true;
+		m_read_tick = mGetTick();
+		m_is_request_pending = true;
+	}
+}
+
+void ble_pickit_cache_tasks(void)
+{
+	if (m_is_read_pending && (mTickCompare(m_read_tick) >= (CACHE_READ_THROUGH_TIMEOUT * TICK_1MS)))
+	{
+		NRF_LOG_INFO("Cache: key 0x%02x not published by the host MCU.", m_selected_key);
+		m_is_request_pending = false;
+		read_reply(CACHE_STATUS_STALE);
+	}
+}
+
+bool ble_pickit_cache_request_is_pending(void)
+{
+	return m_is_request_pending;
+}
+
+uint8_t ble_pickit_cache_request_key(void)
+{
+	return m_selected_key;
+}
+
+void ble_pickit_cache_request_consume(void)
+{
+	m_is_request_pending = false;
+}
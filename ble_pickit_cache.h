@@ -0,0 +1,43 @@
+#ifndef BLE_PICKIT_CACHE_H
+#define BLE_PICKIT_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Shadow cache of the values published by the host MCU, served on the reads of the cache characteristic
+ * (MESSAGE_CACHE_UUID, read with authorization / write) without any UART round trip.
+ *  - Host MCU -> bridge: ID_CACHE_UPDATE - Length - Key - Max age (ms, 2B, 0: never stale) - Value.
+ *  - Central: writes the Key to read, then reads Key - Status - Value.
+ *  - Read-through: a stale or missing key is requested to the host MCU (ID_CACHE_REQUEST - Length (1) - Key), the read
+ *    is answered by its ID_CACHE_UPDATE or, after CACHE_READ_THROUGH_TIMEOUT, with the stale value (or no value).
+ */
+#define CACHE_ENTRY_COUNT					16
+#define CACHE_VALUE_SIZE					32
+#define CACHE_READ_THROUGH_TIMEOUT			50									// ms
+#define CACHE_KEY_PROFILER					0xf0								// Keys owned by the bridge: 0xf0 + profiler region
+
+#define CACHE_STATUS_FRESH					0x00
+#define CACHE_STATUS_STALE					0x01								// Host MCU did not answer the read-through: last value
+#define CACHE_STATUS_MISS					0x02								// No value (no Value field)
+
+typedef struct
+{
+	uint8_t							key;
+	uint8_t							length;
+	uint8_t							value[CACHE_VALUE_SIZE];
+	uint16_t						max_age;							/**< ms, 0: never stale. */
+	uint64_t						tick;								/**< Last ID_CACHE_UPDATE. */
+	bool							is_valid;
+} ble_pickit_cache_entry_t;
+
+void ble_pickit_cache_update(uint8_t const * p_data, uint8_t length);
+void ble_pickit_cache_select(uint8_t key);
+void ble_pickit_cache_read(void);
+void ble_pickit_cache_tasks(void);
+
+bool ble_pickit_cache_request_is_pending(void);
+uint8_t ble_pickit_cache_request_key(void);
+void ble_pickit_cache_request_consume(void);
+
+#endif
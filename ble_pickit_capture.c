@@ -0,0 +1,125 @@
+#include "sdk_common.h"
+#include "app_fifo.h"
+#include "app_util_platform.h"
+#include "ble_pickit_board.h"
+#include "ble_pickit_capture.h"
+
+#if defined(BLE_PICKIT_CAPTURE_ENABLED)
+static app_fifo_t m_ring;
+static uint8_t m_ring_buffer[CAPTURE_RING_SIZE];
+static bool m_is_running = false;
+
+/**@brief Function for getting the size of the oldest record (0 if the ring is empty).
+ */
+static uint16_t record_size(void)
+{
+	uint8_t length_msb, length_lsb;
+
+	if (app_fifo_peek(&m_ring, CAPTURE_HEADER_SIZE - 1, &length_lsb) != NRF_SUCCESS)
+	{
+		return 0;
+	}
+	(void) app_fifo_peek(&m_ring, CAPTURE_HEADER_SIZE - 2, &length_msb);
+	return CAPTURE_HEADER_SIZE + MIN((length_msb << 8) | (length_lsb << 0), CAPTURE_DATA_MAX);
+}
+
+static void record_drop(void)
+{
+	uint16_t size = record_size();
+	uint8_t dummy;
+
+	while (size-- > 0)
+	{
+		(void) app_fifo_get(&m_ring, &dummy);
+	}
+}
+#endif
+
+void ble_pickit_capture_init(void)
+{
+#if defined(BLE_PICKIT_CAPTURE_ENABLED)
+	APP_ERROR_CHECK(app_fifo_init(&m_ring, m_ring_buffer, CAPTURE_RING_SIZE));
+#endif
+}
+
+/**@brief Function for handling a CAPTURE_CMD_xxx of the host MCU (CAPTURE_CMD_READ is answered by the encoder).
+ */
+void ble_pickit_capture_control(uint8_t command)
+{
+#if defined(BLE_PICKIT_CAPTURE_ENABLED)
+	CRITICAL_REGION_ENTER();
+	if (command == CAPTURE_CMD_START)
+	{
+		(void) app_fifo_flush(&m_ring);
+	}
+	m_is_running = (command == CAPTURE_CMD_START);
+	CRITICAL_REGION_EXIT();
+#endif
+}
+
+/**@brief Function for recording a frame (any context: the GATT writes are recorded by the SoftDevice observer).
+ */
+void ble_pickit_capture_put(uint8_t source, uint16_t tag, uint8_t const * p_data, uint16_t length)
+{
+#if defined(BLE_PICKIT_CAPTURE_ENABLED)
+	uint32_t timestamp = mGetTick();
+	uint8_t header[CAPTURE_HEADER_SIZE];
+	uint32_t data_size = MIN(length, CAPTURE_DATA_MAX);
+	uint32_t size;
+
+	header[0] = (timestamp >> 24) & 0xff;
+	header[1] = (timestamp >> 16) & 0xff;
+	header[2] = (timestamp >> 8) & 0xff;
+	header[3] = (timestamp >> 0) & 0xff;
+	header[4] = source;
+	header[5] = (tag >> 8) & 0xff;
+	header[6] = (tag >> 0) & 0xff;
+	header[7] = (length >> 8) & 0xff;
+	header[8] = (length >> 0) & 0xff;
+
+	CRITICAL_REGION_ENTER();
+	if (m_is_running)
+	{
+		do
+		{
+			size = 1;
+			(void) app_fifo_write(&m_ring, NULL, &size);
+			if (size < (CAPTURE_HEADER_SIZE + data_size))
+			{
+				record_drop();
+			}
+		} while (size < (CAPTURE_HEADER_SIZE + data_size));
+
+		size = CAPTURE_HEADER_SIZE;
+		(void) app_fifo_write(&m_ring, header, &size);
+		size = data_size;
+		(void) app_fifo_write(&m_ring, p_data, &size);
+	}
+	CRITICAL_REGION_EXIT();
+#endif
+}
+
+/**@brief Function for reading the oldest whole records (CAPTURE_CMD_READ).
+ *
+ * @param[in] max_length  Size of p_buffer (CAPTURE_READ_SIZE for the UART, ATT payload for the BLE).
+ *
+ * @return Number of bytes encoded (0: ring empty).
+ */
+uint8_t ble_pickit_capture_encode(uint8_t * p_buffer, uint8_t max_length)
+{
+	uint8_t length = 0;
+#if defined(BLE_PICKIT_CAPTURE_ENABLED)
+	uint32_t size;
+
+	CRITICAL_REGION_ENTER();
+	m_is_running = false;
+	CRITICAL_REGION_EXIT();
+
+	while (((size = record_size()) > 0) && ((length + size) <= max_length))
+	{
+		(void) app_fifo_read(&m_ring, &p_buffer[length], &size);
+		length += size;
+	}
+#endif
+	return length;
+}
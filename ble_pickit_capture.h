@@ -0,0 +1,52 @@
+#ifndef BLE_PICKIT_CAPTURE_H
+#define BLE_PICKIT_CAPTURE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Frame capture: every frame crossing the bridge (UART frames and ACK / NACK in both directions, GATT writes and
+ * notifications) is recorded with its timestamp into a RAM ring. When the ring is full the oldest records are dropped.
+ * The probes are removed from the build when BLE_PICKIT_CAPTURE_ENABLED is not defined, the capture is stopped at boot.
+ *  - UART: ID_CAPTURE - Length (1) - Command. CAPTURE_CMD_START clears the ring and starts the capture,
+ *    CAPTURE_CMD_STOP stops it, CAPTURE_CMD_READ stops it and returns the oldest whole records (up to
+ *    CAPTURE_READ_SIZE bytes, removed from the ring). The host MCU reads until a frame without record.
+ *  - BLE (params characteristic 0x1503): 0x07 - Length (1) - Command, same commands. CAPTURE_CMD_READ is answered by a
+ *    params notification 0x07 - Length - Records (whole records fitting in the ATT payload, at least
+ *    CAPTURE_HEADER_SIZE + CAPTURE_DATA_MAX + 2 bytes to read every record), the central reads until Length is 0.
+ *    The dump notifications are not captured (the read stops the capture).
+ *  - Record (big endian): Timestamp (4B, RTC ticks 1/32768 s, 24 bits) - Source - Tag (2B) - Length (2B) - Data.
+ *    Tag: attribute handle of the GATT sources, 0 for the UART. Length is the length of the frame, only its first
+ *    CAPTURE_DATA_MAX bytes are recorded (Data: MIN(Length, CAPTURE_DATA_MAX) bytes).
+ */
+//#define BLE_PICKIT_CAPTURE_ENABLED
+
+#define CAPTURE_RING_SIZE					4096								// Must be a power of 2 (app_fifo)
+#define CAPTURE_HEADER_SIZE					9
+#define CAPTURE_DATA_MAX					64
+#define CAPTURE_READ_SIZE					250
+
+#define CAPTURE_CMD_STOP					0x00
+#define CAPTURE_CMD_START					0x01
+#define CAPTURE_CMD_READ					0x02
+
+typedef enum
+{
+	CAPTURE_SOURCE_UART_RX,					/**< Host MCU -> bridge: frame, "ACK" or "NACK" */
+	CAPTURE_SOURCE_UART_TX,					/**< Bridge -> host MCU: frame (each retransmission), "ACK" or "NACK" */
+	CAPTURE_SOURCE_GATT_WRITE,				/**< Central -> bridge */
+	CAPTURE_SOURCE_GATT_NOTIFICATION,		/**< Bridge -> central (accepted by the SoftDevice) */
+} capture_source_t;
+
+#if defined(BLE_PICKIT_CAPTURE_ENABLED)
+#define CAPTURE(_source, _tag, _p_data, _length)	ble_pickit_capture_put((_source), (_tag), (_p_data), (_length))
+#else
+#define CAPTURE(_source, _tag, _p_data, _length)
+#endif
+
+void ble_pickit_capture_init(void);
+void ble_pickit_capture_control(uint8_t command);
+void ble_pickit_capture_put(uint8_t source, uint16_t tag, uint8_t const * p_data, uint16_t length);
+uint8_t ble_pickit_capture_encode(uint8_t * p_buffer, uint8_t max_length);
+
+#endif
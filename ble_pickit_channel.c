@@ -0,0 +1,241 @@
+#include "sdk_common.h"
+#include "nrf_log.h"
+#include "ble_pickit_board.h"
+#include "ble_vsd.h"
+#include "ble_pickit_service.h"
+#include "ble_pickit_channel.h"
+
+static ble_pickit_channel_t m_channels[BLE_PICKIT_CHANNEL_COUNT];
+static uint8_t m_notif_channel;
+static uint8_t m_uart_channel = BLE_PICKIT_CHANNEL_COUNT;
+static uint8_t m_flow_mask;
+static bool m_is_flow_updated;
+
+void ble_pickit_channel_init(void)
+{
+	uint8_t i;
+
+	for (i = 0 ; i < BLE_PICKIT_CHANNEL_COUNT ; i++)
+	{
+		APP_ERROR_CHECK(app_fifo_init(&m_channels[i].to_ble_fifo, m_channels[i].to_ble_buffer, CHANNEL_TO_BLE_FIFO_SIZE));
+		APP_ERROR_CHECK(app_fifo_init(&m_channels[i].to_uart_fifo, m_channels[i].to_uart_buffer, CHANNEL_TO_UART_FIFO_SIZE));
+		m_channels[i].priority = i;
+		m_channels[i].is_paused = false;
+	}
+}
+
+void ble_pickit_channel_priority_set(uint8_t channel, uint8_t priority)
+{
+	if (channel < BLE_PICKIT_CHANNEL_COUNT)
+	{
+		m_channels[channel].priority = priority;
+	}
+}
+
+static uint32_t fifo_free_get(app_fifo_t * p_fifo)
+{
+	uint32_t size = 1;
+
+	(void) app_fifo_write(p_fifo, NULL, &size);
+	return size;
+}
+
+static bool fifo_is_empty(app_fifo_t * p_fifo)
+{
+	uint32_t size = 0;
+
+	(void) app_fifo_read(p_fifo, NULL, &size);
+	return (size == 0);
+}
+
+static bool record_put(app_fifo_t * p_fifo, uint8_t const * p_data, uint8_t length)
+{
+	uint32_t size = length;
+
+	if (fifo_free_get(p_fifo) < (uint32_t) (length + 1))
+	{
+		return false;
+	}
+
+	(void) app_fifo_put(p_fifo, length);
+	(void) app_fifo_write(p_fifo, p_data, &size);
+	return true;
+}
+
+static uint8_t record_peek(app_fifo_t * p_fifo, uint8_t * p_data)
+{
+	uint8_t length = 0;
+	uint16_t i;
+
+	(void) app_fifo_peek(p_fifo, 0, &length);
+	for (i = 0 ; i < length ; i++)
+	{
+		(void) app_fifo_peek(p_fifo, i + 1, &p_data[i]);
+	}
+
+	return length;
+}
+
+static void record_drop(app_fifo_t * p_fifo)
+{
+	uint8_t length = 0;
+	uint8_t dummy;
+
+	if (app_fifo_get(p_fifo, &length) == NRF_SUCCESS)
+	{
+		for ( ; length > 0 ; length--)
+		{
+			(void) app_fifo_get(p_fifo, &dummy);
+		}
+	}
+}
+
+/**@brief Function for selecting the channel with the highest priority having a record in the given direction.
+ *
+ * @param[in] is_to_ble  true: UART -> BLE queues / false: BLE -> UART queues.
+ * @param[in] skip_mask  Channels not to select (bit n = channel n).
+ *
+ * @return The channel or BLE_PICKIT_CHANNEL_COUNT if no record is waiting.
+ */
+static uint8_t channel_select(bool is_to_ble, uint8_t skip_mask)
+{
+	uint8_t selected = BLE_PICKIT_CHANNEL_COUNT;
+	uint8_t i;
+
+	for (i = 0 ; i < BLE_PICKIT_CHANNEL_COUNT ; i++)
+	{
+		if ((skip_mask & (1 << i)) || fifo_is_empty(is_to_ble ? &m_channels[i].to_ble_fifo : &m_channels[i].to_uart_fifo))
+		{
+			continue;
+		}
+		if ((selected == BLE_PICKIT_CHANNEL_COUNT) || (m_channels[i].priority < m_channels[selected].priority))
+		{
+			selected = i;
+		}
+	}
+
+	return selected;
+}
+
+static void channel_flow_update(void)
+{
+	uint8_t mask = 0;
+	uint8_t i;
+
+	for (i = 0 ; i < BLE_PICKIT_CHANNEL_COUNT ; i++)
+	{
+		uint32_t free = fifo_free_get(&m_channels[i].to_ble_fifo);
+
+		// Hysteresis: a paused channel resumes only once its queue is half empty.
+		m_channels[i].is_paused = m_channels[i].is_paused ? (free < CHANNEL_RESUME_LEVEL) : (free < CHANNEL_PAUSE_LEVEL);
+		mask |= (m_channels[i].is_paused << i);
+	}
+
+	if (mask != m_flow_mask)
+	{
+		m_flow_mask = mask;
+		m_is_flow_updated = true;
+	}
+}
+
+void ble_pickit_channel_uart_receive(uint8_t channel, uint8_t const * p_data, uint8_t length)
+{
+	if (channel >= BLE_PICKIT_CHANNEL_COUNT)
+	{
+		return;
+	}
+
+	if (!record_put(&m_channels[channel].to_ble_fifo, p_data, length))
+	{
+		NRF_LOG_INFO("Channel %d: notification queue full, frame dropped.", channel);
+	}
+	channel_flow_update();
+}
+
+/**@brief Function for queuing a channel characteristic write.
+ *
+ * @details The UART frames are sent by ble_stack_tasks().
+ */
+void ble_pickit_channel_ble_receive(uint8_t channel, uint8_t const * p_data, uint16_t length)
+{
+	if ((channel >= BLE_PICKIT_CHANNEL_COUNT) || (length > UINT8_MAX))
+	{
+		return;
+	}
+
+	if (!record_put(&m_channels[channel].to_uart_fifo, p_data, (uint8_t) length))
+	{
+		NRF_LOG_INFO("Channel %d: UART queue full, write dropped.", channel);
+	}
+}
+
+static uint16_t channel_notif(uint8_t *buffer)
+{
+	return record_peek(&m_channels[m_notif_channel].to_ble_fifo, buffer);
+}
+
+void ble_pickit_channel_notification_tasks(void)
+{
+	uint8_t done_mask = 0;
+	uint8_t channel;
+
+	// One notification per channel and per call: the highest priority channel always gets the first free SoftDevice buffer.
+	while ((channel = channel_select(true, done_mask)) < BLE_PICKIT_CHANNEL_COUNT)
+	{
+		m_notif_channel = channel;
+		if (ble_pickit_channel_notification_send(channel, channel_notif))
+		{
+			// NRF_ERROR_RESOURCES: retried from the highest priority channel on the next call.
+			break;
+		}
+		record_drop(&m_channels[channel].to_ble_fifo);
+		done_mask |= (1 << channel);
+	}
+
+	channel_flow_update();
+}
+
+bool ble_pickit_channel_uart_is_pending(void)
+{
+	return (m_uart_channel < BLE_PICKIT_CHANNEL_COUNT) || (channel_select(false, 0) < BLE_PICKIT_CHANNEL_COUNT);
+}
+
+/**@brief Function for getting the next record to send over the UART (kept in its queue until ble_pickit_channel_uart_consume).
+ *
+ * @param[out] p_channel  Channel of the record.
+ * @param[out] p_data     Data of the record.
+ *
+ * @return Length of the record.
+ */
+uint8_t ble_pickit_channel_uart_peek(uint8_t * p_channel, uint8_t * p_data)
+{
+	if (m_uart_channel >= BLE_PICKIT_CHANNEL_COUNT)
+	{
+		m_uart_channel = channel_select(false, 0);
+	}
+	*p_channel = m_uart_channel;
+
+	return (m_uart_channel < BLE_PICKIT_CHANNEL_COUNT) ? record_peek(&m_channels[m_uart_channel].to_uart_fifo, p_data) : 0;
+}
+
+void ble_pickit_channel_uart_consume(void)
+{
+	if (m_uart_channel < BLE_PICKIT_CHANNEL_COUNT)
+	{
+		record_drop(&m_channels[m_uart_channel].to_uart_fifo);
+		m_uart_channel = BLE_PICKIT_CHANNEL_COUNT;
+	}
+}
+
+bool ble_pickit_channel_flow_is_updated(void)
+{
+	bool is_updated = m_is_flow_updated;
+
+	m_is_flow_updated = false;
+	return is_updated;
+}
+
+uint8_t ble_pickit_channel_flow_get(void)
+{
+	return m_flow_mask;
+}
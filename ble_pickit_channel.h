@@ -0,0 +1,46 @@
+#ifndef BLE_PICKIT_CHANNEL_H
+#define BLE_PICKIT_CHANNEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "app_fifo.h"
+
+/*
+ * Logical channels: each channel is a notify / write characteristic (MESSAGE_CHANNEL_UUID + channel)
+ * mapped to the UART frames ID_CHANNEL_BUFFER | channel (no ID / Length header in the characteristic value).
+ *  - UART -> BLE: one queue per channel, the notifications are sent by priority (0: highest) so a bulk
+ *    channel never delays the frames of a control channel waiting in another queue.
+ *  - BLE -> UART: one queue per channel, the UART frames are sent by priority as well.
+ *  - Flow control: the host receives ID_CHANNEL_FLOW (bit n = 1: stop sending on the channel n) each time
+ *    a queue crosses its pause / resume level.
+ */
+#define BLE_PICKIT_CHANNEL_COUNT			3
+#define CHANNEL_TO_BLE_FIFO_SIZE			1024								// Must be a power of 2 (app_fifo)
+#define CHANNEL_TO_UART_FIFO_SIZE			512									// Must be a power of 2 (app_fifo)
+#define CHANNEL_PAUSE_LEVEL					(2 * (1 + 242))						// Free bytes: room for the frames in flight on the UART
+#define CHANNEL_RESUME_LEVEL				(CHANNEL_TO_BLE_FIFO_SIZE / 2)
+
+typedef struct
+{
+	app_fifo_t						to_ble_fifo;						/**< Records: Length (1B) - Data */
+	uint8_t							to_ble_buffer[CHANNEL_TO_BLE_FIFO_SIZE];
+	app_fifo_t						to_uart_fifo;						/**< Records: Length (1B) - Data */
+	uint8_t							to_uart_buffer[CHANNEL_TO_UART_FIFO_SIZE];
+	uint8_t							priority;
+	bool							is_paused;
+} ble_pickit_channel_t;
+
+void ble_pickit_channel_init(void);
+void ble_pickit_channel_priority_set(uint8_t channel, uint8_t priority);
+void ble_pickit_channel_uart_receive(uint8_t channel, uint8_t const * p_data, uint8_t length);
+void ble_pickit_channel_ble_receive(uint8_t channel, uint8_t const * p_data, uint16_t length);
+void ble_pickit_channel_notification_tasks(void);
+
+bool ble_pickit_channel_uart_is_pending(void);
+uint8_t ble_pickit_channel_uart_peek(uint8_t * p_channel, uint8_t * p_data);
+void ble_pickit_channel_uart_consume(void);
+
+bool ble_pickit_channel_flow_is_updated(void);
+uint8_t ble_pickit_channel_flow_get(void);
+
+#endif
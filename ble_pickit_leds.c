@@ -0,0 +1,213 @@
+#include "sdk_common.h"
+#include "app_timer.h"
+#include "app_util_platform.h"
+#include "ble_pickit_board.h"
+#include "ble_pickit_profiler.h"
+#include "ble_pickit_leds.h"
+
+typedef struct
+{
+	uint32_t						led;
+	uint32_t						time;								/**< ms */
+	volatile bool					is_running;							/**< LED on, timer started */
+	volatile bool					is_activity;						/**< Activity since the timer started */
+	volatile bool					is_busy;							/**< Kept on until the end of the activity */
+} leds_activity_t;
+
+APP_TIMER_DEF(m_ble_timer_id);
+APP_TIMER_DEF(m_uart_timer_id);
+APP_TIMER_DEF(m_advertising_timer_id);
+
+static leds_activity_t m_ble = {LED_1, LEDS_BLE_ACTIVITY_TIME, false, false, false};
+static leds_activity_t m_uart = {LED_3, LEDS_UART_ACTIVITY_TIME, false, false, false};
+static volatile bool m_is_enabled = false;
+static volatile bool m_is_init_done = false;
+static bool m_is_connected = false;
+static bool m_is_advertising = false;
+static bool m_is_blinking = false;
+static volatile bool m_blink_state = false;
+
+static void led_write(uint32_t led, bool value)
+{
+	if (m_is_enabled && m_is_init_done)
+	{
+		board_led_lat(led, value);
+	}
+}
+
+/**@brief Function for starting the on time of an activity LED or latching the activity if it is already on.
+ *
+ * @details Called from the main loop: the timer handler (app_timer interrupt) can not end the on time between the test
+ *          of is_running and the latch.
+ */
+static void activity_event(leds_activity_t * p_activity, app_timer_id_t timer_id)
+{
+	bool is_start;
+
+	CRITICAL_REGION_ENTER();
+	is_start = !p_activity->is_running;
+	p_activity->is_running = true;
+	p_activity->is_activity = !is_start;
+	CRITICAL_REGION_EXIT();
+
+	if (is_start)
+	{
+		led_write(p_activity->led, true);
+		(void) app_timer_start(timer_id, APP_TIMER_TICKS(p_activity->time), NULL);
+	}
+}
+
+/**@brief Function for ending (or extending if an activity occurred meanwhile) the on time of an activity LED.
+ */
+static void activity_timeout(leds_activity_t * p_activity, app_timer_id_t timer_id)
+{
+	PROFILER_BEGIN(PROFILER_REGION_LEDS);
+	if (p_activity->is_activity || p_activity->is_busy)
+	{
+		p_activity->is_activity = false;
+		led_write(p_activity->led, true);
+		(void) app_timer_start(timer_id, APP_TIMER_TICKS(p_activity->time), NULL);
+	}
+	else
+	{
+		led_write(p_activity->led, false);
+		p_activity->is_running = false;
+	}
+	PROFILER_END(PROFILER_REGION_LEDS);
+}
+
+static void ble_timer_handler(void * p_context)
+{
+	activity_timeout(&m_ble, m_ble_timer_id);
+}
+
+static void uart_timer_handler(void * p_context)
+{
+	activity_timeout(&m_uart, m_uart_timer_id);
+}
+
+static void advertising_timer_handler(void * p_context)
+{
+	m_blink_state = !m_blink_state;
+	led_write(LED_2, m_blink_state);
+}
+
+/**@brief Function for updating LED_2 with the state of the link.
+ */
+static void link_update(void)
+{
+	bool is_blinking = !m_is_connected && m_is_advertising;
+
+	if (is_blinking != m_is_blinking)
+	{
+		m_is_blinking = is_blinking;
+		if (is_blinking)
+		{
+			(void) app_timer_start(m_advertising_timer_id, APP_TIMER_TICKS(LEDS_ADVERTISING_PERIOD), NULL);
+		}
+		else
+		{
+			(void) app_timer_stop(m_advertising_timer_id);
+		}
+	}
+	if (!is_blinking)
+	{
+		led_write(LED_2, m_is_connected);
+	}
+}
+
+/**@brief Function for setting the three LEDs from the current state (enable, end of the initialization).
+ */
+static void leds_refresh(void)
+{
+	if (!m_is_enabled)
+	{
+		board_led_clr(LED_1);
+		board_led_clr(LED_2);
+		board_led_clr(LED_3);
+	}
+	else if (!m_is_init_done)
+	{
+		board_led_set(LED_1);
+		board_led_set(LED_2);
+		board_led_set(LED_3);
+	}
+	else
+	{
+		led_write(LED_1, m_ble.is_running);
+		led_write(LED_3, m_uart.is_running);
+		led_write(LED_2, m_is_blinking ? m_blink_state : m_is_connected);
+	}
+}
+
+void ble_pickit_leds_init(bool enable)
+{
+	APP_ERROR_CHECK(app_timer_create(&m_ble_timer_id, APP_TIMER_MODE_SINGLE_SHOT, ble_timer_handler));
+	APP_ERROR_CHECK(app_timer_create(&m_uart_timer_id, APP_TIMER_MODE_SINGLE_SHOT, uart_timer_handler));
+	APP_ERROR_CHECK(app_timer_create(&m_advertising_timer_id, APP_TIMER_MODE_REPEATED, advertising_timer_handler));
+
+	m_is_enabled = enable;
+	leds_refresh();
+}
+
+void ble_pickit_leds_enable(bool enable)
+{
+	m_is_enabled = enable;
+	leds_refresh();
+}
+
+void ble_pickit_leds_event(leds_evt_t evt)
+{
+	switch (evt)
+	{
+		case LEDS_EVT_INIT_DONE:
+			m_is_init_done = true;
+			leds_refresh();
+			break;
+
+		case LEDS_EVT_BLE_ACTIVITY:
+			activity_event(&m_ble, m_ble_timer_id);
+			break;
+
+		case LEDS_EVT_UART_ACTIVITY:
+			activity_event(&m_uart, m_uart_timer_id);
+			break;
+
+		case LEDS_EVT_UART_TX_START:
+			if (!m_uart.is_busy)
+			{
+				m_uart.is_busy = true;
+				activity_event(&m_uart, m_uart_timer_id);
+			}
+			break;
+
+		case LEDS_EVT_UART_TX_DONE:
+			m_uart.is_busy = false;
+			activity_event(&m_uart, m_uart_timer_id);
+			break;
+
+		case LEDS_EVT_ADVERTISING_START:
+			m_is_advertising = true;
+			link_update();
+			break;
+
+		case LEDS_EVT_ADVERTISING_STOP:
+			m_is_advertising = false;
+			link_update();
+			break;
+
+		case LEDS_EVT_CONNECTED:
+			m_is_connected = true;
+			m_is_advertising = false;
+			link_update();
+			break;
+
+		case LEDS_EVT_DISCONNECTED:
+			m_is_connected = false;
+			link_update();
+			break;
+
+		default:
+			break;
+	}
+}
@@ -0,0 +1,37 @@
+#ifndef BLE_PICKIT_LEDS_H
+#define BLE_PICKIT_LEDS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Status LEDs driven by events and app_timer (no polling in the main loop):
+ *  - All on until LEDS_EVT_INIT_DONE.
+ *  - LED_1: BLE service event, on for LEDS_BLE_ACTIVITY_TIME after the last one.
+ *  - LED_2: on when connected, blinking (LEDS_ADVERTISING_PERIOD) when advertising, off otherwise.
+ *  - LED_3: UART, on during the transmissions and LEDS_UART_ACTIVITY_TIME after the last activity.
+ * An activity restarts nothing: it is latched and checked when the timer of its LED expires (off time between 1 and 2
+ * times the activity time), so an event costs a few instructions. params.leds_status_enable: ble_pickit_leds_enable().
+ */
+#define LEDS_BLE_ACTIVITY_TIME				1									// ms
+#define LEDS_UART_ACTIVITY_TIME				20									// ms
+#define LEDS_ADVERTISING_PERIOD				125									// ms, half period
+
+typedef enum
+{
+	LEDS_EVT_INIT_DONE,
+	LEDS_EVT_BLE_ACTIVITY,
+	LEDS_EVT_UART_ACTIVITY,
+	LEDS_EVT_UART_TX_START,
+	LEDS_EVT_UART_TX_DONE,
+	LEDS_EVT_ADVERTISING_START,
+	LEDS_EVT_ADVERTISING_STOP,
+	LEDS_EVT_CONNECTED,
+	LEDS_EVT_DISCONNECTED,
+} leds_evt_t;
+
+void ble_pickit_leds_init(bool enable);
+void ble_pickit_leds_enable(bool enable);
+void ble_pickit_leds_event(leds_evt_t evt);
+
+#endif
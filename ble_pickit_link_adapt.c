@@ -0,0 +1,186 @@
+#include "sdk_common.h"
+#include "nrf_log.h"
+#include "ble_gap.h"
+#include "ble_pickit_board.h"
+#include "ble_vsd.h"
+#include "ble_pickit_stats.h"
+#include "ble_pickit_trace.h"
+#include "ble_pickit_link_adapt.h"
+
+typedef struct
+{
+	uint8_t							phys;								/**< BLE_GAP_PHY_xxx, 0: preferred PHY */
+	int8_t							tx_power;							/**< dBm */
+	bool							pa_lna;
+	int8_t							rssi_threshold;						/**< dBm, below: next level */
+} link_adapt_level_t;
+
+static const link_adapt_level_t m_levels[] =
+{
+	{0,						0,	false,	-70},
+	{BLE_GAP_PHY_1MBPS,		0,	false,	-80},
+	{BLE_GAP_PHY_1MBPS,		4,	false,	-88},
+	{BLE_GAP_PHY_1MBPS,		4,	true,	INT8_MIN},
+};
+
+#define LINK_ADAPT_LEVEL_COUNT				(sizeof(m_levels) / sizeof(m_levels[0]))
+
+static uint16_t m_conn_handle = BLE_CONN_HANDLE_INVALID;
+static uint8_t m_level = 0;
+static bool m_is_apply_pending = false;
+static int16_t m_rssi = 0;												/**< Average (dBm), 0: no sample yet */
+static uint8_t m_hold = 0;
+static uint64_t m_sample_tick;
+static uint64_t m_period_tick;
+static uint32_t m_notifications;
+static uint32_t m_queue_full;
+static uint32_t m_bytes;
+
+/**@brief Function for getting the increase of a statistics counter since the last period (reset by ID_STATS included).
+ */
+static uint32_t counter_delta(stats_counter_t counter, uint32_t * p_last)
+{
+	uint32_t value = ble_pickit_stats_get(counter);
+	uint32_t delta = (value >= *p_last) ? (value - *p_last) : value;
+
+	*p_last = value;
+	return delta;
+}
+
+void ble_pickit_link_adapt_start(uint16_t conn_handle)
+{
+	m_conn_handle = conn_handle;
+	m_level = 0;
+	m_is_apply_pending = false;
+	m_rssi = 0;
+	m_hold = 0;
+	m_sample_tick = mGetTick();
+	m_period_tick = mGetTick();
+	m_notifications = ble_pickit_stats_get(STATS_NOTIFICATIONS);
+	m_queue_full = ble_pickit_stats_get(STATS_HVX_QUEUE_FULL);
+	m_bytes = ble_pickit_stats_get(STATS_NOTIFICATION_BYTES);
+
+	(void) sd_ble_gap_rssi_start(conn_handle, BLE_GAP_RSSI_THRESHOLD_INVALID, 0);
+}
+
+/**@brief Function for stopping the adaptation on disconnection (the PA/LNA goes back to params.pa_lna_enable).
+ */
+void ble_pickit_link_adapt_stop(ble_pickit_params const * p_params)
+{
+	if (m_levels[m_level].pa_lna && !p_params->pa_lna_enable)
+	{
+		board_pa_lna_init(false);
+	}
+	m_conn_handle = BLE_CONN_HANDLE_INVALID;
+	m_level = 0;
+	m_is_apply_pending = false;
+}
+
+/**@brief Function for applying the PHY, TX power and PA/LNA of the current level (retried while the SoftDevice is busy).
+ */
+static void level_apply(ble_pickit_params const * p_params)
+{
+	link_adapt_level_t const * p_level = &m_levels[m_level];
+	ble_gap_phys_t phys = p_params->preferred_gap_params.phys_params;
+	uint32_t err_code;
+
+	if (p_level->phys != 0)
+	{
+		phys.tx_phys = p_level->phys;
+		phys.rx_phys = p_level->phys;
+	}
+
+	err_code = sd_ble_gap_phy_update(m_conn_handle, &phys);
+	if (err_code == NRF_ERROR_BUSY)
+	{
+		return;
+	}
+
+	(void) sd_ble_gap_tx_power_set(BLE_GAP_TX_POWER_ROLE_CONN, m_conn_handle, p_level->tx_power);
+	board_pa_lna_init(p_level->pa_lna || p_params->pa_lna_enable);
+	m_is_apply_pending = false;
+}
+
+static void level_change(uint8_t level, uint8_t loss, uint32_t goodput)
+{
+	NRF_LOG_INFO("Link adaptation: level %d -> %d (RSSI %d dBm, loss %d%%, goodput %d B/s)", m_level, level, m_rssi, loss, goodput);
+	TRACE(TRACE_MODULE_LINK, TRACE_LEVEL_INFO, TRACE_EVT_LINK_ADAPT, (m_level << 8) | level, goodput);
+	m_level = level;
+	m_hold = 0;
+	m_is_apply_pending = true;
+}
+
+void ble_pickit_link_adapt_tasks(ble_pickit_params const * p_params)
+{
+	uint32_t notifications, queue_full, bytes, goodput;
+	uint8_t loss = 0;
+	int8_t rssi;
+	uint8_t channel;
+
+	if (m_conn_handle == BLE_CONN_HANDLE_INVALID)
+	{
+		return;
+	}
+
+	if (!p_params->link_adapt_enable)
+	{
+		if (m_level != 0)
+		{
+			level_change(0, 0, 0);
+		}
+	}
+	else
+	{
+		if (mTickCompare(m_sample_tick) >= (LINK_ADAPT_SAMPLE_PERIOD * TICK_1MS))
+		{
+			m_sample_tick = mGetTick();
+			if (sd_ble_gap_rssi_get(m_conn_handle, &rssi, &channel) == NRF_SUCCESS)
+			{
+				m_rssi = (m_rssi == 0) ? rssi : ((3 * m_rssi + rssi) / 4);
+			}
+		}
+
+		if (mTickCompare(m_period_tick) >= (LINK_ADAPT_PERIOD * TICK_1MS))
+		{
+			m_period_tick = mGetTick();
+
+			notifications = counter_delta(STATS_NOTIFICATIONS, &m_notifications);
+			queue_full = counter_delta(STATS_HVX_QUEUE_FULL, &m_queue_full);
+			bytes = counter_delta(STATS_NOTIFICATION_BYTES, &m_bytes);
+			goodput = (bytes * 1000) / LINK_ADAPT_PERIOD;
+
+			// A refused notification is counted once (its retries are not) and again in notifications once accepted.
+			if (notifications >= LINK_ADAPT_LOSS_MIN_SAMPLES)
+			{
+				loss = (queue_full >= notifications) ? 100 : ((queue_full * 100) / notifications);
+			}
+
+			TRACE(TRACE_MODULE_LINK, TRACE_LEVEL_DEBUG, TRACE_EVT_LINK_PERIOD, (m_level << 8) | (uint8_t) m_rssi, goodput);
+
+			if (m_rssi == 0)
+			{
+				// No RSSI sample yet.
+			}
+			else if (((m_rssi < m_levels[m_level].rssi_threshold) || (loss > LINK_ADAPT_LOSS_HIGH)) && ((m_level + 1) < LINK_ADAPT_LEVEL_COUNT))
+			{
+				level_change(m_level + 1, loss, goodput);
+			}
+			else if ((m_level > 0) && (m_rssi >= (m_levels[m_level - 1].rssi_threshold + LINK_ADAPT_HYSTERESIS)) && (loss < LINK_ADAPT_LOSS_LOW))
+			{
+				if (++m_hold >= LINK_ADAPT_HOLD)
+				{
+					level_change(m_level - 1, loss, goodput);
+				}
+			}
+			else
+			{
+				m_hold = 0;
+			}
+		}
+	}
+
+	if (m_is_apply_pending)
+	{
+		level_apply(p_params);
+	}
+}
@@ -0,0 +1,31 @@
+#ifndef BLE_PICKIT_LINK_ADAPT_H
+#define BLE_PICKIT_LINK_ADAPT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ble_vsd.h"
+
+/*
+ * Link adaptation (params.link_adapt_enable): the connection RSSI (averaged) and the notification loss signal
+ * (notifications refused at least once by the SoftDevice / notifications sent, see STATS_HVX_QUEUE_FULL) move the link
+ * between levels of increasing robustness:
+ *   0: preferred PHY - 0 dBm      1: 1 Mbps - 0 dBm      2: 1 Mbps - +4 dBm      3: 1 Mbps - +4 dBm - PA/LNA
+ * A level is left for a more robust one as soon as the RSSI falls below its threshold or the loss exceeds
+ * LINK_ADAPT_LOSS_HIGH, it comes back when the RSSI is LINK_ADAPT_HYSTERESIS dB above this threshold with a low loss
+ * for LINK_ADAPT_HOLD periods. Each decision is logged with the RSSI, the loss and the goodput of the period, each
+ * period is traced (TRACE_EVT_LINK_PERIOD). Disabling the adaptation restores level 0.
+ *  - UART: ID_LINK_ADAPT - Length (1) - Enable.
+ */
+#define LINK_ADAPT_SAMPLE_PERIOD			100									// ms, RSSI sample
+#define LINK_ADAPT_PERIOD					1000								// ms, decision
+#define LINK_ADAPT_HYSTERESIS				8									// dB
+#define LINK_ADAPT_HOLD						3									// Periods
+#define LINK_ADAPT_LOSS_HIGH				50									// %
+#define LINK_ADAPT_LOSS_LOW					10									// %
+#define LINK_ADAPT_LOSS_MIN_SAMPLES			20									// Notifications sent in the period
+
+void ble_pickit_link_adapt_start(uint16_t conn_handle);
+void ble_pickit_link_adapt_stop(ble_pickit_params const * p_params);
+void ble_pickit_link_adapt_tasks(ble_pickit_params const * p_params);
+
+#endif
@@ -0,0 +1,89 @@
+#include "ble_pickit_link_model.h"
+
+#define LINK_MODEL_PHY_2MBPS				2									// BLE_GAP_PHY_2MBPS
+#define LINK_MODEL_LL_OVERHEAD				9									// Access address (4) - Header (2) - CRC (3)
+#define LINK_MODEL_L2CAP_HEADER				4
+#define LINK_MODEL_ATT_HEADER				3
+
+/**@brief Function for getting the air time of a LL packet (preamble: 1 byte at 1 Mbps, 2 bytes at 2 Mbps).
+ */
+static uint32_t air_time_us(uint8_t phy, uint16_t payload)
+{
+	if (phy == LINK_MODEL_PHY_2MBPS)
+	{
+		return ((2 + LINK_MODEL_LL_OVERHEAD + payload) * 8) / 2;
+	}
+	return (1 + LINK_MODEL_LL_OVERHEAD + payload) * 8;
+}
+
+void ble_pickit_link_model_run(ble_pickit_link_model_params_t const * p_params, ble_pickit_link_model_result_t * p_result)
+{
+	uint32_t interval_us = p_params->conn_interval * 1250UL;
+	uint32_t event_us = p_params->is_event_extension ? interval_us : (p_params->event_length * 1250UL);
+	uint32_t exchange_us;
+	uint32_t packets;
+
+	p_result->exchange_time_us = 0;
+	p_result->packets_per_event = 0;
+	p_result->throughput = 0;
+
+	if ((interval_us == 0) || (p_params->max_tx_octets <= LINK_MODEL_ATT_HEADER))
+	{
+		return;
+	}
+
+	if (event_us > interval_us)
+	{
+		event_us = interval_us;
+	}
+	event_us = (event_us > LINK_MODEL_EVENT_MARGIN_US) ? (event_us - LINK_MODEL_EVENT_MARGIN_US) : 0;
+
+	exchange_us = air_time_us(p_params->phy, p_params->max_tx_octets + LINK_MODEL_L2CAP_HEADER) + LINK_MODEL_T_IFS_US + air_time_us(p_params->phy, 0) + LINK_MODEL_T_IFS_US;
+	packets = event_us / exchange_us;
+	if ((p_params->hvn_queue_size > 0) && (packets > p_params->hvn_queue_size))
+	{
+		packets = p_params->hvn_queue_size;
+	}
+
+	p_result->exchange_time_us = exchange_us;
+	p_result->packets_per_event = packets;
+	p_result->throughput = (uint32_t) (((uint64_t) packets * (p_params->max_tx_octets - LINK_MODEL_ATT_HEADER) * 1000000UL) / interval_us);
+}
+
+void ble_pickit_link_model_params_decode(uint8_t const * p_buffer, ble_pickit_link_model_params_t * p_params)
+{
+	p_params->conn_interval = (p_buffer[0] << 8) | (p_buffer[1] << 0);
+	p_params->event_length = (p_buffer[2] << 8) | (p_buffer[3] << 0);
+	p_params->is_event_extension = (p_buffer[4] != 0);
+	p_params->phy = p_buffer[5];
+	p_params->max_tx_octets = p_buffer[6];
+	p_params->hvn_queue_size = p_buffer[7];
+}
+
+/**@brief Function for running the model and encoding Params - Result (LINK_MODEL_RESULT_SIZE bytes).
+ */
+uint8_t ble_pickit_link_model_encode(ble_pickit_link_model_params_t const * p_params, uint8_t * p_buffer)
+{
+	ble_pickit_link_model_result_t result;
+
+	ble_pickit_link_model_run(p_params, &result);
+
+	*p_buffer++ = (p_params->conn_interval >> 8) & 0xff;
+	*p_buffer++ = (p_params->conn_interval >> 0) & 0xff;
+	*p_buffer++ = (p_params->event_length >> 8) & 0xff;
+	*p_buffer++ = (p_params->event_length >> 0) & 0xff;
+	*p_buffer++ = p_params->is_event_extension;
+	*p_buffer++ = p_params->phy;
+	*p_buffer++ = p_params->max_tx_octets;
+	*p_buffer++ = p_params->hvn_queue_size;
+	*p_buffer++ = (result.exchange_time_us >> 8) & 0xff;
+	*p_buffer++ = (result.exchange_time_us >> 0) & 0xff;
+	*p_buffer++ = (result.packets_per_event >> 8) & 0xff;
+	*p_buffer++ = (result.packets_per_event >> 0) & 0xff;
+	*p_buffer++ = (result.throughput >> 24) & 0xff;
+	*p_buffer++ = (result.throughput >> 16) & 0xff;
+	*p_buffer++ = (result.throughput >> 8) & 0xff;
+	*p_buffer++ = (result.throughput >> 0) & 0xff;
+
+	return LINK_MODEL_RESULT_SIZE;
+}
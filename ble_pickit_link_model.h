@@ -0,0 +1,47 @@
+#ifndef BLE_PICKIT_LINK_MODEL_H
+#define BLE_PICKIT_LINK_MODEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Link layer timing model: notification throughput predicted from the parameters the firmware sets (connection
+ * interval, event length and extension, PHY, data length, HVN queue). Each notification is one LL packet (ATT payload:
+ * max_tx_octets - 3, as the throughput test and the app notifications) acknowledged by an empty packet of the central:
+ *   exchange = air time (data) + T_IFS + air time (empty) + T_IFS
+ *   packets per event = MIN(event time / exchange, HVN queue size)
+ * Retransmissions, encryption (MIC) and the other links are not modeled: the result is an upper bound.
+ * No SDK dependency: the model also builds on a host to sweep configurations.
+ *  - UART: ID_LINK_MODEL - Length (0) for the current (or preferred when disconnected) parameters,
+ *    ID_LINK_MODEL - Length (LINK_MODEL_PARAMS_SIZE) - Params for any parameters. Returns Params - Exchange time (us, 2B)
+ *    - Packets per event (2B) - Throughput (ATT payload bytes/s, 4B), big endian.
+ *  - Params: Conn interval (1.25 ms, 2B) - Event length (1.25 ms, 2B) - Event extension - PHY (BLE_GAP_PHY_1MBPS /
+ *    BLE_GAP_PHY_2MBPS) - Max TX octets (LL payload - 4) - HVN queue size (0: not limiting).
+ */
+#define LINK_MODEL_T_IFS_US					150
+#define LINK_MODEL_EVENT_MARGIN_US			150									// Guard before the next anchor point
+#define LINK_MODEL_PARAMS_SIZE				8
+#define LINK_MODEL_RESULT_SIZE				(LINK_MODEL_PARAMS_SIZE + 8)
+
+typedef struct
+{
+	uint16_t						conn_interval;						/**< 1.25 ms units. */
+	uint16_t						event_length;						/**< 1.25 ms units (gap_conn_cfg.event_length). */
+	bool							is_event_extension;					/**< BLE_COMMON_OPT_CONN_EVT_EXT */
+	uint8_t							phy;
+	uint8_t							max_tx_octets;
+	uint8_t							hvn_queue_size;
+} ble_pickit_link_model_params_t;
+
+typedef struct
+{
+	uint16_t						exchange_time_us;
+	uint16_t						packets_per_event;
+	uint32_t						throughput;							/**< ATT payload bytes per second. */
+} ble_pickit_link_model_result_t;
+
+void ble_pickit_link_model_run(ble_pickit_link_model_params_t const * p_params, ble_pickit_link_model_result_t * p_result);
+void ble_pickit_link_model_params_decode(uint8_t const * p_buffer, ble_pickit_link_model_params_t * p_params);
+uint8_t ble_pickit_link_model_encode(ble_pickit_link_model_params_t const * p_params, uint8_t * p_buffer);
+
+#endif
@@ -0,0 +1,83 @@
+#include "sdk_common.h"
+#include "ble_pickit_lz.h"
+
+void ble_pickit_lz_init(ble_pickit_lz_t * p_lz)
+{
+	p_lz->flags = 0;
+	p_lz->flags_count = 0;
+	p_lz->match = 0;
+	p_lz->is_match_pending = false;
+}
+
+/**@brief Function for decoding a part of a LZSS stream.
+ *
+ * @param[in,out] p_lz          Decoder state (kept between two fragments of the same stream).
+ * @param[in]     p_in          Compressed data.
+ * @param[in]     in_length     Length of the compressed data.
+ * @param[out]    p_out         Output buffer (also used as window).
+ * @param[in,out] p_out_length  Current length of the output (updated on success).
+ * @param[in]     out_size      Size of the output buffer.
+ *
+ * @return NRF_SUCCESS, NRF_ERROR_DATA_SIZE if the output overflows or NRF_ERROR_INVALID_DATA if a match
+ *         refers to data before the start of the output.
+ */
+uint32_t ble_pickit_lz_decode(ble_pickit_lz_t * p_lz, uint8_t const * p_in, uint16_t in_length, uint8_t * p_out, uint16_t * p_out_length, uint16_t out_size)
+{
+	uint16_t out_index = *p_out_length;
+	uint16_t i = 0;
+
+	while (i < in_length)
+	{
+		if (p_lz->flags_count == 0)
+		{
+			p_lz->flags = p_in[i++];
+			p_lz->flags_count = 8;
+			continue;
+		}
+
+		if (p_lz->flags & 0x01)
+		{
+			if (out_index >= out_size)
+			{
+				return NRF_ERROR_DATA_SIZE;
+			}
+			p_out[out_index++] = p_in[i++];
+		}
+		else if (!p_lz->is_match_pending)
+		{
+			p_lz->match = p_in[i++];
+			p_lz->is_match_pending = true;
+			continue;
+		}
+		else
+		{
+			uint16_t offset = ((p_lz->match << 4) | (p_in[i] >> 4)) + 1;
+			uint8_t length = (p_in[i] & 0x0f) + LZ_MIN_MATCH;
+
+			i++;
+			p_lz->is_match_pending = false;
+
+			if (offset > out_index)
+			{
+				return NRF_ERROR_INVALID_DATA;
+			}
+			if ((out_index + length) > out_size)
+			{
+				return NRF_ERROR_DATA_SIZE;
+			}
+			// Byte per byte: the source may overlap the destination (repeated pattern).
+			for ( ; length > 0 ; length--)
+			{
+				p_out[out_index] = p_out[out_index - offset];
+				out_index++;
+			}
+		}
+
+		p_lz->flags >>= 1;
+		p_lz->flags_count--;
+	}
+
+	*p_out_length = out_index;
+
+	return NRF_SUCCESS;
+}
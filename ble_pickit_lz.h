@@ -0,0 +1,34 @@
+#ifndef BLE_PICKIT_LZ_H
+#define BLE_PICKIT_LZ_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * LZSS stream used by the compressed extended messages (ID_CHAR_EXT_BUFFER_LZ).
+ *
+ * The stream is a sequence of groups: 1 flag byte followed by up to 8 items (flag bits LSB first).
+ *  - bit = 1: literal, 1 byte copied as is.
+ *  - bit = 0: match, 2 bytes [OOOOOOOO][OOOOLLLL] with O = offset - 1 (12 bits) and L = length - 3 (4 bits).
+ * A match copies 'length' bytes starting 'offset' bytes before the current end of the output.
+ * The stream ends with the input: the unused bits of the last flag byte are ignored.
+ *
+ * The window (4096 bytes) is the output buffer itself: decoding needs no other RAM than the
+ * ble_pickit_lz_t state and an item may be split between two BLE fragments.
+ */
+#define LZ_WINDOW_SIZE				4096
+#define LZ_MIN_MATCH				3
+#define LZ_MAX_MATCH				(LZ_MIN_MATCH + 15)
+
+typedef struct
+{
+	uint8_t							flags;
+	uint8_t							flags_count;			/**< Number of items remaining in the current group. */
+	uint8_t							match;					/**< First byte of a match split between two fragments. */
+	bool							is_match_pending;
+} ble_pickit_lz_t;
+
+void ble_pickit_lz_init(ble_pickit_lz_t * p_lz);
+uint32_t ble_pickit_lz_decode(ble_pickit_lz_t * p_lz, uint8_t const * p_in, uint16_t in_length, uint8_t * p_out, uint16_t * p_out_length, uint16_t out_size);
+
+#endif
@@ -0,0 +1,76 @@
+#include "sdk_common.h"
+#include "app_util_platform.h"
+#include "ble_pickit_profiler.h"
+
+static ble_pickit_profiler_record_t m_records[PROFILER_REGION_COUNT];
+
+/**@brief Function for starting the DWT cycle counter (not started by default out of a debug session).
+ */
+void ble_pickit_profiler_init(void)
+{
+#if defined(BLE_PICKIT_PROFILER_ENABLED)
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+#endif
+	ble_pickit_profiler_reset();
+}
+
+void ble_pickit_profiler_record(profiler_region_t region, uint32_t cycles)
+{
+	ble_pickit_profiler_record_t * p_record = &m_records[region];
+
+	if ((p_record->count == 0) || (cycles < p_record->min))
+	{
+		p_record->min = cycles;
+	}
+	if (cycles > p_record->max)
+	{
+		p_record->max = cycles;
+	}
+	p_record->sum += cycles;
+	p_record->count++;
+}
+
+void ble_pickit_profiler_reset(void)
+{
+	CRITICAL_REGION_ENTER();
+	memset(m_records, 0, sizeof(m_records));
+	CRITICAL_REGION_EXIT();
+}
+
+static uint8_t * encode_u32(uint8_t * p_buffer, uint32_t value)
+{
+	*p_buffer++ = (value >> 24) & 0xff;
+	*p_buffer++ = (value >> 16) & 0xff;
+	*p_buffer++ = (value >> 8) & 0xff;
+	*p_buffer++ = (value >> 0) & 0xff;
+	return p_buffer;
+}
+
+/**@brief Function for encoding the record of a region (Region - Count - Min - Avg - Max, big endian).
+ *
+ * @return PROFILER_RECORD_SIZE or 0 if the region does not exist.
+ */
+uint8_t ble_pickit_profiler_encode(uint8_t region, uint8_t * p_buffer)
+{
+	ble_pickit_profiler_record_t record;
+
+	if (region >= PROFILER_REGION_COUNT)
+	{
+		return 0;
+	}
+
+	// Copy first: the SoftDevice observers may update their regions meanwhile.
+	CRITICAL_REGION_ENTER();
+	record = m_records[region];
+	CRITICAL_REGION_EXIT();
+
+	*p_buffer++ = region;
+	p_buffer = encode_u32(p_buffer, record.count);
+	p_buffer = encode_u32(p_buffer, record.min);
+	p_buffer = encode_u32(p_buffer, (record.count > 0) ? (uint32_t) (record.sum / record.count) : 0);
+	(void) encode_u32(p_buffer, record.max);
+
+	return PROFILER_RECORD_SIZE;
+}
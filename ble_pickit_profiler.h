@@ -0,0 +1,55 @@
+#ifndef BLE_PICKIT_PROFILER_H
+#define BLE_PICKIT_PROFILER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "nrf.h"
+
+/*
+ * Cycle profiler: PROFILER_BEGIN / PROFILER_END around a region of code record its number of executions and its
+ * min / avg / max duration in CPU cycles (DWT cycle counter, 64 MHz). The probes cost a few cycles and are removed
+ * from the build when BLE_PICKIT_PROFILER_ENABLED is not defined.
+ * A region is only probed from one context (main loop or SoftDevice observers), its record has a single writer.
+ *  - UART: ID_PROFILER - Length (0) returns Region - Count (4B) - Min (4B) - Avg (4B) - Max (4B) for each region,
+ *    ID_PROFILER - Length (1) - 0x01 resets the records.
+ *  - GATT: read of the cache characteristic with the key CACHE_KEY_PROFILER + region.
+ */
+//#define BLE_PICKIT_PROFILER_ENABLED
+
+typedef enum
+{
+	PROFILER_REGION_MAIN_LOOP,					/**< Iteration of the main loop (without the log processing / sleep). */
+	PROFILER_REGION_MAIN_EVT,					/**< main_evt_process() */
+	PROFILER_REGION_LEDS,						/**< LED engine (app_timer handlers) */
+	PROFILER_REGION_UART_RX,					/**< UART byte poll, frame check and dispatch */
+	PROFILER_REGION_FLAGS,						/**< Flag chain (UART requests and notifications) */
+	PROFILER_REGION_CRC,						/**< fu_crc_16_ibm() */
+	PROFILER_REGION_BLE_EVT,					/**< ble_evt_handler() (SoftDevice observer) */
+	PROFILER_REGION_SERVICE_EVT,				/**< ble_pickit_service_event_handler() (SoftDevice observer) */
+	PROFILER_REGION_COUNT
+} profiler_region_t;
+
+#define PROFILER_RECORD_SIZE					17			// Region - Count - Min - Avg - Max
+
+typedef struct
+{
+	uint32_t						count;
+	uint32_t						min;
+	uint32_t						max;
+	uint64_t						sum;
+} ble_pickit_profiler_record_t;
+
+#if defined(BLE_PICKIT_PROFILER_ENABLED)
+#define PROFILER_BEGIN(_region)				uint32_t _profiler_start_##_region = DWT->CYCCNT
+#define PROFILER_END(_region)				ble_pickit_profiler_record(_region, DWT->CYCCNT - _profiler_start_##_region)
+#else
+#define PROFILER_BEGIN(_region)
+#define PROFILER_END(_region)
+#endif
+
+void ble_pickit_profiler_init(void);
+void ble_pickit_profiler_record(profiler_region_t region, uint32_t cycles);
+void ble_pickit_profiler_reset(void);
+uint8_t ble_pickit_profiler_encode(uint8_t region, uint8_t * p_buffer);
+
+#endif
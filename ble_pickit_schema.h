@@ -0,0 +1,112 @@
+#ifndef BLE_PICKIT_SCHEMA_H
+#define BLE_PICKIT_SCHEMA_H
+
+#include <stdint.h>
+#include "ble_gap.h"
+#include "ble_vsd.h"
+
+/*
+ * Message schema: the fixed layouts and the inbound IDs are declared once (X-macros), the encoders, decoders and
+ * dispatch tables are generated from these lists. All the fields are big endian.
+ */
+
+/**@brief Parameters snapshot: ID_GET_BLE_PARAMS (UART) and sub-command 0x00 of the params characteristic.
+ *        X(size, field of ble_pickit_params)
+ */
+#define BLE_PICKIT_PARAMS_LAYOUT(X)														\
+	X(2, current_gap_params.conn_params.min_conn_interval)								\
+	X(2, current_gap_params.conn_params.max_conn_interval)								\
+	X(2, current_gap_params.conn_params.slave_latency)									\
+	X(2, current_gap_params.conn_params.conn_sup_timeout)								\
+	X(1, current_gap_params.phys_params.tx_phys)										\
+	X(1, current_gap_params.mtu_size_params.max_tx_octets)								\
+	X(1, current_gap_params.mtu_size_params.max_rx_octets)								\
+	X(1, pa_lna_enable)																	\
+	X(1, leds_status_enable)
+
+/**@brief Connection parameters: ID_SET_BLE_CONN_PARAMS (UART) and sub-command 0x01 of the params characteristic.
+ *        X(size, field of ble_gap_conn_params_t)
+ */
+#define BLE_PICKIT_CONN_PARAMS_LAYOUT(X)												\
+	X(2, min_conn_interval)																\
+	X(2, max_conn_interval)																\
+	X(2, slave_latency)																	\
+	X(2, conn_sup_timeout)
+
+/**@brief Frames received from the host MCU (ble_vsd.c).
+ *        X(ID, minimum length, maximum length, handler). The IDs without entry are ignored (ID_CHANNEL_BUFFER | channel
+ *        excepted) as well as the frames out of their length range.
+ */
+#define BLE_PICKIT_UART_RX_SCHEMA(X)													\
+	X(ID_PA_LNA,					1,	UINT8_MAX,	_rx_pa_lna)								\
+	X(ID_LED_STATUS,				1,	UINT8_MAX,	_rx_led_status)							\
+	X(ID_SET_NAME,					0,	19,			_rx_set_name)							\
+	X(ID_GET_VERSION,				0,	UINT8_MAX,	_rx_get_version)						\
+	X(ID_ADV_INTERVAL,				2,	UINT8_MAX,	_rx_adv_interval)						\
+	X(ID_ADV_TIMEOUT,				2,	UINT8_MAX,	_rx_adv_timeout)						\
+	X(ID_EXT_COMPRESSION,			1,	UINT8_MAX,	_rx_ext_compression)					\
+	X(ID_NOTIF_AGGREGATION,			1,	UINT8_MAX,	_rx_notif_aggregation)					\
+	X(ID_TRANSPARENT_MODE,			1,	UINT8_MAX,	_rx_transparent_mode)					\
+	X(ID_CHANNEL_CONFIG,			2,	UINT8_MAX,	_rx_channel_config)						\
+	X(ID_UART_FULL_DUPLEX,			1,	UINT8_MAX,	_rx_uart_full_duplex)					\
+	X(ID_NOTIF_FLOW,				1,	UINT8_MAX,	_rx_notif_flow)							\
+	X(ID_RPC_TIMEOUT,				2,	UINT8_MAX,	_rx_rpc_timeout)						\
+	X(ID_PROFILER,					0,	1,			_rx_profiler)							\
+	X(ID_TRACE,						0,	0,			_rx_trace)								\
+	X(ID_CAPTURE,					1,	1,			_rx_capture)							\
+	X(ID_STATS,						0,	1,			_rx_stats)								\
+	X(ID_BENCHMARK,					0,	0,			_rx_benchmark)							\
+	X(ID_LINK_MODEL,				0,	8,			_rx_link_model)							\
+	X(ID_LINK_ADAPT,				1,	UINT8_MAX,	_rx_link_adapt)							\
+	X(ID_SET_BLE_CONN_PARAMS,		8,	UINT8_MAX,	_rx_set_ble_conn_params)				\
+	X(ID_SET_BLE_PHY_PARAMS,		1,	UINT8_MAX,	_rx_set_ble_phy_params)					\
+	X(ID_SET_BLE_ATT_SIZE_PARAMS,	2,	UINT8_MAX,	_rx_set_ble_att_size_params)			\
+	X(ID_CHAR_BUFFER,				0,	NOTIF_RECORD_MAX_LENGTH,	_rx_char_buffer)		\
+	X(ID_CHAR_BROADCAST_BUFFER,		0,	UINT8_MAX,	_rx_char_broadcast_buffer)				\
+	X(ID_CHAR_BUFFER_FLUSH,			0,	NOTIF_RECORD_MAX_LENGTH,	_rx_char_buffer_flush)	\
+	X(ID_RPC_RESPONSE,				2,	NOTIF_RECORD_MAX_LENGTH,	_rx_rpc_response)		\
+	X(ID_CACHE_UPDATE,				3,	UINT8_MAX,	_rx_cache_update)						\
+	X(ID_SOFTWARE_RESET,			1,	1,			_rx_software_reset)
+
+/**@brief Writes of the params characteristic (main.c): Sub-command - Length - Data (0x00: Sub-command only).
+ *        X(sub-command, write length, handler). Sub-command 0x01 is told apart by its length.
+ */
+#define BLE_PICKIT_PARAMS_WRITE_SCHEMA(X)												\
+	X(0x00,		1,		params_write_all)												\
+	X(0x01,		10,		params_write_conn)												\
+	X(0x02,		3,		params_write_phy)												\
+	X(0x03,		4,		params_write_att_size)											\
+	X(0x01,		3,		params_write_pa_lna)											\
+	X(0x04,		3,		params_write_leds)												\
+	X(0x05,		3,		params_write_transparent)										\
+	X(0x06,		2,		params_write_credits)											\
+	X(0x07,		3,		params_write_capture)											\
+	X(0x08,		2,		params_write_trace)
+
+#define _SCHEMA_SIZE(_size, _field)				+ (_size)
+#define _SCHEMA_ENCODE(_size, _field)			for (i = (_size) ; i > 0 ; i--) { *p_buffer++ = (uint8_t) (p_struct->_field >> (8 * (i - 1))); }
+#define _SCHEMA_DECODE(_size, _field)			p_struct->_field = 0; for (i = 0 ; i < (_size) ; i++) { p_struct->_field = (p_struct->_field << 8) | *p_buffer++; }
+
+#define BLE_PICKIT_PARAMS_SIZE					(0 BLE_PICKIT_PARAMS_LAYOUT(_SCHEMA_SIZE))
+#define BLE_PICKIT_CONN_PARAMS_SIZE				(0 BLE_PICKIT_CONN_PARAMS_LAYOUT(_SCHEMA_SIZE))
+
+/**@brief Function for encoding the parameters snapshot (BLE_PICKIT_PARAMS_SIZE bytes).
+ */
+static inline uint8_t ble_pickit_params_encode(ble_pickit_params const * p_struct, uint8_t * p_buffer)
+{
+	uint8_t i;
+
+	BLE_PICKIT_PARAMS_LAYOUT(_SCHEMA_ENCODE)
+	return BLE_PICKIT_PARAMS_SIZE;
+}
+
+/**@brief Function for decoding the connection parameters (BLE_PICKIT_CONN_PARAMS_SIZE bytes).
+ */
+static inline void ble_pickit_conn_params_decode(uint8_t const * p_buffer, ble_gap_conn_params_t * p_struct)
+{
+	uint8_t i;
+
+	BLE_PICKIT_CONN_PARAMS_LAYOUT(_SCHEMA_DECODE)
+}
+
+#endif
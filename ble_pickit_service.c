@@ -4,9 +4,19 @@
 #include "ble_pickit_board.h"
 #include "ble_vsd.h"
 #include "ble_pickit_service.h"
+#include "ble_pickit_cache.h"
+#include "ble_pickit_schema.h"
+#include "ble_pickit_profiler.h"
+#include "ble_pickit_trace.h"
+#include "ble_pickit_capture.h"
+#include "ble_pickit_stats.h"
 
 static ble_pickit_t * p_vsd;
 static ble_msg_t * p_msg;
+static bool m_is_params_dirty = false;				/**< Params changed since the last notification */
+static bool m_is_params_dirty_uart = false;			/**< Params changed since the last ID_GET_BLE_PARAMS request */
+static bool m_is_params_hvx_full = false;			/**< Snapshot refused (NRF_ERROR_RESOURCES): retried on SERVICE_EVT_TX_COMPLETE */
+static uint64_t m_params_dirty_tick = 0;
 
 void ble_pickit_service_set_link_with_vsd(ble_pickit_t * p)
 {
@@ -32,11 +42,18 @@ uint32_t ble_pickit_service_init(ble_msg_t * p, const ble_msg_init_t * p_msg_ini
 	p->char_app.is_notification_enabled = false;
 	p->char_test.is_notification_enabled = false;
 	p->char_params.is_notification_enabled = false;
+	for (uint8_t i = 0 ; i < BLE_PICKIT_CHANNEL_COUNT ; i++)
+	{
+		p->char_channel[i].is_notification_enabled = false;
+	}
 
 	p->ble_params.change_conn_params_request = false;
 	p->ble_params.change_phy_param_request= false;
 	p->ble_params.change_mtu_size_params_request = false;
 
+	p->disconnect_tick = 0;
+	p->is_reconnect_measure_pending = false;
+
 	// Add Message Service UUID
 	ble_uuid128_t base_uuid = {MESSAGE_SERVICE_UUID_BASE};
 	err_code = sd_ble_uuid_vs_add(&base_uuid, &p->uuid_type);
@@ -71,6 +88,21 @@ uint32_t ble_pickit_service_init(ble_msg_t * p, const ble_msg_init_t * p_msg_ini
 		return err_code;
 	}
 
+	for (uint8_t i = 0 ; i < BLE_PICKIT_CHANNEL_COUNT ; i++)
+	{
+		err_code = add_characteristic_channel(p, p_msg_init, i);
+		if (err_code != NRF_SUCCESS)
+		{
+			return err_code;
+		}
+	}
+
+	err_code = add_characteristic_cache_0x1507(p, p_msg_init);
+	if (err_code != NRF_SUCCESS)
+	{
+		return err_code;
+	}
+
 	return NRF_SUCCESS;
 }
 
@@ -134,6 +166,116 @@ uint32_t add_characteristic_app_0x1501(ble_msg_t * p_msg, const ble_msg_init_t *
     return err_code;
 }
 
+uint32_t add_characteristic_channel(ble_msg_t * p_msg, const ble_msg_init_t * p_msg_init, uint8_t channel)
+{
+    uint32_t            err_code;
+    ble_gatts_char_md_t char_md;
+    ble_gatts_attr_md_t cccd_md;
+    ble_gatts_attr_t    attr_char_value;
+    ble_uuid_t          ble_uuid;
+    ble_gatts_attr_md_t attr_md;
+
+    // Set CCCD
+    memset(&cccd_md, 0, sizeof(cccd_md));
+
+    //  Read  operation on Cccd should be possible without authentication.
+    BLE_GAP_CONN_SEC_MODE_SET_OPEN(&cccd_md.read_perm);
+    BLE_GAP_CONN_SEC_MODE_SET_OPEN(&cccd_md.write_perm);
+
+    cccd_md.vloc       = BLE_GATTS_VLOC_STACK;
+
+    // Properties displayed to the central during service discovery
+    memset(&char_md, 0, sizeof(char_md));
+
+    char_md.char_props.read     = 0;        // We do not want to read
+    char_md.char_props.write    = 1;        // We want to write
+    char_md.char_props.notify   = 1;        // We want to notify
+    char_md.p_char_user_desc    = NULL;
+    char_md.p_char_pf           = NULL;
+    char_md.p_user_desc_md      = NULL;
+    char_md.p_cccd_md           = &cccd_md;
+    char_md.p_sccd_md           = NULL;
+
+    // Set the properties (ie accessability of the attribute): same security as the app characteristic
+    memset(&attr_md, 0, sizeof(attr_md));
+
+    attr_md.read_perm   = p_msg_init->char_app_security.read_perm;
+    attr_md.write_perm  = p_msg_init->char_app_security.write_perm;
+    attr_md.vloc        = BLE_GATTS_VLOC_STACK;
+    attr_md.rd_auth     = 0;
+    attr_md.wr_auth     = 0;
+    attr_md.vlen        = 1;
+
+    // CHAR UUID
+    ble_uuid.type = p_msg->uuid_type;
+    ble_uuid.uuid = MESSAGE_CHANNEL_UUID + channel;
+
+    // Set UUID, pointer to attr_md, set size of the characteristic
+    memset(&attr_char_value, 0, sizeof(attr_char_value));
+
+    attr_char_value.p_uuid      = &ble_uuid;
+    attr_char_value.p_attr_md   = &attr_md;
+    attr_char_value.init_len    = sizeof(uint8_t);
+    attr_char_value.init_offs   = 0;
+    attr_char_value.max_len     = NRF_SDH_BLE_GATT_MAX_MTU_SIZE;
+    attr_char_value.p_value     = NULL;
+
+    // Structure are populated, now we add the characteristic
+    err_code = sd_ble_gatts_characteristic_add(p_msg->service_handle, &char_md, &attr_char_value, &p_msg->char_channel[channel].handles);
+
+    return err_code;
+}
+
+uint32_t add_characteristic_cache_0x1507(ble_msg_t * p_msg, const ble_msg_init_t * p_msg_init)
+{
+    uint32_t            err_code;
+    ble_gatts_char_md_t char_md;
+    ble_gatts_attr_t    attr_char_value;
+    ble_uuid_t          ble_uuid;
+    ble_gatts_attr_md_t attr_md;
+
+    // Properties displayed to the central during service discovery
+    memset(&char_md, 0, sizeof(char_md));
+
+    char_md.char_props.read     = 1;        // We want to read
+    char_md.char_props.write    = 1;        // We want to write (key selection)
+    char_md.char_props.notify   = 0;        // We do not want to notify
+    char_md.p_char_user_desc    = NULL;
+    char_md.p_char_pf           = NULL;
+    char_md.p_user_desc_md      = NULL;
+    char_md.p_cccd_md           = NULL;
+    char_md.p_sccd_md           = NULL;
+
+    // Set the properties (ie accessability of the attribute): same security as the app characteristic
+    memset(&attr_md, 0, sizeof(attr_md));
+
+    attr_md.read_perm   = p_msg_init->char_app_security.read_perm;
+    attr_md.write_perm  = p_msg_init->char_app_security.write_perm;
+    attr_md.vloc        = BLE_GATTS_VLOC_STACK;
+    attr_md.rd_auth     = 1;                                                // Value set by the reply to BLE_GATTS_EVT_RW_AUTHORIZE_REQUEST
+    attr_md.wr_auth     = 0;
+    attr_md.vlen        = 1;
+
+    // CHAR UUID
+    ble_uuid.type = p_msg->uuid_type;
+    ble_uuid.uuid = MESSAGE_CACHE_UUID;
+
+    // Set UUID, pointer to attr_md, set size of the characteristic: Key - Status - Value
+    memset(&attr_char_value, 0, sizeof(attr_char_value));
+
+    attr_char_value.p_uuid      = &ble_uuid;
+    attr_char_value.p_attr_md   = &attr_md;
+    attr_char_value.init_len    = sizeof(uint8_t);
+    attr_char_value.init_offs   = 0;
+    attr_char_value.max_len     = CACHE_VALUE_SIZE + 2;
+    attr_char_value.p_value     = NULL;
+
+    // Structure are populated, now we add the characteristic
+    err_code = sd_ble_gatts_characteristic_add(p_msg->service_handle, &char_md, &attr_char_value, &p_msg->char_cache.handles);
+
+    return err_code;
+}
+
 uint32_t add_characteristic_test_0x1502(ble_msg_t * p_msg, const ble_msg_init_t * p_msg_init)
 {
     uint32_t            err_code;
@@ -256,6 +398,20 @@ uint32_t add_characteristic_params_0x1503(ble_msg_t * p_msg, const ble_msg_init_
 
 
 
+/**@brief Function for tracing and counting a notification refused by the SoftDevice (HVN queue full). A refused
+ *        notification is retried until accepted: only the first refusal of a stall is traced and counted, the ring
+ *        would be flooded and the loss of the link adaptation inflated by the retries otherwise.
+ */
+static void hvx_resources(ble_characteristics_t * p_char)
+{
+	if (!p_char->is_hvx_stalled)
+	{
+		p_char->is_hvx_stalled = true;
+		TRACE(TRACE_MODULE_SERVICE, TRACE_LEVEL_WARNING, TRACE_EVT_HVX_RESOURCES, p_char->handles.value_handle, 0);
+		ble_pickit_stats_add(STATS_HVX_QUEUE_FULL, 1);
+	}
+}
+
 void ble_pickit_throughput_notification_send(ble_msg_t * p_msg)
 {
 	uint32_t err_code = NRF_SUCCESS;
@@ -339,9 +495,13 @@ void ble_pickit_throughput_notification_send(ble_msg_t * p_msg)
 					if (err_code == NRF_SUCCESS)
 					{
 						p_msg->char_test.notifications_on_going++;
+						p_msg->char_test.is_hvx_stalled = false;
+						ble_pickit_stats_add(STATS_NOTIFICATIONS, 1);
+						ble_pickit_stats_add(STATS_NOTIFICATION_BYTES, _att_payload);
 					}
 					else if (err_code == NRF_ERROR_RESOURCES)
 					{
+						hvx_resources(&p_msg->char_test);
 						// Wait for BLE_GATTS_EVT_HVN_TX_COMPLETE.
 						p_msg->throughput.indice--;
 						p_msg->throughput.bytes_transmitted -= _att_payload;
@@ -356,7 +516,7 @@ void ble_pickit_throughput_notification_send(ble_msg_t * p_msg)
 					if (mTickCompare(p_msg->throughput._sm.tick) >= TICK_1S)
 					{
 						p_msg->throughput._sm.tick = mGetTick();
-						NRF_LOG_INFO("Data: " NRF_LOG_FLOAT_MARKER " Ko/s", NRF_LOG_FLOAT(p_msg->throughput.average_data_rate_kbps));
+						TRACE(TRACE_MODULE_THROUGHPUT, TRACE_LEVEL_INFO, TRACE_EVT_THROUGHPUT, p_msg->throughput.indice, p_msg->throughput.bytes_transmitted);
 					}
 				}
 			}
@@ -436,11 +596,36 @@ void ble_pickit_throughput_notification_send(ble_msg_t * p_msg)
 	}
 }
 
-void ble_pickit_parameters_notification_send()
+static void params_dirty_set(bool is_uart)
+{
+	if (!m_is_params_dirty && !m_is_params_dirty_uart)
+	{
+		m_params_dirty_tick = mGetTick();
+	}
+	m_is_params_dirty = true;
+	m_is_params_dirty_uart |= is_uart;
+}
+
+void ble_pickit_parameters_changed(void)
+{
+	params_dirty_set(true);
+}
+
+void ble_pickit_parameters_notification_enabled(void)
+{
+	params_dirty_set(false);
+}
+
+void ble_pickit_parameters_tx_complete(void)
 {
+	m_is_params_hvx_full = false;
+}
+
+static uint32_t params_notification_send(void)
+{
+	uint8_t params_data[BLE_PICKIT_PARAMS_SIZE + 2] = {0};
+	uint16_t _att_payload = BLE_PICKIT_PARAMS_SIZE + 2;
 	uint32_t err_code = NRF_SUCCESS;
-	uint8_t params_data[15] = {0};
-	uint16_t _att_payload = 15;
 	ble_gatts_hvx_params_t const hvx_param =
 	{
 		.handle = p_msg->char_params.handles.value_handle,
@@ -450,75 +635,130 @@ void ble_pickit_parameters_notification_send()
 		.p_data = params_data,
 	};
 
-	if (p_msg->char_params.is_notification_enabled && (p_msg->conn_handle != BLE_CONN_HANDLE_INVALID))
+	params_data[0] = 0x00; 	// ID
+	params_data[1] = ble_pickit_params_encode(&p_vsd->params, &params_data[2]);	// Length
+
+	err_code = sd_ble_gatts_hvx(p_msg->conn_handle, &hvx_param);
+
+	if (err_code == NRF_ERROR_RESOURCES)
+	{
+		hvx_resources(&p_msg->char_params);
+	}
+	else if (err_code != NRF_SUCCESS)
 	{
+		NRF_LOG_ERROR("params_notification_send - sd_ble_gatts_hvx() failed: 0x%x", err_code);
+	}
+	else
+	{
+		p_msg->char_params.is_hvx_stalled = false;
+		CAPTURE(CAPTURE_SOURCE_GATT_NOTIFICATION, hvx_param.handle, params_data, _att_payload);
+		ble_pickit_stats_add(STATS_NOTIFICATIONS, 1);
+		ble_pickit_stats_add(STATS_NOTIFICATION_BYTES, _att_payload);
+	}
 
-		params_data[0] = 0x00; 	// ID
-		params_data[1] = 13;	// Length
+	return err_code;
+}
 
-		params_data[2] = (uint8_t) (p_vsd->params.current_gap_params.conn_params.min_conn_interval >> 8);
-		params_data[3] = (uint8_t) (p_vsd->params.current_gap_params.conn_params.min_conn_interval >> 0);
-		params_data[4] = (uint8_t) (p_vsd->params.current_gap_params.conn_params.max_conn_interval >> 8);
-		params_data[5] = (uint8_t) (p_vsd->params.current_gap_params.conn_params.max_conn_interval >> 0);
-		params_data[6] = (uint8_t) (p_vsd->params.current_gap_params.conn_params.slave_latency >> 8);
-		params_data[7] = (uint8_t) (p_vsd->params.current_gap_params.conn_params.slave_latency >> 0);
-		params_data[8] = (uint8_t) (p_vsd->params.current_gap_params.conn_params.conn_sup_timeout >> 8);
-		params_data[9] = (uint8_t) (p_vsd->params.current_gap_params.conn_params.conn_sup_timeout >> 0);
-		params_data[10] = (uint8_t) (p_vsd->params.current_gap_params.phys_params.tx_phys);
-		params_data[11] = (uint8_t) (p_vsd->params.current_gap_params.mtu_size_params.max_tx_octets);
-		params_data[12] = (uint8_t) (p_vsd->params.current_gap_params.mtu_size_params.max_rx_octets);
-		params_data[13] = (uint8_t) (p_vsd->params.pa_lna_enable);
-		params_data[14] = (uint8_t) (p_vsd->params.leds_status_enable);
+/**@brief Function for sending the params snapshot PARAMS_COALESCE_TIME after the first change (UART frame
+ *        ID_GET_BLE_PARAMS and notification). The snapshot is built when sent so it holds the latest state, and the
+ *        notification stays pending until the SoftDevice accepts it.
+ */
+void ble_pickit_parameters_tasks(void)
+{
+	if ((p_msg == NULL) || (!m_is_params_dirty && !m_is_params_dirty_uart) || (mTickCompare(m_params_dirty_tick) < PARAMS_COALESCE_TIME))
+	{
+		return;
+	}
 
-		err_code = sd_ble_gatts_hvx(p_msg->conn_handle, &hvx_param);
+	if (m_is_params_dirty_uart && !p_vsd->flags.send_ble_params)
+	{
+		// Held while a request is pending: its frame may be built already, the latest state is sent by the next one.
+		p_vsd->flags.send_ble_params = true;
+		m_is_params_dirty_uart = false;
+	}
 
-		if (err_code == NRF_ERROR_RESOURCES)
+	if (!m_is_params_dirty)
+	{
+		// Nothing to notify.
+	}
+	else if (!p_msg->char_params.is_notification_enabled || (p_msg->conn_handle == BLE_CONN_HANDLE_INVALID))
+	{
+		// The current state is sent again on SERVICE_EVT_PARAMS_NOTIFICATION_ENABLED.
+		m_is_params_dirty = false;
+		m_is_params_hvx_full = false;
+	}
+	else if (!m_is_params_hvx_full)
+	{
+		if (params_notification_send() == NRF_ERROR_RESOURCES)
 		{
-			NRF_LOG_INFO("sd_ble_gatts_hvx() failed: error resources");
+			m_is_params_hvx_full = true;
 		}
-		else if (err_code != NRF_SUCCESS)
+		else
 		{
-			NRF_LOG_ERROR("ble_pickit_parameters_notification_send - sd_ble_gatts_hvx() failed: 0x%x", err_code);
+			m_is_params_dirty = false;
 		}
 	}
 }
 
-uint8_t ble_pickit_app_notification_send(p_function ptr)
+/**@brief Function for getting the ATT payload of a notification with the current data length.
+ */
+uint16_t ble_pickit_app_notification_max_length(void)
+{
+	uint16_t octets = p_vsd->params.current_gap_params.mtu_size_params.max_tx_octets;
+
+	if (octets < BLE_GATT_ATT_MTU_DEFAULT)
+	{
+		octets = BLE_GATT_ATT_MTU_DEFAULT;
+	}
+
+	return MIN(octets, NRF_SDH_BLE_GATT_MAX_MTU_SIZE) - 3;
+}
+
+static uint8_t notification_send(ble_characteristics_t * p_char, p_notif_function ptr)
 {
 	uint8_t ret = 1;
 
-	if (p_msg->char_app.is_notification_enabled && (p_msg->conn_handle != BLE_CONN_HANDLE_INVALID))
+	if (p_char->is_notification_enabled && (p_msg->conn_handle != BLE_CONN_HANDLE_INVALID))
 	{
 		uint32_t err_code = NRF_SUCCESS;
 		uint8_t _buffer[256] = {0};
 		uint16_t _att_payload = 0;
 		ble_gatts_hvx_params_t const hvx_param =
 		{
-			.handle = p_msg->char_app.handles.value_handle,
+			.handle = p_char->handles.value_handle,
 			.type   = BLE_GATT_HVX_NOTIFICATION,
 			.offset = 0,
 			.p_len  = &_att_payload,
 			.p_data = _buffer,
 		};
 
-		(*ptr)(_buffer);
-		_att_payload = _buffer[1]+2;
+		_att_payload = (*ptr)(_buffer);
 
 		err_code = sd_ble_gatts_hvx(p_msg->conn_handle, &hvx_param);
 
 		if (err_code == NRF_ERROR_RESOURCES)
 		{
 			ret = 1;
-			NRF_LOG_INFO("sd_ble_gatts_hvx() failed: error resources");
+			hvx_resources(p_char);
 		}
 		else if (err_code != NRF_SUCCESS)
 		{
 			ret = 0;
-			NRF_LOG_ERROR("ble_pickit_parameters_notification_send - sd_ble_gatts_hvx() failed: 0x%x", err_code);
+			NRF_LOG_ERROR("notification_send - sd_ble_gatts_hvx() failed on handle 0x%04x: 0x%x", p_char->handles.value_handle, err_code);
 		}
 		else if (err_code == NRF_SUCCESS)
 		{
 			ret = 0;
+			p_char->is_hvx_stalled = false;
+			CAPTURE(CAPTURE_SOURCE_GATT_NOTIFICATION, hvx_param.handle, _buffer, _att_payload);
+			ble_pickit_stats_add(STATS_NOTIFICATIONS, 1);
+			ble_pickit_stats_add(STATS_NOTIFICATION_BYTES, _att_payload);
+
+			if (p_msg->is_reconnect_measure_pending)
+			{
+				p_msg->is_reconnect_measure_pending = false;
+				NRF_LOG_INFO("Reconnection: first notification sent %d ms after the disconnection.", mTickCompare(p_msg->disconnect_tick) / TICK_1MS);
+			}
 		}
 	}
 	else
@@ -529,6 +769,21 @@ uint8_t ble_pickit_app_notification_send(p_function ptr)
 	return ret;
 }
 
+uint8_t ble_pickit_app_notification_send(p_notif_function ptr)
+{
+	return (p_msg != NULL) ? notification_send(&p_msg->char_app, ptr) : 0;
+}
+
+uint8_t ble_pickit_params_notification_send(p_notif_function ptr)
+{
+	return (p_msg != NULL) ? notification_send(&p_msg->char_params, ptr) : 0;
+}
+
+uint8_t ble_pickit_channel_notification_send(uint8_t channel, p_notif_function ptr)
+{
+	return ((p_msg != NULL) && (channel < BLE_PICKIT_CHANNEL_COUNT)) ? notification_send(&p_msg->char_channel[channel], ptr) : 0;
+}
+
 /**@brief Function for handling the Connect event.
  *
  * @param[in]   p_msg       Message Service structure.
@@ -554,6 +809,8 @@ static void on_disconnect(ble_msg_t * p_msg, ble_evt_t const * p_ble_evt)
 {
     UNUSED_PARAMETER(p_ble_evt);
     p_msg->conn_handle = BLE_CONN_HANDLE_INVALID;
+    p_msg->disconnect_tick = mGetTick();
+    p_msg->is_reconnect_measure_pending = true;
 
     ble_msg_evt_t evt;
 
@@ -573,6 +830,10 @@ static void on_write(ble_msg_t * p_msg, ble_evt_t const * p_ble_evt)
 	ble_msg_evt_t evt;
 	ble_gatts_evt_write_t const * p_evt_write = &p_ble_evt->evt.gatts_evt.params.write;
 
+	CAPTURE(CAPTURE_SOURCE_GATT_WRITE, p_evt_write->handle, p_evt_write->data, p_evt_write->len);
+	ble_pickit_stats_add(STATS_GATT_WRITES, 1);
+	ble_pickit_stats_add(STATS_GATT_WRITE_BYTES, p_evt_write->len);
+
 	// Check if the handle passed with the event matches the Message Value Characteristic handle.
 	if (p_evt_write->handle == p_msg->char_app.handles.value_handle)
 	{
@@ -590,6 +851,26 @@ static void on_write(ble_msg_t * p_msg, ble_evt_t const * p_ble_evt)
 		p_msg->evt_handler(p_msg, &evt, p_ble_evt->evt.gatts_evt.params.write.data, p_ble_evt->evt.gatts_evt.params.write.len);
 	}
 
+	else if (p_evt_write->handle == p_msg->char_cache.handles.value_handle)
+	{
+		evt.evt_type = SERVICE_EVT_CACHE_WRITE;
+		p_msg->evt_handler(p_msg, &evt, p_ble_evt->evt.gatts_evt.params.write.data, p_ble_evt->evt.gatts_evt.params.write.len);
+	}
+
+	for (evt.channel = 0 ; evt.channel < BLE_PICKIT_CHANNEL_COUNT ; evt.channel++)
+	{
+		if (p_evt_write->handle == p_msg->char_channel[evt.channel].handles.value_handle)
+		{
+			evt.evt_type = SERVICE_EVT_CHANNEL_WRITE;
+			p_msg->evt_handler(p_msg, &evt, p_ble_evt->evt.gatts_evt.params.write.data, p_ble_evt->evt.gatts_evt.params.write.len);
+		}
+		else if ((p_evt_write->handle == p_msg->char_channel[evt.channel].handles.cccd_handle) && (p_evt_write->len == 2))
+		{
+			evt.evt_type = ble_srv_is_notification_enabled(p_evt_write->data) ? SERVICE_EVT_CHANNEL_NOTIFICATION_ENABLED : SERVICE_EVT_CHANNEL_NOTIFICATION_DISABLED;
+			p_msg->evt_handler(p_msg, &evt, NULL, 0);
+		}
+	}
+
 
 	// Check if the Message value CCCD is written to and that the value is the appropriate length, i.e 2 bytes.
     if ((p_evt_write->handle == p_msg->char_app.handles.cccd_handle) && (p_evt_write->len == 2))
@@ -642,51 +923,117 @@ static void on_write(ble_msg_t * p_msg, ble_evt_t const * p_ble_evt)
         }
 }
 
-///**@brief Function for handling the RW Authorize event.
-// *
-// * @param[in]   p_msg       Message Service structure.
-// * @param[in]   p_ble_evt   Event received from the BLE stack.
-// */
-//static void on_read(ble_msg_t * p_msg, ble_evt_t const * p_ble_evt)
-//{
-//    ble_gatts_evt_read_t const * p_evt_read = &p_ble_evt->evt.gatts_evt.params.authorize_request.request.read;
-//
-//    // Check if the handle passed with the event matches the Message Value Characteristic handle.
-//    if (p_evt_read->handle == p_msg->char_app_handles.value_handle)
-//    {
-//        ble_gatts_rw_authorize_reply_params_t p_rw_authorize_reply_params;
-//
-//        memset(&p_rw_authorize_reply_params, 0, sizeof(&p_rw_authorize_reply_params));
-//
-//        p_rw_authorize_reply_params.type                       = BLE_GATTS_AUTHORIZE_TYPE_READ;
-//        p_rw_authorize_reply_params.params.read.gatt_status    = 0;
-//        p_rw_authorize_reply_params.params.read.update         = 0;
-//        p_rw_authorize_reply_params.params.read.offset         = 0;
-//        p_rw_authorize_reply_params.params.read.len            = sizeof(uint8_t);
-//        p_rw_authorize_reply_params.params.read.p_data         = NULL;
-//
-//        ret_code_t err_code = sd_ble_gatts_rw_authorize_reply(p_msg->conn_handle, &p_rw_authorize_reply_params);
-//        if(err_code != NRF_SUCCESS)
-//        {
-//            NRF_LOG_INFO("READ AUTH RESP ERROR : err_code %d", err_code);
-//        }
-//        else
-//        {
-//            NRF_LOG_INFO("READ AUTH RESP SUCCESS");
-//        }
-//    }
-//
-//}
+static bool is_cccd_notification_enabled(ble_msg_t * p_msg, uint16_t cccd_handle)
+{
+	uint8_t cccd_value[BLE_CCCD_VALUE_LEN] = {0};
+	ble_gatts_value_t gatts_value =
+	{
+		.len     = BLE_CCCD_VALUE_LEN,
+		.offset  = 0,
+		.p_value = cccd_value,
+	};
 
-static void on_tx_complete(ble_msg_t * p_msg, ble_evt_t const * p_ble_evt)
+	if (sd_ble_gatts_value_get(p_msg->conn_handle, cccd_handle, &gatts_value) != NRF_SUCCESS)
+	{
+		return false;
+	}
+
+	return ble_srv_is_notification_enabled(cccd_value);
+}
+
+void ble_pickit_service_cccd_restore(ble_msg_evt_handler_t evt_handler)
+{
+	ble_msg_evt_t evt;
+
+	if ((p_msg == NULL) || (evt_handler == NULL) || (p_msg->conn_handle == BLE_CONN_HANDLE_INVALID))
+	{
+		return;
+	}
+
+	evt.evt_type = is_cccd_notification_enabled(p_msg, p_msg->char_app.handles.cccd_handle) ? SERVICE_EVT_APP_NOTIFICATION_ENABLED : SERVICE_EVT_APP_NOTIFICATION_DISABLED;
+	evt_handler(p_msg, &evt, NULL, 0);
+
+	evt.evt_type = is_cccd_notification_enabled(p_msg, p_msg->char_test.handles.cccd_handle) ? SERVICE_EVT_TEST_NOTIFICATION_ENABLED : SERVICE_EVT_TEST_NOTIFICATION_DISABLED;
+	evt_handler(p_msg, &evt, NULL, 0);
+
+	evt.evt_type = is_cccd_notification_enabled(p_msg, p_msg->char_params.handles.cccd_handle) ? SERVICE_EVT_PARAMS_NOTIFICATION_ENABLED : SERVICE_EVT_PARAMS_NOTIFICATION_DISABLED;
+	evt_handler(p_msg, &evt, NULL, 0);
+
+	for (evt.channel = 0 ; evt.channel < BLE_PICKIT_CHANNEL_COUNT ; evt.channel++)
+	{
+		evt.evt_type = is_cccd_notification_enabled(p_msg, p_msg->char_channel[evt.channel].handles.cccd_handle) ? SERVICE_EVT_CHANNEL_NOTIFICATION_ENABLED : SERVICE_EVT_CHANNEL_NOTIFICATION_DISABLED;
+		evt_handler(p_msg, &evt, NULL, 0);
+	}
+}
+
+static void read_authorize_reply(ble_msg_t * p_msg, uint8_t const * p_data, uint16_t length, bool is_update)
+{
+    ble_gatts_rw_authorize_reply_params_t rw_authorize_reply_params;
+
+    memset(&rw_authorize_reply_params, 0, sizeof(rw_authorize_reply_params));
+
+    rw_authorize_reply_params.type                       = BLE_GATTS_AUTHORIZE_TYPE_READ;
+    rw_authorize_reply_params.params.read.gatt_status    = BLE_GATT_STATUS_SUCCESS;
+    rw_authorize_reply_params.params.read.update         = is_update;
+    rw_authorize_reply_params.params.read.offset         = 0;
+    rw_authorize_reply_params.params.read.len            = length;
+    rw_authorize_reply_params.params.read.p_data         = p_data;
+
+    ret_code_t err_code = sd_ble_gatts_rw_authorize_reply(p_msg->conn_handle, &rw_authorize_reply_params);
+    if (err_code != NRF_SUCCESS)
+    {
+        NRF_LOG_INFO("READ AUTH RESP ERROR : err_code %d", err_code);
+    }
+}
+
+/**@brief Function for handling the RW Authorize event.
+ *
+ * @details The first read of the cache characteristic is answered from the main loop (ble_pickit_cache_read), the
+ *          following Read Blob requests (offset > 0) are served from the value set by this first reply.
+ *
+ * @param[in]   p_msg       Message Service structure.
+ * @param[in]   p_ble_evt   Event received from the BLE stack.
+ */
+static void on_read(ble_msg_t * p_msg, ble_evt_t const * p_ble_evt)
 {
-	if (p_msg->char_test.notifications_on_going > 0)
+    ble_gatts_evt_rw_authorize_request_t const * p_request = &p_ble_evt->evt.gatts_evt.params.authorize_request;
+    ble_msg_evt_t evt;
+
+    if ((p_request->type != BLE_GATTS_AUTHORIZE_TYPE_READ) || (p_request->request.read.handle != p_msg->char_cache.handles.value_handle))
+    {
+        return;
+    }
+
+    if (p_request->request.read.offset > 0)
+    {
+        read_authorize_reply(p_msg, NULL, 0, false);
+    }
+    else
+    {
+        evt.evt_type = SERVICE_EVT_CACHE_READ;
+        p_msg->evt_handler(p_msg, &evt, NULL, 0);
+    }
+}
+
+void ble_pickit_cache_read_reply(uint8_t const * p_data, uint16_t length)
+{
+	if ((p_msg != NULL) && (p_msg->conn_handle != BLE_CONN_HANDLE_INVALID))
 	{
-		p_msg->char_test.notifications_on_going--;
-		ble_pickit_throughput_notification_send(p_msg);
+		read_authorize_reply(p_msg, p_data, length, true);
 	}
 }
 
+static void on_tx_complete(ble_msg_t * p_msg, ble_evt_t const * p_ble_evt)
+{
+    UNUSED_PARAMETER(p_ble_evt);
+
+    ble_msg_evt_t evt;
+
+    evt.evt_type = SERVICE_EVT_TX_COMPLETE;
+
+    p_msg->evt_handler(p_msg, &evt, NULL, 0);
+}
+
 void ble_pickit_service_event_handler( ble_evt_t const * p_ble_evt, void * p_context)
 {
 	ble_msg_t * p_msg = (ble_msg_t *) p_context;
@@ -696,6 +1043,7 @@ void ble_pickit_service_event_handler( ble_evt_t const * p_ble_evt, void * p_con
 		return;
 	}
 
+	PROFILER_BEGIN(PROFILER_REGION_SERVICE_EVT);
 	switch(p_ble_evt->header.evt_id)
 	{
 		case BLE_GAP_EVT_CONNECTED:
@@ -709,20 +1057,17 @@ void ble_pickit_service_event_handler( ble_evt_t const * p_ble_evt, void * p_con
 			break;
 
 		case BLE_GATTS_EVT_WRITE:
-			NRF_LOG_INFO("Event write.");
-			p_vsd->status.is_ble_service_has_event = true;
+			TRACE(TRACE_MODULE_SERVICE, TRACE_LEVEL_DEBUG, TRACE_EVT_GATTS_WRITE, p_ble_evt->evt.gatts_evt.params.write.handle, p_ble_evt->evt.gatts_evt.params.write.len);
 			on_write(p_msg, p_ble_evt);
 			break;
 
         case BLE_GATTS_EVT_RW_AUTHORIZE_REQUEST:
-        	NRF_LOG_INFO("Event read.");
-        	p_vsd->status.is_ble_service_has_event = true;
-//            on_read(p_msg, p_ble_evt);
+        	TRACE(TRACE_MODULE_SERVICE, TRACE_LEVEL_DEBUG, TRACE_EVT_GATTS_READ, p_ble_evt->evt.gatts_evt.params.authorize_request.request.read.handle, p_ble_evt->evt.gatts_evt.params.authorize_request.request.read.offset);
+            on_read(p_msg, p_ble_evt);
             break;
 
         case BLE_GATTS_EVT_HVN_TX_COMPLETE:
 //        	NRF_LOG_INFO("Tx complete.");
-        	p_vsd->status.is_ble_service_has_event = true;
             on_tx_complete(p_msg, p_ble_evt);
             break;
             
@@ -731,4 +1076,5 @@ void ble_pickit_service_event_handler( ble_evt_t const * p_ble_evt, void * p_con
 			break;
 
 	}
+	PROFILER_END(PROFILER_REGION_SERVICE_EVT);
 }
@@ -2,6 +2,7 @@
 #include <stdbool.h>
 #include "ble.h"
 #include "ble_srv_common.h"
+#include "ble_pickit_channel.h"
 
 // <o> BLE_MSG_BLE_OBSERVER_PRIO  
 // <i> Priority with which BLE events are dispatched to the Message Service.
@@ -25,6 +26,10 @@ NRF_SDH_BLE_OBSERVER(_name ## _obs, BLE_MSG_BLE_OBSERVER_PRIO, ble_pickit_servic
 #define MESSAGE_APP_CHAR_UUID          		0x1501		// (Notification / Write)
 #define MESSAGE_TEST_UUID        			0x1502		// (Notification / Write)
 #define MESSAGE_PARAMS_UUID					0x1503		// (Notification / Write)
+#define MESSAGE_CHANNEL_UUID				0x1504		// (Notification / Write) 0x1504 + channel, BLE_PICKIT_CHANNEL_COUNT characteristics
+#define MESSAGE_CACHE_UUID					0x1507		// (Read with authorization / Write) see ble_pickit_cache.h
+
+#define PARAMS_COALESCE_TIME				TICK_50MS	// Params changes sent in one snapshot (ble_pickit_parameters_tasks)
 
 /**@brief Message Service event type. */
 typedef enum
@@ -38,16 +43,24 @@ typedef enum
 	SERVICE_EVT_TEST_NOTIFICATION_DISABLED,
 	SERVICE_EVT_PARAMS_NOTIFICATION_ENABLED,
 	SERVICE_EVT_PARAMS_NOTIFICATION_DISABLED,
+	SERVICE_EVT_CHANNEL_NOTIFICATION_ENABLED,
+	SERVICE_EVT_CHANNEL_NOTIFICATION_DISABLED,
 
 	SERVICE_EVT_APP_WRITE,
 	SERVICE_EVT_TEST_WRITE,
 	SERVICE_EVT_PARAMS_WRITE,
+	SERVICE_EVT_CHANNEL_WRITE,
+	SERVICE_EVT_CACHE_WRITE,
+	SERVICE_EVT_CACHE_READ,
+
+	SERVICE_EVT_TX_COMPLETE,
 } service_evt_type_t;
 
 /**@brief Message Service event. */
 typedef struct
 {
 	service_evt_type_t evt_type;                                  /**< Type of event. */
+	uint8_t            channel;                                   /**< Channel of the SERVICE_EVT_CHANNEL_xxx events. */
 } ble_msg_evt_t;
 
 // Forward declaration of the ble_msg_t type.
@@ -97,6 +110,7 @@ typedef struct
 	ble_gatts_char_handles_t	handles;							/**< Handles related to the Message characteristic. */
 	bool						is_notification_enabled;
 	uint8_t						notifications_on_going;				/**< Number of notifications on going to be sent. */
+	bool						is_hvx_stalled;						/**< Last notification refused (NRF_ERROR_RESOURCES) and not sent since. */
 } ble_characteristics_t;
 
 
@@ -108,6 +122,8 @@ struct ble_msg_s
 	ble_characteristics_t		char_app;
 	ble_characteristics_t		char_test;
 	ble_characteristics_t		char_params;
+	ble_characteristics_t		char_channel[BLE_PICKIT_CHANNEL_COUNT];
+	ble_characteristics_t		char_cache;
 
     uint16_t                  	service_handle;               		/**< Handle of Message Service (as provided by the BLE stack). */
     uint16_t                  	conn_handle;                 		/**< Handle of the current connection (as provided by the BLE stack, is BLE_CONN_HANDLE_INVALID if not in a connection). */
@@ -115,6 +131,9 @@ struct ble_msg_s
 
     uint16_t					att_payload;
 
+    uint64_t					disconnect_tick;					/**< Tick of the last disconnection (disconnect-to-first-notification measurement). */
+    bool						is_reconnect_measure_pending;		/**< True until the first APP notification following a reconnection is sent. */
+
     _throughput_t				throughput;
     _ble_params_t				ble_params;
 
@@ -129,6 +148,7 @@ typedef enum
 } _THROUGHPUT_COMMANDS;
 
 typedef void (*p_function)(uint8_t *buffer);
+typedef uint16_t (*p_notif_function)(uint8_t *buffer);
 
 void ble_pickit_service_set_link_with_vsd(ble_pickit_t * p);
 /**@brief Function for initializing the Message Service.
@@ -145,6 +165,8 @@ uint32_t ble_pickit_service_init(ble_msg_t * p, const ble_msg_init_t * p_msg_ini
 uint32_t add_characteristic_app_0x1501(ble_msg_t * p_msg, const ble_msg_init_t * p_msg_init);
 uint32_t add_characteristic_test_0x1502(ble_msg_t * p_msg, const ble_msg_init_t * p_msg_init);
 uint32_t add_characteristic_params_0x1503(ble_msg_t * p_msg, const ble_msg_init_t * p_msg_init);
+uint32_t add_characteristic_channel(ble_msg_t * p_msg, const ble_msg_init_t * p_msg_init, uint8_t channel);
+uint32_t add_characteristic_cache_0x1507(ble_msg_t * p_msg, const ble_msg_init_t * p_msg_init);
 
 /**@brief Function for handling the Application's BLE Stack events.
  *
@@ -157,7 +179,35 @@ uint32_t add_characteristic_params_0x1503(ble_msg_t * p_msg, const ble_msg_init_
  */
 void ble_pickit_service_event_handler(ble_evt_t const * p_ble_evt, void * p_context);
 
+/**@brief Function for re-synchronizing the notification states with the CCCD values of the GATT server.
+ *
+ * @details To be called on PM_EVT_LOCAL_DB_CACHE_APPLIED: a bonded central does not rewrite its CCCDs on
+ *          reconnection, the values are restored by the Peer Manager without any BLE_GATTS_EVT_WRITE. Also called by
+ *          the main loop once a CCCD write has been dropped (event queue full).
+ *
+ * @param[in] evt_handler  Handler of the notification events: the handler of the service in the SoftDevice observer
+ *                         context, their processing in the main loop.
+ */
+void ble_pickit_service_cccd_restore(ble_msg_evt_handler_t evt_handler);
+
 void ble_pickit_throughput_notification_send(ble_msg_t * p_msg);
-void ble_pickit_parameters_notification_send();
-uint8_t ble_pickit_app_notification_send(p_function ptr);
+/**@brief Function for marking the params as changed: the snapshot (notification and UART frame ID_GET_BLE_PARAMS) is
+ *        sent by ble_pickit_parameters_tasks() once the burst of changes is over.
+ */
+void ble_pickit_parameters_changed(void);
+/**@brief Function for sending the current params to a central which just enabled their notifications (no UART frame). */
+void ble_pickit_parameters_notification_enabled(void);
+void ble_pickit_parameters_tx_complete(void);
+void ble_pickit_parameters_tasks(void);
+uint16_t ble_pickit_app_notification_max_length(void);
+/**@brief Function for sending an app notification built by ptr (which returns the length of the ATT payload).
+ *
+ * @return 0 if the notification is queued or dropped (notification disabled or error), 1 if it has to be sent later.
+ */
+uint8_t ble_pickit_app_notification_send(p_notif_function ptr);
+uint8_t ble_pickit_channel_notification_send(uint8_t channel, p_notif_function ptr);
+/**@brief Function for sending a params notification built by ptr (single ID - Length - Data record, see ble_pickit_parameters_tasks for the snapshot). */
+uint8_t ble_pickit_params_notification_send(p_notif_function ptr);
+/**@brief Function for answering the pending authorized read of the cache characteristic (SERVICE_EVT_CACHE_READ). */
+void ble_pickit_cache_read_reply(uint8_t const * p_data, uint16_t length);
 
@@ -0,0 +1,91 @@
+#include "sdk_common.h"
+#include "app_util_platform.h"
+#include "ble_pickit_board.h"
+#include "ble_pickit_stats.h"
+
+static uint32_t m_counters[STATS_COUNTER_COUNT];
+static uint32_t m_latency_buckets[STATS_LATENCY_BUCKETS];
+static uint32_t m_latency_max;
+static uint32_t m_reset_tick;
+
+void ble_pickit_stats_reset(void)
+{
+	CRITICAL_REGION_ENTER();
+	memset(m_counters, 0, sizeof(m_counters));
+	memset(m_latency_buckets, 0, sizeof(m_latency_buckets));
+	m_latency_max = 0;
+	m_reset_tick = mGetTick();
+	CRITICAL_REGION_EXIT();
+}
+
+void ble_pickit_stats_add(stats_counter_t counter, uint32_t value)
+{
+	m_counters[counter] += value;
+}
+
+uint32_t ble_pickit_stats_get(stats_counter_t counter)
+{
+	return m_counters[counter];
+}
+
+void ble_pickit_stats_latency(uint32_t ticks)
+{
+	uint8_t bucket = 0;
+
+	while ((bucket < (STATS_LATENCY_BUCKETS - 1)) && (ticks >= (1UL << bucket)))
+	{
+		bucket++;
+	}
+	m_latency_buckets[bucket]++;
+	m_latency_max = MAX(m_latency_max, ticks);
+}
+
+/**@brief Function for getting the upper bound of the bucket holding a percentile of the latencies (0: no latency).
+ */
+static uint32_t latency_percentile(uint8_t percent)
+{
+	uint32_t total = 0;
+	uint32_t count = 0;
+	uint8_t bucket;
+
+	for (bucket = 0 ; bucket < STATS_LATENCY_BUCKETS ; bucket++)
+	{
+		total += m_latency_buckets[bucket];
+	}
+	for (bucket = 0 ; (total > 0) && (bucket < STATS_LATENCY_BUCKETS) ; bucket++)
+	{
+		count += m_latency_buckets[bucket];
+		if ((count * 100) >= (total * percent))
+		{
+			return MIN((1UL << bucket) - 1, m_latency_max);
+		}
+	}
+	return 0;
+}
+
+static uint8_t * encode_u32(uint8_t * p_buffer, uint32_t value)
+{
+	*p_buffer++ = (value >> 24) & 0xff;
+	*p_buffer++ = (value >> 16) & 0xff;
+	*p_buffer++ = (value >> 8) & 0xff;
+	*p_buffer++ = (value >> 0) & 0xff;
+	return p_buffer;
+}
+
+/**@brief Function for encoding the statistics (STATS_RECORD_SIZE bytes, see ble_pickit_stats.h).
+ */
+uint8_t ble_pickit_stats_encode(uint8_t * p_buffer)
+{
+	uint8_t i;
+
+	p_buffer = encode_u32(p_buffer, (mGetTick() - m_reset_tick) & STATS_TICK_MASK);
+	for (i = 0 ; i < STATS_COUNTER_COUNT ; i++)
+	{
+		p_buffer = encode_u32(p_buffer, m_counters[i]);
+	}
+	p_buffer = encode_u32(p_buffer, latency_percentile(50));
+	p_buffer = encode_u32(p_buffer, latency_percentile(99));
+	(void) encode_u32(p_buffer, m_latency_max);
+
+	return STATS_RECORD_SIZE;
+}
@@ -0,0 +1,40 @@
+#ifndef BLE_PICKIT_STATS_H
+#define BLE_PICKIT_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Link statistics: counters of the UART and GATT traffic and histogram of the UART frame latency (request -> ACK of
+ * the host MCU), the same figures for any host MCU or central driving the bridge.
+ * A counter is only updated from one context (GATT writes: SoftDevice observer, the others: main loop).
+ *  - UART: ID_STATS - Length (0) returns the record, ID_STATS - Length (1) - 0x01 resets the statistics.
+ *  - Record (big endian, 4B each): Elapsed (RTC ticks 1/32768 s since the reset, 24 bits) - stats_counter_t counters -
+ *    Latency p50 - Latency p99 - Latency max (RTC ticks, p50 / p99: upper bound of their power of 2 bucket).
+ */
+#define STATS_TICK_MASK						0x00ffffff							// RTC counter: 24 bits
+#define STATS_LATENCY_BUCKETS				25									// Bucket n: latency < 2^n ticks
+
+typedef enum
+{
+	STATS_UART_TX_FRAMES,					/**< Frames sent to the host MCU (retransmissions included) */
+	STATS_UART_TX_RETRANSMISSIONS,			/**< NACK or no ACK in time */
+	STATS_UART_RX_FRAMES,
+	STATS_UART_RX_CRC_ERRORS,				/**< Frames NACKed */
+	STATS_NOTIFICATIONS,					/**< Accepted by the SoftDevice */
+	STATS_NOTIFICATION_BYTES,
+	STATS_HVX_QUEUE_FULL,					/**< Notifications refused (NRF_ERROR_RESOURCES), once each: retries not counted */
+	STATS_GATT_WRITES,
+	STATS_GATT_WRITE_BYTES,
+	STATS_COUNTER_COUNT
+} stats_counter_t;
+
+#define STATS_RECORD_SIZE					((1 + STATS_COUNTER_COUNT + 3) * 4)
+
+void ble_pickit_stats_reset(void);
+void ble_pickit_stats_add(stats_counter_t counter, uint32_t value);
+void ble_pickit_stats_latency(uint32_t ticks);
+uint32_t ble_pickit_stats_get(stats_counter_t counter);
+uint8_t ble_pickit_stats_encode(uint8_t * p_buffer);
+
+#endif
@@ -0,0 +1,75 @@
+#include "sdk_common.h"
+#include "app_util_platform.h"
+#include "nrf_atfifo.h"
+#include "ble_pickit_board.h"
+#include "ble_pickit_trace.h"
+
+NRF_ATFIFO_DEF(m_trace_fifo, ble_pickit_trace_record_t, TRACE_RING_SIZE);
+static volatile uint16_t m_trace_lost = 0;								/**< Records dropped (ring full) since the last drain. */
+
+void ble_pickit_trace_init(void)
+{
+	APP_ERROR_CHECK(NRF_ATFIFO_INIT(m_trace_fifo));
+}
+
+/**@brief Function for storing a record (any context). Use TRACE() to get the compile time filtering.
+ */
+void ble_pickit_trace_put(uint8_t module, uint8_t event, uint16_t arg0, uint32_t arg1)
+{
+	nrf_atfifo_item_put_t context;
+	ble_pickit_trace_record_t * p_record = nrf_atfifo_item_alloc(m_trace_fifo, &context);
+
+	if (p_record == NULL)
+	{
+		m_trace_lost++;
+		return;
+	}
+
+	p_record->timestamp = mGetTick();
+	p_record->module = module;
+	p_record->event = event;
+	p_record->arg0 = arg0;
+	p_record->arg1 = arg1;
+	(void) nrf_atfifo_item_put(m_trace_fifo, &context);
+}
+
+/**@brief Function for draining the oldest records (Lost - Records, see ble_pickit_trace.h).
+ *
+ * @param[in] max_records  TRACE_UART_RECORDS for the UART, records fitting in the ATT payload for the BLE.
+ *
+ * @return Number of bytes encoded.
+ */
+uint8_t ble_pickit_trace_encode(uint8_t * p_buffer, uint8_t max_records)
+{
+	nrf_atfifo_item_get_t context;
+	ble_pickit_trace_record_t * p_record;
+	uint16_t lost;
+	uint8_t length = 2;
+
+	CRITICAL_REGION_ENTER();
+	lost = m_trace_lost;
+	m_trace_lost = 0;
+	CRITICAL_REGION_EXIT();
+
+	p_buffer[0] = (lost >> 8) & 0xff;
+	p_buffer[1] = (lost >> 0) & 0xff;
+
+	while ((length < (2 + max_records * TRACE_RECORD_SIZE)) && ((p_record = nrf_atfifo_item_get(m_trace_fifo, &context)) != NULL))
+	{
+		p_buffer[length++] = (p_record->timestamp >> 24) & 0xff;
+		p_buffer[length++] = (p_record->timestamp >> 16) & 0xff;
+		p_buffer[length++] = (p_record->timestamp >> 8) & 0xff;
+		p_buffer[length++] = (p_record->timestamp >> 0) & 0xff;
+		p_buffer[length++] = p_record->module;
+		p_buffer[length++] = p_record->event;
+		p_buffer[length++] = (p_record->arg0 >> 8) & 0xff;
+		p_buffer[length++] = (p_record->arg0 >> 0) & 0xff;
+		p_buffer[length++] = (p_record->arg1 >> 24) & 0xff;
+		p_buffer[length++] = (p_record->arg1 >> 16) & 0xff;
+		p_buffer[length++] = (p_record->arg1 >> 8) & 0xff;
+		p_buffer[length++] = (p_record->arg1 >> 0) & 0xff;
+		(void) nrf_atfifo_item_free(m_trace_fifo, &context);
+	}
+
+	return length;
+}
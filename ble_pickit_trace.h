@@ -0,0 +1,71 @@
+#ifndef BLE_PICKIT_TRACE_H
+#define BLE_PICKIT_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Binary trace: TRACE() stores a fixed size record in a RAM ring (nrf_atfifo, lock-free, usable from the SoftDevice
+ * observers and the main loop) without any string formatting. A record is dropped (and counted) when the ring is full.
+ * The records out of TRACE_LEVEL or TRACE_MODULES are removed from the build.
+ *  - UART: ID_TRACE - Length (0) returns Lost (2B) - up to TRACE_UART_RECORDS records, the oldest first. The host MCU
+ *    polls until a frame without record.
+ *  - BLE (params characteristic 0x1503): 0x08 - Length (0) drains the ring in params notifications 0x08 - Length -
+ *    Lost (2B) - Records (as many as fit in the ATT payload), the last one without record (Length 2).
+ *  - Record (TRACE_RECORD_SIZE, big endian): Timestamp (4B, RTC ticks 1/32768 s, 24 bits) - Module - Event -
+ *    Arg0 (2B) - Arg1 (4B). Module and Event are the trace_module_t and trace_event_t values.
+ */
+#define TRACE_LEVEL_ERROR					1
+#define TRACE_LEVEL_WARNING					2
+#define TRACE_LEVEL_INFO					3
+#define TRACE_LEVEL_DEBUG					4
+
+#define TRACE_LEVEL							TRACE_LEVEL_DEBUG
+#define TRACE_MODULES						((1 << TRACE_MODULE_SERVICE) | (1 << TRACE_MODULE_VSD) | (1 << TRACE_MODULE_THROUGHPUT) | (1 << TRACE_MODULE_LINK))
+
+#define TRACE_RING_SIZE						64									// Records, must be a power of 2
+#define TRACE_RECORD_SIZE					12
+#define TRACE_UART_RECORDS					20									// 2 + 20 * 12 bytes: standard frame
+
+typedef enum
+{
+	TRACE_MODULE_SERVICE,
+	TRACE_MODULE_VSD,
+	TRACE_MODULE_THROUGHPUT,
+	TRACE_MODULE_LINK,
+} trace_module_t;
+
+typedef enum
+{
+	TRACE_EVT_GATTS_WRITE,					/**< Arg0: handle - Arg1: length */
+	TRACE_EVT_GATTS_READ,					/**< Arg0: handle - Arg1: offset */
+	TRACE_EVT_HVX_RESOURCES,				/**< Arg0: handle */
+	TRACE_EVT_NOTIF_FIFO_FULL,				/**< Arg0: record ID - Arg1: length */
+	TRACE_EVT_THROUGHPUT,					/**< Arg0: notifications sent - Arg1: bytes transmitted (every second) */
+	TRACE_EVT_LINK_ADAPT,					/**< Arg0: previous level - new level - Arg1: goodput (B/s) */
+	TRACE_EVT_LINK_PERIOD,					/**< Arg0: level - RSSI (dBm, int8) - Arg1: goodput (B/s) */
+} trace_event_t;
+
+typedef struct
+{
+	uint32_t						timestamp;
+	uint8_t							module;
+	uint8_t							event;
+	uint16_t						arg0;
+	uint32_t						arg1;
+} ble_pickit_trace_record_t;
+
+#define TRACE(_module, _level, _event, _arg0, _arg1)																\
+	do																												\
+	{																												\
+		if (((_level) <= TRACE_LEVEL) && ((TRACE_MODULES) & (1 << (_module))))										\
+		{																											\
+			ble_pickit_trace_put((_module), (_event), (_arg0), (_arg1));											\
+		}																											\
+	} while (0)
+
+void ble_pickit_trace_init(void);
+void ble_pickit_trace_put(uint8_t module, uint8_t event, uint16_t arg0, uint32_t arg1);
+uint8_t ble_pickit_trace_encode(uint8_t * p_buffer, uint8_t max_records);
+
+#endif
@@ -0,0 +1,192 @@
+#include "sdk_common.h"
+#include "nrf_log.h"
+#include "nrf_gpio.h"
+#include "app_uart.h"
+#include "app_fifo.h"
+#include "nrfx_spis.h"
+#include "ble_pickit_board.h"
+#include "ble_pickit_transport.h"
+
+static ble_pickit_transport_t const m_transport_uart =
+{
+	.put = app_uart_put,
+	.get = app_uart_get,
+	.tasks = NULL,
+};
+
+static ble_pickit_transport_t const * mp_transport = &m_transport_uart;
+
+void ble_pickit_transport_set(ble_pickit_transport_t const * p_transport)
+{
+	mp_transport = p_transport;
+}
+
+uint32_t ble_pickit_transport_put(uint8_t byte)
+{
+	return mp_transport->put(byte);
+}
+
+uint32_t ble_pickit_transport_get(uint8_t * p_byte)
+{
+	return mp_transport->get(p_byte);
+}
+
+void ble_pickit_transport_tasks(void)
+{
+	if (mp_transport->tasks != NULL)
+	{
+		mp_transport->tasks();
+	}
+}
+
+#if defined(SPIS_CSN_PIN)
+
+#if !NRFX_CHECK(NRFX_SPIS1_ENABLED)
+#error "SPIS_CSN_PIN is defined: enable NRFX_SPIS_ENABLED, NRFX_SPIS1_ENABLED, SPIS_ENABLED and SPIS1_ENABLED in sdk_config.h"
+#endif
+
+static nrfx_spis_t const m_spis = NRFX_SPIS_INSTANCE(1);
+static app_fifo_t m_spis_tx_fifo;
+static uint8_t m_spis_tx_fifo_buffer[SPIS_FIFO_SIZE];
+static app_fifo_t m_spis_rx_fifo;
+static uint8_t m_spis_rx_fifo_buffer[SPIS_FIFO_SIZE];
+static uint8_t m_spis_tx_buffer[SPIS_TRANSFER_SIZE];
+static uint8_t m_spis_rx_buffer[SPIS_TRANSFER_SIZE];
+static volatile bool m_spis_is_xfer_done;
+static volatile uint32_t m_spis_tx_amount;
+static volatile uint32_t m_spis_rx_amount;
+static bool m_spis_is_armed;
+static ble_pickit_transport_tx_empty_t m_tx_empty_handler;
+
+static uint32_t spis_fifo_free_get(app_fifo_t * p_fifo)
+{
+	uint32_t size = 1;
+
+	(void) app_fifo_write(p_fifo, NULL, &size);
+	return size;
+}
+
+static uint32_t spis_fifo_used_get(app_fifo_t * p_fifo)
+{
+	uint32_t size = 0;
+
+	(void) app_fifo_read(p_fifo, NULL, &size);
+	return size;
+}
+
+static void spis_event_handler(nrfx_spis_evt_t const * p_event, void * p_context)
+{
+	if (p_event->evt_type == NRFX_SPIS_XFER_DONE)
+	{
+		m_spis_tx_amount = p_event->tx_amount;
+		m_spis_rx_amount = p_event->rx_amount;
+		m_spis_is_xfer_done = true;
+	}
+}
+
+/**@brief Function for handling the end of an SPIS transaction and re-arming the EasyDMA buffers (main loop).
+ *
+ * @details The buffers are only touched once the transaction is done (the SPIS semaphore belongs to the CPU):
+ *          the bytes of the TX fifo leave it only if they were clocked out by the master.
+ */
+static void spis_tasks(void)
+{
+	uint32_t length;
+	uint32_t i;
+
+	if (m_spis_is_xfer_done)
+	{
+		m_spis_is_xfer_done = false;
+		m_spis_is_armed = false;
+
+		if (m_spis_rx_amount > 1)
+		{
+			length = MIN(m_spis_rx_buffer[0], m_spis_rx_amount - 1);
+			(void) app_fifo_write(&m_spis_rx_fifo, &m_spis_rx_buffer[1], &length);
+		}
+
+		if (m_spis_tx_amount > 1)
+		{
+			length = MIN(m_spis_tx_buffer[0], m_spis_tx_amount - 1);
+			(void) app_fifo_read(&m_spis_tx_fifo, m_spis_tx_buffer, &length);
+
+			if ((spis_fifo_used_get(&m_spis_tx_fifo) == 0) && (m_tx_empty_handler != NULL))
+			{
+				m_tx_empty_handler();
+			}
+		}
+	}
+
+	// Armed only if a whole transaction fits in the RX fifo: the master receives SPIS_BUSY_HEADER otherwise.
+	if (!m_spis_is_armed && (spis_fifo_free_get(&m_spis_rx_fifo) >= (SPIS_TRANSFER_SIZE - 1)))
+	{
+		length = MIN(spis_fifo_used_get(&m_spis_tx_fifo), SPIS_TRANSFER_SIZE - 1);
+		for (i = 0 ; i < length ; i++)
+		{
+			(void) app_fifo_peek(&m_spis_tx_fifo, i, &m_spis_tx_buffer[i + 1]);
+		}
+		m_spis_tx_buffer[0] = length;
+
+		m_spis_is_armed = (nrfx_spis_buffers_set(&m_spis, m_spis_tx_buffer, length + 1, m_spis_rx_buffer, SPIS_TRANSFER_SIZE) == NRFX_SUCCESS);
+	}
+
+	nrf_gpio_pin_write(SPIS_DRDY_PIN, (spis_fifo_used_get(&m_spis_tx_fifo) > 0));
+}
+
+static uint32_t spis_put(uint8_t byte)
+{
+	uint32_t err_code = app_fifo_put(&m_spis_tx_fifo, byte);
+
+	if (err_code != NRF_SUCCESS)
+	{
+		// The callers retry until the byte is queued: the fifo is drained from here.
+		spis_tasks();
+	}
+	return err_code;
+}
+
+static uint32_t spis_get(uint8_t * p_byte)
+{
+	return app_fifo_get(&m_spis_rx_fifo, p_byte);
+}
+
+static ble_pickit_transport_t const m_transport_spis =
+{
+	.put = spis_put,
+	.get = spis_get,
+	.tasks = spis_tasks,
+};
+
+void ble_pickit_transport_spis_init(ble_pickit_transport_tx_empty_t tx_empty_handler)
+{
+	nrfx_spis_config_t config = NRFX_SPIS_DEFAULT_CONFIG;
+
+	config.sck_pin = SPIS_SCK_PIN;
+	config.mosi_pin = SPIS_MOSI_PIN;
+	config.miso_pin = SPIS_MISO_PIN;
+	config.csn_pin = SPIS_CSN_PIN;
+	config.mode = NRF_SPIS_MODE_0;
+	config.def = SPIS_BUSY_HEADER;
+	config.orc = 0x00;
+
+	APP_ERROR_CHECK(app_fifo_init(&m_spis_tx_fifo, m_spis_tx_fifo_buffer, SPIS_FIFO_SIZE));
+	APP_ERROR_CHECK(app_fifo_init(&m_spis_rx_fifo, m_spis_rx_fifo_buffer, SPIS_FIFO_SIZE));
+	nrf_gpio_cfg_output(SPIS_DRDY_PIN);
+	nrf_gpio_pin_clear(SPIS_DRDY_PIN);
+	APP_ERROR_CHECK(nrfx_spis_init(&m_spis, &config, spis_event_handler, NULL));
+
+	m_tx_empty_handler = tx_empty_handler;
+	mp_transport = &m_transport_spis;
+	spis_tasks();
+
+	NRF_LOG_INFO("SPIS transport.");
+}
+
+#else
+
+void ble_pickit_transport_spis_init(ble_pickit_transport_tx_empty_t tx_empty_handler)
+{
+	NRF_LOG_INFO("SPIS transport not available (SPIS_CSN_PIN not defined): UART transport.");
+}
+
+#endif
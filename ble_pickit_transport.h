@@ -0,0 +1,39 @@
+#ifndef BLE_PICKIT_TRANSPORT_H
+#define BLE_PICKIT_TRANSPORT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Byte transport between the host MCU and the bridge. The frame protocol of ble_vsd.c only uses
+ * ble_pickit_transport_put / ble_pickit_transport_get, the back end is selected at init:
+ *  - UART (default): app_uart fifo initialized by uart_init() (main.c), 1 Mbaud.
+ *  - SPIS (SPIS_CSN_PIN defined in ble_pickit_board.h): SPI slave with EasyDMA, host MCU as master (mode 0, up to 8 MHz).
+ *    The SPIS1 instance must be enabled in sdk_config.h (NRFX_SPIS_ENABLED, NRFX_SPIS1_ENABLED, SPIS_ENABLED, SPIS1_ENABLED),
+ *    they are 0 by default so that the UART only build does not reserve the peripheral.
+ *    Each transaction exchanges [Length][Data] in both directions (Length <= SPIS_TRANSFER_SIZE - 1). The bridge
+ *    answers SPIS_BUSY_HEADER (DEF character) while it cannot receive. SPIS_DRDY_PIN is high while the bridge has
+ *    bytes to send: the master clocks a transaction (a Length of 0 may be returned once if the bytes were queued
+ *    after the buffers were armed, the next transaction carries them).
+ * ble_pickit_transport_set() plugs any other back end (e.g. a fake on a host build).
+ */
+#define SPIS_TRANSFER_SIZE					255									// EasyDMA MAXCNT (8 bits on nRF52832)
+#define SPIS_FIFO_SIZE						1024								// Must be a power of 2 (app_fifo)
+#define SPIS_BUSY_HEADER					0xff
+
+typedef void (*ble_pickit_transport_tx_empty_t)(void);
+
+typedef struct
+{
+	uint32_t (*put)(uint8_t byte);											/**< NRF_SUCCESS or NRF_ERROR_NO_MEM (to be retried). */
+	uint32_t (*get)(uint8_t * p_byte);										/**< NRF_SUCCESS or NRF_ERROR_NOT_FOUND. */
+	void (*tasks)(void);													/**< Main loop processing (NULL if none). */
+} ble_pickit_transport_t;
+
+void ble_pickit_transport_set(ble_pickit_transport_t const * p_transport);
+void ble_pickit_transport_spis_init(ble_pickit_transport_tx_empty_t tx_empty_handler);
+uint32_t ble_pickit_transport_put(uint8_t byte);
+uint32_t ble_pickit_transport_get(uint8_t * p_byte);
+void ble_pickit_transport_tasks(void);
+
+#endif
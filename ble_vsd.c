@@ -1,12 +1,34 @@
 #include "sdk_common.h"
 #include "nrf_log.h"
+#include "nrf_gpio.h"
 #include "ble_pickit_board.h"
 #include "ble_vsd.h"
 #include "ble_pickit_service.h"
+#include "ble_pickit_broadcast.h"
+#include "ble_pickit_channel.h"
+#include "ble_pickit_transport.h"
+#include "ble_pickit_lz.h"
+#include "ble_pickit_cache.h"
+#include "ble_pickit_schema.h"
+#include "ble_pickit_profiler.h"
+#include "ble_pickit_trace.h"
+#include "ble_pickit_capture.h"
+#include "ble_pickit_stats.h"
+#include "ble_pickit_benchmark.h"
+#include "ble_pickit_link_model.h"
+#include "ble_pickit_leds.h"
 
 
 static ble_pickit_t * p_vsd;
 static uint8_t current_id_requested = ID_NONE;
+static uint16_t m_notif_length = 0;
+static ble_pickit_lz_t m_lz;
+static ble_pickit_link_model_params_t m_link_model_params;
+// Dump notifications kept while the SoftDevice queue is full: the records leave their ring when encoded.
+static uint8_t m_capture_notif[256];
+static uint16_t m_capture_notif_length = 0;
+static uint8_t m_trace_notif[256];
+static uint16_t m_trace_notif_length = 0;
 
 static void _boot(uint8_t *buffer);
 static void _version(uint8_t *buffer);
@@ -15,8 +37,58 @@ static void _ble_params(uint8_t *buffer);
 static void _pa_lna_param(uint8_t *buffer);
 static void _transfer_ble_to_uart(uint8_t *buffer);
 static void _extended_transfer_ble_to_uart(uint8_t *buffer);
-static void _notif_buffer(uint8_t *buffer);
+static void _ext_message_release(void);
+static uint16_t _ext_buffer_status(uint8_t *buffer);
+static uint16_t _ext_nack(uint8_t *buffer);
+static void _outgoing_message_release(void);
+static uint16_t _credits(uint8_t *buffer);
+static uint16_t _notif_buffer(uint8_t *buffer);
+static bool _notif_buffer_append(uint8_t record_id, uint8_t const * p_data, uint8_t length, bool is_flush);
+static void _rpc_response(uint8_t const * p_data, uint8_t length);
+static void _rpc_tasks(void);
+static void _notif_buffer_flush_check(void);
+static void _notif_buffer_consume(void);
+static void _notif_flow_update(bool is_release_allowed);
+static void _notif_flow(uint8_t *buffer);
+static uint16_t _transparent_notif(uint8_t *buffer);
+static void _channel_transfer_ble_to_uart(uint8_t *buffer);
+static void _channel_flow(uint8_t *buffer);
+static void _cache_request(uint8_t *buffer);
+static void _profiler(uint8_t *buffer);
+static void _trace(uint8_t *buffer);
+static void _capture(uint8_t *buffer);
+static uint16_t _capture_notif(uint8_t *buffer);
+static uint16_t _trace_notif(uint8_t *buffer);
+static void _stats(uint8_t *buffer);
+static void _benchmark(uint8_t *buffer);
+static void _link_model(uint8_t *buffer);
+static void _transparent_tasks(void);
+static void _uart_full_duplex_receive(void);
+
+static void _uart_rx_dispatch(uint8_t id, uint8_t const * p_data, uint8_t length);
+
+typedef void (*p_uart_rx_function)(uint8_t const * p_data, uint8_t length);
+
+typedef struct
+{
+	p_uart_rx_function				handler;
+	uint8_t							min_length;
+	uint8_t							max_length;
+} ble_uart_rx_schema_t;
+
+#define _UART_RX_PROTOTYPE(_id, _min_length, _max_length, _handler)		static void _handler(uint8_t const * p_data, uint8_t length);
+#define _UART_RX_ENTRY(_id, _min_length, _max_length, _handler)			[_id] = {_handler, _min_length, _max_length},
+
+BLE_PICKIT_UART_RX_SCHEMA(_UART_RX_PROTOTYPE)
+
+/**@brief Jump table of the inbound IDs (generated from BLE_PICKIT_UART_RX_SCHEMA). */
+static const ble_uart_rx_schema_t m_uart_rx_schema[UINT8_MAX + 1] =
+{
+	BLE_PICKIT_UART_RX_SCHEMA(_UART_RX_ENTRY)
+};
 
+static void _uart_reply_queue(char const * p_reply, uint8_t length);
+static void _uart_reply_tasks(void);
 static bool is_vsd_send_request_free_for_id(uint8_t id);
 static uint8_t vsd_send_request(p_function ptr, bool is_extended_message, uint8_t id);
 
@@ -24,84 +96,61 @@ void ble_init(ble_pickit_t * p_vsd_params)
 {
     p_vsd = p_vsd_params;
     p_vsd->flags.boot_mode = true;
+
+    APP_ERROR_CHECK(app_fifo_init(&p_vsd->characteristic.buffer.fifo, p_vsd->characteristic.buffer.fifo_buffer, NOTIF_FIFO_SIZE));
+    APP_ERROR_CHECK(app_fifo_init(&p_vsd->transparent.tx_fifo, p_vsd->transparent.tx_fifo_buffer, TRANSPARENT_TX_FIFO_SIZE));
+    ble_pickit_channel_init();
 }
 
 void ble_stack_tasks()
 {
-	static uint64_t tick_blink_led_1 = 0;
-	static uint64_t tick_blink_led_3 = 0;
 	ret_code_t err_code;
 
-	if (p_vsd->params.leds_status_enable)
+#if defined(TRANSPARENT_MODE_PIN)
 	{
-		if (!p_vsd->status.is_init_done)
+		static bool is_pin_low = false;
+
+		if (is_pin_low != !nrf_gpio_pin_read(TRANSPARENT_MODE_PIN))
 		{
-			board_led_set(LED_1);
-			board_led_set(LED_2);
-			board_led_set(LED_3);
+			is_pin_low = !is_pin_low;
+			ble_pickit_transparent_set(is_pin_low);
 		}
-		else
-		{
-
-			if (p_vsd->status.is_ble_service_has_event)
-			{
-				tick_blink_led_1 = mGetTick();
-				p_vsd->status.is_ble_service_has_event = false;
-				board_led_set(LED_1);
-			}
-			else if (mTickCompare(tick_blink_led_1) > TICK_1MS)
-			{
-				board_led_clr(LED_1);
-			}
+	}
+#endif
 
-			if (p_vsd->status.is_connected_to_a_central)
-			{
-				board_led_set(LED_2);
-			}
-			else if (p_vsd->status.is_in_advertising_mode)
-			{
-				board_led_lat(LED_2, (mGetTick() >> 12)&1);
-			}
-			else
-			{
-				board_led_clr(LED_2);
-			}
+	ble_pickit_transport_tasks();
 
-			if ((p_vsd->uart.transmit_in_progress) || (p_vsd->status.is_uart_message_receives))
-			{
-				tick_blink_led_3 = mGetTick();
-				p_vsd->status.is_uart_message_receives = false;
-				board_led_set(LED_3);
-			}
-			else if (mTickCompare(tick_blink_led_3) > TICK_20MS)
-			{
-				board_led_clr(LED_3);
-			}
-		}
-	}
-	else
+	if (p_vsd->params.transparent_enable)
 	{
-		board_led_clr(LED_1);
-		board_led_clr(LED_2);
-		board_led_clr(LED_3);
+		_transparent_tasks();
+		ble_pickit_broadcast_tasks();
+		return;
 	}
 
-    err_code = app_uart_get(&p_vsd->uart.buffer[p_vsd->uart.index]);
-	if (err_code == NRF_SUCCESS)
+	PROFILER_BEGIN(PROFILER_REGION_UART_RX);
+	if (p_vsd->params.uart_full_duplex)
 	{
-		p_vsd->uart.receive_in_progress = true;
-		p_vsd->uart.tick = mGetTick();
-		p_vsd->uart.index++;
+		_uart_full_duplex_receive();
+	}
+	else
+	{
+		err_code = ble_pickit_transport_get(&p_vsd->uart.buffer[p_vsd->uart.index]);
+		if (err_code == NRF_SUCCESS)
+		{
+			p_vsd->uart.receive_in_progress = true;
+			p_vsd->uart.tick = mGetTick();
+			p_vsd->uart.index++;
+		}
 	}
 
-    if (mTickCompare(p_vsd->uart.tick) >= TICK_300US)
+    if (!p_vsd->params.uart_full_duplex && (mTickCompare(p_vsd->uart.tick) >= TICK_300US))
     {
         if (	(p_vsd->uart.index == 3) && 		\
                 (p_vsd->uart.buffer[0] == 'A') && 	\
                 (p_vsd->uart.buffer[1] == 'C') && 	\
                 (p_vsd->uart.buffer[2] == 'K'))
         {
-            p_vsd->uart.message_type = UART_ACK_MESSAGE;
+            p_vsd->uart.ack_type = UART_ACK_MESSAGE;
         }
         else if (	(p_vsd->uart.index == 4) &&	 		\
                     (p_vsd->uart.buffer[0] == 'N') && 	\
@@ -109,9 +158,9 @@ void ble_stack_tasks()
                     (p_vsd->uart.buffer[2] == 'C') && 	\
                     (p_vsd->uart.buffer[3] == 'K'))
         {
-            p_vsd->uart.message_type = UART_NACK_MESSAGE;
+            p_vsd->uart.ack_type = UART_NACK_MESSAGE;
         }
-        else if ((p_vsd->uart.index > 5) && (p_vsd->uart.buffer[1] == 'W'))
+        else if ((p_vsd->uart.index >= 5) && (p_vsd->uart.buffer[1] == 'W'))
         {
             p_vsd->uart.message_type = UART_NEW_MESSAGE;
         }
@@ -128,8 +177,9 @@ void ble_stack_tasks()
         uint8_t i;
         uint16_t crc_calc, crc_uart;
 
-        p_vsd->status.is_uart_message_receives = true;
+        ble_pickit_leds_event(LEDS_EVT_UART_ACTIVITY);
         p_vsd->uart.message_type = UART_NO_MESSAGE;
+        CAPTURE(CAPTURE_SOURCE_UART_RX, 0, p_vsd->uart.buffer, p_vsd->uart.buffer[2]+5);
 
         crc_calc = fu_crc_16_ibm(p_vsd->uart.buffer, p_vsd->uart.buffer[2]+3);
         crc_uart = (p_vsd->uart.buffer[p_vsd->uart.buffer[2]+3] << 8) + (p_vsd->uart.buffer[p_vsd->uart.buffer[2]+4] << 0);
@@ -143,104 +193,41 @@ void ble_stack_tasks()
             {
                 p_vsd->incoming_uart_message.data[i] = p_vsd->uart.buffer[3+i];
             }
-            do {} while (app_uart_put('A') != NRF_SUCCESS);
-			do {} while (app_uart_put('C') != NRF_SUCCESS);
-			do {} while (app_uart_put('K') != NRF_SUCCESS);
-            p_vsd->uart.transmit_in_progress = true;
+            _uart_reply_queue("ACK", 3);
+            CAPTURE(CAPTURE_SOURCE_UART_TX, 0, (uint8_t const *) "ACK", 3);
+            ble_pickit_stats_add(STATS_UART_RX_FRAMES, 1);
         }
         else
         {
             p_vsd->incoming_uart_message.id = ID_NONE;
-            do {} while (app_uart_put('N') != NRF_SUCCESS);
-            do {} while (app_uart_put('A') != NRF_SUCCESS);
-			do {} while (app_uart_put('C') != NRF_SUCCESS);
-			do {} while (app_uart_put('K') != NRF_SUCCESS);
-            p_vsd->uart.transmit_in_progress = true;
+            _uart_reply_queue("NACK", 4);
+            CAPTURE(CAPTURE_SOURCE_UART_TX, 0, (uint8_t const *) "NACK", 4);
+            ble_pickit_stats_add(STATS_UART_RX_CRC_ERRORS, 1);
         }
         memset(p_vsd->uart.buffer, 0, sizeof(p_vsd->uart.buffer));
 
-        switch (p_vsd->incoming_uart_message.id)
-        {
-        	case ID_PA_LNA:
-        		p_vsd->params.pa_lna_enable = p_vsd->incoming_uart_message.data[0] & 0x01;
-        		break;
-
-        	case ID_LED_STATUS:
-        		p_vsd->params.leds_status_enable = p_vsd->incoming_uart_message.data[0] & 0x01;
-        		p_vsd->flags.send_ble_params = true;
-				ble_pickit_parameters_notification_send();
-        		break;
-
-			case ID_SET_NAME:
-				memcpy(p_vsd->infos.device_name, p_vsd->incoming_uart_message.data, p_vsd->incoming_uart_message.length);
-				p_vsd->infos.device_name[p_vsd->incoming_uart_message.length] = '\0';
-				break;
-
-            case ID_GET_VERSION:
-                p_vsd->flags.send_version = true;
-                break;
-
-            case ID_ADV_INTERVAL:
-            	p_vsd->params.preferred_gap_params.adv_interval = (p_vsd->incoming_uart_message.data[0] << 8) | (p_vsd->incoming_uart_message.data[1] << 0);
-            	break;
-
-            case ID_ADV_TIMEOUT:
-            	p_vsd->params.preferred_gap_params.adv_timeout = (p_vsd->incoming_uart_message.data[0] << 8) | (p_vsd->incoming_uart_message.data[1] << 0);
-            	break;
-
-            case ID_SET_BLE_CONN_PARAMS:
-            	if (	(p_vsd->params.preferred_gap_params.conn_params.min_conn_interval != ((p_vsd->incoming_uart_message.data[0] << 8) | (p_vsd->incoming_uart_message.data[1] << 0))) ||
-            			(p_vsd->params.preferred_gap_params.conn_params.max_conn_interval != ((p_vsd->incoming_uart_message.data[2] << 8) | (p_vsd->incoming_uart_message.data[3] << 0))) ||
-						(p_vsd->params.preferred_gap_params.conn_params.slave_latency != ((p_vsd->incoming_uart_message.data[4] << 8) | (p_vsd->incoming_uart_message.data[5] << 0))) ||
-						(p_vsd->params.preferred_gap_params.conn_params.conn_sup_timeout != ((p_vsd->incoming_uart_message.data[6] << 8) | (p_vsd->incoming_uart_message.data[7] << 0))))
-				{
-            		p_vsd->params.preferred_gap_params.conn_params.min_conn_interval = (p_vsd->incoming_uart_message.data[0] << 8) | (p_vsd->incoming_uart_message.data[1] << 0);
-            		p_vsd->params.preferred_gap_params.conn_params.max_conn_interval = (p_vsd->incoming_uart_message.data[2] << 8) | (p_vsd->incoming_uart_message.data[3] << 0);
-            		p_vsd->params.preferred_gap_params.conn_params.slave_latency = (p_vsd->incoming_uart_message.data[4] << 8) | (p_vsd->incoming_uart_message.data[5] << 0);
-            		p_vsd->params.preferred_gap_params.conn_params.conn_sup_timeout = (p_vsd->incoming_uart_message.data[6] << 8) | (p_vsd->incoming_uart_message.data[7] << 0);
-					p_vsd->flags.set_conn_params = true;
-				}
-            	break;
-
-            case ID_SET_BLE_PHY_PARAMS:
-            	if (	(p_vsd->params.preferred_gap_params.phys_params.tx_phys != p_vsd->incoming_uart_message.data[0]) ||
-            			(p_vsd->params.preferred_gap_params.phys_params.rx_phys != p_vsd->incoming_uart_message.data[0]))
-            	{
-            		p_vsd->params.preferred_gap_params.phys_params.tx_phys = p_vsd->incoming_uart_message.data[0];
-            		p_vsd->params.preferred_gap_params.phys_params.rx_phys = p_vsd->incoming_uart_message.data[0];
-					p_vsd->flags.set_phy_params = true;
-            	}
-            	break;
-
-            case ID_SET_BLE_ATT_SIZE_PARAMS:
-            	if (	(p_vsd->params.preferred_gap_params.mtu_size_params.max_tx_octets != p_vsd->incoming_uart_message.data[0]) ||
-						(p_vsd->params.preferred_gap_params.mtu_size_params.max_rx_octets != p_vsd->incoming_uart_message.data[1]))
-				{
-            		p_vsd->params.preferred_gap_params.mtu_size_params.max_tx_octets = p_vsd->incoming_uart_message.data[0];
-            		p_vsd->params.preferred_gap_params.mtu_size_params.max_rx_octets = p_vsd->incoming_uart_message.data[1];
-					p_vsd->flags.set_att_size_params = true;
-				}
-            	break;
+        /** Inbound frames: BLE_PICKIT_UART_RX_SCHEMA (ble_pickit_schema.h) */
+        _uart_rx_dispatch(p_vsd->incoming_uart_message.id, p_vsd->incoming_uart_message.data, p_vsd->incoming_uart_message.length);
+    }
+    _uart_reply_tasks();
+    PROFILER_END(PROFILER_REGION_UART_RX);
 
-            case ID_CHAR_BUFFER:
-            	p_vsd->flags.notification_buffer = true;
-            	memcpy(p_vsd->characteristic.buffer.data, p_vsd->incoming_uart_message.data, p_vsd->incoming_uart_message.length);
-            	p_vsd->characteristic.buffer.length = p_vsd->incoming_uart_message.length;
-            	break;
+    /** Logical channels: notifications by priority and UART / flow control requests */
+    ble_pickit_channel_notification_tasks();
+    p_vsd->flags.transfer_channel_to_uart |= ble_pickit_channel_uart_is_pending();
+    p_vsd->flags.send_channel_flow |= ble_pickit_channel_flow_is_updated();
 
-            case ID_SOFTWARE_RESET:
-            	if ((p_vsd->incoming_uart_message.length == 1) && ((p_vsd->incoming_uart_message.data[0] == RESET_ALL) || (p_vsd->incoming_uart_message.data[0] == RESET_BLE_PICKIT)))
-				{
-					p_vsd->flags.exec_reset = true;
-				}
-                break;
+    /** RPC requests without response from the host MCU */
+    _rpc_tasks();
 
-            default:
-                break;
+    /** Cache reads waiting for the host MCU (read-through) */
+    ble_pickit_cache_tasks();
+    p_vsd->flags.send_cache_request |= ble_pickit_cache_request_is_pending();
 
-        }
-    }
+    /** Records waiting for a notification (flush on size, on timeout or on request) */
+    _notif_buffer_flush_check();
 
+    PROFILER_BEGIN(PROFILER_REGION_FLAGS);
     if (p_vsd->flags.w > 0)
     {
 
@@ -287,44 +274,413 @@ void ble_stack_tasks()
 				p_vsd->flags.send_pa_lna_param = false;
 			}
 		}
+        else if (p_vsd->flags.send_notif_flow && is_vsd_send_request_free_for_id(ID_NOTIF_FLOW))
+		{
+        	if (!vsd_send_request(_notif_flow, false, ID_NOTIF_FLOW))
+			{
+				p_vsd->flags.send_notif_flow = false;
+			}
+		}
+        else if (p_vsd->flags.send_profiler && is_vsd_send_request_free_for_id(ID_PROFILER))
+		{
+        	if (!vsd_send_request(_profiler, false, ID_PROFILER))
+			{
+				p_vsd->flags.send_profiler = false;
+			}
+		}
+        else if (p_vsd->flags.send_trace && is_vsd_send_request_free_for_id(ID_TRACE))
+		{
+        	if (!vsd_send_request(_trace, false, ID_TRACE))
+			{
+				p_vsd->flags.send_trace = false;
+			}
+		}
+        else if (p_vsd->flags.send_capture && is_vsd_send_request_free_for_id(ID_CAPTURE))
+		{
+        	if (!vsd_send_request(_capture, false, ID_CAPTURE))
+			{
+				p_vsd->flags.send_capture = false;
+			}
+		}
+        else if (p_vsd->flags.send_stats && is_vsd_send_request_free_for_id(ID_STATS))
+		{
+        	if (!vsd_send_request(_stats, false, ID_STATS))
+			{
+				p_vsd->flags.send_stats = false;
+			}
+		}
+        else if (p_vsd->flags.send_benchmark && is_vsd_send_request_free_for_id(ID_BENCHMARK))
+		{
+        	if (!vsd_send_request(_benchmark, false, ID_BENCHMARK))
+			{
+				p_vsd->flags.send_benchmark = false;
+			}
+		}
+        else if (p_vsd->flags.send_link_model && is_vsd_send_request_free_for_id(ID_LINK_MODEL))
+		{
+        	if (!vsd_send_request(_link_model, false, ID_LINK_MODEL))
+			{
+				p_vsd->flags.send_link_model = false;
+			}
+		}
+        else if (p_vsd->flags.send_cache_request && is_vsd_send_request_free_for_id(ID_CACHE_REQUEST))
+		{
+        	if (!vsd_send_request(_cache_request, false, ID_CACHE_REQUEST))
+			{
+        		ble_pickit_cache_request_consume();
+				p_vsd->flags.send_cache_request = false;
+			}
+		}
         else if (p_vsd->flags.transfer_ble_to_uart && is_vsd_send_request_free_for_id(ID_CHAR_BUFFER))
 		{
         	if (!vsd_send_request(_transfer_ble_to_uart, false, ID_CHAR_BUFFER))
 			{
-				p_vsd->flags.transfer_ble_to_uart = false;
+				_outgoing_message_release();
 			}
 		}
         else if (p_vsd->flags.extended_transfer_ble_to_uart && is_vsd_send_request_free_for_id(ID_CHAR_EXT_BUFFER_NO_CRC))
 		{
         	if (!vsd_send_request(_extended_transfer_ble_to_uart, true, ID_CHAR_EXT_BUFFER_NO_CRC))
 			{
-				p_vsd->flags.extended_transfer_ble_to_uart = false;
+				_ext_message_release();
+			}
+		}
+        else if (p_vsd->flags.send_channel_flow && is_vsd_send_request_free_for_id(ID_CHANNEL_FLOW))
+		{
+        	if (!vsd_send_request(_channel_flow, false, ID_CHANNEL_FLOW))
+			{
+				p_vsd->flags.send_channel_flow = false;
+			}
+		}
+        else if (p_vsd->flags.transfer_channel_to_uart && is_vsd_send_request_free_for_id(ID_CHANNEL_BUFFER))
+		{
+        	if (!vsd_send_request(_channel_transfer_ble_to_uart, false, ID_CHANNEL_BUFFER))
+			{
+				ble_pickit_channel_uart_consume();
+				p_vsd->flags.transfer_channel_to_uart = false;
 			}
 		}
 
     	/** Send NOTIFICATION over BLE */
+    	if (p_vsd->flags.send_ext_buffer_status)
+    	{
+    		if (!ble_pickit_app_notification_send(_ext_buffer_status))
+    		{
+    			p_vsd->flags.send_ext_buffer_status = false;
+    		}
+    	}
+    	if (p_vsd->flags.send_credits)
+    	{
+    		if (!ble_pickit_params_notification_send(_credits))
+    		{
+    			p_vsd->flags.send_credits = false;
+    		}
+    	}
+    	if (p_vsd->flags.send_capture_notif)
+    	{
+    		if (!ble_pickit_params_notification_send(_capture_notif))
+    		{
+    			m_capture_notif_length = 0;
+    			p_vsd->flags.send_capture_notif = false;
+    		}
+    	}
+    	if (p_vsd->flags.send_trace_notif)
+    	{
+    		if (!ble_pickit_params_notification_send(_trace_notif))
+    		{
+    			// Notifications until the ring is drained (Length 2: Lost only).
+    			p_vsd->flags.send_trace_notif = (m_trace_notif[1] > 2);
+    			m_trace_notif_length = 0;
+    		}
+    	}
+    	if (p_vsd->flags.send_ext_nack)
+    	{
+    		// Nothing to report once the transfer is complete (or restarted from its first fragment).
+    		if ((p_vsd->outgoing_uart_extended_ring.rx.p_message == NULL) || !ble_pickit_app_notification_send(_ext_nack))
+    		{
+    			p_vsd->flags.send_ext_nack = false;
+    		}
+    	}
     	if (p_vsd->flags.notification_buffer)
         {
+        	m_notif_length = 0;
         	if (!ble_pickit_app_notification_send(_notif_buffer))
         	{
+        		_notif_buffer_consume();
         		p_vsd->flags.notification_buffer = false;
         	}
         }
     }
+    PROFILER_END(PROFILER_REGION_FLAGS);
+
+    /** Update BROADCAST (advertising data) */
+    ble_pickit_broadcast_tasks();
+
+}
+
+static void _uart_rx_dispatch(uint8_t id, uint8_t const * p_data, uint8_t length)
+{
+	ble_uart_rx_schema_t const * p_schema = &m_uart_rx_schema[id];
+
+	if (p_schema->handler != NULL)
+	{
+		if ((length >= p_schema->min_length) && (length <= p_schema->max_length))
+		{
+			(*p_schema->handler)(p_data, length);
+		}
+		else
+		{
+			NRF_LOG_INFO("UART ID 0x%02x: invalid length %d, frame ignored.", id, length);
+		}
+	}
+	else if ((id & ID_CHANNEL_MASK) == ID_CHANNEL_BUFFER)
+	{
+		ble_pickit_channel_uart_receive(id & ~ID_CHANNEL_MASK, p_data, length);
+	}
+}
+
+static void _rx_pa_lna(uint8_t const * p_data, uint8_t length)
+{
+	p_vsd->params.pa_lna_enable = p_data[0] & 0x01;
+}
+
+static void _rx_led_status(uint8_t const * p_data, uint8_t length)
+{
+	p_vsd->params.leds_status_enable = p_data[0] & 0x01;
+	ble_pickit_leds_enable(p_vsd->params.leds_status_enable);
+	ble_pickit_parameters_changed();
+}
+
+static void _rx_set_name(uint8_t const * p_data, uint8_t length)
+{
+	memcpy(p_vsd->infos.device_name, p_data, length);
+	p_vsd->infos.device_name[length] = '\0';
+}
+
+static void _rx_get_version(uint8_t const * p_data, uint8_t length)
+{
+	p_vsd->flags.send_version = true;
+}
+
+static void _rx_notif_flow(uint8_t const * p_data, uint8_t length)
+{
+	p_vsd->params.notif_flow_enable = p_data[0] & 0x01;
+	if (!p_vsd->params.notif_flow_enable && p_vsd->characteristic.buffer.is_xoff)
+	{
+		p_vsd->characteristic.buffer.is_xoff = false;
+		p_vsd->flags.send_notif_flow = true;
+	}
+}
+
+static void _rx_uart_full_duplex(uint8_t const * p_data, uint8_t length)
+{
+	// Takes effect after the ACK of this frame (sent with the current mode).
+	p_vsd->params.uart_full_duplex = p_data[0] & 0x01;
+	p_vsd->uart.index = 0;
+	p_vsd->uart.receive_in_progress = false;
+}
+
+static void _rx_ext_compression(uint8_t const * p_data, uint8_t length)
+{
+	p_vsd->params.ext_lz_uart_enable = p_data[0] & 0x01;
+}
+
+static void _rx_adv_interval(uint8_t const * p_data, uint8_t length)
+{
+	p_vsd->params.preferred_gap_params.adv_interval = (p_data[0] << 8) | (p_data[1] << 0);
+}
+
+static void _rx_adv_timeout(uint8_t const * p_data, uint8_t length)
+{
+	p_vsd->params.preferred_gap_params.adv_timeout = (p_data[0] << 8) | (p_data[1] << 0);
+}
+
+static void _rx_set_ble_conn_params(uint8_t const * p_data, uint8_t length)
+{
+	ble_gap_conn_params_t conn_params;
+
+	ble_pickit_conn_params_decode(p_data, &conn_params);
+	if (memcmp(&p_vsd->params.preferred_gap_params.conn_params, &conn_params, sizeof(conn_params)) != 0)
+	{
+		p_vsd->params.preferred_gap_params.conn_params = conn_params;
+		p_vsd->flags.set_conn_params = true;
+	}
+}
+
+static void _rx_set_ble_phy_params(uint8_t const * p_data, uint8_t length)
+{
+	if (	(p_vsd->params.preferred_gap_params.phys_params.tx_phys != p_data[0]) ||
+			(p_vsd->params.preferred_gap_params.phys_params.rx_phys != p_data[0]))
+	{
+		p_vsd->params.preferred_gap_params.phys_params.tx_phys = p_data[0];
+		p_vsd->params.preferred_gap_params.phys_params.rx_phys = p_data[0];
+		p_vsd->flags.set_phy_params = true;
+	}
+}
+
+static void _rx_set_ble_att_size_params(uint8_t const * p_data, uint8_t length)
+{
+	if (	(p_vsd->params.preferred_gap_params.mtu_size_params.max_tx_octets != p_data[0]) ||
+			(p_vsd->params.preferred_gap_params.mtu_size_params.max_rx_octets != p_data[1]))
+	{
+		p_vsd->params.preferred_gap_params.mtu_size_params.max_tx_octets = p_data[0];
+		p_vsd->params.preferred_gap_params.mtu_size_params.max_rx_octets = p_data[1];
+		p_vsd->flags.set_att_size_params = true;
+	}
+}
+
+static void _rx_char_buffer(uint8_t const * p_data, uint8_t length)
+{
+	(void) _notif_buffer_append(ID_CHAR_BUFFER, p_data, length, false);
+}
+
+static void _rx_char_buffer_flush(uint8_t const * p_data, uint8_t length)
+{
+	(void) _notif_buffer_append(ID_CHAR_BUFFER, p_data, length, true);
+}
+
+static void _rx_rpc_response(uint8_t const * p_data, uint8_t length)
+{
+	_rpc_response(p_data, length);
+}
+
+static void _rx_rpc_timeout(uint8_t const * p_data, uint8_t length)
+{
+	p_vsd->params.rpc_timeout = (p_data[0] << 8) | (p_data[1] << 0);
+}
+
+static void _rx_profiler(uint8_t const * p_data, uint8_t length)
+{
+	if ((length == 1) && (p_data[0] == 0x01))
+	{
+		ble_pickit_profiler_reset();
+	}
+	else
+	{
+		p_vsd->flags.send_profiler = true;
+	}
+}
+
+static void _rx_trace(uint8_t const * p_data, uint8_t length)
+{
+	p_vsd->flags.send_trace = true;
+}
+
+static void _rx_capture(uint8_t const * p_data, uint8_t length)
+{
+	if (p_data[0] == CAPTURE_CMD_READ)
+	{
+		p_vsd->flags.send_capture = true;
+	}
+	else
+	{
+		ble_pickit_capture_control(p_data[0]);
+	}
+}
+
+static void _rx_stats(uint8_t const * p_data, uint8_t length)
+{
+	if ((length == 1) && (p_data[0] == 0x01))
+	{
+		ble_pickit_stats_reset();
+	}
+	else
+	{
+		p_vsd->flags.send_stats = true;
+	}
+}
+
+static void _rx_benchmark(uint8_t const * p_data, uint8_t length)
+{
+	p_vsd->flags.send_benchmark = true;
+}
+
+/**@brief ID_LINK_MODEL: parameters of the host MCU or the ones set by the firmware (current link, preferred ones
+ *        when disconnected).
+ */
+static void _rx_link_model(uint8_t const * p_data, uint8_t length)
+{
+	ble_pickit_gap_params const * p_gap = &p_vsd->params.preferred_gap_params;
+	uint8_t max_tx_octets = p_gap->mtu_size_params.max_tx_octets - 4;		// Preferred: LL payload
+
+	if (length == LINK_MODEL_PARAMS_SIZE)
+	{
+		ble_pickit_link_model_params_decode(p_data, &m_link_model_params);
+	}
+	else if (length == 0)
+	{
+		if (p_vsd->status.is_connected_to_a_central)
+		{
+			p_gap = &p_vsd->params.current_gap_params;
+			max_tx_octets = p_gap->mtu_size_params.max_tx_octets;			// Current: LL payload - 4
+		}
+		m_link_model_params.conn_interval = p_gap->conn_params.max_conn_interval;
+		m_link_model_params.event_length = CONN_EVENT_LENGTH;
+		m_link_model_params.is_event_extension = true;
+		m_link_model_params.phy = (p_gap->phys_params.tx_phys & BLE_GAP_PHY_2MBPS) ? BLE_GAP_PHY_2MBPS : BLE_GAP_PHY_1MBPS;
+		m_link_model_params.max_tx_octets = max_tx_octets;
+		m_link_model_params.hvn_queue_size = 0;								// Refilled on BLE_GATTS_EVT_HVN_TX_COMPLETE during the event
+	}
+	else
+	{
+		return;
+	}
+	p_vsd->flags.send_link_model = true;
+}
+
+static void _rx_link_adapt(uint8_t const * p_data, uint8_t length)
+{
+	p_vsd->params.link_adapt_enable = p_data[0] & 0x01;
+}
+
+static void _rx_cache_update(uint8_t const * p_data, uint8_t length)
+{
+	ble_pickit_cache_update(p_data, length);
+}
+
+static void _rx_transparent_mode(uint8_t const * p_data, uint8_t length)
+{
+	if (length >= 3)
+	{
+		p_vsd->params.transparent_timeout = (p_data[1] << 8) | (p_data[2] << 0);
+	}
+	ble_pickit_transparent_set(p_data[0] & 0x01);
+}
+
+static void _rx_channel_config(uint8_t const * p_data, uint8_t length)
+{
+	ble_pickit_channel_priority_set(p_data[0], p_data[1]);
+}
 
+static void _rx_notif_aggregation(uint8_t const * p_data, uint8_t length)
+{
+	p_vsd->params.aggregation_enable = p_data[0] & 0x01;
+	if (length >= 3)
+	{
+		p_vsd->params.aggregation_timeout = (p_data[1] << 8) | (p_data[2] << 0);
+	}
+}
+
+static void _rx_char_broadcast_buffer(uint8_t const * p_data, uint8_t length)
+{
+	// An empty payload stops the broadcast.
+	ble_pickit_broadcast_set(p_data, length);
+}
+
+static void _rx_software_reset(uint8_t const * p_data, uint8_t length)
+{
+	if ((p_data[0] == RESET_ALL) || (p_data[0] == RESET_BLE_PICKIT))
+	{
+		p_vsd->flags.exec_reset = true;
+	}
 }
 
 static void _boot(uint8_t *buffer)
 {
-	uint16_t crc = 0;
+	// Constant frame: CRC16 precomputed (fu_crc_16_ibm of the 4 first bytes).
+	static const uint8_t boot_frame[] = {ID_BOOT_MODE, 'N', 1, 0x23, 0x5e, 0x20};
 
-	buffer[0] = ID_BOOT_MODE;
-	buffer[1] = 'N';
-	buffer[2] = 1;
-	buffer[3] = 0x23;
-	crc = fu_crc_16_ibm(buffer, buffer[2]+3);
-	buffer[buffer[2]+3] = (crc >> 8) & 0xff;
-	buffer[buffer[2]+4] = (crc >> 0) & 0xff;
+	memcpy(buffer, boot_frame, sizeof(boot_frame));
 }
 
 static void _version(uint8_t *buffer)
@@ -363,20 +719,7 @@ static void _ble_params(uint8_t *buffer)
 
 	buffer[0] = ID_GET_BLE_PARAMS;
 	buffer[1] = 'N';
-	buffer[2] = 13;
-	buffer[3] = (p_vsd->params.current_gap_params.conn_params.min_conn_interval >> 8) & 0xff;
-	buffer[4] = (p_vsd->params.current_gap_params.conn_params.min_conn_interval >> 0) & 0xff;
-	buffer[5] = (p_vsd->params.current_gap_params.conn_params.max_conn_interval >> 8) & 0xff;
-	buffer[6] = (p_vsd->params.current_gap_params.conn_params.max_conn_interval >> 0) & 0xff;
-	buffer[7] = (p_vsd->params.current_gap_params.conn_params.slave_latency >> 8) & 0xff;
-	buffer[8] = (p_vsd->params.current_gap_params.conn_params.slave_latency >> 0) & 0xff;
-	buffer[9] = (p_vsd->params.current_gap_params.conn_params.conn_sup_timeout >> 8) & 0xff;
-	buffer[10] = (p_vsd->params.current_gap_params.conn_params.conn_sup_timeout >> 0) & 0xff;
-	buffer[11] = p_vsd->params.current_gap_params.phys_params.tx_phys;
-	buffer[12] = p_vsd->params.current_gap_params.mtu_size_params.max_tx_octets;
-	buffer[13] = p_vsd->params.current_gap_params.mtu_size_params.max_rx_octets;
-	buffer[14] = p_vsd->params.pa_lna_enable;
-	buffer[15] = p_vsd->params.leds_status_enable;
+	buffer[2] = ble_pickit_params_encode(&p_vsd->params, &buffer[3]);
 	crc = fu_crc_16_ibm(buffer, buffer[2]+3);
 	buffer[buffer[2]+3] = (crc >> 8) & 0xff;
 	buffer[buffer[2]+4] = (crc >> 0) & 0xff;
@@ -397,54 +740,890 @@ static void _pa_lna_param(uint8_t *buffer)
 
 static void _transfer_ble_to_uart(uint8_t *buffer)
 {
+	ble_serial_message_t * p_message = &p_vsd->outgoing_uart_ring.message[p_vsd->outgoing_uart_ring.drain];
     uint8_t i = 0;
 	uint16_t crc = 0;
 
-	buffer[0] = p_vsd->outgoing_uart_message.id;
-	buffer[1] = p_vsd->outgoing_uart_message.type;
-	buffer[2] = p_vsd->outgoing_uart_message.length;
+	buffer[0] = p_message->id;
+	buffer[1] = p_message->type;
+	buffer[2] = p_message->length;
 	for (i = 0 ; i < buffer[2] ; i++)
 	{
-		buffer[3+i] = p_vsd->outgoing_uart_message.data[i];
+		buffer[3+i] = p_message->data[i];
 	}
 	crc = fu_crc_16_ibm(buffer, buffer[2]+3);
 	buffer[buffer[2]+3] = (crc >> 8) & 0xff;
 	buffer[buffer[2]+4] = (crc >> 0) & 0xff;
 }
 
-static void _extended_transfer_ble_to_uart(uint8_t *buffer)
-{
-	// No CRC for extended message
-    memcpy(buffer, &p_vsd->outgoing_uart_extended_message, p_vsd->outgoing_uart_extended_message.length + 4);
-}
-
-static void _notif_buffer(uint8_t *buffer)
+/**@brief Function for getting the next free message of the ring (app characteristic write).
+ *
+ * @return The message to fill or NULL if the central has no credit left (credits notified again).
+ */
+ble_serial_message_t * ble_pickit_outgoing_message_alloc(void)
 {
-	uint8_t i = 0;
+	ble_serial_message_ring_t * p_ring = &p_vsd->outgoing_uart_ring;
 
-	buffer[0] = ID_CHAR_BUFFER;
-	buffer[1] = p_vsd->characteristic.buffer.length;
-	for (i = 0 ; i < buffer[1] ; i++)
+	if (p_ring->count >= OUTGOING_MESSAGE_RING_SIZE)
 	{
-		buffer[2+i] = p_vsd->characteristic.buffer.data[i];
+		p_vsd->flags.send_credits = true;
+		return NULL;
 	}
+	return &p_ring->message[(p_ring->drain + p_ring->count) % OUTGOING_MESSAGE_RING_SIZE];
 }
 
-static bool is_vsd_send_request_free_for_id(uint8_t id)
+void ble_pickit_outgoing_message_commit(void)
 {
-	return (current_id_requested == id) || (current_id_requested == ID_NONE);
+	p_vsd->outgoing_uart_ring.count++;
+	p_vsd->flags.transfer_ble_to_uart = true;
 }
 
-static uint8_t vsd_send_request(p_function ptr, bool is_extended_message, uint8_t id)
+static void _outgoing_message_release(void)
 {
-    static state_machine_t sm;
-	static uint8_t buffer[MAXIMUM_SIZE_EXTENDED_MESSAGE + 4] = {0};
+	ble_serial_message_ring_t * p_ring = &p_vsd->outgoing_uart_ring;
 
-	switch (sm.index)
-	{
-		case 0:
-			sm.index++;
-			sm.tick = mGetTick();
+	p_ring->drain = (p_ring->drain + 1) % OUTGOING_MESSAGE_RING_SIZE;
+	p_ring->count--;
+	p_vsd->flags.transfer_ble_to_uart = (p_ring->count > 0);
+	p_vsd->flags.send_credits = true;
+}
+
+static uint16_t _credits(uint8_t *buffer)
+{
+	buffer[0] = 0x06;
+	buffer[1] = 2;
+	buffer[2] = OUTGOING_MESSAGE_RING_SIZE - p_vsd->outgoing_uart_ring.count;
+	buffer[3] = EXT_MESSAGE_RING_SIZE - p_vsd->outgoing_uart_extended_ring.count;
+	return 4;
+}
+
+static void _extended_transfer_ble_to_uart(uint8_t *buffer)
+{
+	ble_serial_extended_ring_t * p_ring = &p_vsd->outgoing_uart_extended_ring;
+
+	// No CRC for extended message
+    memcpy(buffer, &p_ring->message[p_ring->drain], p_ring->message[p_ring->drain].length + 4);
+}
+
+/**@brief Function for getting the next free extended message of the ring (new transfer).
+ *
+ * @return The message to fill or NULL if all of them are waiting for the UART (busy status notified to the central).
+ */
+static ble_serial_extended_message_t * _ext_message_alloc(void)
+{
+	ble_serial_extended_ring_t * p_ring = &p_vsd->outgoing_uart_extended_ring;
+
+	if (p_ring->count >= EXT_MESSAGE_RING_SIZE)
+	{
+		if (!p_ring->is_busy_notified)
+		{
+			p_ring->is_busy_notified = true;
+			p_vsd->flags.send_ext_buffer_status = true;
+		}
+		return NULL;
+	}
+	return &p_ring->message[(p_ring->drain + p_ring->count) % EXT_MESSAGE_RING_SIZE];
+}
+
+/**@brief Function for queuing the extended message filled since _ext_message_alloc (all the fragments received).
+ */
+static void _ext_message_commit(void)
+{
+	p_vsd->outgoing_uart_extended_ring.count++;
+	p_vsd->flags.extended_transfer_ble_to_uart = true;
+}
+
+static bool _ext_fragment_is_received(ble_ext_reassembly_t const * p_rx, uint8_t fragment)
+{
+	return (p_rx->bitmap[(fragment - 1) >> 3] & (1 << ((fragment - 1) & 0x07))) != 0;
+}
+
+static uint8_t _ext_fragment_first_missing(ble_ext_reassembly_t const * p_rx)
+{
+	uint8_t fragment;
+
+	for (fragment = 1 ; (fragment < p_rx->total) && _ext_fragment_is_received(p_rx, fragment) ; fragment++);
+	return fragment;
+}
+
+/**@brief Function for placing a fragment of an extended message (SERVICE_EVT_APP_WRITE on the app characteristic).
+ *
+ * @param[in] buffer  ID - Length - Total - Current - Data
+ * @param[in] length  Length of buffer (Length + 2).
+ */
+void ble_pickit_ext_fragment_receive(uint8_t const * buffer, uint16_t length)
+{
+	ble_ext_reassembly_t * p_rx = &p_vsd->outgoing_uart_extended_ring.rx;
+	// A compressed message is decoded on the fly (fragment per fragment) unless the host MCU accepts it as is.
+	bool is_lz_decoded = (buffer[0] == ID_CHAR_EXT_BUFFER_LZ) && !p_vsd->params.ext_lz_uart_enable;
+	uint8_t total = buffer[2];
+	uint8_t current = buffer[3];
+	uint8_t data_length = buffer[1] - 2;
+	uint16_t offset;
+
+	if ((length < 4) || (current == 0) || (current > total))
+	{
+		return;
+	}
+
+	// New transfer: first fragment (unless it repairs the current transfer) or any fragment if none is in progress.
+	if (	(p_rx->p_message == NULL) || (p_rx->id != buffer[0]) || (p_rx->total != total) || 	\
+			((current == 1) && _ext_fragment_is_received(p_rx, 1)))
+	{
+		ble_serial_extended_message_t * p_message = _ext_message_alloc();
+
+		memset(p_rx, 0, sizeof(ble_ext_reassembly_t));
+		if (p_message == NULL)
+		{
+			NRF_LOG_INFO("Extended message: buffers busy, transfer refused");
+			return;
+		}
+
+		memset(p_message, 0, sizeof(ble_serial_extended_message_t));
+		p_message->id = is_lz_decoded ? ID_CHAR_EXT_BUFFER_NO_CRC : buffer[0];
+		p_message->type = 'N';
+		p_message->length = 0;
+		ble_pickit_lz_init(&m_lz);
+
+		p_rx->p_message = p_message;
+		p_rx->id = buffer[0];
+		p_rx->total = total;
+		p_rx->next = 1;
+	}
+
+	if (!_ext_fragment_is_received(p_rx, current))
+	{
+		if (is_lz_decoded)
+		{
+			// Out of sequence: dropped (reported missing).
+			if (current == p_rx->next)
+			{
+				if (ble_pickit_lz_decode(&m_lz, &buffer[4], data_length, p_rx->p_message->data, &p_rx->p_message->length, MAXIMUM_SIZE_EXTENDED_MESSAGE) != NRF_SUCCESS)
+				{
+					// Corrupted stream: the message is dropped.
+					NRF_LOG_INFO("Extended message: LZ stream error");
+					p_rx->p_message->id = ID_NONE;
+				}
+				p_rx->next++;
+				p_rx->bitmap[(current - 1) >> 3] |= (1 << ((current - 1) & 0x07));
+				p_rx->received++;
+			}
+		}
+		else if ((current < total) ? ((p_rx->fragment_size == 0) || (p_rx->fragment_size == data_length)) : ((total == 1) || (p_rx->fragment_size > 0)))
+		{
+			// The last fragment is placed once the size of the others is known (reported missing otherwise).
+			p_rx->fragment_size = (current < total) ? data_length : p_rx->fragment_size;
+			offset = (current - 1) * p_rx->fragment_size;
+
+			if ((offset + data_length) <= MAXIMUM_SIZE_EXTENDED_MESSAGE)
+			{
+				memcpy(&p_rx->p_message->data[offset], &buffer[4], data_length);
+				if (current == total)
+				{
+					p_rx->p_message->length = offset + data_length;
+				}
+				p_rx->bitmap[(current - 1) >> 3] |= (1 << ((current - 1) & 0x07));
+				p_rx->received++;
+			}
+		}
+	}
+
+	if (p_rx->received == total)
+	{
+		ble_serial_extended_message_t * p_message = p_rx->p_message;
+		uint16_t message_length = p_message->length;
+
+		if ((p_rx->id == ID_CHAR_EXT_BUFFER_CRC) && (	(message_length < 2) || 																\
+														(fu_crc_16_ibm(p_message->data, message_length - 2) != ((p_message->data[message_length - 2] << 8) | p_message->data[message_length - 1]))))
+		{
+			// All the fragments are received but the message is corrupted: all of them are requested again.
+			NRF_LOG_INFO("Extended message: CRC error");
+			memset(p_rx->bitmap, 0, sizeof(p_rx->bitmap));
+			p_rx->received = 0;
+			p_rx->fragment_size = 0;
+			p_rx->nack_last = total;
+			p_vsd->flags.send_ext_nack = true;
+			return;
+		}
+
+		if (p_message->id != ID_NONE)
+		{
+			_ext_message_commit();
+		}
+		p_rx->p_message = NULL;
+	}
+	else if ((current == total) || (current == p_rx->nack_last))
+	{
+		for (p_rx->nack_last = total ; _ext_fragment_is_received(p_rx, p_rx->nack_last) ; p_rx->nack_last--);
+		p_vsd->flags.send_ext_nack = true;
+	}
+}
+
+static void _ext_message_release(void)
+{
+	ble_serial_extended_ring_t * p_ring = &p_vsd->outgoing_uart_extended_ring;
+
+	p_ring->drain = (p_ring->drain + 1) % EXT_MESSAGE_RING_SIZE;
+	p_ring->count--;
+	p_vsd->flags.extended_transfer_ble_to_uart = (p_ring->count > 0);
+	p_vsd->flags.send_credits = true;
+
+	if (p_ring->is_busy_notified)
+	{
+		p_ring->is_busy_notified = false;
+		p_vsd->flags.send_ext_buffer_status = true;
+	}
+}
+
+static uint16_t _ext_nack(uint8_t *buffer)
+{
+	ble_ext_reassembly_t * p_rx = &p_vsd->outgoing_uart_extended_ring.rx;
+	uint8_t first = _ext_fragment_first_missing(p_rx);
+	uint8_t length = MIN(((p_rx->total - first) / 8) + 1, ble_pickit_app_notification_max_length() - 3);
+	uint16_t i;
+
+	buffer[0] = ID_CHAR_EXT_BUFFER_NACK;
+	buffer[1] = 1 + length;
+	buffer[2] = first;
+	memset(&buffer[3], 0, length);
+	for (i = 0 ; (i < (length * 8)) && ((first + i) <= p_rx->total) ; i++)
+	{
+		if (!_ext_fragment_is_received(p_rx, first + i))
+		{
+			buffer[3 + (i >> 3)] |= (1 << (i & 0x07));
+		}
+	}
+	return 3 + length;
+}
+
+static uint16_t _ext_buffer_status(uint8_t *buffer)
+{
+	buffer[0] = ID_CHAR_EXT_BUFFER_STATUS;
+	buffer[1] = 1;
+	buffer[2] = EXT_MESSAGE_RING_SIZE - p_vsd->outgoing_uart_extended_ring.count;
+	return 3;
+}
+
+static void _channel_transfer_ble_to_uart(uint8_t *buffer)
+{
+	uint8_t channel;
+	uint16_t crc = 0;
+
+	// The record stays in its channel queue until the frame is acknowledged.
+	buffer[2] = ble_pickit_channel_uart_peek(&channel, &buffer[3]);
+	buffer[0] = ID_CHANNEL_BUFFER | channel;
+	buffer[1] = 'N';
+	crc = fu_crc_16_ibm(buffer, buffer[2]+3);
+	buffer[buffer[2]+3] = (crc >> 8) & 0xff;
+	buffer[buffer[2]+4] = (crc >> 0) & 0xff;
+}
+
+static void _notif_flow(uint8_t *buffer)
+{
+	uint16_t crc = 0;
+
+	buffer[0] = ID_NOTIF_FLOW;
+	buffer[1] = 'N';
+	buffer[2] = 1;
+	buffer[3] = p_vsd->characteristic.buffer.is_xoff;
+	crc = fu_crc_16_ibm(buffer, buffer[2]+3);
+	buffer[buffer[2]+3] = (crc >> 8) & 0xff;
+	buffer[buffer[2]+4] = (crc >> 0) & 0xff;
+}
+
+static void _profiler(uint8_t *buffer)
+{
+	uint16_t crc = 0;
+	uint8_t region;
+
+	buffer[0] = ID_PROFILER;
+	buffer[1] = 'N';
+	buffer[2] = 0;
+	for (region = 0 ; region < PROFILER_REGION_COUNT ; region++)
+	{
+		buffer[2] += ble_pickit_profiler_encode(region, &buffer[3 + buffer[2]]);
+	}
+	crc = fu_crc_16_ibm(buffer, buffer[2]+3);
+	buffer[buffer[2]+3] = (crc >> 8) & 0xff;
+	buffer[buffer[2]+4] = (crc >> 0) & 0xff;
+}
+
+static void _trace(uint8_t *buffer)
+{
+	uint16_t crc = 0;
+
+	buffer[0] = ID_TRACE;
+	buffer[1] = 'N';
+	buffer[2] = ble_pickit_trace_encode(&buffer[3], TRACE_UART_RECORDS);
+	crc = fu_crc_16_ibm(buffer, buffer[2]+3);
+	buffer[buffer[2]+3] = (crc >> 8) & 0xff;
+	buffer[buffer[2]+4] = (crc >> 0) & 0xff;
+}
+
+static void _capture(uint8_t *buffer)
+{
+	uint16_t crc = 0;
+
+	buffer[0] = ID_CAPTURE;
+	buffer[1] = 'N';
+	buffer[2] = ble_pickit_capture_encode(&buffer[3], CAPTURE_READ_SIZE);
+	crc = fu_crc_16_ibm(buffer, buffer[2]+3);
+	buffer[buffer[2]+3] = (crc >> 8) & 0xff;
+	buffer[buffer[2]+4] = (crc >> 0) & 0xff;
+}
+
+static uint16_t _capture_notif(uint8_t *buffer)
+{
+	// Encoded again only once the previous notification is sent.
+	if (m_capture_notif_length == 0)
+	{
+		m_capture_notif[0] = 0x07;
+		m_capture_notif[1] = ble_pickit_capture_encode(&m_capture_notif[2], ble_pickit_app_notification_max_length() - 2);
+		m_capture_notif_length = m_capture_notif[1] + 2;
+	}
+	memcpy(buffer, m_capture_notif, m_capture_notif_length);
+	return m_capture_notif_length;
+}
+
+static uint16_t _trace_notif(uint8_t *buffer)
+{
+	if (m_trace_notif_length == 0)
+	{
+		m_trace_notif[0] = 0x08;
+		m_trace_notif[1] = ble_pickit_trace_encode(&m_trace_notif[2], (ble_pickit_app_notification_max_length() - 4) / TRACE_RECORD_SIZE);
+		m_trace_notif_length = m_trace_notif[1] + 2;
+	}
+	memcpy(buffer, m_trace_notif, m_trace_notif_length);
+	return m_trace_notif_length;
+}
+
+static void _stats(uint8_t *buffer)
+{
+	uint16_t crc = 0;
+
+	buffer[0] = ID_STATS;
+	buffer[1] = 'N';
+	buffer[2] = ble_pickit_stats_encode(&buffer[3]);
+	crc = fu_crc_16_ibm(buffer, buffer[2]+3);
+	buffer[buffer[2]+3] = (crc >> 8) & 0xff;
+	buffer[buffer[2]+4] = (crc >> 0) & 0xff;
+}
+
+static void _benchmark(uint8_t *buffer)
+{
+	uint16_t crc = 0;
+
+	buffer[0] = ID_BENCHMARK;
+	buffer[1] = 'N';
+	buffer[2] = ble_pickit_benchmark_run(&buffer[3]);
+	crc = fu_crc_16_ibm(buffer, buffer[2]+3);
+	buffer[buffer[2]+3] = (crc >> 8) & 0xff;
+	buffer[buffer[2]+4] = (crc >> 0) & 0xff;
+}
+
+static void _link_model(uint8_t *buffer)
+{
+	uint16_t crc = 0;
+
+	buffer[0] = ID_LINK_MODEL;
+	buffer[1] = 'N';
+	buffer[2] = ble_pickit_link_model_encode(&m_link_model_params, &buffer[3]);
+	crc = fu_crc_16_ibm(buffer, buffer[2]+3);
+	buffer[buffer[2]+3] = (crc >> 8) & 0xff;
+	buffer[buffer[2]+4] = (crc >> 0) & 0xff;
+}
+
+static void _cache_request(uint8_t *buffer)
+{
+	uint16_t crc = 0;
+
+	buffer[0] = ID_CACHE_REQUEST;
+	buffer[1] = 'N';
+	buffer[2] = 1;
+	buffer[3] = ble_pickit_cache_request_key();
+	crc = fu_crc_16_ibm(buffer, buffer[2]+3);
+	buffer[buffer[2]+3] = (crc >> 8) & 0xff;
+	buffer[buffer[2]+4] = (crc >> 0) & 0xff;
+}
+
+static void _channel_flow(uint8_t *buffer)
+{
+	uint16_t crc = 0;
+
+	buffer[0] = ID_CHANNEL_FLOW;
+	buffer[1] = 'N';
+	buffer[2] = 1;
+	buffer[3] = ble_pickit_channel_flow_get();
+	crc = fu_crc_16_ibm(buffer, buffer[2]+3);
+	buffer[buffer[2]+3] = (crc >> 8) & 0xff;
+	buffer[buffer[2]+4] = (crc >> 0) & 0xff;
+}
+
+static uint16_t _notif_buffer(uint8_t *buffer)
+{
+	app_fifo_t * p_fifo = &p_vsd->characteristic.buffer.fifo;
+	uint16_t max_length = ble_pickit_app_notification_max_length();
+	uint32_t available = 0;
+	uint16_t length = 0;
+	uint16_t i;
+
+	// The records are only peeked: they are removed from the fifo once the notification is queued (_notif_buffer_consume).
+	(void) app_fifo_read(p_fifo, NULL, &available);
+	while (length < available)
+	{
+		uint8_t record_length;
+
+		(void) app_fifo_peek(p_fifo, length + 1, &record_length);
+		if ((length > 0) && ((length + record_length + 2) > max_length))
+		{
+			// A record larger than the current ATT payload is still sent alone (at most NOTIF_RECORD_MAX_LENGTH + 2 bytes,
+			// the maximum ATT payload): sd_ble_gatts_hvx() rejects it as the first version did.
+			break;
+		}
+		for (i = 0 ; i < (record_length + 2) ; i++)
+		{
+			(void) app_fifo_peek(p_fifo, length + i, &buffer[length + i]);
+		}
+		length += record_length + 2;
+
+		if (!p_vsd->params.aggregation_enable)
+		{
+			break;
+		}
+	}
+
+	m_notif_length = length;
+	return length;
+}
+
+static void _notif_buffer_consume(void)
+{
+	app_fifo_t * p_fifo = &p_vsd->characteristic.buffer.fifo;
+	uint8_t dummy;
+
+	if (m_notif_length == 0)
+	{
+		// Notification disabled or not connected: the pending records are dropped.
+		(void) app_fifo_flush(p_fifo);
+		_notif_flow_update(true);
+	}
+	for ( ; m_notif_length > 0 ; m_notif_length--)
+	{
+		(void) app_fifo_get(p_fifo, &dummy);
+	}
+}
+
+/**@brief Function for appending a record (record_id - Length - Data) to the notification fifo.
+ *
+ * @return false if the fifo is full (record dropped).
+ */
+static bool _notif_buffer_append(uint8_t record_id, uint8_t const * p_data, uint8_t length, bool is_flush)
+{
+	ble_char_buffer_t * p_buffer = &p_vsd->characteristic.buffer;
+	uint32_t available = 0;
+	uint32_t size = 1;
+
+	if (length > NOTIF_RECORD_MAX_LENGTH)
+	{
+		NRF_LOG_INFO("Record 0x%02x of %d bytes: larger than a notification, dropped.", record_id, length);
+		return false;
+	}
+
+	(void) app_fifo_write(&p_buffer->fifo, NULL, &size);
+	if (size < (uint32_t) (length + 2))
+	{
+		TRACE(TRACE_MODULE_VSD, TRACE_LEVEL_WARNING, TRACE_EVT_NOTIF_FIFO_FULL, record_id, length);
+		return false;
+	}
+
+	(void) app_fifo_read(&p_buffer->fifo, NULL, &available);
+	if (available == 0)
+	{
+		p_buffer->tick = mGetTick();
+	}
+
+	(void) app_fifo_put(&p_buffer->fifo, record_id);
+	(void) app_fifo_put(&p_buffer->fifo, length);
+	size = length;
+	(void) app_fifo_write(&p_buffer->fifo, p_data, &size);
+
+	p_buffer->is_flush_requested |= is_flush;
+	_notif_flow_update(false);
+	return true;
+}
+
+static ble_rpc_request_t * _rpc_find(uint8_t request_id)
+{
+	uint8_t i;
+
+	for (i = 0 ; i < RPC_IN_FLIGHT_MAX ; i++)
+	{
+		if (p_vsd->rpc.request[i].is_pending && (p_vsd->rpc.request[i].id == request_id))
+		{
+			return &p_vsd->rpc.request[i];
+		}
+	}
+	return NULL;
+}
+
+/**@brief Function for registering an ID_RPC_REQUEST written by the central (called before it is queued for the UART).
+ *
+ * @details The request is refused if RPC_IN_FLIGHT_MAX requests are already in flight or if its Request ID is
+ *          still in flight: the central then receives an ID_RPC_RESPONSE record with RPC_STATUS_BUSY.
+ *
+ * @return true if the request has to be forwarded to the host MCU.
+ */
+bool ble_pickit_rpc_register(uint8_t request_id)
+{
+	uint8_t record[2] = {request_id, RPC_STATUS_BUSY};
+	uint8_t i;
+
+	if ((p_vsd->rpc.count < RPC_IN_FLIGHT_MAX) && (_rpc_find(request_id) == NULL))
+	{
+		for (i = 0 ; i < RPC_IN_FLIGHT_MAX ; i++)
+		{
+			if (!p_vsd->rpc.request[i].is_pending)
+			{
+				p_vsd->rpc.request[i].id = request_id;
+				p_vsd->rpc.request[i].tick = mGetTick();
+				p_vsd->rpc.request[i].is_pending = true;
+				p_vsd->rpc.count++;
+				return true;
+			}
+		}
+	}
+
+	(void) _notif_buffer_append(ID_RPC_RESPONSE, record, sizeof(record), true);
+	return false;
+}
+
+/**@brief Function for forwarding an ID_RPC_RESPONSE of the host MCU (Request ID - Status - Payload) to the central.
+ *
+ * @details A response without request in flight (timed out or unknown Request ID) is dropped.
+ */
+static void _rpc_response(uint8_t const * p_data, uint8_t length)
+{
+	ble_rpc_request_t * p_request = (length >= 2) ? _rpc_find(p_data[0]) : NULL;
+
+	if (p_request == NULL)
+	{
+		NRF_LOG_INFO("ID_RPC_RESPONSE: no request in flight, response dropped.");
+		return;
+	}
+
+	// Kept in flight if the fifo is full: the central then receives RPC_STATUS_TIMEOUT.
+	if (_notif_buffer_append(ID_RPC_RESPONSE, p_data, length, true))
+	{
+		p_request->is_pending = false;
+		p_vsd->rpc.count--;
+	}
+}
+
+static void _rpc_tasks(void)
+{
+	uint8_t record[2] = {0, RPC_STATUS_TIMEOUT};
+	uint8_t i;
+
+	if (p_vsd->rpc.count == 0)
+	{
+		return;
+	}
+
+	for (i = 0 ; i < RPC_IN_FLIGHT_MAX ; i++)
+	{
+		if (p_vsd->rpc.request[i].is_pending && (mTickCompare(p_vsd->rpc.request[i].tick) >= (p_vsd->params.rpc_timeout * TICK_1MS)))
+		{
+			record[0] = p_vsd->rpc.request[i].id;
+			if (!_notif_buffer_append(ID_RPC_RESPONSE, record, sizeof(record), true))
+			{
+				// Retried on the next call.
+				break;
+			}
+			p_vsd->rpc.request[i].is_pending = false;
+			p_vsd->rpc.count--;
+		}
+	}
+}
+
+/**@brief Function for updating the XOFF / XON state of the notification fifo.
+ *
+ * @details XOFF is reported as soon as the free room goes under NOTIF_FIFO_XOFF_LEVEL. XON is only reported when a
+ *          release is allowed (BLE_GATTS_EVT_HVN_TX_COMPLETE or fifo flushed) and the free room is back over
+ *          NOTIF_FIFO_XON_LEVEL: the host MCU then sends at the rate of the notifications sent over the air.
+ *
+ * @param[in] is_release_allowed  true: XON may be reported.
+ */
+static void _notif_flow_update(bool is_release_allowed)
+{
+	ble_char_buffer_t * p_buffer = &p_vsd->characteristic.buffer;
+	uint32_t size = 1;
+	bool is_xoff;
+
+	(void) app_fifo_write(&p_buffer->fifo, NULL, &size);
+	is_xoff = p_buffer->is_xoff ? (!is_release_allowed || (size < NOTIF_FIFO_XON_LEVEL)) : (size < NOTIF_FIFO_XOFF_LEVEL);
+
+	if (p_vsd->params.notif_flow_enable && (is_xoff != p_buffer->is_xoff))
+	{
+		p_buffer->is_xoff = is_xoff;
+		p_vsd->flags.send_notif_flow = true;
+	}
+}
+
+/**@brief Function for releasing the host MCU (XON) once notifications have been sent (SERVICE_EVT_TX_COMPLETE).
+ */
+void ble_pickit_notif_flow_release(void)
+{
+	_notif_flow_update(true);
+}
+
+static void _notif_buffer_flush_check(void)
+{
+	ble_char_buffer_t * p_buffer = &p_vsd->characteristic.buffer;
+	uint32_t available = 0;
+
+	(void) app_fifo_read(&p_buffer->fifo, NULL, &available);
+	if (available == 0)
+	{
+		p_buffer->is_flush_requested = false;
+	}
+	else if (	!p_vsd->params.aggregation_enable || 											\
+				p_buffer->is_flush_requested || 												\
+				(available >= ble_pickit_app_notification_max_length()) || 						\
+				(mTickCompare(p_buffer->tick) >= (p_vsd->params.aggregation_timeout * TICK_1MS)))
+	{
+		p_vsd->flags.notification_buffer = true;
+	}
+}
+
+void ble_pickit_transparent_set(bool enable)
+{
+	ble_transparent_t * p_transparent = &p_vsd->transparent;
+
+	if (enable == p_vsd->params.transparent_enable)
+	{
+		return;
+	}
+
+	p_vsd->params.transparent_enable = enable;
+	p_transparent->length = 0;
+	p_transparent->tick = mGetTick();
+	p_transparent->tick_rate = mGetTick();
+	p_transparent->uart_to_ble_bytes = 0;
+	p_transparent->ble_to_uart_bytes = 0;
+	(void) app_fifo_flush(&p_transparent->tx_fifo);
+
+	// The framed protocol restarts from an empty reception buffer.
+	p_vsd->uart.index = 0;
+	p_vsd->uart.message_type = UART_NO_MESSAGE;
+	p_vsd->uart.ack_type = UART_NO_MESSAGE;
+
+	NRF_LOG_INFO("Transparent mode: %s", enable ? "enter" : "exit");
+}
+
+/**@brief Function for queuing the bytes of an app characteristic write in transparent mode.
+ *
+ * @details The bytes are sent to the UART by ble_stack_tasks() without blocking.
+ */
+void ble_pickit_transparent_write(uint8_t const * p_data, uint16_t length)
+{
+	uint32_t size = length;
+
+	if ((app_fifo_write(&p_vsd->transparent.tx_fifo, p_data, &size) != NRF_SUCCESS) || (size < length))
+	{
+		NRF_LOG_INFO("Transparent mode: UART fifo full, %d bytes dropped.", length - size);
+	}
+}
+
+static uint16_t _transparent_notif(uint8_t *buffer)
+{
+	memcpy(buffer, p_vsd->transparent.data, p_vsd->transparent.length);
+	return p_vsd->transparent.length;
+}
+
+static void _transparent_tasks(void)
+{
+	ble_transparent_t * p_transparent = &p_vsd->transparent;
+	uint16_t max_length = MIN(ble_pickit_app_notification_max_length(), TRANSPARENT_PACKET_SIZE);
+	uint32_t timeout = (p_vsd->params.transparent_timeout > 0) ? (p_vsd->params.transparent_timeout * TICK_1MS) : TICK_300US;
+	uint8_t byte;
+
+	/** UART -> BLE: the bytes are read only if there is room in the packet (the transport fifo buffers the others) */
+	while ((p_transparent->length < max_length) && (ble_pickit_transport_get(&byte) == NRF_SUCCESS))
+	{
+		if (p_transparent->length == 0)
+		{
+			p_transparent->is_escape_guard_ok = (mTickCompare(p_transparent->tick) >= TICK_1S);
+		}
+		p_transparent->data[p_transparent->length++] = byte;
+		p_transparent->tick = mGetTick();
+		p_transparent->uart_to_ble_bytes++;
+		ble_pickit_leds_event(LEDS_EVT_UART_ACTIVITY);
+	}
+
+	if (p_transparent->length > 0)
+	{
+		if (	p_transparent->is_escape_guard_ok && 							\
+				(p_transparent->length == 3) && 								\
+				(memcmp(p_transparent->data, "+++", 3) == 0))
+		{
+			// Escape sequence: held until the guard time after it elapses (any other byte cancels it).
+			if (mTickCompare(p_transparent->tick) >= TICK_1S)
+			{
+				ble_pickit_transparent_set(false);
+				return;
+			}
+		}
+		else if ((p_transparent->length >= max_length) || (mTickCompare(p_transparent->tick) >= timeout))
+		{
+			if (!ble_pickit_app_notification_send(_transparent_notif))
+			{
+				p_transparent->length = 0;
+			}
+		}
+	}
+
+	/** BLE -> UART: a byte leaves the fifo only once the transport fifo accepts it */
+	while ((app_fifo_peek(&p_transparent->tx_fifo, 0, &byte) == NRF_SUCCESS) && (ble_pickit_transport_put(byte) == NRF_SUCCESS))
+	{
+		(void) app_fifo_get(&p_transparent->tx_fifo, &byte);
+		p_transparent->ble_to_uart_bytes++;
+		p_vsd->uart.transmit_in_progress = true;
+		ble_pickit_leds_event(LEDS_EVT_UART_TX_START);
+	}
+
+	if (mTickCompare(p_transparent->tick_rate) >= TICK_1S)
+	{
+		if ((p_transparent->uart_to_ble_bytes > 0) || (p_transparent->ble_to_uart_bytes > 0))
+		{
+			NRF_LOG_INFO("Transparent mode: UART -> BLE %d B/s - BLE -> UART %d B/s", p_transparent->uart_to_ble_bytes, p_transparent->ble_to_uart_bytes);
+		}
+		p_transparent->uart_to_ble_bytes = 0;
+		p_transparent->ble_to_uart_bytes = 0;
+		p_transparent->tick_rate = mGetTick();
+	}
+}
+
+/**@brief Function for receiving the UART bytes in full duplex mode.
+ *
+ * @details The frames are delimited by their length (ID - 'W' - Length - Data - CRC16) instead of an idle time:
+ *          a frame is handled as soon as its last byte is received, the ACK / NACK of the host may follow or
+ *          precede a frame without any gap and the bridge transmits without waiting for the RX line to be idle.
+ *          The reading stops on a complete frame so that it is handled (buffer untouched) before the next one.
+ */
+static void _uart_full_duplex_receive(void)
+{
+	ble_uart_t * p_uart = &p_vsd->uart;
+	uint8_t data;
+
+	// Resynchronization: an incomplete frame followed by a silence is dropped.
+	if ((p_uart->index > 0) && (mTickCompare(p_uart->tick) >= TICK_1MS))
+	{
+		p_uart->index = 0;
+	}
+
+	while ((p_uart->message_type != UART_NEW_MESSAGE) && (ble_pickit_transport_get(&data) == NRF_SUCCESS))
+	{
+		p_uart->buffer[p_uart->index++] = data;
+		p_uart->tick = mGetTick();
+
+		if (p_uart->index < 2)
+		{
+			continue;
+		}
+
+		if ((p_uart->buffer[0] == 'A') && (p_uart->buffer[1] == 'C'))
+		{
+			if (p_uart->index == 3)
+			{
+				p_uart->ack_type = (data == 'K') ? UART_ACK_MESSAGE : p_uart->ack_type;
+				p_uart->index = 0;
+			}
+		}
+		else if ((p_uart->buffer[0] == 'N') && (p_uart->buffer[1] == 'A'))
+		{
+			if (p_uart->index == 4)
+			{
+				p_uart->ack_type = ((p_uart->buffer[2] == 'C') && (data == 'K')) ? UART_NACK_MESSAGE : p_uart->ack_type;
+				p_uart->index = 0;
+			}
+		}
+		else if ((p_uart->buffer[1] == 'W') && ((p_uart->index < 3) || (p_uart->buffer[2] < (sizeof(p_uart->buffer) - 5))))
+		{
+			if ((p_uart->index > 2) && (p_uart->index == (p_uart->buffer[2] + 5)))
+			{
+				p_uart->message_type = UART_NEW_MESSAGE;
+				p_uart->index = 0;
+			}
+		}
+		else
+		{
+			// Not a header: slide by one byte.
+			p_uart->buffer[0] = p_uart->buffer[1];
+			p_uart->index = 1;
+		}
+	}
+}
+
+/**@brief Function for queuing an ACK / NACK for the host MCU.
+ *
+ * @details The reply is put in the transport by _uart_reply_tasks() without blocking the main loop, between two frames
+ *          of vsd_send_request(). The host MCU waits for the reply of its frame before sending the next one: the buffer
+ *          only fills up if the host MCU retransmits without waiting, the reply is then dropped (the host MCU times out
+ *          and sends the frame again).
+ */
+static void _uart_reply_queue(char const * p_reply, uint8_t length)
+{
+	ble_uart_t * p_uart = &p_vsd->uart;
+
+	if ((p_uart->reply_length + length) > sizeof(p_uart->reply))
+	{
+		NRF_LOG_WARNING("UART: %s dropped (replies not sent).", p_reply);
+		return;
+	}
+	memcpy(&p_uart->reply[p_uart->reply_length], p_reply, length);
+	p_uart->reply_length += length;
+}
+
+static void _uart_reply_tasks(void)
+{
+	ble_uart_t * p_uart = &p_vsd->uart;
+
+	if (p_uart->is_frame_queuing || (p_uart->reply_length == 0))
+	{
+		return;
+	}
+	while ((p_uart->reply_index < p_uart->reply_length) && (ble_pickit_transport_put(p_uart->reply[p_uart->reply_index]) == NRF_SUCCESS))
+	{
+		p_uart->reply_index++;
+		p_uart->transmit_in_progress = true;
+		ble_pickit_leds_event(LEDS_EVT_UART_TX_START);
+	}
+	if (p_uart->reply_index == p_uart->reply_length)
+	{
+		p_uart->reply_index = 0;
+		p_uart->reply_length = 0;
+	}
+}
+
+static bool is_vsd_send_request_free_for_id(uint8_t id)
+{
+	return (current_id_requested == id) || (current_id_requested == ID_NONE);
+}
+
+static uint8_t vsd_send_request(p_function ptr, bool is_extended_message, uint8_t id)
+{
+    static state_machine_t sm;
+	static uint8_t buffer[MAXIMUM_SIZE_EXTENDED_MESSAGE + 4] = {0};
+	static uint32_t request_tick;
+	static uint16_t tx_index;
+	uint16_t tx_length;
+
+	switch (sm.index)
+	{
+		case 0:
+			sm.index++;
+			sm.tick = mGetTick();
+			request_tick = mGetTick();
 			current_id_requested = id;
 			/* no break */
         case 1:
@@ -458,7 +1637,7 @@ static uint8_t vsd_send_request(p_function ptr, bool is_extended_message, uint8_
             break;
 
         case 2:
-        	if (mTickCompare(sm.tick) >= TICK_400US)
+        	if (p_vsd->params.uart_full_duplex || (mTickCompare(sm.tick) >= TICK_400US))
         	{
         		if (!p_vsd->uart.transmit_in_progress && !p_vsd->uart.receive_in_progress)
 				{
@@ -476,23 +1655,39 @@ static uint8_t vsd_send_request(p_function ptr, bool is_extended_message, uint8_
 
 		case 3:
 
-			if (is_extended_message)
+			// The frame is put in the transport as the fifo frees up (no busy wait in the main loop). The replies
+			// waiting for the transport are sent before it and none is put inside it.
+			tx_length = is_extended_message ? (((buffer[2] << 0) | (buffer[3] << 8)) + 5) : (buffer[2] + 5);
+			if (!p_vsd->uart.is_frame_queuing)
 			{
-				uint16_t data_length = (buffer[2] << 0) | (buffer[3] << 8);
-				for (uint16_t i = 0 ; i <= (data_length + 4) ; i++)
+				if (p_vsd->uart.reply_length > 0)
 				{
-					do {} while (app_uart_put(buffer[i]) != NRF_SUCCESS);
+					break;
 				}
+				p_vsd->uart.ack_type = UART_NO_MESSAGE;
+				p_vsd->uart.is_frame_queuing = true;
+				tx_index = 0;
 			}
-			else
+
+			while ((tx_index < tx_length) && (ble_pickit_transport_put(buffer[tx_index]) == NRF_SUCCESS))
 			{
-				for (uint8_t i = 0 ; i <= (buffer[2] + 4) ; i++)
-				{
-					do {} while (app_uart_put(buffer[i]) != NRF_SUCCESS);
-				}
+				tx_index++;
+				p_vsd->uart.transmit_in_progress = true;
+			}
+			if (tx_index < tx_length)
+			{
+				break;
+			}
+			p_vsd->uart.is_frame_queuing = false;
+
+			if (is_extended_message || (id != ID_CAPTURE))
+			{
+				CAPTURE(CAPTURE_SOURCE_UART_TX, 0, buffer, tx_length);
 			}
 
             p_vsd->uart.transmit_in_progress = true;
+            ble_pickit_leds_event(LEDS_EVT_UART_TX_START);
+            ble_pickit_stats_add(STATS_UART_TX_FRAMES, 1);
 
 			sm.index++;
 			sm.tick = mGetTick();
@@ -517,19 +1712,24 @@ static uint8_t vsd_send_request(p_function ptr, bool is_extended_message, uint8_
 
 		case 5:
 
-            if (p_vsd->uart.message_type == UART_ACK_MESSAGE)
+            if (p_vsd->uart.ack_type == UART_ACK_MESSAGE)
             {
-                p_vsd->uart.message_type = UART_NO_MESSAGE;
+                CAPTURE(CAPTURE_SOURCE_UART_RX, 0, (uint8_t const *) "ACK", 3);
+                ble_pickit_stats_latency((mGetTick() - request_tick) & STATS_TICK_MASK);
+                p_vsd->uart.ack_type = UART_NO_MESSAGE;
                 sm.index = 0;
                 current_id_requested = ID_NONE;
             }
-            else if (p_vsd->uart.message_type == UART_NACK_MESSAGE)
+            else if (p_vsd->uart.ack_type == UART_NACK_MESSAGE)
             {
-                p_vsd->uart.message_type = UART_NO_MESSAGE;
+                CAPTURE(CAPTURE_SOURCE_UART_RX, 0, (uint8_t const *) "NACK", 4);
+                ble_pickit_stats_add(STATS_UART_TX_RETRANSMISSIONS, 1);
+                p_vsd->uart.ack_type = UART_NO_MESSAGE;
                 sm.index = 3;
             }
             else if (mTickCompare(sm.tick) >= TICK_10MS)
             {
+                ble_pickit_stats_add(STATS_UART_TX_RETRANSMISSIONS, 1);
                 sm.index = 3;
             }
 			break;
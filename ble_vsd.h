@@ -6,6 +6,7 @@
 #include "app_uart.h"
 #include "nrf_uart.h"
 #include "nrf_uarte.h"
+#include "app_fifo.h"
 
 #define ID_NONE						0xfe
 #define ID_BOOT_MODE                0x00
@@ -17,10 +18,37 @@
 #define ID_ADV_TIMEOUT				0x06
 #define ID_GET_CONN_STATUS			0x07
 #define ID_GET_BLE_PARAMS			0x08
+#define ID_EXT_COMPRESSION			0x09
+#define ID_NOTIF_AGGREGATION		0x0a
+#define ID_TRANSPARENT_MODE			0x0b
+#define ID_CHANNEL_CONFIG			0x0c
+#define ID_CHANNEL_FLOW				0x0d
+#define ID_UART_FULL_DUPLEX			0x0e
+#define ID_NOTIF_FLOW				0x0f
+#define ID_RPC_TIMEOUT				0x10
+#define ID_PROFILER					0x11		// See ble_pickit_profiler.h
+#define ID_TRACE					0x12		// See ble_pickit_trace.h
+#define ID_CAPTURE					0x13		// See ble_pickit_capture.h
+#define ID_STATS					0x14		// See ble_pickit_stats.h
+#define ID_BENCHMARK				0x15		// See ble_pickit_benchmark.h
+#define ID_LINK_MODEL				0x16		// See ble_pickit_link_model.h
+#define ID_LINK_ADAPT				0x17		// See ble_pickit_link_adapt.h
 #define ID_SOFTWARE_RESET			0xff
 
 #define ID_CHAR_BUFFER              0x30
+#define ID_CHAR_BROADCAST_BUFFER    0x31
+#define ID_CHAR_BUFFER_FLUSH        0x32
 #define ID_CHAR_EXT_BUFFER_NO_CRC   0x41
+#define ID_CHAR_EXT_BUFFER_LZ       0x42
+#define ID_CHAR_EXT_BUFFER_STATUS   0x43		// App notification: ID - Length (1) - Free buffers
+#define ID_CHAR_EXT_BUFFER_CRC      0x44		// As ID_CHAR_EXT_BUFFER_NO_CRC, the message ends with its CRC16 (checked by the bridge, forwarded to the host)
+#define ID_CHAR_EXT_BUFFER_NACK     0x45		// App notification: ID - Length - First missing fragment - Bitmap (bit n: fragment First + n missing)
+#define ID_CHANNEL_BUFFER           0x50		// 0x50 | channel
+#define ID_CHANNEL_MASK             0xf0
+#define ID_RPC_REQUEST              0x60		// Central -> host MCU: ID - Length - Request ID - Payload
+#define ID_RPC_RESPONSE             0x61		// Host MCU -> central: ID - Length - Request ID - Status - Payload
+#define ID_CACHE_UPDATE             0x70		// Host MCU -> bridge: ID - Length - Key - Max age (ms, 2B) - Value (see ble_pickit_cache.h)
+#define ID_CACHE_REQUEST            0x71		// Bridge -> host MCU: ID - Length (1) - Key to publish
 
 #define ID_SET_BLE_CONN_PARAMS      0x20
 #define ID_SET_BLE_PHY_PARAMS       0x21
@@ -29,7 +57,22 @@
 #define RESET_BLE_PICKIT            0x01
 #define RESET_ALL                   0x02
 
+#define RPC_STATUS_OK				0x00		// Status set by the host MCU (any value except the ones below)
+#define RPC_STATUS_TIMEOUT			0xfe		// Set by the bridge: no response from the host MCU within rpc_timeout
+#define RPC_STATUS_BUSY				0xff		// Set by the bridge: RPC_IN_FLIGHT_MAX requests in flight or Request ID already in flight
+
 #define MAXIMUM_SIZE_EXTENDED_MESSAGE	4800
+#define OUTGOING_MESSAGE_RING_SIZE		8			// App characteristic writes waiting for the UART (credits of the central)
+#define EXT_MESSAGE_RING_SIZE			2			// Extended messages: one received from BLE while the previous one is sent over the UART
+#define NOTIF_FIFO_SIZE					1024		// Must be a power of 2 (app_fifo)
+#define NOTIF_FIFO_XOFF_LEVEL			(NOTIF_FIFO_SIZE / 2)			// Free bytes: room for the app_uart fifo (256) and a frame in flight
+#define NOTIF_FIFO_XON_LEVEL			((NOTIF_FIFO_SIZE * 3) / 4)		// Free bytes
+#define NOTIF_RECORD_MAX_LENGTH			(NRF_SDH_BLE_GATT_MAX_MTU_SIZE - 3 - 2)		// Data of a record (ID - Length - Data) in one ATT payload
+#define RPC_IN_FLIGHT_MAX				16			// Requests waiting for a response of the host MCU
+#define TRANSPARENT_PACKET_SIZE			244			// ATT payload with the maximum MTU (NRF_SDH_BLE_GATT_MAX_MTU_SIZE - 3)
+#define TRANSPARENT_TX_FIFO_SIZE		2048		// Must be a power of 2 (app_fifo)
+#define UART_REPLY_BUFFER_SIZE			16			// ACK / NACK waiting for the transport (4 replies)
+#define CONN_EVENT_LENGTH				320			// gap_conn_cfg.event_length (1.25 ms units), extended up to the interval (BLE_COMMON_OPT_CONN_EVT_EXT)
 
 typedef enum
 {
@@ -54,6 +97,21 @@ typedef union
         unsigned 					transfer_ble_to_uart:1;
         unsigned 					extended_transfer_ble_to_uart:1;
         unsigned 					notification_buffer:1;
+        unsigned 					transfer_channel_to_uart:1;
+        unsigned 					send_channel_flow:1;
+        unsigned 					send_notif_flow:1;
+        unsigned 					send_ext_buffer_status:1;
+        unsigned 					send_ext_nack:1;
+        unsigned 					send_credits:1;
+        unsigned 					send_cache_request:1;
+        unsigned 					send_profiler:1;
+        unsigned 					send_trace:1;
+        unsigned 					send_capture:1;
+        unsigned 					send_capture_notif:1;
+        unsigned 					send_trace_notif:1;
+        unsigned 					send_stats:1;
+        unsigned 					send_benchmark:1;
+        unsigned 					send_link_model:1;
 
         unsigned                    set_conn_params:1;
         unsigned                    set_phy_params:1;
@@ -70,15 +128,22 @@ typedef struct
 	unsigned 						is_init_done:1;
 	unsigned 						is_connected_to_a_central:1;
 	unsigned 						is_in_advertising_mode:1;
-	unsigned 						is_ble_service_has_event:1;
-	unsigned 						is_uart_message_receives:1;
 
 } ble_pickit_status_t;
 
+/*
+ * Records waiting for an app notification: ID_CHAR_BUFFER (1B) - Length (1B) - Data
+ * Without aggregation a notification carries a single record. With aggregation the records are packed
+ * in the same notification (up to the ATT payload) which is sent when it is full, when the oldest
+ * record is older than aggregation_timeout or when an ID_CHAR_BUFFER_FLUSH record is received.
+ */
 typedef struct
 {
-    uint8_t                         data[242];
-    uint8_t                         length;
+	app_fifo_t						fifo;
+	uint8_t							fifo_buffer[NOTIF_FIFO_SIZE];
+	uint64_t						tick;					/**< Reception of the oldest record waiting in the fifo. */
+	bool							is_flush_requested;
+	bool							is_xoff;				// ID_NOTIF_FLOW state reported to the host
 } ble_char_buffer_t;
 
 typedef struct
@@ -86,6 +151,26 @@ typedef struct
     ble_char_buffer_t               buffer;
 } ble_chars_t;
 
+/*
+ * Transparent mode: no framing, no ACK.
+ *  - UART -> BLE: the received bytes are sent as raw app notifications when a notification is full
+ *    or when no byte is received during transparent_timeout.
+ *  - BLE -> UART: the app characteristic writes are forwarded as is.
+ * Exit with the GPIO, the params characteristic or "+++" alone between two silences of 1 s.
+ */
+typedef struct
+{
+	uint8_t							data[TRANSPARENT_PACKET_SIZE];		/**< UART -> BLE: bytes waiting for a notification. */
+	uint16_t						length;
+	uint64_t						tick;								/**< Reception of the last UART byte. */
+	bool							is_escape_guard_ok;					/**< Silence of 1 s before the first byte of the packet. */
+	app_fifo_t						tx_fifo;							/**< BLE -> UART: bytes waiting for the UART. */
+	uint8_t							tx_fifo_buffer[TRANSPARENT_TX_FIFO_SIZE];
+	uint32_t						uart_to_ble_bytes;
+	uint32_t						ble_to_uart_bytes;
+	uint64_t						tick_rate;
+} ble_transparent_t;
+
 typedef struct
 {
 	uint8_t 						id;
@@ -94,6 +179,19 @@ typedef struct
 	uint8_t 						data[242];
 } ble_serial_message_t;
 
+/*
+ * Ring of the app characteristic writes sent over the UART. The central owns one credit per free message: a write
+ * consumes a credit, the bridge notifies the credits on the params characteristic (0x06 - 2 - Credits - Free extended
+ * buffers) on request and each time a message (or an extended message) has been sent over the UART. A write without
+ * credit is dropped and the credits are notified again.
+ */
+typedef struct
+{
+	ble_serial_message_t			message[OUTGOING_MESSAGE_RING_SIZE];
+	uint8_t							drain;					// Message sent over the UART
+	uint8_t							count;					// Messages waiting for (or in) the UART transfer
+} ble_serial_message_ring_t;
+
 typedef struct
 {
 	uint8_t 						id;
@@ -102,14 +200,71 @@ typedef struct
 	uint8_t 						data[MAXIMUM_SIZE_EXTENDED_MESSAGE];
 } ble_serial_extended_message_t;
 
+/*
+ * Reassembly of an extended message: the fragments (ID - Length - Total - Current - Data) are placed at
+ * (Current - 1) * fragment size (all the fragments but the last one have the same size) so that they are received
+ * in any order, the duplicates are ignored and the message is queued once all of them are received (and its CRC
+ * checked for ID_CHAR_EXT_BUFFER_CRC). The missing fragments are reported by ID_CHAR_EXT_BUFFER_NACK when the last
+ * fragment is received and then when the last fragment of the previous report is received. A compressed message
+ * decoded by the bridge needs its fragments in sequence: the ones following a gap are reported missing as well.
+ */
+typedef struct
+{
+	ble_serial_extended_message_t *	p_message;				// NULL: no transfer in progress
+	uint8_t							id;
+	uint8_t							total;
+	uint8_t							received;
+	uint8_t							next;					// Next fragment in sequence (compressed message)
+	uint8_t							nack_last;				// Last fragment reported missing
+	uint8_t							fragment_size;
+	uint8_t							bitmap[32];				// bit (n - 1): fragment n received
+} ble_ext_reassembly_t;
+
+/*
+ * Ring of extended messages: the central fills the next free message while the previous ones are sent over the UART.
+ * When all of them are waiting for the UART, a new transfer is refused (its fragments are dropped) and the central
+ * receives ID_CHAR_EXT_BUFFER_STATUS with 0 free buffer, then again once a buffer is released.
+ */
+typedef struct
+{
+	ble_serial_extended_message_t	message[EXT_MESSAGE_RING_SIZE];
+	uint8_t							drain;					// Message sent over the UART
+	uint8_t							count;					// Complete messages waiting for (or in) the UART transfer
+	bool							is_busy_notified;
+	ble_ext_reassembly_t			rx;
+} ble_serial_extended_ring_t;
+
+/*
+ * RPC: the central may keep up to RPC_IN_FLIGHT_MAX requests in flight (ID_RPC_REQUEST forwarded as is to the host MCU).
+ * The host MCU answers in any order with ID_RPC_RESPONSE, the response is notified to the central as an ID_RPC_RESPONSE
+ * record of the notification fifo. The bridge answers itself RPC_STATUS_TIMEOUT / RPC_STATUS_BUSY (no payload).
+ */
+typedef struct
+{
+	uint8_t							id;						// Request ID chosen by the central
+	bool							is_pending;
+	uint64_t						tick;					// Request received from the central
+} ble_rpc_request_t;
+
+typedef struct
+{
+	ble_rpc_request_t				request[RPC_IN_FLIGHT_MAX];
+	uint8_t							count;
+} ble_rpc_t;
+
 typedef struct
 {
     BLE_UART_MESSAGE_TYPE 			message_type;
+    BLE_UART_MESSAGE_TYPE 			ack_type;							// UART_ACK_MESSAGE / UART_NACK_MESSAGE kept apart from the frames (full duplex)
 	bool 							transmit_in_progress;
 	bool 							receive_in_progress;
 	uint8_t 						buffer[256];
 	uint8_t 						index;
 	uint64_t 						tick;
+	uint8_t 						reply[UART_REPLY_BUFFER_SIZE];		// ACK / NACK queued between the frames (never inside a frame being sent)
+	uint8_t 						reply_length;
+	uint8_t 						reply_index;
+	bool 							is_frame_queuing;					// Frame of vsd_send_request() partially put in the transport
 } ble_uart_t;
 
 typedef struct
@@ -127,6 +282,15 @@ typedef struct
 	ble_pickit_gap_params			current_gap_params;
 	bool							pa_lna_enable;
 	bool							leds_status_enable;
+	bool							ext_lz_uart_enable;		// true: ID_CHAR_EXT_BUFFER_LZ forwarded compressed to the host MCU / false: decompressed by the bridge
+	bool							aggregation_enable;		// true: several ID_CHAR_BUFFER records per notification
+	uint16_t						aggregation_timeout;	// Maximum delay (ms) of a record waiting for the notification to be filled
+	bool							transparent_enable;		// true: raw bytes between the UART and the app characteristic (no framing)
+	uint16_t						transparent_timeout;	// Inter-byte timeout (ms) closing a transparent packet (0: 300 us)
+	bool							uart_full_duplex;		// true: frames delimited by their length, TX and RX independent / false: 300 us idle + 400 us guard
+	bool							notif_flow_enable;		// true: ID_NOTIF_FLOW (XOFF / XON) sent to the host on the notification fifo levels
+	uint16_t						rpc_timeout;			// Maximum delay (ms) of an ID_RPC_REQUEST waiting for its ID_RPC_RESPONSE
+	bool							link_adapt_enable;		// true: PHY, TX power and PA/LNA driven by the link quality (ble_pickit_link_adapt.h)
 } ble_pickit_params;
 
 typedef struct
@@ -141,9 +305,11 @@ typedef struct
 	ble_pickit_params				params;
 	ble_uart_t                      uart;
 	ble_serial_message_t            incoming_uart_message;
-	ble_serial_message_t			outgoing_uart_message;
-	ble_serial_extended_message_t	outgoing_uart_extended_message;
+	ble_serial_message_ring_t		outgoing_uart_ring;
+	ble_serial_extended_ring_t		outgoing_uart_extended_ring;
+	ble_rpc_t						rpc;
 	ble_chars_t						characteristic;
+	ble_transparent_t				transparent;
 	ble_pickit_flags_t        		flags;
 	ble_pickit_status_t				status;
 } ble_pickit_t;
@@ -186,6 +352,15 @@ typedef struct
 	.current_gap_params = {{0}, {0}, {0}, 0, 0},				\
 	.pa_lna_enable = false,										\
 	.leds_status_enable = true,									\
+	.ext_lz_uart_enable = false,								\
+	.aggregation_enable = false,								\
+	.aggregation_timeout = 5,									\
+	.transparent_enable = false,								\
+	.transparent_timeout = 2,									\
+	.uart_full_duplex = false,									\
+	.notif_flow_enable = false,									\
+	.rpc_timeout = 1000,										\
+	.link_adapt_enable = false,									\
 }
 
 #define BLE_DEVICE_INFOS_INSTANCE(_name, _version)       		\
@@ -200,9 +375,11 @@ typedef struct
 	.params = BLE_PICKIT_PARAMS_INSTANCE(),						\
 	.uart = {0},                                        		\
 	.incoming_uart_message = {0},                            	\
-	.outgoing_uart_message = {0},                            	\
-	.outgoing_uart_extended_message = {0},                      \
+	.outgoing_uart_ring = {{{0}}},                            	\
+	.outgoing_uart_extended_ring = {{{0}}},                     \
+	.rpc = {{{0}}},												\
 	.characteristic = {{{0}}},									\
+	.transparent = {{0}},										\
 	.flags = {{0}},                                    			\
 	.status = {0},												\
 }
@@ -214,5 +391,12 @@ typedef void (*p_function)(uint8_t *buffer);
 
 void ble_init(ble_pickit_t * p_vsd_params);
 void ble_stack_tasks();
+void ble_pickit_transparent_set(bool enable);
+void ble_pickit_notif_flow_release(void);
+void ble_pickit_ext_fragment_receive(uint8_t const * buffer, uint16_t length);
+ble_serial_message_t * ble_pickit_outgoing_message_alloc(void);
+void ble_pickit_outgoing_message_commit(void);
+bool ble_pickit_rpc_register(uint8_t request_id);
+void ble_pickit_transparent_write(uint8_t const * p_data, uint16_t length);
 
 #endif
@@ -0,0 +1,106 @@
+#include <string.h>
+#include "host_clock.h"
+#include "app_timer.h"
+#include "fake_uart.h"
+#include "bridge.h"
+
+// The entry point of the firmware is replaced by the steps of bridge_step(), the static functions and variables of
+// main.c are visible to the harness (and to the tests including bridge.c).
+#define main bridge_firmware_main
+#include "../main.c"
+#undef main
+
+static bool m_is_started = false;
+static void (*m_transport_process)(void) = NULL;
+static bridge_hook_t m_hook = NULL;
+static void * mp_hook_context = NULL;
+
+void bridge_init(host_sd_config_t const * p_config)
+{
+	fake_uart_init(FAKE_UART_BAUD_RATE);
+	bridge_init_transport(p_config, fake_uart_transport(), fake_uart_process);
+}
+
+void bridge_init_transport(host_sd_config_t const * p_config, ble_pickit_transport_t const * p_transport, void (*transport_process)(void))
+{
+	host_sd_init(p_config);
+	ble_pickit_transport_set(p_transport);
+	m_transport_process = transport_process;
+	host_clock_sync();
+	m_is_started = false;
+	main_init(false);
+}
+
+void bridge_hook_set(bridge_hook_t hook, void * p_context)
+{
+	m_hook = hook;
+	mp_hook_context = p_context;
+}
+
+void bridge_step(void)
+{
+	host_clock_sync();
+	app_timer_process();
+	host_sd_process();
+	m_transport_process();
+	if (m_hook != NULL)
+	{
+		m_hook(mp_hook_context);
+	}
+	host_clock_sync();
+	if (!m_is_started)
+	{
+		if (main_init_tasks())
+		{
+			main_start();
+			m_is_started = true;
+		}
+	}
+	else
+	{
+		main_tasks();
+	}
+}
+
+void bridge_run_for(uint64_t ns)
+{
+	uint64_t end = host_clock_ns() + ns;
+
+	while (host_clock_ns() < end)
+	{
+		bridge_step();
+		if (host_clock_is_virtual())
+		{
+			host_clock_advance(BRIDGE_STEP_NS);
+		}
+	}
+}
+
+bool bridge_run_until(bool (*condition)(void * p_context), void * p_context, uint64_t timeout_ns)
+{
+	uint64_t end = host_clock_ns() + timeout_ns;
+
+	while (!condition(p_context))
+	{
+		if (host_clock_ns() >= end)
+		{
+			return false;
+		}
+		bridge_step();
+		if (host_clock_is_virtual())
+		{
+			host_clock_advance(BRIDGE_STEP_NS);
+		}
+	}
+	return true;
+}
+
+bool bridge_is_started(void)
+{
+	return m_is_started;
+}
+
+bool bridge_is_connected(void)
+{
+	return ble_pickit.status.is_connected_to_a_central;
+}
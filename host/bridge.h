@@ -0,0 +1,29 @@
+/*
+ * Host build: the firmware of the bridge (main.c and the modules) run one main loop pass at a time on the fake
+ * SoftDevice and the fake UART. bridge_step() stands for the interrupts (app_timer, SoftDevice, UART) followed by one
+ * pass of main(): the 500 ms initialization sequence, main_start() and then the main loop.
+ * The transport is the fake UART (bridge_init) or any other one with its processing (bridge_init_transport).
+ * The firmware keeps its state in static variables: one bridge per process.
+ */
+#ifndef BRIDGE_H
+#define BRIDGE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "softdevice.h"
+#include "ble_pickit_transport.h"
+
+#define BRIDGE_STEP_NS						5000ULL								// Virtual time of a main loop pass
+
+typedef void (*bridge_hook_t)(void * p_context);
+
+void bridge_init(host_sd_config_t const * p_config);
+void bridge_init_transport(host_sd_config_t const * p_config, ble_pickit_transport_t const * p_transport, void (*transport_process)(void));
+void bridge_hook_set(bridge_hook_t hook, void * p_context);
+void bridge_step(void);
+void bridge_run_for(uint64_t ns);
+bool bridge_run_until(bool (*condition)(void * p_context), void * p_context, uint64_t timeout_ns);
+bool bridge_is_started(void);
+bool bridge_is_connected(void);
+
+#endif
@@ -0,0 +1,783 @@
+/*
+ * End-to-end benchmark of the bridge: host MCU emulator (host_mcu.c) on the UART side, scripted central on the fake
+ * SoftDevice on the BLE side, one scenario per run, one JSON line of results on stdout.
+ *
+ *   e2e_bench [options] small-burst | ext-4800 | mixed
+ *
+ * Scenarios:
+ *  - small-burst: frames of --size bytes in both directions, in bursts: the host MCU queues --burst ID_CHAR_BUFFER
+ *    frames (notified on 0x1501), the central writes OUTGOING_MESSAGE_RING_SIZE frames (its credits) on 0x1501,
+ *    the next burst leaves once the previous one is received. --frames frames per direction.
+ *  - ext-4800: --messages extended messages of MAXIMUM_SIZE_EXTENDED_MESSAGE bytes written by the central in
+ *    fragments (ID_CHAR_EXT_BUFFER_NO_CRC) and received by the host MCU in one extended frame (content checked).
+ *  - mixed: during --duration-s, bulk frames of 200 bytes from the host MCU, a small frame written by the central every
+ *    20 ms, a params snapshot requested on 0x1503 every 100 ms (control latency) and the 1 KB throughput test of
+ *    0x1502 launched every second. The frames in flight at the end are waited for (1 s at most).
+ * Options:
+ *  --transport fake|pty     fake UART in virtual time (default, reproducible) or PTY in real time
+ *  --conn-interval-ms N     interval granted by the central (default: as requested by the bridge)
+ *  --hvn-queue N            notifications queued in the SoftDevice (default 8)
+ *  --packets-per-event N    notifications per connection event (default 0: as many as fit)
+ *  --writes-per-event N     writes of the central per connection event (default 6: write commands)
+ *  --nack-every N           the host MCU refuses one frame of the bridge out of N
+ *  --corrupt-every N        the host MCU corrupts the CRC of one frame out of N
+ *  --full-duplex            UART in full duplex (ID_UART_FULL_DUPLEX)
+ *  --capture FILE           capture the frames of the run (params 0x07, ble_pickit_capture.h) and write the dump read
+ *                           by the central to FILE, for the replay tool (replay.c)
+ *  --trace FILE             write the binary trace left at the end of the run (params 0x08, ble_pickit_trace.h) to FILE:
+ *                           the params notifications 0x08 as read by the central, for trace_decode.py
+ * Results: throughput (payload bytes per second) and p50 / p99 latency (us) per direction, first byte queued to last
+ * byte received, UART retransmissions of both sides, NRF_ERROR_RESOURCES of the SoftDevice (hvx_resources: every call,
+ * hvx_refused: STATS_HVX_QUEUE_FULL of the bridge, once per refused notification) and frames lost.
+ */
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "nordic_common.h"
+#include "host_clock.h"
+#include "softdevice.h"
+#include "fake_uart.h"
+#include "pty_uart.h"
+#include "host_mcu.h"
+#include "bridge.h"
+#include "ble_vsd.h"
+#include "ble_pickit_board.h"
+#include "ble_pickit_service.h"
+#include "ble_pickit_stats.h"
+#include "ble_pickit_capture.h"
+
+#define BENCH_SAMPLES_MAX					65536
+#define BENCH_SMALL_SIZE_MAX				(NOTIF_RECORD_MAX_LENGTH)
+#define BENCH_EXT_FRAGMENT_SIZE				240									// ATT payload (244) - ID - Length - Total - Current
+#define BENCH_MIXED_BULK_SIZE				200
+#define BENCH_MIXED_DOWN_PERIOD_NS			20000000ULL
+#define BENCH_MIXED_CONTROL_PERIOD_NS		100000000ULL
+#define BENCH_MIXED_TEST_PERIOD_NS			1000000000ULL
+#define BENCH_SETUP_NS						1000000000ULL
+#define BENCH_CAPTURE_SUB_COMMAND			0x07								// Params characteristic: capture commands
+#define BENCH_TRACE_SUB_COMMAND				0x08								// Params characteristic: trace drain
+#define BENCH_DRAIN_NS						1000000000ULL						// Mixed: frames in flight at the end of the duration
+
+typedef enum
+{
+	SCENARIO_SMALL_BURST,
+	SCENARIO_EXT_4800,
+	SCENARIO_MIXED,
+} scenario_t;
+
+typedef struct
+{
+	scenario_t						scenario;
+	bool							is_pty;
+	bool							is_full_duplex;
+	uint32_t						frames;
+	uint32_t						size;
+	uint32_t						burst;
+	uint32_t						messages;
+	uint32_t						duration_s;
+	uint32_t						timeout_s;
+	uint16_t						nack_every;
+	uint16_t						corrupt_every;
+	char const *					p_capture_path;
+	char const *					p_trace_path;
+	host_sd_config_t				sd_config;
+} bench_options_t;
+
+typedef struct
+{
+	uint32_t						values[BENCH_SAMPLES_MAX];			/**< Latencies (ns). */
+	uint32_t						count;
+} samples_t;
+
+/**@brief One direction of the traffic: the sending time of each sequence number gives the latency on reception.
+ */
+typedef struct
+{
+	uint64_t *						p_sent_ns;
+	bool *							p_is_received;
+	uint32_t						sent;
+	uint32_t						received;
+	uint64_t						bytes;
+	uint32_t						errors;								/**< Wrong content or unknown sequence number. */
+	uint32_t						duplicates;							/**< Received again (retransmission of a frame already received). */
+	samples_t						latency;
+} flow_t;
+
+static bench_options_t m_options =
+{
+	.scenario = SCENARIO_SMALL_BURST,
+	.frames = 512,
+	.size = 20,
+	.burst = 16,
+	.messages = 8,
+	.duration_s = 5,
+	.timeout_s = 120,
+	.sd_config = HOST_SD_CONFIG_DEFAULT,
+};
+
+static host_mcu_t m_mcu;
+static int m_slave_fd = -1;
+static flow_t m_up;														/**< Host MCU -> central */
+static flow_t m_down;													/**< Central -> host MCU */
+static flow_t m_control;												/**< Params snapshot request -> notification */
+static uint32_t m_flow_capacity;
+static uint32_t m_down_in_flight;
+static uint64_t m_start_ns;
+static uint64_t m_end_ns;
+static uint64_t m_next_down_ns;
+static uint64_t m_next_control_ns;
+static uint64_t m_next_test_ns;
+static bool m_is_control_pending;
+static uint32_t m_test_bytes;
+static uint32_t m_ext_nacks;
+static uint32_t m_ext_fragment;											/**< Next fragment of the message being written (0: none). */
+static uint16_t m_app_handle;
+static uint16_t m_test_handle;
+static uint16_t m_params_handle;
+static uint32_t m_setup_frames;
+static FILE * m_dump_file;
+static uint8_t m_dump_sub_command;
+static uint8_t m_dump_header_size;										// Bytes of the notification written before the data (0 or 2)
+static uint32_t m_dump_reads;											// Notifications received
+static uint8_t m_dump_read_length;										// Data of the last one
+
+static uint32_t be32_get(uint8_t const * p_data)
+{
+	return ((uint32_t) p_data[0] << 24) | ((uint32_t) p_data[1] << 16) | ((uint32_t) p_data[2] << 8) | p_data[3];
+}
+
+static void be32_set(uint8_t * p_data, uint32_t value)
+{
+	p_data[0] = value >> 24;
+	p_data[1] = value >> 16;
+	p_data[2] = value >> 8;
+	p_data[3] = value;
+}
+
+static void samples_add(samples_t * p_samples, uint64_t ns)
+{
+	if (p_samples->count < BENCH_SAMPLES_MAX)
+	{
+		p_samples->values[p_samples->count++] = (ns > UINT32_MAX) ? UINT32_MAX : (uint32_t) ns;
+	}
+}
+
+static int samples_compare(void const * p_a, void const * p_b)
+{
+	uint32_t a = *(uint32_t const *) p_a;
+	uint32_t b = *(uint32_t const *) p_b;
+
+	return (a > b) - (a < b);
+}
+
+static double samples_percentile_us(samples_t * p_samples, uint8_t percentile)
+{
+	if (p_samples->count == 0)
+	{
+		return 0;
+	}
+	qsort(p_samples->values, p_samples->count, sizeof(p_samples->values[0]), samples_compare);
+	return p_samples->values[((p_samples->count - 1) * percentile) / 100] / 1000.0;
+}
+
+static void flow_init(flow_t * p_flow)
+{
+	memset(p_flow, 0, sizeof(*p_flow));
+	p_flow->p_sent_ns = calloc(m_flow_capacity, sizeof(uint64_t));
+	p_flow->p_is_received = calloc(m_flow_capacity, sizeof(bool));
+}
+
+static uint32_t flow_send(flow_t * p_flow)
+{
+	p_flow->p_sent_ns[p_flow->sent % m_flow_capacity] = host_clock_ns();
+	p_flow->p_is_received[p_flow->sent % m_flow_capacity] = false;
+	return p_flow->sent++;
+}
+
+/**@return true on the first reception of the sequence number.
+ */
+static bool flow_receive(flow_t * p_flow, uint32_t sequence, uint32_t bytes)
+{
+	if (sequence >= p_flow->sent)
+	{
+		p_flow->errors++;
+		return false;
+	}
+	if (p_flow->p_is_received[sequence % m_flow_capacity])
+	{
+		p_flow->duplicates++;
+		return false;
+	}
+	p_flow->p_is_received[sequence % m_flow_capacity] = true;
+	samples_add(&p_flow->latency, host_clock_ns() - p_flow->p_sent_ns[sequence % m_flow_capacity]);
+	p_flow->received++;
+	p_flow->bytes += bytes;
+	return true;
+}
+
+/* Host MCU side */
+
+static uint32_t mcu_write(uint8_t const * p_data, uint32_t length, void * p_context)
+{
+	uint32_t written = 0;
+	ssize_t count;
+
+	if (!m_options.is_pty)
+	{
+		fake_uart_host_write(p_data, length);
+		return length;
+	}
+	while (written < length)
+	{
+		count = write(m_slave_fd, &p_data[written], length - written);
+		written += (count > 0) ? count : 0;
+	}
+	return written;
+}
+
+static uint32_t mcu_read(uint8_t * p_data, uint32_t length, void * p_context)
+{
+	ssize_t count;
+
+	if (!m_options.is_pty)
+	{
+		return fake_uart_host_read(p_data, length);
+	}
+	pty_uart_process();
+	count = read(m_slave_fd, p_data, length);
+	return (count > 0) ? count : 0;
+}
+
+static void mcu_on_frame(host_mcu_t * p_mcu, uint8_t id, uint8_t const * p_data, uint16_t length, void * p_context)
+{
+	uint32_t sequence;
+	uint16_t i;
+
+	if (m_start_ns == 0)
+	{
+		m_setup_frames++;
+		return;
+	}
+	if ((id == ID_CHAR_BUFFER) && (length >= 4))
+	{
+		if (flow_receive(&m_down, be32_get(p_data), length))
+		{
+			m_down_in_flight--;
+		}
+	}
+	else if ((id == ID_CHAR_EXT_BUFFER_NO_CRC) && (length == MAXIMUM_SIZE_EXTENDED_MESSAGE))
+	{
+		sequence = be32_get(p_data);
+		for (i = 4 ; i < length ; i++)
+		{
+			if (p_data[i] != (uint8_t) (sequence + i))
+			{
+				m_down.errors++;
+				break;
+			}
+		}
+		if (flow_receive(&m_down, sequence, length))
+		{
+			m_down_in_flight--;
+		}
+	}
+}
+
+static void mcu_frame_send(uint8_t id, uint32_t size)
+{
+	uint8_t data[HOST_MCU_FRAME_DATA_MAX];
+	uint32_t sequence = m_up.sent;
+	uint32_t i;
+
+	be32_set(data, sequence);
+	for (i = 4 ; i < size ; i++)
+	{
+		data[i] = (uint8_t) (sequence + i);
+	}
+	if (host_mcu_send(&m_mcu, id, data, size))
+	{
+		(void) flow_send(&m_up);
+	}
+}
+
+/* Central side */
+
+static void central_on_notification(uint16_t handle, uint8_t const * p_data, uint16_t length, void * p_context)
+{
+	uint16_t i = 0;
+
+	if (handle == m_test_handle)
+	{
+		m_test_bytes += length;
+	}
+	else if (handle == m_params_handle)
+	{
+		if ((length >= 2) && (p_data[0] == 0x00) && m_is_control_pending)
+		{
+			m_is_control_pending = false;
+			(void) flow_receive(&m_control, m_control.sent - 1, length);
+		}
+		else if ((length >= 2) && (p_data[0] == m_dump_sub_command) && (m_dump_file != NULL))
+		{
+			// Capture: the records as read, one after the other. Trace: the notifications as read.
+			m_dump_reads++;
+			m_dump_read_length = MIN(p_data[1], length - 2);
+			(void) fwrite(&p_data[2 - m_dump_header_size], 1, m_dump_header_size + m_dump_read_length, m_dump_file);
+		}
+	}
+	else if (handle == m_app_handle)
+	{
+		// Records: ID - Length - Data (several per notification with the aggregation).
+		while ((i + 2) <= length)
+		{
+			uint8_t id = p_data[i];
+			uint8_t record_length = p_data[i + 1];
+
+			if ((i + 2 + record_length) > length)
+			{
+				m_up.errors++;
+				break;
+			}
+			if ((id == ID_CHAR_BUFFER) && (record_length >= 4) && (m_start_ns != 0))
+			{
+				(void) flow_receive(&m_up, be32_get(&p_data[i + 2]), record_length);
+			}
+			else if (id == ID_CHAR_EXT_BUFFER_NACK)
+			{
+				m_ext_nacks++;
+			}
+			i += 2 + record_length;
+		}
+	}
+}
+
+static void central_frame_write(uint32_t size)
+{
+	uint8_t data[BENCH_SMALL_SIZE_MAX + 2];
+	uint32_t sequence = m_down.sent;
+	uint32_t i;
+
+	data[0] = ID_CHAR_BUFFER;
+	data[1] = size;
+	be32_set(&data[2], sequence);
+	for (i = 4 ; i < size ; i++)
+	{
+		data[2 + i] = (uint8_t) (sequence + i);
+	}
+	if (host_sd_write(m_app_handle, data, size + 2))
+	{
+		(void) flow_send(&m_down);
+		m_down_in_flight++;
+	}
+}
+
+/**@brief Function for writing the fragments of the extended messages as the write queue of the SoftDevice frees up.
+ */
+static void central_ext_write(void)
+{
+	uint8_t const total = (MAXIMUM_SIZE_EXTENDED_MESSAGE + BENCH_EXT_FRAGMENT_SIZE - 1) / BENCH_EXT_FRAGMENT_SIZE;
+	uint8_t data[BENCH_EXT_FRAGMENT_SIZE + 4];
+	uint32_t sequence;
+	uint32_t offset;
+	uint32_t length;
+	uint32_t i;
+
+	while (host_sd_write_queue_free() > 0)
+	{
+		if (m_ext_fragment == 0)
+		{
+			if ((m_down.sent >= m_options.messages) || (m_down_in_flight >= EXT_MESSAGE_RING_SIZE))
+			{
+				return;
+			}
+			(void) flow_send(&m_down);
+			m_down_in_flight++;
+			m_ext_fragment = 1;
+		}
+		sequence = m_down.sent - 1;
+		offset = (m_ext_fragment - 1) * BENCH_EXT_FRAGMENT_SIZE;
+		length = MIN(BENCH_EXT_FRAGMENT_SIZE, MAXIMUM_SIZE_EXTENDED_MESSAGE - offset);
+		data[0] = ID_CHAR_EXT_BUFFER_NO_CRC;
+		data[1] = length + 2;
+		data[2] = total;
+		data[3] = m_ext_fragment;
+		for (i = 0 ; i < length ; i++)
+		{
+			data[4 + i] = (uint8_t) (sequence + offset + i);
+		}
+		if (offset == 0)
+		{
+			be32_set(&data[4], sequence);
+		}
+		(void) host_sd_write(m_app_handle, data, length + 4);
+		m_ext_fragment = (m_ext_fragment == total) ? 0 : (m_ext_fragment + 1);
+	}
+}
+
+static void central_on_conn_event(void * p_context)
+{
+	uint64_t now = host_clock_ns();
+	uint8_t command;
+
+	if (m_start_ns == 0)
+	{
+		return;
+	}
+	switch (m_options.scenario)
+	{
+		case SCENARIO_SMALL_BURST:
+			if ((m_down_in_flight == 0) && (m_down.sent < m_options.frames))
+			{
+				while ((m_down_in_flight < OUTGOING_MESSAGE_RING_SIZE) && (m_down.sent < m_options.frames) && (host_sd_write_queue_free() > 0))
+				{
+					central_frame_write(m_options.size);
+				}
+			}
+			break;
+
+		case SCENARIO_EXT_4800:
+			central_ext_write();
+			break;
+
+		case SCENARIO_MIXED:
+			if (now >= m_end_ns)
+			{
+				break;
+			}
+			if ((now >= m_next_down_ns) && (m_down_in_flight < OUTGOING_MESSAGE_RING_SIZE))
+			{
+				central_frame_write(m_options.size);
+				m_next_down_ns = now + BENCH_MIXED_DOWN_PERIOD_NS;
+			}
+			if ((now >= m_next_control_ns) && !m_is_control_pending)
+			{
+				command = 0x00;
+				if (host_sd_write(m_params_handle, &command, 1))
+				{
+					(void) flow_send(&m_control);
+					m_is_control_pending = true;
+					m_next_control_ns = now + BENCH_MIXED_CONTROL_PERIOD_NS;
+				}
+			}
+			if (now >= m_next_test_ns)
+			{
+				command = THROUGHPUT_LAUNCH_TEST_1KB;
+				if (host_sd_write(m_test_handle, &command, 1))
+				{
+					m_next_test_ns = now + BENCH_MIXED_TEST_PERIOD_NS;
+				}
+			}
+			break;
+	}
+}
+
+/* Harness */
+
+static void bench_hook(void * p_context)
+{
+	host_mcu_process(&m_mcu);
+	if (m_start_ns == 0)
+	{
+		return;
+	}
+	switch (m_options.scenario)
+	{
+		case SCENARIO_SMALL_BURST:
+			if ((m_up.sent == m_up.received) && (m_up.sent < m_options.frames))
+			{
+				while ((m_up.sent < m_options.frames) && ((m_up.sent % m_options.burst) != 0 || m_up.sent == m_up.received))
+				{
+					mcu_frame_send(ID_CHAR_BUFFER, m_options.size);
+					if ((m_up.sent % m_options.burst) == 0)
+					{
+						break;
+					}
+				}
+			}
+			break;
+
+		case SCENARIO_MIXED:
+			while ((host_clock_ns() < m_end_ns) && (host_mcu_queue_free(&m_mcu) > (HOST_MCU_QUEUE_SIZE - 4)))
+			{
+				mcu_frame_send(ID_CHAR_BUFFER, BENCH_MIXED_BULK_SIZE);
+			}
+			break;
+
+		default:
+			break;
+	}
+}
+
+static bool is_started(void * p_context)
+{
+	return bridge_is_started() && host_mcu_is_idle(&m_mcu);
+}
+
+static bool is_dump_read(void * p_context)
+{
+	return m_dump_reads != *(uint32_t const *) p_context;
+}
+
+static void capture_command(uint8_t command)
+{
+	uint8_t const data[3] = {BENCH_CAPTURE_SUB_COMMAND, 1, command};
+
+	(void) host_sd_write(m_params_handle, data, sizeof(data));
+}
+
+/**@brief Function for reading a ring of the bridge with the params characteristic until a notification without data
+ *        beyond empty_length bytes. The capture answers each request with one notification (is_request_per_read), the
+ *        trace one request with notifications until its ring is drained.
+ */
+static bool params_dump(char const * p_path, uint8_t const * p_request, uint8_t request_size, bool is_request_per_read,
+						uint8_t header_size, uint8_t empty_length)
+{
+	bool is_request = true;
+	bool is_read = false;
+	uint32_t reads;
+
+	if ((m_dump_file = fopen(p_path, "wb")) == NULL)
+	{
+		return false;
+	}
+	m_dump_sub_command = p_request[0];
+	m_dump_header_size = header_size;
+	do
+	{
+		reads = m_dump_reads;
+		if (is_request)
+		{
+			(void) host_sd_write(m_params_handle, p_request, request_size);
+			is_request = is_request_per_read;
+		}
+		if (!(is_read = bridge_run_until(is_dump_read, &reads, BENCH_SETUP_NS)))
+		{
+			break;
+		}
+	} while (m_dump_read_length > empty_length);
+	fclose(m_dump_file);
+	m_dump_file = NULL;
+	return is_read;
+}
+
+static bool capture_dump(char const * p_path)
+{
+	uint8_t const request[3] = {BENCH_CAPTURE_SUB_COMMAND, 1, CAPTURE_CMD_READ};
+
+	return params_dump(p_path, request, sizeof(request), true, 0, 0);
+}
+
+static bool trace_dump(char const * p_path)
+{
+	uint8_t const request[2] = {BENCH_TRACE_SUB_COMMAND, 0};
+
+	return params_dump(p_path, request, sizeof(request), false, 2, 2);
+}
+
+static bool is_connected(void * p_context)
+{
+	return bridge_is_connected();
+}
+
+static bool is_done(void * p_context)
+{
+	switch (m_options.scenario)
+	{
+		case SCENARIO_SMALL_BURST:
+			return (m_up.received == m_options.frames) && (m_down.received == m_options.frames);
+
+		case SCENARIO_EXT_4800:
+			return m_down.received == m_options.messages;
+
+		default:
+			return	(host_clock_ns() >= (m_end_ns + BENCH_DRAIN_NS)) ||															\
+					((host_clock_ns() >= m_end_ns) && (m_up.received == m_up.sent) && (m_down.received == m_down.sent) && !m_is_control_pending);
+	}
+}
+
+static void flow_print(char const * p_name, flow_t * p_flow, double duration_s)
+{
+	printf("\"%s\":{\"sent\":%u,\"received\":%u,\"bytes\":%llu,\"throughput_bytes_per_s\":%.0f,\"latency_us\":{\"p50\":%.1f,\"p99\":%.1f},\"errors\":%u,\"duplicates\":%u}",
+			p_name, p_flow->sent, p_flow->received, (unsigned long long) p_flow->bytes, (duration_s > 0) ? (p_flow->bytes / duration_s) : 0,
+			samples_percentile_us(&p_flow->latency, 50), samples_percentile_us(&p_flow->latency, 99), p_flow->errors, p_flow->duplicates);
+}
+
+static void results_print(bool is_complete)
+{
+	static char const * const scenario_names[] = {"small-burst", "ext-4800", "mixed"};
+	host_sd_stats_t const * p_sd_stats = host_sd_stats_get();
+	double duration_s = (host_clock_ns() - m_start_ns) / 1e9;
+
+	printf("{\"scenario\":\"%s\",\"transport\":\"%s\",\"uart\":\"%s\",\"complete\":%s,",
+			scenario_names[m_options.scenario], m_options.is_pty ? "pty" : "fake", m_options.is_full_duplex ? "full-duplex" : "half-duplex", is_complete ? "true" : "false");
+	printf("\"config\":{\"conn_interval_ms\":%.2f,\"hvn_queue_size\":%u,\"packets_per_event\":%u,\"writes_per_event\":%u,\"frame_size\":%u},",
+			host_sd_conn_interval() * 1.25, m_options.sd_config.hvn_queue_size, m_options.sd_config.packets_per_event, m_options.sd_config.writes_per_event,
+			(m_options.scenario == SCENARIO_EXT_4800) ? MAXIMUM_SIZE_EXTENDED_MESSAGE : m_options.size);
+	printf("\"duration_s\":%.3f,", duration_s);
+	flow_print("up", &m_up, duration_s);
+	printf(",");
+	flow_print("down", &m_down, duration_s);
+	printf(",");
+	flow_print("control", &m_control, duration_s);
+	printf(",\"test_bytes\":%u,", m_test_bytes);
+	printf("\"retransmissions\":{\"host_to_bridge\":%u,\"bridge_to_host\":%u,\"host_timeouts\":%u,\"nacks_sent\":%u,\"ext_nacks\":%u},",
+			m_mcu.stats.retransmissions, ble_pickit_stats_get(STATS_UART_TX_RETRANSMISSIONS), m_mcu.stats.timeouts, m_mcu.stats.nacks_sent, m_ext_nacks);
+	printf("\"uart_ack_latency_us\":{\"p50\":%.1f,\"p99\":%.1f},", host_mcu_latency_percentile(&m_mcu, 50) / 1000.0, host_mcu_latency_percentile(&m_mcu, 99) / 1000.0);
+	printf("\"ble\":{\"conn_events\":%u,\"notifications\":%u,\"ll_packets\":%u,\"hvx_resources\":%u,\"hvx_refused\":%u,\"writes\":%u},",
+			p_sd_stats->conn_events, p_sd_stats->notifications, p_sd_stats->ll_packets, p_sd_stats->hvx_resources,
+			ble_pickit_stats_get(STATS_HVX_QUEUE_FULL), p_sd_stats->writes);
+	printf("\"lost\":{\"up\":%u,\"down\":%u}}\n", m_up.sent - m_up.received, m_down.sent - m_down.received);
+}
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: e2e_bench [--transport fake|pty] [--conn-interval-ms N] [--hvn-queue N] [--packets-per-event N]\n"
+					"                 [--writes-per-event N] [--frames N] [--size N] [--burst N] [--messages N] [--duration-s N]\n"
+					"                 [--timeout-s N] [--nack-every N] [--corrupt-every N] [--full-duplex] [--capture FILE]\n"
+					"                 [--trace FILE]\n"
+					"                 small-burst | ext-4800 | mixed\n");
+	exit(EXIT_FAILURE);
+}
+
+static void options_parse(int argc, char ** argv)
+{
+	int i;
+
+	m_options.sd_config.writes_per_event = 6;
+	for (i = 1 ; i < argc ; i++)
+	{
+		char const * p_value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+		if (strcmp(argv[i], "--full-duplex") == 0)
+		{
+			m_options.is_full_duplex = true;
+			continue;
+		}
+		if (strncmp(argv[i], "--", 2) != 0)
+		{
+			if (strcmp(argv[i], "small-burst") == 0)			m_options.scenario = SCENARIO_SMALL_BURST;
+			else if (strcmp(argv[i], "ext-4800") == 0)		m_options.scenario = SCENARIO_EXT_4800;
+			else if (strcmp(argv[i], "mixed") == 0)			m_options.scenario = SCENARIO_MIXED;
+			else usage();
+			continue;
+		}
+		if (p_value == NULL)
+		{
+			usage();
+		}
+		i++;
+		if (strcmp(argv[i - 1], "--transport") == 0)				m_options.is_pty = (strcmp(p_value, "pty") == 0);
+		else if (strcmp(argv[i - 1], "--conn-interval-ms") == 0)	m_options.sd_config.conn_interval = (uint16_t) ((atof(p_value) / 1.25) + 0.5);
+		else if (strcmp(argv[i - 1], "--hvn-queue") == 0)			m_options.sd_config.hvn_queue_size = atoi(p_value);
+		else if (strcmp(argv[i - 1], "--packets-per-event") == 0)	m_options.sd_config.packets_per_event = atoi(p_value);
+		else if (strcmp(argv[i - 1], "--writes-per-event") == 0)	m_options.sd_config.writes_per_event = atoi(p_value);
+		else if (strcmp(argv[i - 1], "--frames") == 0)				m_options.frames = atoi(p_value);
+		else if (strcmp(argv[i - 1], "--size") == 0)				m_options.size = atoi(p_value);
+		else if (strcmp(argv[i - 1], "--burst") == 0)				m_options.burst = atoi(p_value);
+		else if (strcmp(argv[i - 1], "--messages") == 0)			m_options.messages = atoi(p_value);
+		else if (strcmp(argv[i - 1], "--duration-s") == 0)			m_options.duration_s = atoi(p_value);
+		else if (strcmp(argv[i - 1], "--timeout-s") == 0)			m_options.timeout_s = atoi(p_value);
+		else if (strcmp(argv[i - 1], "--nack-every") == 0)			m_options.nack_every = atoi(p_value);
+		else if (strcmp(argv[i - 1], "--corrupt-every") == 0)		m_options.corrupt_every = atoi(p_value);
+		else if (strcmp(argv[i - 1], "--capture") == 0)			m_options.p_capture_path = p_value;
+		else if (strcmp(argv[i - 1], "--trace") == 0)				m_options.p_trace_path = p_value;
+		else usage();
+	}
+	if (	(m_options.size < 4) || (m_options.size > BENCH_SMALL_SIZE_MAX) || (m_options.burst == 0) ||		\
+			(m_options.sd_config.hvn_queue_size == 0) || (m_options.sd_config.hvn_queue_size > HOST_SD_HVN_QUEUE_MAX))
+	{
+		usage();
+	}
+}
+
+int main(int argc, char ** argv)
+{
+	host_sd_central_t central = {.on_notification = central_on_notification, .on_conn_event = central_on_conn_event};
+	host_mcu_init_t mcu_init = {.write = mcu_write, .read = mcu_read, .on_frame = mcu_on_frame, .baud_rate = FAKE_UART_BAUD_RATE};
+	uint8_t const full_duplex = 1;
+	bool is_complete;
+
+	options_parse(argc, argv);
+	m_flow_capacity = MAX(MAX(m_options.frames, m_options.messages), BENCH_SAMPLES_MAX);
+	flow_init(&m_up);
+	flow_init(&m_down);
+	flow_init(&m_control);
+
+	if (m_options.is_pty)
+	{
+		if (!pty_uart_init(FAKE_UART_BAUD_RATE) || ((m_slave_fd = open(pty_uart_slave_name(), O_RDWR | O_NOCTTY | O_NONBLOCK)) < 0))
+		{
+			fprintf(stderr, "e2e_bench: pseudo-terminal not available\n");
+			return EXIT_FAILURE;
+		}
+		bridge_init_transport(&m_options.sd_config, pty_uart_transport(), pty_uart_process);
+	}
+	else
+	{
+		host_clock_virtual_set(true);
+		bridge_init(&m_options.sd_config);
+	}
+	host_mcu_init(&m_mcu, &mcu_init);
+	bridge_hook_set(bench_hook, NULL);
+	host_sd_central_set(&central);
+
+	// Setup: boot frame, connection, notifications enabled and link updated.
+	if (!bridge_run_until(is_started, NULL, BENCH_SETUP_NS * 5))
+	{
+		fprintf(stderr, "e2e_bench: the bridge did not start\n");
+		return EXIT_FAILURE;
+	}
+	if (m_options.is_full_duplex)
+	{
+		(void) host_mcu_send(&m_mcu, ID_UART_FULL_DUPLEX, &full_duplex, 1);
+		(void) bridge_run_until(is_started, NULL, BENCH_SETUP_NS);
+		m_mcu.init.is_full_duplex = true;
+	}
+	host_sd_connect();
+	if (!bridge_run_until(is_connected, NULL, BENCH_SETUP_NS))
+	{
+		fprintf(stderr, "e2e_bench: no connection\n");
+		return EXIT_FAILURE;
+	}
+	m_app_handle = host_sd_value_handle(MESSAGE_APP_CHAR_UUID);
+	m_test_handle = host_sd_value_handle(MESSAGE_TEST_UUID);
+	m_params_handle = host_sd_value_handle(MESSAGE_PARAMS_UUID);
+	(void) host_sd_notification_enable(MESSAGE_APP_CHAR_UUID, true);
+	(void) host_sd_notification_enable(MESSAGE_PARAMS_UUID, true);
+	(void) host_sd_notification_enable(MESSAGE_TEST_UUID, true);
+	bridge_run_for(BENCH_SETUP_NS);
+	if (m_options.p_capture_path != NULL)
+	{
+		capture_command(CAPTURE_CMD_START);
+		bridge_run_for(BENCH_SETUP_NS / 10);
+	}
+
+	// Measure.
+	m_mcu.init.nack_every = m_options.nack_every;
+	m_mcu.init.corrupt_every = m_options.corrupt_every;
+	memset(&m_mcu.stats, 0, sizeof(m_mcu.stats));
+	m_mcu.latency_count = 0;
+	ble_pickit_stats_reset();
+	m_start_ns = host_clock_ns();
+	m_end_ns = m_start_ns + m_options.duration_s * 1000000000ULL;
+	m_next_down_ns = m_start_ns;
+	m_next_control_ns = m_start_ns;
+	m_next_test_ns = m_start_ns;
+	is_complete = bridge_run_until(is_done, NULL, m_options.timeout_s * 1000000000ULL);
+	results_print(is_complete);
+	if ((m_options.p_capture_path != NULL) && !capture_dump(m_options.p_capture_path))
+	{
+		fprintf(stderr, "e2e_bench: capture not read\n");
+		return EXIT_FAILURE;
+	}
+	if ((m_options.p_trace_path != NULL) && !trace_dump(m_options.p_trace_path))
+	{
+		fprintf(stderr, "e2e_bench: trace not read\n");
+		return EXIT_FAILURE;
+	}
+
+	return is_complete ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,183 @@
+#include <string.h>
+#include "sdk_common.h"
+#include "app_uart.h"
+#include "app_fifo.h"
+#include "host_clock.h"
+#include "fake_uart.h"
+
+typedef struct
+{
+	uint8_t							bytes[FAKE_UART_LINE_SIZE];
+	uint64_t						ready_ns[FAKE_UART_LINE_SIZE];		/**< End of the stop bit of each byte. */
+	uint32_t						read;
+	uint32_t						write;
+	uint64_t						busy_until_ns;
+} line_t;
+
+static line_t m_tx_line;
+static line_t m_rx_line;
+static app_fifo_t m_rx_fifo;
+static uint8_t m_rx_fifo_buffer[FAKE_UART_FIFO_SIZE];
+static uint64_t m_byte_ns;
+static bool m_is_tx_pending;
+static fake_uart_stats_t m_stats;
+
+static uint32_t fake_put(uint8_t byte);
+static uint32_t fake_get(uint8_t * p_byte);
+
+static ble_pickit_transport_t const m_transport =
+{
+	.put = fake_put,
+	.get = fake_get,
+	.tasks = NULL,
+};
+
+static void line_reset(line_t * p_line)
+{
+	p_line->read = 0;
+	p_line->write = 0;
+	p_line->busy_until_ns = 0;
+}
+
+static bool line_push(line_t * p_line, uint8_t byte)
+{
+	uint64_t now = host_clock_ns();
+
+	if ((p_line->write - p_line->read) >= FAKE_UART_LINE_SIZE)
+	{
+		return false;
+	}
+	p_line->busy_until_ns = MAX(p_line->busy_until_ns, now) + m_byte_ns;
+	p_line->bytes[p_line->write % FAKE_UART_LINE_SIZE] = byte;
+	p_line->ready_ns[p_line->write % FAKE_UART_LINE_SIZE] = p_line->busy_until_ns;
+	p_line->write++;
+	return true;
+}
+
+static bool line_pop(line_t * p_line, uint8_t * p_byte)
+{
+	if ((p_line->read == p_line->write) || (p_line->ready_ns[p_line->read % FAKE_UART_LINE_SIZE] > host_clock_ns()))
+	{
+		return false;
+	}
+	*p_byte = p_line->bytes[p_line->read % FAKE_UART_LINE_SIZE];
+	p_line->read++;
+	return true;
+}
+
+/**@brief Bytes of the bridge not sent yet (the app_uart TX fifo): the ones after the byte being sent.
+ */
+static uint32_t tx_fifo_length(void)
+{
+	uint64_t now = host_clock_ns();
+	uint32_t count = 0;
+	uint32_t i;
+
+	for (i = m_tx_line.write ; (i != m_tx_line.read) && (m_tx_line.ready_ns[(i - 1) % FAKE_UART_LINE_SIZE] > (now + m_byte_ns)) ; i--)
+	{
+		count++;
+	}
+	return count;
+}
+
+static void rx_receive(void)
+{
+	uint8_t byte;
+
+	while (line_pop(&m_rx_line, &byte))
+	{
+		if (app_fifo_put(&m_rx_fifo, byte) != NRF_SUCCESS)
+		{
+			m_stats.rx_overflows++;
+			host_app_uart_evt(APP_UART_FIFO_ERROR);
+		}
+	}
+}
+
+static uint32_t fake_put(uint8_t byte)
+{
+	host_clock_sync();
+	if (tx_fifo_length() >= FAKE_UART_FIFO_SIZE)
+	{
+		return NRF_ERROR_NO_MEM;
+	}
+	if (!line_push(&m_tx_line, byte))
+	{
+		return NRF_ERROR_NO_MEM;
+	}
+	m_is_tx_pending = true;
+	m_stats.tx_bytes++;
+	return NRF_SUCCESS;
+}
+
+static uint32_t fake_get(uint8_t * p_byte)
+{
+	host_clock_sync();
+	rx_receive();
+	if (app_fifo_get(&m_rx_fifo, p_byte) != NRF_SUCCESS)
+	{
+		return NRF_ERROR_NOT_FOUND;
+	}
+	m_stats.rx_bytes++;
+	return NRF_SUCCESS;
+}
+
+void fake_uart_init(uint32_t baud_rate)
+{
+	line_reset(&m_tx_line);
+	line_reset(&m_rx_line);
+	(void) app_fifo_init(&m_rx_fifo, m_rx_fifo_buffer, sizeof(m_rx_fifo_buffer));
+	m_byte_ns = (10ULL * 1000000000ULL) / baud_rate;
+	m_is_tx_pending = false;
+	memset(&m_stats, 0, sizeof(m_stats));
+}
+
+ble_pickit_transport_t const * fake_uart_transport(void)
+{
+	return &m_transport;
+}
+
+void fake_uart_process(void)
+{
+	host_clock_sync();
+	rx_receive();
+	if (m_is_tx_pending && (m_tx_line.busy_until_ns <= host_clock_ns()))
+	{
+		m_is_tx_pending = false;
+		m_stats.tx_empty_events++;
+		host_app_uart_evt(APP_UART_TX_EMPTY);
+	}
+}
+
+bool fake_uart_is_idle(void)
+{
+	uint64_t now = host_clock_ns();
+
+	return !m_is_tx_pending && (m_tx_line.busy_until_ns <= now) && (m_rx_line.busy_until_ns <= now);
+}
+
+fake_uart_stats_t const * fake_uart_stats_get(void)
+{
+	return &m_stats;
+}
+
+void fake_uart_host_write(uint8_t const * p_data, uint32_t length)
+{
+	uint32_t i;
+
+	for (i = 0 ; i < length ; i++)
+	{
+		(void) line_push(&m_rx_line, p_data[i]);
+	}
+}
+
+uint32_t fake_uart_host_read(uint8_t * p_data, uint32_t length)
+{
+	uint32_t count = 0;
+
+	while ((count < length) && line_pop(&m_tx_line, &p_data[count]))
+	{
+		count++;
+	}
+	return count;
+}
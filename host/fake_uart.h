@@ -0,0 +1,39 @@
+/*
+ * Host build: transport fake (ble_pickit_transport_t) standing for app_uart on a 1 Mbaud line (8N1: 10 bits per
+ * byte). The bytes are carried by two timed queues:
+ *  - bridge -> host MCU: ble_pickit_transport_put() queues the byte behind the ones still on the line, NRF_ERROR_NO_MEM
+ *    when FAKE_UART_FIFO_SIZE bytes wait (app_uart TX fifo), the caller retries on a next pass of the main loop.
+ *  - host MCU -> bridge: fake_uart_host_write() queues the bytes at the line rate, fake_uart_process() moves the
+ *    received ones to the RX fifo (FAKE_UART_FIFO_SIZE bytes, APP_UART_FIFO_ERROR and byte lost when full).
+ * fake_uart_process() (harness, like the UART interrupt) also reports APP_UART_TX_EMPTY to the app_uart event handler
+ * once the last queued byte is sent.
+ */
+#ifndef FAKE_UART_H
+#define FAKE_UART_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ble_pickit_transport.h"
+
+#define FAKE_UART_BAUD_RATE					1000000
+#define FAKE_UART_FIFO_SIZE					256
+#define FAKE_UART_LINE_SIZE					65536								// Bytes in flight on the line (power of 2)
+
+typedef struct
+{
+	uint32_t						tx_bytes;							/**< Bytes sent by the bridge. */
+	uint32_t						rx_bytes;							/**< Bytes received by the bridge. */
+	uint32_t						rx_overflows;						/**< Bytes lost (RX fifo full). */
+	uint32_t						tx_empty_events;
+} fake_uart_stats_t;
+
+void fake_uart_init(uint32_t baud_rate);
+ble_pickit_transport_t const * fake_uart_transport(void);
+void fake_uart_process(void);
+bool fake_uart_is_idle(void);
+fake_uart_stats_t const * fake_uart_stats_get(void);
+
+void fake_uart_host_write(uint8_t const * p_data, uint32_t length);
+uint32_t fake_uart_host_read(uint8_t * p_data, uint32_t length);
+
+#endif
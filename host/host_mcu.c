@@ -0,0 +1,316 @@
+#include <stdlib.h>
+#include <string.h>
+#include "host_clock.h"
+#include "host_mcu.h"
+
+#define ID_CHAR_EXT_BUFFER_NO_CRC			0x41
+#define ID_CHAR_EXT_BUFFER_LZ				0x42
+#define ID_CHAR_EXT_BUFFER_CRC				0x44
+
+/**@brief Reference CRC (bitwise CRC-16/ARC: polynomial 0x8005 reflected, initial value 0), independent of the table
+ *        of the firmware.
+ */
+uint16_t host_mcu_crc16(uint8_t const * p_data, uint32_t length)
+{
+	uint16_t crc = 0;
+	uint8_t bit;
+
+	while (length--)
+	{
+		crc ^= *p_data++;
+		for (bit = 0 ; bit < 8 ; bit++)
+		{
+			crc = (crc & 1) ? ((crc >> 1) ^ 0xA001) : (crc >> 1);
+		}
+	}
+	return crc;
+}
+
+static bool is_extended(uint8_t id)
+{
+	return (id == ID_CHAR_EXT_BUFFER_NO_CRC) || (id == ID_CHAR_EXT_BUFFER_LZ) || (id == ID_CHAR_EXT_BUFFER_CRC);
+}
+
+static bool line_is_free(host_mcu_t const * p_mcu)
+{
+	uint64_t gap = p_mcu->init.is_full_duplex ? 0 : HOST_MCU_GAP_NS;
+
+	return host_clock_ns() >= (p_mcu->line_free_ns + gap);
+}
+
+static void line_write(host_mcu_t * p_mcu, uint8_t const * p_data, uint32_t length)
+{
+	uint64_t now = host_clock_ns();
+
+	(void) p_mcu->init.write(p_data, length, p_mcu->init.p_context);
+	p_mcu->line_free_ns = ((p_mcu->line_free_ns > now) ? p_mcu->line_free_ns : now) + length * p_mcu->byte_ns;
+}
+
+static void frame_transmit(host_mcu_t * p_mcu)
+{
+	host_mcu_frame_t const * p_frame = &p_mcu->queue[p_mcu->queue_read % HOST_MCU_QUEUE_SIZE];
+	uint8_t buffer[HOST_MCU_FRAME_DATA_MAX + 5];
+	uint16_t crc;
+
+	buffer[0] = p_frame->id;
+	buffer[1] = 'W';
+	buffer[2] = p_frame->length;
+	memcpy(&buffer[3], p_frame->data, p_frame->length);
+	crc = host_mcu_crc16(buffer, p_frame->length + 3);
+	p_mcu->stats.transmissions++;
+	if ((p_mcu->init.corrupt_every > 0) && ((p_mcu->stats.transmissions % p_mcu->init.corrupt_every) == 0))
+	{
+		crc ^= 0x5a5a;
+	}
+	buffer[p_frame->length + 3] = crc >> 8;
+	buffer[p_frame->length + 4] = crc & 0xff;
+	line_write(p_mcu, buffer, p_frame->length + 5);
+	p_mcu->sent_ns = p_mcu->line_free_ns;
+	p_mcu->is_in_flight = true;
+	p_mcu->is_retransmit_requested = false;
+}
+
+static void ack_receive(host_mcu_t * p_mcu, bool is_ack)
+{
+	host_mcu_frame_t const * p_frame = &p_mcu->queue[p_mcu->queue_read % HOST_MCU_QUEUE_SIZE];
+
+	if (!p_mcu->is_in_flight)
+	{
+		return;
+	}
+	if (is_ack)
+	{
+		if (p_mcu->latency_count < HOST_MCU_LATENCY_SAMPLES)
+		{
+			p_mcu->latency_ns[p_mcu->latency_count++] = (uint32_t) (host_clock_ns() - p_frame->queued_ns);
+		}
+		p_mcu->stats.frames_acked++;
+		p_mcu->stats.bytes_acked += p_frame->length;
+		p_mcu->queue_read++;
+		p_mcu->is_in_flight = false;
+	}
+	else
+	{
+		p_mcu->stats.nacks_received++;
+		p_mcu->is_retransmit_requested = true;
+	}
+}
+
+static void frame_receive(host_mcu_t * p_mcu, uint8_t const * p_frame, uint16_t data_offset, uint16_t length, bool is_checked)
+{
+	bool is_good = true;
+
+	if (is_checked)
+	{
+		uint16_t crc = (p_frame[length + 3] << 8) | p_frame[length + 4];
+
+		is_good = (host_mcu_crc16(p_frame, length + 3) == crc);
+		if (is_good && (p_mcu->init.nack_every > 0) && ((++p_mcu->good_frames % p_mcu->init.nack_every) == 0))
+		{
+			// Fault injection: the frame is refused, the bridge sends it again.
+			p_mcu->pending_ack = 'N';
+			return;
+		}
+		p_mcu->pending_ack = is_good ? 'A' : 'N';
+	}
+	if (!is_good)
+	{
+		p_mcu->stats.crc_errors++;
+		return;
+	}
+	if (is_checked)
+	{
+		p_mcu->stats.frames_received++;
+	}
+	else
+	{
+		p_mcu->stats.ext_frames_received++;
+	}
+	p_mcu->stats.bytes_received += length;
+	if (p_mcu->init.on_frame != NULL)
+	{
+		p_mcu->init.on_frame(p_mcu, p_frame[0], &p_frame[data_offset], length, p_mcu->init.p_context);
+	}
+}
+
+/**@brief Function for parsing the bytes of the bridge (frames, ACK, NACK), resynchronized on the next byte when the
+ *        first ones do not start a message.
+ */
+static void rx_parse(host_mcu_t * p_mcu, uint8_t byte)
+{
+	uint8_t * p_buffer = p_mcu->rx_buffer;
+
+	p_buffer[p_mcu->rx_index++] = byte;
+	if (p_mcu->rx_index < 2)
+	{
+		return;
+	}
+	if ((p_buffer[0] == 'A') && (p_buffer[1] == 'C'))
+	{
+		if (p_mcu->rx_index == 3)
+		{
+			p_mcu->rx_index = 0;
+			if (byte == 'K')
+			{
+				ack_receive(p_mcu, true);
+			}
+		}
+	}
+	else if ((p_buffer[0] == 'N') && (p_buffer[1] == 'A'))
+	{
+		if (p_mcu->rx_index == 4)
+		{
+			p_mcu->rx_index = 0;
+			if ((p_buffer[2] == 'C') && (byte == 'K'))
+			{
+				ack_receive(p_mcu, false);
+			}
+		}
+	}
+	else if ((p_buffer[1] == 'N') && is_extended(p_buffer[0]))
+	{
+		if (p_mcu->rx_index >= 4)
+		{
+			uint16_t length = p_buffer[2] | (p_buffer[3] << 8);
+
+			if ((length + 5) > HOST_MCU_RX_BUFFER_SIZE)
+			{
+				p_mcu->rx_index = 0;
+			}
+			else if (p_mcu->rx_index == (uint32_t) (length + 5))
+			{
+				p_mcu->rx_index = 0;
+				frame_receive(p_mcu, p_buffer, 4, length, false);
+			}
+		}
+	}
+	else if (p_buffer[1] == 'N')
+	{
+		if ((p_mcu->rx_index >= 3) && (p_mcu->rx_index == (uint32_t) (p_buffer[2] + 5)))
+		{
+			p_mcu->rx_index = 0;
+			frame_receive(p_mcu, p_buffer, 3, p_buffer[2], true);
+		}
+	}
+	else
+	{
+		p_buffer[0] = p_buffer[1];
+		p_mcu->rx_index = 1;
+	}
+}
+
+void host_mcu_init(host_mcu_t * p_mcu, host_mcu_init_t const * p_init)
+{
+	memset(p_mcu, 0, sizeof(*p_mcu));
+	p_mcu->init = *p_init;
+	if (p_mcu->init.baud_rate == 0)
+	{
+		p_mcu->init.baud_rate = 1000000;
+	}
+	p_mcu->byte_ns = (10ULL * 1000000000ULL) / p_mcu->init.baud_rate;
+}
+
+bool host_mcu_send(host_mcu_t * p_mcu, uint8_t id, uint8_t const * p_data, uint8_t length)
+{
+	host_mcu_frame_t * p_frame;
+
+	if ((host_mcu_queue_free(p_mcu) == 0) || (length > HOST_MCU_FRAME_DATA_MAX))
+	{
+		return false;
+	}
+	p_frame = &p_mcu->queue[p_mcu->queue_write % HOST_MCU_QUEUE_SIZE];
+	p_frame->id = id;
+	p_frame->length = length;
+	memcpy(p_frame->data, p_data, length);
+	p_frame->queued_ns = host_clock_ns();
+	p_mcu->queue_write++;
+	return true;
+}
+
+uint32_t host_mcu_queue_free(host_mcu_t const * p_mcu)
+{
+	return HOST_MCU_QUEUE_SIZE - (p_mcu->queue_write - p_mcu->queue_read);
+}
+
+void host_mcu_process(host_mcu_t * p_mcu)
+{
+	uint8_t bytes[64];
+	uint32_t count;
+	uint32_t i;
+
+	while ((count = p_mcu->init.read(bytes, sizeof(bytes), p_mcu->init.p_context)) > 0)
+	{
+		for (i = 0 ; i < count ; i++)
+		{
+			rx_parse(p_mcu, bytes[i]);
+		}
+		if (!p_mcu->init.is_full_duplex && (p_mcu->line_free_ns < host_clock_ns()))
+		{
+			// Half duplex: the gap also follows the last byte of the bridge.
+			p_mcu->line_free_ns = host_clock_ns();
+		}
+	}
+
+	if (!line_is_free(p_mcu))
+	{
+		return;
+	}
+	if (p_mcu->pending_ack != 0)
+	{
+		if (p_mcu->pending_ack == 'A')
+		{
+			line_write(p_mcu, (uint8_t const *) "ACK", 3);
+			p_mcu->stats.acks_sent++;
+		}
+		else
+		{
+			line_write(p_mcu, (uint8_t const *) "NACK", 4);
+			p_mcu->stats.nacks_sent++;
+		}
+		p_mcu->pending_ack = 0;
+		return;
+	}
+	if (p_mcu->is_in_flight)
+	{
+		if (!p_mcu->is_retransmit_requested && ((host_clock_ns() - p_mcu->sent_ns) >= HOST_MCU_ACK_TIMEOUT_NS))
+		{
+			p_mcu->stats.timeouts++;
+			p_mcu->is_retransmit_requested = true;
+		}
+		if (p_mcu->is_retransmit_requested)
+		{
+			p_mcu->stats.retransmissions++;
+			frame_transmit(p_mcu);
+		}
+	}
+	else if (p_mcu->queue_read != p_mcu->queue_write)
+	{
+		frame_transmit(p_mcu);
+	}
+}
+
+bool host_mcu_is_idle(host_mcu_t const * p_mcu)
+{
+	return !p_mcu->is_in_flight && (p_mcu->queue_read == p_mcu->queue_write) && (p_mcu->pending_ack == 0) && (p_mcu->rx_index == 0);
+}
+
+static int latency_compare(void const * p_a, void const * p_b)
+{
+	uint32_t a = *(uint32_t const *) p_a;
+	uint32_t b = *(uint32_t const *) p_b;
+
+	return (a > b) - (a < b);
+}
+
+uint32_t host_mcu_latency_percentile(host_mcu_t * p_mcu, uint8_t percentile)
+{
+	uint32_t index;
+
+	if (p_mcu->latency_count == 0)
+	{
+		return 0;
+	}
+	qsort(p_mcu->latency_ns, p_mcu->latency_count, sizeof(p_mcu->latency_ns[0]), latency_compare);
+	index = ((p_mcu->latency_count - 1) * percentile) / 100;
+	return p_mcu->latency_ns[index];
+}
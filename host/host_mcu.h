@@ -0,0 +1,96 @@
+/*
+ * Host build: host MCU side of the UART protocol of ble_vsd.c, used by the tests (in-process, on the fake UART) and
+ * by the end-to-end benchmark (host/e2e_bench.c, on the fake UART or through a PTY).
+ *  - Frames to the bridge: ID - 'W' - Length - Data - CRC16 (MSB first, CRC-16/ARC of ID..Data), one frame in flight:
+ *    sent again on NACK or when no ACK comes within HOST_MCU_ACK_TIMEOUT_NS.
+ *  - Frames from the bridge: ID - 'N' - Length - Data - CRC16 answered by "ACK" / "NACK", extended frames
+ *    (ID_CHAR_EXT_BUFFER_xxx) ID - 'N' - Length (2B, LSB first) - Data - 1 byte, not acknowledged.
+ *  - Half duplex (default protocol of the bridge): the bridge delimits the frames by a silence of 300 us, the
+ *    transmissions of the host MCU (frames, ACK, NACK) start HOST_MCU_GAP_NS after the last byte on the line (sent or
+ *    received). Full duplex: back to back.
+ * Fault injection: NACK one good frame of the bridge out of nack_every, corrupt the CRC of one frame out of
+ * corrupt_every. The ACK latency of each frame (queued to ACK received) is sampled for the percentiles.
+ */
+#ifndef HOST_MCU_H
+#define HOST_MCU_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define HOST_MCU_QUEUE_SIZE					64
+#define HOST_MCU_FRAME_DATA_MAX				251									// Receive buffer of the bridge: 256 bytes
+#define HOST_MCU_RX_BUFFER_SIZE				(4800 + 8)
+#define HOST_MCU_ACK_TIMEOUT_NS				20000000ULL
+#define HOST_MCU_GAP_NS						500000ULL
+#define HOST_MCU_LATENCY_SAMPLES			8192
+
+typedef struct host_mcu_s host_mcu_t;
+
+typedef struct
+{
+	uint32_t (*write)(uint8_t const * p_data, uint32_t length, void * p_context);
+	uint32_t (*read)(uint8_t * p_data, uint32_t length, void * p_context);
+	void (*on_frame)(host_mcu_t * p_mcu, uint8_t id, uint8_t const * p_data, uint16_t length, void * p_context);
+	void * p_context;
+	uint32_t						baud_rate;
+	bool							is_full_duplex;
+	uint16_t						nack_every;
+	uint16_t						corrupt_every;
+} host_mcu_init_t;
+
+typedef struct
+{
+	uint32_t						frames_acked;						/**< Frames sent and acknowledged. */
+	uint32_t						transmissions;						/**< Frames put on the line (retransmissions included). */
+	uint32_t						retransmissions;
+	uint32_t						nacks_received;
+	uint32_t						timeouts;
+	uint32_t						frames_received;					/**< Frames of the bridge with a good CRC. */
+	uint32_t						ext_frames_received;
+	uint32_t						crc_errors;
+	uint32_t						acks_sent;
+	uint32_t						nacks_sent;
+	uint64_t						bytes_received;						/**< Data of the frames of the bridge. */
+	uint64_t						bytes_acked;						/**< Data of the frames acknowledged by the bridge. */
+} host_mcu_stats_t;
+
+typedef struct
+{
+	uint8_t							id;
+	uint8_t							length;
+	uint8_t							data[HOST_MCU_FRAME_DATA_MAX];
+	uint64_t						queued_ns;
+} host_mcu_frame_t;
+
+struct host_mcu_s
+{
+	host_mcu_init_t					init;
+	uint64_t						byte_ns;
+	uint64_t						line_free_ns;						/**< End of the last byte written. */
+
+	host_mcu_frame_t				queue[HOST_MCU_QUEUE_SIZE];
+	uint32_t						queue_read;
+	uint32_t						queue_write;
+	bool							is_in_flight;
+	bool							is_retransmit_requested;
+	uint64_t						sent_ns;
+	uint8_t							pending_ack;						/**< 0, 'A' (ACK) or 'N' (NACK) to send. */
+	uint32_t						good_frames;						/**< Frames of the bridge with a good CRC (NACKed included). */
+
+	uint8_t							rx_buffer[HOST_MCU_RX_BUFFER_SIZE];
+	uint32_t						rx_index;
+
+	host_mcu_stats_t				stats;
+	uint32_t						latency_ns[HOST_MCU_LATENCY_SAMPLES];
+	uint32_t						latency_count;
+};
+
+uint16_t host_mcu_crc16(uint8_t const * p_data, uint32_t length);
+void host_mcu_init(host_mcu_t * p_mcu, host_mcu_init_t const * p_init);
+bool host_mcu_send(host_mcu_t * p_mcu, uint8_t id, uint8_t const * p_data, uint8_t length);
+uint32_t host_mcu_queue_free(host_mcu_t const * p_mcu);
+void host_mcu_process(host_mcu_t * p_mcu);
+bool host_mcu_is_idle(host_mcu_t const * p_mcu);
+uint32_t host_mcu_latency_percentile(host_mcu_t * p_mcu, uint8_t percentile);
+
+#endif
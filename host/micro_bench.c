@@ -0,0 +1,328 @@
+/*
+ * Micro benchmarks of the hot functions of the bridge on the host, next to the cycle counts of ID_BENCHMARK on the
+ * target (ble_pickit_benchmark.c). ble_vsd.c is compiled in this file to reach its static frame builders; the bridge
+ * is first connected on the fake SoftDevice (notifications enabled) and then left still while the kernels run.
+ *
+ *   micro_bench [--repetitions N]
+ *
+ * Kernels:
+ *  - crc16_4, crc16_258: fu_crc_16_ibm on a control frame and on a full UART frame.
+ *  - rx_frame_pass: ble_stack_tasks() pass classifying a received 'W' frame (CRC, ACK queued and sent, dispatch of an
+ *    unused ID), the copy of the frame in the receive buffer included. rx_idle_pass: the same pass without frame.
+ *  - ble_params, transfer_ble_to_uart: frame builders of ID_GET_BLE_PARAMS and of an app characteristic write (242 bytes).
+ *  - notif_buffer: aggregation of 11 records of 20 bytes in one notification (records peeked, not consumed).
+ *  - app_notification_send: ble_pickit_app_notification_send(_notif_buffer) on the hvx sink of the fake SoftDevice.
+ *  - ext_reassembly: the 20 fragments of a 4800 bytes extended message (ble_pickit_ext_fragment_receive), released.
+ * Each repetition times a batch of calls (grown until it lasts BENCH_SAMPLE_MIN_NS) on CLOCK_MONOTONIC. One JSON line
+ * per kernel: min / median / mean / standard deviation of the ns per call over the repetitions and the median in ns
+ * per byte. The min is the cost without preemption of the host.
+ */
+#include "../ble_vsd.c"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "host_clock.h"
+#include "softdevice.h"
+#include "fake_uart.h"
+#include "host_mcu.h"
+#include "bridge.h"
+
+#define BENCH_REPETITIONS					31
+#define BENCH_REPETITIONS_MAX				1001
+#define BENCH_SAMPLE_MIN_NS					200000ULL
+#define BENCH_RX_BATCH						32									// ACK of the batch in the UART fifo (3 bytes each)
+#define BENCH_SETUP_NS						1000000000ULL
+#define BENCH_RECORD_SIZE					20
+#define BENCH_RECORD_COUNT					11
+#define BENCH_EXT_FRAGMENT_SIZE				240
+#define BENCH_EXT_FRAGMENT_COUNT			(MAXIMUM_SIZE_EXTENDED_MESSAGE / BENCH_EXT_FRAGMENT_SIZE)
+#define BENCH_UNUSED_ID						0xfe
+
+typedef struct
+{
+	char const *					p_name;
+	uint32_t						bytes;								/**< Bytes per call (ns per byte), 0: ns per call only. */
+	uint32_t						batch;								/**< Calls per repetition (0: calibrated). */
+	void (*prepare)(void);												/**< Before each batch, not timed (NULL: none). */
+	void (*run)(void);
+} bench_kernel_t;
+
+static host_mcu_t m_mcu;
+static uint32_t m_repetitions = BENCH_REPETITIONS;
+static uint8_t m_frame[256 + 5];
+static uint8_t m_rx_frame[sizeof(((ble_uart_t *) 0)->buffer)];
+static uint16_t m_rx_frame_length;
+static uint8_t m_fragments[BENCH_EXT_FRAGMENT_COUNT][BENCH_EXT_FRAGMENT_SIZE + 4];
+static volatile uint32_t m_sink;
+
+static uint32_t mcu_write(uint8_t const * p_data, uint32_t length, void * p_context)
+{
+	fake_uart_host_write(p_data, length);
+	return length;
+}
+
+static uint32_t mcu_read(uint8_t * p_data, uint32_t length, void * p_context)
+{
+	return fake_uart_host_read(p_data, length);
+}
+
+static void bench_hook(void * p_context)
+{
+	host_mcu_process(&m_mcu);
+}
+
+static bool is_started(void * p_context)
+{
+	return bridge_is_started() && host_mcu_is_idle(&m_mcu);
+}
+
+static bool is_connected(void * p_context)
+{
+	return bridge_is_connected();
+}
+
+/* Kernels */
+
+static void crc16_4_run(void)
+{
+	m_sink += fu_crc_16_ibm(m_frame, 4);
+}
+
+static void crc16_258_run(void)
+{
+	m_sink += fu_crc_16_ibm(m_frame, 258);
+}
+
+/**@brief Function for running the bridge until the ACK of the previous batch are sent (UART events handled, not timed).
+ */
+static void rx_prepare(void)
+{
+	bridge_run_for(BENCH_RX_BATCH * 4 * 10 * 1000ULL);
+}
+
+static void rx_frame_run(void)
+{
+	memcpy(p_vsd->uart.buffer, m_rx_frame, m_rx_frame_length);
+	p_vsd->uart.index = m_rx_frame_length;
+	p_vsd->uart.tick = mGetTick() - TICK_300US;
+	ble_stack_tasks();
+}
+
+static void rx_idle_run(void)
+{
+	ble_stack_tasks();
+}
+
+static void ble_params_run(void)
+{
+	_ble_params(m_frame);
+}
+
+static void transfer_ble_to_uart_run(void)
+{
+	_transfer_ble_to_uart(m_frame);
+}
+
+/**@brief Function for queuing the records aggregated by _notif_buffer (sent meanwhile if the bridge ran).
+ */
+static void notif_prepare(void)
+{
+	uint8_t i;
+
+	(void) app_fifo_flush(&p_vsd->characteristic.buffer.fifo);
+	for (i = 0 ; i < BENCH_RECORD_COUNT ; i++)
+	{
+		(void) _notif_buffer_append(ID_CHAR_BUFFER, m_frame, BENCH_RECORD_SIZE, false);
+	}
+}
+
+static void notif_buffer_run(void)
+{
+	m_sink += _notif_buffer(m_frame);
+}
+
+static void app_notification_send_run(void)
+{
+	m_sink += ble_pickit_app_notification_send(_notif_buffer);
+}
+
+static void ext_reassembly_run(void)
+{
+	uint8_t i;
+
+	for (i = 0 ; i < BENCH_EXT_FRAGMENT_COUNT ; i++)
+	{
+		ble_pickit_ext_fragment_receive(m_fragments[i], sizeof(m_fragments[i]));
+	}
+	_ext_message_release();
+}
+
+/* Harness */
+
+static void inputs_init(void)
+{
+	ble_serial_message_t * p_message = &p_vsd->outgoing_uart_ring.message[p_vsd->outgoing_uart_ring.drain];
+	uint16_t crc;
+	uint32_t i;
+
+	for (i = 0 ; i < sizeof(m_frame) ; i++)
+	{
+		m_frame[i] = (uint8_t) (i * 7);
+	}
+
+	// Frame of the host MCU: ID - 'W' - Length - Data - CRC16.
+	m_rx_frame[0] = BENCH_UNUSED_ID;
+	m_rx_frame[1] = 'W';
+	m_rx_frame[2] = 20;
+	memcpy(&m_rx_frame[3], m_frame, m_rx_frame[2]);
+	crc = fu_crc_16_ibm(m_rx_frame, m_rx_frame[2] + 3);
+	m_rx_frame[m_rx_frame[2] + 3] = crc >> 8;
+	m_rx_frame[m_rx_frame[2] + 4] = crc & 0xff;
+	m_rx_frame_length = m_rx_frame[2] + 5;
+
+	p_message->id = ID_CHAR_BUFFER;
+	p_message->type = 'N';
+	p_message->length = sizeof(p_message->data);
+	memcpy(p_message->data, m_frame, sizeof(p_message->data));
+
+	// Fragments: ID - Length - Total - Current - Data.
+	for (i = 0 ; i < BENCH_EXT_FRAGMENT_COUNT ; i++)
+	{
+		m_fragments[i][0] = ID_CHAR_EXT_BUFFER_NO_CRC;
+		m_fragments[i][1] = BENCH_EXT_FRAGMENT_SIZE + 2;
+		m_fragments[i][2] = BENCH_EXT_FRAGMENT_COUNT;
+		m_fragments[i][3] = i + 1;
+		memset(&m_fragments[i][4], i, BENCH_EXT_FRAGMENT_SIZE);
+	}
+}
+
+static int sample_compare(void const * p_a, void const * p_b)
+{
+	double a = *(double const *) p_a;
+	double b = *(double const *) p_b;
+
+	return (a > b) - (a < b);
+}
+
+static void kernel_measure(bench_kernel_t const * p_kernel)
+{
+	static double samples[BENCH_REPETITIONS_MAX];
+	uint32_t batch = p_kernel->batch;
+	double mean = 0;
+	double variance = 0;
+	uint64_t start;
+	uint32_t repetition;
+	uint32_t i;
+
+	// Calibration (and warm-up): the batch grows until it lasts BENCH_SAMPLE_MIN_NS.
+	for (batch = (batch == 0) ? 1 : batch ; ; batch *= 2)
+	{
+		if (p_kernel->prepare != NULL)
+		{
+			p_kernel->prepare();
+		}
+		start = host_clock_real_ns();
+		for (i = 0 ; i < batch ; i++)
+		{
+			p_kernel->run();
+		}
+		if ((p_kernel->batch != 0) || ((host_clock_real_ns() - start) >= BENCH_SAMPLE_MIN_NS))
+		{
+			break;
+		}
+	}
+
+	for (repetition = 0 ; repetition < m_repetitions ; repetition++)
+	{
+		if (p_kernel->prepare != NULL)
+		{
+			p_kernel->prepare();
+		}
+		start = host_clock_real_ns();
+		for (i = 0 ; i < batch ; i++)
+		{
+			p_kernel->run();
+		}
+		samples[repetition] = (double) (host_clock_real_ns() - start) / batch;
+		mean += samples[repetition];
+	}
+	mean /= m_repetitions;
+	for (repetition = 0 ; repetition < m_repetitions ; repetition++)
+	{
+		variance += (samples[repetition] - mean) * (samples[repetition] - mean);
+	}
+	qsort(samples, m_repetitions, sizeof(samples[0]), sample_compare);
+
+	printf("{\"kernel\":\"%s\",\"bytes\":%u,\"batch\":%u,\"repetitions\":%u,\"ns_per_call\":{\"min\":%.1f,\"median\":%.1f,\"mean\":%.1f,\"stddev\":%.1f}",
+			p_kernel->p_name, p_kernel->bytes, batch, m_repetitions, samples[0], samples[m_repetitions / 2], mean, sqrt(variance / m_repetitions));
+	if (p_kernel->bytes > 0)
+	{
+		printf(",\"ns_per_byte\":%.3f", samples[m_repetitions / 2] / p_kernel->bytes);
+	}
+	printf("}\n");
+}
+
+int main(int argc, char ** argv)
+{
+	host_sd_config_t sd_config = HOST_SD_CONFIG_DEFAULT;
+	host_mcu_init_t mcu_init = {.write = mcu_write, .read = mcu_read, .baud_rate = FAKE_UART_BAUD_RATE};
+	uint8_t params_length;
+	uint8_t i;
+
+	if ((argc == 3) && (strcmp(argv[1], "--repetitions") == 0))
+	{
+		m_repetitions = atoi(argv[2]);
+	}
+	if ((argc != 1) && ((argc != 3) || (m_repetitions == 0) || (m_repetitions > BENCH_REPETITIONS_MAX)))
+	{
+		fprintf(stderr, "usage: micro_bench [--repetitions N (1 to %u)]\n", BENCH_REPETITIONS_MAX);
+		return EXIT_FAILURE;
+	}
+
+	// Bridge connected, notifications of the app characteristic enabled.
+	host_clock_virtual_set(true);
+	bridge_init(&sd_config);
+	host_mcu_init(&m_mcu, &mcu_init);
+	bridge_hook_set(bench_hook, NULL);
+	if (!bridge_run_until(is_started, NULL, BENCH_SETUP_NS * 5))
+	{
+		fprintf(stderr, "micro_bench: the bridge did not start\n");
+		return EXIT_FAILURE;
+	}
+	host_sd_connect();
+	if (!bridge_run_until(is_connected, NULL, BENCH_SETUP_NS))
+	{
+		fprintf(stderr, "micro_bench: no connection\n");
+		return EXIT_FAILURE;
+	}
+	(void) host_sd_notification_enable(MESSAGE_APP_CHAR_UUID, true);
+	bridge_run_for(BENCH_SETUP_NS);
+	host_sd_hvx_sink_set(true);
+	inputs_init();
+
+	_ble_params(m_frame);
+	params_length = m_frame[2] + 5;
+	{
+		bench_kernel_t const kernels[] =
+		{
+			{"crc16_4",					4,									0,					NULL,			crc16_4_run},
+			{"crc16_258",				258,								0,					NULL,			crc16_258_run},
+			{"rx_frame_pass",			m_rx_frame_length,					BENCH_RX_BATCH,		rx_prepare,		rx_frame_run},
+			{"rx_idle_pass",			0,									BENCH_RX_BATCH,		rx_prepare,		rx_idle_run},
+			{"ble_params",				params_length,						0,					NULL,			ble_params_run},
+			{"transfer_ble_to_uart",	sizeof(((ble_serial_message_t *) 0)->data) + 5,	0,	NULL,			transfer_ble_to_uart_run},
+			{"notif_buffer",			BENCH_RECORD_COUNT * (BENCH_RECORD_SIZE + 2),	0,	notif_prepare,	notif_buffer_run},
+			{"app_notification_send",	BENCH_RECORD_COUNT * (BENCH_RECORD_SIZE + 2),	0,	notif_prepare,	app_notification_send_run},
+			{"ext_reassembly",			MAXIMUM_SIZE_EXTENDED_MESSAGE,		0,					NULL,			ext_reassembly_run},
+		};
+
+		for (i = 0 ; i < ARRAY_SIZE(kernels) ; i++)
+		{
+			kernel_measure(&kernels[i]);
+		}
+	}
+	host_sd_hvx_sink_set(false);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,156 @@
+#define _GNU_SOURCE
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include "sdk_common.h"
+#include "app_uart.h"
+#include "app_fifo.h"
+#include "host_clock.h"
+#include "pty_uart.h"
+
+static int m_master_fd = -1;
+static char m_slave_name[64];
+static app_fifo_t m_tx_fifo;
+static uint8_t m_tx_fifo_buffer[PTY_UART_FIFO_SIZE];
+static app_fifo_t m_rx_fifo;
+static uint8_t m_rx_fifo_buffer[PTY_UART_FIFO_SIZE];
+static uint64_t m_byte_ns;
+static uint64_t m_line_ns;												/**< End of the last byte written on the line. */
+static bool m_is_tx_pending;
+static pty_uart_stats_t m_stats;
+
+static uint32_t pty_put(uint8_t byte);
+static uint32_t pty_get(uint8_t * p_byte);
+
+static ble_pickit_transport_t const m_transport =
+{
+	.put = pty_put,
+	.get = pty_get,
+	.tasks = NULL,
+};
+
+static uint32_t pty_put(uint8_t byte)
+{
+	if (app_fifo_put(&m_tx_fifo, byte) != NRF_SUCCESS)
+	{
+		return NRF_ERROR_NO_MEM;
+	}
+	m_is_tx_pending = true;
+	return NRF_SUCCESS;
+}
+
+static uint32_t pty_get(uint8_t * p_byte)
+{
+	pty_uart_process();
+	if (app_fifo_get(&m_rx_fifo, p_byte) != NRF_SUCCESS)
+	{
+		return NRF_ERROR_NOT_FOUND;
+	}
+	m_stats.rx_bytes++;
+	return NRF_SUCCESS;
+}
+
+bool pty_uart_init(uint32_t baud_rate)
+{
+	struct termios attributes;
+	int slave_fd;
+
+	m_master_fd = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+	if ((m_master_fd < 0) || (grantpt(m_master_fd) != 0) || (unlockpt(m_master_fd) != 0) || (ptsname_r(m_master_fd, m_slave_name, sizeof(m_slave_name)) != 0))
+	{
+		return false;
+	}
+
+	// Raw mode (no echo, no line discipline): set on the slave, shared by both sides.
+	slave_fd = open(m_slave_name, O_RDWR | O_NOCTTY);
+	if ((slave_fd < 0) || (tcgetattr(slave_fd, &attributes) != 0))
+	{
+		return false;
+	}
+	cfmakeraw(&attributes);
+	(void) tcsetattr(slave_fd, TCSANOW, &attributes);
+	(void) close(slave_fd);
+
+	(void) app_fifo_init(&m_tx_fifo, m_tx_fifo_buffer, sizeof(m_tx_fifo_buffer));
+	(void) app_fifo_init(&m_rx_fifo, m_rx_fifo_buffer, sizeof(m_rx_fifo_buffer));
+	m_byte_ns = (10ULL * 1000000000ULL) / baud_rate;
+	m_line_ns = 0;
+	m_is_tx_pending = false;
+	memset(&m_stats, 0, sizeof(m_stats));
+	return true;
+}
+
+char const * pty_uart_slave_name(void)
+{
+	return m_slave_name;
+}
+
+ble_pickit_transport_t const * pty_uart_transport(void)
+{
+	return &m_transport;
+}
+
+/**@brief Function for moving the bytes between the fifos and the PTY (harness, like the UART interrupt).
+ */
+void pty_uart_process(void)
+{
+	uint64_t now = host_clock_ns();
+	uint32_t space;
+	uint8_t bytes[PTY_UART_FIFO_SIZE];
+	uint32_t count = 0;
+	ssize_t length;
+
+	// TX: the bytes whose line time has come.
+	if (m_line_ns < now)
+	{
+		m_line_ns = MAX(m_line_ns, now - m_byte_ns);
+	}
+	while ((m_line_ns + m_byte_ns <= now) && (app_fifo_peek(&m_tx_fifo, 0, &bytes[count]) == NRF_SUCCESS))
+	{
+		(void) app_fifo_get(&m_tx_fifo, &bytes[count]);
+		count++;
+		m_line_ns += m_byte_ns;
+	}
+	if (count > 0)
+	{
+		uint32_t written = 0;
+
+		while (written < count)
+		{
+			length = write(m_master_fd, &bytes[written], count - written);
+			if ((length < 0) && (errno != EAGAIN) && (errno != EINTR))
+			{
+				break;
+			}
+			written += (length > 0) ? length : 0;
+		}
+		m_stats.tx_bytes += count;
+	}
+	if (m_is_tx_pending && (app_fifo_peek(&m_tx_fifo, 0, &bytes[0]) != NRF_SUCCESS) && (m_line_ns <= now))
+	{
+		m_is_tx_pending = false;
+		m_stats.tx_empty_events++;
+		host_app_uart_evt(APP_UART_TX_EMPTY);
+	}
+
+	// RX: as many bytes as the fifo can hold, the others wait in the PTY.
+	space = 0;
+	(void) app_fifo_write(&m_rx_fifo, NULL, &space);
+	if (space > 0)
+	{
+		length = read(m_master_fd, bytes, MIN(space, sizeof(bytes)));
+		if (length > 0)
+		{
+			count = length;
+			(void) app_fifo_write(&m_rx_fifo, bytes, &count);
+		}
+	}
+}
+
+pty_uart_stats_t const * pty_uart_stats_get(void)
+{
+	return &m_stats;
+}
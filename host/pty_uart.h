@@ -0,0 +1,30 @@
+/*
+ * Host build: transport (ble_pickit_transport_t) on a pseudo-terminal, in real time. The bridge owns the master side,
+ * the host MCU (host_mcu.c in the same process, or any program opening pty_uart_slave_name()) the slave side, both in
+ * raw mode. The bytes of the bridge leave at the line rate (FAKE_UART_BAUD_RATE, 10 bits per byte) from a TX fifo of
+ * PTY_UART_FIFO_SIZE bytes (NRF_ERROR_NO_MEM when full) and APP_UART_TX_EMPTY is reported once the last one is sent.
+ * The received bytes wait in the PTY (flow control) until the RX fifo has room.
+ */
+#ifndef PTY_UART_H
+#define PTY_UART_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ble_pickit_transport.h"
+
+#define PTY_UART_FIFO_SIZE					256
+
+typedef struct
+{
+	uint32_t						tx_bytes;
+	uint32_t						rx_bytes;
+	uint32_t						tx_empty_events;
+} pty_uart_stats_t;
+
+bool pty_uart_init(uint32_t baud_rate);
+char const * pty_uart_slave_name(void);
+ble_pickit_transport_t const * pty_uart_transport(void);
+void pty_uart_process(void);
+pty_uart_stats_t const * pty_uart_stats_get(void);
+
+#endif
@@ -0,0 +1,457 @@
+/*
+ * Replay of a frame capture (ble_pickit_capture.h) on the host build of the bridge.
+ *
+ *   replay [--speed X] [--no-cccd] [--tolerance N] FILE
+ *
+ * Dump format (FILE): the records of the capture as read from the bridge, one after the other, without any header:
+ * ID_CAPTURE frames (UART, Data of each frame) or params notifications 0x07 - Length - Records (BLE, Records of each
+ * notification), up to the first empty read. Record (big endian):
+ *
+ *   Timestamp (4B) | Source (1B) | Tag (2B) | Length (2B) | Data (MIN(Length, CAPTURE_DATA_MAX) bytes)
+ *
+ *  - Timestamp: RTC ticks (1/32768 s) of the 24 bits counter, wrapping every 512 s (unwrapped record to record).
+ *  - Source: capture_source_t. Tag: attribute handle of the GATT sources (handles of the firmware: the fake SoftDevice
+ *    assigns the same ones), 0 for the UART.
+ *  - Length: length of the frame. A record with Length > CAPTURE_DATA_MAX is truncated.
+ * e2e_bench --capture FILE writes such a dump from the host build.
+ *
+ * The inputs of the capture are re-injected at their time (scaled by 1 / --speed, virtual time): the bytes of the host
+ * MCU (CAPTURE_SOURCE_UART_RX: frames, ACK, NACK) into the fake UART read by ble_stack_tasks(), the writes of the central
+ * (CAPTURE_SOURCE_GATT_WRITE) into the fake SoftDevice, up to on_service_event_handler(). Truncated inputs are skipped,
+ * as well as the capture commands written by the central (params 0x07: the read of the dump would read the capture of
+ * the replay).
+ * The UART records are taken when the frame is classified (300 us of silence after its last byte): the bytes are sent
+ * that long before. The writes are delivered on the connection events: the events of the replay are aligned on the
+ * first captured write and each write is queued half an interval before its event (all the writes of an event go).
+ * The bridge is started and connected first (boot frame acknowledged), the notifications of 0x1501 - 0x1503 enabled
+ * unless --no-cccd (the capture then has to hold the CCCD writes).
+ * The outputs of the replay (CAPTURE_SOURCE_UART_TX, CAPTURE_SOURCE_GATT_NOTIFICATION) are captured again and matched
+ * in order, stream by stream (source and tag), with the captured ones (data): longest common subsequence of the two
+ * streams, an output missing on one side does not shift the match of the next ones.
+ * A capture of a whole run (started with the bridge idle) is replayed exactly. A capture which is the tail of the ring
+ * (the run overflowed it) lacks the inputs older than its first record: their outputs and the state they left
+ * (credits, frames waiting for their ACK) are not replayed, the captured outputs they explain are tolerated with
+ * --tolerance N (default 0). Above --speed 1, the UART line (1 Mbaud) and the connection events keep their timing: the
+ * accelerated replay is a stress of the bridge (frames closer than their transmission time, more writes per event), its
+ * outputs differ.
+ * One JSON line of results; exit status 1 if the file is not a capture, 2 if more than --tolerance outputs are not
+ * matched (captured outputs missing from the replay and outputs of the replay missing from the capture).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "nordic_common.h"
+#include "host_clock.h"
+#include "softdevice.h"
+#include "fake_uart.h"
+#include "host_mcu.h"
+#include "bridge.h"
+#include "ble_vsd.h"
+#include "ble_pickit_board.h"
+#include "ble_pickit_service.h"
+#include "ble_pickit_capture.h"
+
+#define REPLAY_FILE_MAX						(1024 * 1024)
+#define REPLAY_RECORD_MAX					16384
+#define REPLAY_SETUP_NS						1000000000ULL
+#define REPLAY_END_NS						1000000000ULL						// Outputs of the last inputs
+#define REPLAY_TICK_MASK					0x00ffffff
+#define REPLAY_UART_SILENCE_NS				((TICK_300US * 1000000000ULL) / HOST_CLOCK_RTC_FREQUENCY)
+#define REPLAY_DRAIN_PERIOD_NS				5000000ULL							// Capture of the replay read before the ring is full
+#define REPLAY_CAPTURE_SUB_COMMAND			0x07								// Params characteristic: capture commands
+
+typedef struct
+{
+	uint64_t						time_ns;							/**< Since the first record. */
+	uint8_t							source;
+	uint16_t						tag;
+	uint16_t						length;
+	uint8_t const *					p_data;								/**< MIN(length, CAPTURE_DATA_MAX) bytes. */
+} record_t;
+
+typedef struct
+{
+	record_t *						p_records;
+	uint32_t						count;
+} record_list_t;
+
+static host_mcu_t m_mcu;
+static bool m_is_replaying;
+static uint8_t m_replay_dump[REPLAY_FILE_MAX];
+static uint32_t m_replay_size;
+static uint64_t m_drain_ns;
+
+/**@brief Function for parsing a dump (records one after the other).
+ *
+ * @return false if the last record is incomplete or if a source is unknown.
+ */
+static bool records_parse(uint8_t const * p_data, uint32_t size, record_list_t * p_list)
+{
+	uint32_t timestamp_last = 0;
+	uint64_t ticks = 0;
+	uint32_t offset = 0;
+
+	p_list->count = 0;
+	while (offset < size)
+	{
+		record_t * p_record = &p_list->p_records[p_list->count];
+		uint32_t timestamp;
+
+		if (((offset + CAPTURE_HEADER_SIZE) > size) || (p_list->count >= REPLAY_RECORD_MAX))
+		{
+			return false;
+		}
+		timestamp = ((uint32_t) p_data[offset] << 24) | (p_data[offset + 1] << 16) | (p_data[offset + 2] << 8) | p_data[offset + 3];
+		p_record->source = p_data[offset + 4];
+		p_record->tag = (p_data[offset + 5] << 8) | p_data[offset + 6];
+		p_record->length = (p_data[offset + 7] << 8) | p_data[offset + 8];
+		p_record->p_data = &p_data[offset + CAPTURE_HEADER_SIZE];
+		offset += CAPTURE_HEADER_SIZE + MIN(p_record->length, CAPTURE_DATA_MAX);
+		if ((offset > size) || (p_record->source > CAPTURE_SOURCE_GATT_NOTIFICATION))
+		{
+			return false;
+		}
+
+		if (p_list->count == 0)
+		{
+			timestamp_last = timestamp;
+		}
+		ticks += (timestamp - timestamp_last) & REPLAY_TICK_MASK;
+		timestamp_last = timestamp;
+		p_record->time_ns = (ticks * 1000000000ULL) / HOST_CLOCK_RTC_FREQUENCY;
+		p_list->count++;
+	}
+	return true;
+}
+
+/**@brief Function for getting the time of the injection of an input, before its capture.
+ */
+static uint64_t record_lead_ns(record_t const * p_record)
+{
+	if (p_record->source == CAPTURE_SOURCE_UART_RX)
+	{
+		return REPLAY_UART_SILENCE_NS + (p_record->length * 10ULL * 1000000000ULL) / FAKE_UART_BAUD_RATE;
+	}
+	return (host_sd_conn_interval() * 1250000ULL) / 2;
+}
+
+/**@brief Function for getting the start of the replay: the connection events fall on the captured writes.
+ */
+static uint64_t replay_start_ns(record_list_t const * p_captured, double speed)
+{
+	uint64_t interval_ns = host_sd_conn_interval() * 1250000ULL;
+	uint64_t event_ns = host_sd_next_event_ns();
+	uint64_t write_ns;
+	uint32_t i;
+
+	for (i = 0 ; (i < p_captured->count) && (p_captured->p_records[i].source != CAPTURE_SOURCE_GATT_WRITE) ; i++);
+	if ((i == p_captured->count) || (interval_ns == 0))
+	{
+		return host_clock_ns() + REPLAY_UART_SILENCE_NS + interval_ns;
+	}
+	write_ns = (uint64_t) (p_captured->p_records[i].time_ns / speed);
+	while (event_ns < (host_clock_ns() + write_ns + interval_ns))
+	{
+		event_ns += interval_ns;
+	}
+	return event_ns - write_ns;
+}
+
+static bool is_output(record_t const * p_record)
+{
+	return (p_record->source == CAPTURE_SOURCE_UART_TX) || (p_record->source == CAPTURE_SOURCE_GATT_NOTIFICATION);
+}
+
+static bool is_same_stream(record_t const * p_a, record_t const * p_b)
+{
+	return is_output(p_a) && is_output(p_b) && (p_a->source == p_b->source) && (p_a->tag == p_b->tag);
+}
+
+static bool records_are_equal(record_t const * p_a, record_t const * p_b)
+{
+	return	is_same_stream(p_a, p_b) && (p_a->length == p_b->length) &&										\
+			(memcmp(p_a->p_data, p_b->p_data, MIN(p_a->length, CAPTURE_DATA_MAX)) == 0);
+}
+
+/**@brief Function for matching the outputs of one stream: length of the longest common subsequence of the captured
+ *        and replayed outputs of the stream of p_first (two rows of the dynamic programming table).
+ */
+static uint32_t stream_match(record_list_t const * p_captured, record_list_t const * p_replayed, record_t const * p_first)
+{
+	uint32_t * p_previous = calloc(p_replayed->count + 1, sizeof(uint32_t));
+	uint32_t * p_current = calloc(p_replayed->count + 1, sizeof(uint32_t));
+	uint32_t * p_swap;
+	uint32_t matched;
+	uint32_t i, j;
+
+	for (i = 0 ; i < p_captured->count ; i++)
+	{
+		record_t const * p_record = &p_captured->p_records[i];
+
+		if (!is_same_stream(p_record, p_first))
+		{
+			continue;
+		}
+		for (j = 0 ; j < p_replayed->count ; j++)
+		{
+			if (!is_same_stream(&p_replayed->p_records[j], p_first))
+			{
+				p_current[j + 1] = p_current[j];
+			}
+			else if (records_are_equal(p_record, &p_replayed->p_records[j]))
+			{
+				p_current[j + 1] = p_previous[j] + 1;
+			}
+			else
+			{
+				p_current[j + 1] = MAX(p_previous[j + 1], p_current[j]);
+			}
+		}
+		p_swap = p_previous;
+		p_previous = p_current;
+		p_current = p_swap;
+	}
+	matched = p_previous[p_replayed->count];
+	free(p_previous);
+	free(p_current);
+	return matched;
+}
+
+/**@brief Function for counting the captured outputs found again, in the same order, in the outputs of the replay.
+ * The order is kept per stream (source and tag): the UART and the notifications of the different characteristics
+ * interleave differently with the timing of the replay.
+ */
+static uint32_t outputs_match(record_list_t const * p_captured, record_list_t const * p_replayed)
+{
+	uint32_t matched = 0;
+	uint32_t i, j;
+
+	for (i = 0 ; i < p_captured->count ; i++)
+	{
+		record_t const * p_record = &p_captured->p_records[i];
+
+		// First output of its stream.
+		for (j = 0 ; (j < i) && !is_same_stream(&p_captured->p_records[j], p_record) ; j++);
+		if (is_output(p_record) && (j == i))
+		{
+			matched += stream_match(p_captured, p_replayed, p_record);
+		}
+	}
+	return matched;
+}
+
+static uint32_t outputs_count(record_list_t const * p_list)
+{
+	uint32_t count = 0;
+	uint32_t i;
+
+	for (i = 0 ; i < p_list->count ; i++)
+	{
+		count += is_output(&p_list->p_records[i]) ? 1 : 0;
+	}
+	return count;
+}
+
+static uint32_t mcu_write(uint8_t const * p_data, uint32_t length, void * p_context)
+{
+	fake_uart_host_write(p_data, length);
+	return length;
+}
+
+static uint32_t mcu_read(uint8_t * p_data, uint32_t length, void * p_context)
+{
+	return fake_uart_host_read(p_data, length);
+}
+
+/**@brief Function for reading the capture of the replay (the read stops the capture, started again once empty).
+ */
+static void replay_capture_drain(void)
+{
+	uint8_t length;
+
+	while (	((m_replay_size + CAPTURE_READ_SIZE) <= sizeof(m_replay_dump)) &&											\
+			((length = ble_pickit_capture_encode(&m_replay_dump[m_replay_size], CAPTURE_READ_SIZE)) > 0))
+	{
+		m_replay_size += length;
+	}
+	ble_pickit_capture_control(CAPTURE_CMD_START);
+}
+
+/**@brief Function for answering the bridge until the replay starts, then for draining its bytes (answers replayed)
+ *        and its capture.
+ */
+static void replay_hook(void * p_context)
+{
+	uint8_t bytes[64];
+
+	if (!m_is_replaying)
+	{
+		host_mcu_process(&m_mcu);
+		return;
+	}
+	while (fake_uart_host_read(bytes, sizeof(bytes)) > 0);
+	if (host_clock_ns() >= m_drain_ns)
+	{
+		m_drain_ns = host_clock_ns() + REPLAY_DRAIN_PERIOD_NS;
+		replay_capture_drain();
+	}
+}
+
+static bool is_started(void * p_context)
+{
+	return bridge_is_started() && host_mcu_is_idle(&m_mcu);
+}
+
+static bool is_connected(void * p_context)
+{
+	return bridge_is_connected();
+}
+
+static uint8_t * file_read(char const * p_path, uint32_t * p_size)
+{
+	uint8_t * p_data = malloc(REPLAY_FILE_MAX);
+	FILE * p_file = fopen(p_path, "rb");
+
+	if ((p_file == NULL) || (p_data == NULL))
+	{
+		free(p_data);
+		return NULL;
+	}
+	*p_size = fread(p_data, 1, REPLAY_FILE_MAX, p_file);
+	fclose(p_file);
+	return p_data;
+}
+
+int main(int argc, char ** argv)
+{
+	host_sd_config_t sd_config = HOST_SD_CONFIG_DEFAULT;
+	host_mcu_init_t mcu_init = {.write = mcu_write, .read = mcu_read, .baud_rate = FAKE_UART_BAUD_RATE};
+	record_list_t captured = {.p_records = calloc(REPLAY_RECORD_MAX, sizeof(record_t))};
+	record_list_t replayed = {.p_records = calloc(REPLAY_RECORD_MAX, sizeof(record_t))};
+	uint32_t uart_inputs = 0, gatt_inputs = 0, truncated = 0, skipped = 0;
+	uint32_t captured_outputs, replayed_outputs, matched;
+	uint32_t tolerance = 0;
+	char const * p_path = NULL;
+	bool is_cccd_enabled = true;
+	double speed = 1.0;
+	uint8_t * p_dump;
+	uint32_t size;
+	uint64_t start_ns;
+	uint64_t target_ns;
+	uint32_t i;
+
+	for (i = 1 ; i < (uint32_t) argc ; i++)
+	{
+		if ((strcmp(argv[i], "--speed") == 0) && ((i + 1) < (uint32_t) argc))
+		{
+			speed = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--no-cccd") == 0)
+		{
+			is_cccd_enabled = false;
+		}
+		else if ((strcmp(argv[i], "--tolerance") == 0) && ((i + 1) < (uint32_t) argc))
+		{
+			tolerance = strtoul(argv[++i], NULL, 0);
+		}
+		else
+		{
+			p_path = argv[i];
+		}
+	}
+	if ((p_path == NULL) || (speed <= 0))
+	{
+		fprintf(stderr, "usage: replay [--speed X (1: original timing)] [--no-cccd] [--tolerance N (outputs not matched)] FILE\n");
+		return EXIT_FAILURE;
+	}
+	if (((p_dump = file_read(p_path, &size)) == NULL) || !records_parse(p_dump, size, &captured))
+	{
+		fprintf(stderr, "replay: %s is not a capture\n", p_path);
+		return EXIT_FAILURE;
+	}
+
+	// Bridge started (boot frame acknowledged) and connected.
+	host_clock_virtual_set(true);
+	sd_config.writes_per_event = HOST_SD_WRITE_QUEUE_SIZE;
+	bridge_init(&sd_config);
+	host_mcu_init(&m_mcu, &mcu_init);
+	bridge_hook_set(replay_hook, NULL);
+	if (!bridge_run_until(is_started, NULL, REPLAY_SETUP_NS * 5))
+	{
+		fprintf(stderr, "replay: the bridge did not start\n");
+		return EXIT_FAILURE;
+	}
+	host_sd_connect();
+	if (!bridge_run_until(is_connected, NULL, REPLAY_SETUP_NS))
+	{
+		fprintf(stderr, "replay: no connection\n");
+		return EXIT_FAILURE;
+	}
+	if (is_cccd_enabled)
+	{
+		(void) host_sd_notification_enable(MESSAGE_APP_CHAR_UUID, true);
+		(void) host_sd_notification_enable(MESSAGE_TEST_UUID, true);
+		(void) host_sd_notification_enable(MESSAGE_PARAMS_UUID, true);
+	}
+	bridge_run_for(REPLAY_SETUP_NS);
+
+	// Replay, the outputs being captured again.
+	m_is_replaying = true;
+	ble_pickit_capture_control(CAPTURE_CMD_START);
+	start_ns = replay_start_ns(&captured, speed);
+	m_drain_ns = host_clock_ns() + REPLAY_DRAIN_PERIOD_NS;
+	for (i = 0 ; i < captured.count ; i++)
+	{
+		record_t const * p_record = &captured.p_records[i];
+
+		if (is_output(p_record))
+		{
+			continue;
+		}
+		if (p_record->length > CAPTURE_DATA_MAX)
+		{
+			truncated++;
+			continue;
+		}
+		if (	(p_record->source == CAPTURE_SOURCE_GATT_WRITE) && (p_record->tag == host_sd_value_handle(MESSAGE_PARAMS_UUID)) &&	\
+				(p_record->length > 0) && (p_record->p_data[0] == REPLAY_CAPTURE_SUB_COMMAND))
+		{
+			skipped++;
+			continue;
+		}
+		target_ns = start_ns + (uint64_t) (p_record->time_ns / speed) - record_lead_ns(p_record);
+		if (target_ns > host_clock_ns())
+		{
+			bridge_run_for(target_ns - host_clock_ns());
+		}
+		if (p_record->source == CAPTURE_SOURCE_UART_RX)
+		{
+			fake_uart_host_write(p_record->p_data, p_record->length);
+			uart_inputs++;
+		}
+		else if (host_sd_write(p_record->tag, p_record->p_data, p_record->length))
+		{
+			gatt_inputs++;
+		}
+	}
+	bridge_run_for(REPLAY_END_NS);
+
+	replay_capture_drain();
+	(void) records_parse(m_replay_dump, m_replay_size, &replayed);
+	captured_outputs = outputs_count(&captured);
+	replayed_outputs = outputs_count(&replayed);
+	matched = outputs_match(&captured, &replayed);
+
+	printf("{\"records\":%u,\"duration_s\":%.3f,\"speed\":%.2f,\"inputs\":{\"uart\":%u,\"gatt\":%u,\"truncated\":%u,\"capture_commands\":%u},",
+			captured.count, (captured.count > 0) ? (captured.p_records[captured.count - 1].time_ns / 1e9) : 0.0, speed, uart_inputs, gatt_inputs, truncated, skipped);
+	printf("\"outputs\":{\"captured\":%u,\"replayed\":%u,\"matched\":%u,\"tolerance\":%u}}\n",
+			captured_outputs, replayed_outputs, matched, tolerance);
+
+	if (((captured_outputs - matched) + (replayed_outputs - matched)) > tolerance)
+	{
+		fprintf(stderr, "replay: %u captured outputs and %u replayed outputs not matched (tolerance %u)\n",
+				captured_outputs - matched, replayed_outputs - matched, tolerance);
+		return 2;
+	}
+	return EXIT_SUCCESS;
+}
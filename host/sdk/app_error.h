@@ -0,0 +1,32 @@
+/*
+ * Host build: subset of the nRF5 SDK header of the same name (see host/README.md).
+ * app_error_handler() prints the error and aborts, unless a test installed a hook (host_app_error_hook_set).
+ */
+#ifndef APP_ERROR_H__
+#define APP_ERROR_H__
+
+#include <stdint.h>
+#include "sdk_errors.h"
+
+typedef void (*host_app_error_hook_t)(ret_code_t error_code, uint32_t line_num, const uint8_t * p_file_name);
+
+void app_error_handler(ret_code_t error_code, uint32_t line_num, const uint8_t * p_file_name);
+void host_app_error_hook_set(host_app_error_hook_t hook);
+
+#define APP_ERROR_HANDLER(ERR_CODE)									\
+	do																\
+	{																\
+		app_error_handler((ERR_CODE), __LINE__, (uint8_t *) __FILE__);	\
+	} while (0)
+
+#define APP_ERROR_CHECK(ERR_CODE)									\
+	do																\
+	{																\
+		const uint32_t LOCAL_ERR_CODE = (ERR_CODE);					\
+		if (LOCAL_ERR_CODE != NRF_SUCCESS)							\
+		{															\
+			APP_ERROR_HANDLER(LOCAL_ERR_CODE);						\
+		}															\
+	} while (0)
+
+#endif
@@ -0,0 +1,26 @@
+/*
+ * Host build: nRF5 SDK app_fifo (same API and behavior: power of 2 size, free running read / write positions).
+ */
+#ifndef APP_FIFO_H__
+#define APP_FIFO_H__
+
+#include <stdint.h>
+#include "sdk_errors.h"
+
+typedef struct
+{
+	uint8_t *						p_buf;
+	uint16_t						buf_size_mask;
+	volatile uint32_t				read_pos;
+	volatile uint32_t				write_pos;
+} app_fifo_t;
+
+uint32_t app_fifo_init(app_fifo_t * p_fifo, uint8_t * p_buf, uint16_t buf_size);
+uint32_t app_fifo_put(app_fifo_t * p_fifo, uint8_t byte);
+uint32_t app_fifo_get(app_fifo_t * p_fifo, uint8_t * p_byte);
+uint32_t app_fifo_peek(app_fifo_t * p_fifo, uint16_t index, uint8_t * p_byte_out);
+uint32_t app_fifo_flush(app_fifo_t * p_fifo);
+uint32_t app_fifo_read(app_fifo_t * p_fifo, uint8_t * p_byte_array, uint32_t * p_size);
+uint32_t app_fifo_write(app_fifo_t * p_fifo, uint8_t const * p_byte_array, uint32_t * p_size);
+
+#endif
@@ -0,0 +1,53 @@
+/*
+ * Host build: subset of the nRF5 SDK header of the same name (see host/README.md).
+ * The timers expire on host_clock: app_timer_process() (called by the harness like the RTC1 interrupt) runs the
+ * handlers of the expired timers.
+ */
+#ifndef APP_TIMER_H__
+#define APP_TIMER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdk_config.h"
+#include "sdk_errors.h"
+#include "nordic_common.h"
+
+#define APP_TIMER_CLOCK_FREQ				32768
+#define APP_TIMER_MIN_TIMEOUT_TICKS			5
+#define APP_TIMER_TICKS(MS)					((uint32_t) ((((uint64_t) (MS)) * (uint64_t) APP_TIMER_CLOCK_FREQ) / (1000 * (APP_TIMER_CONFIG_RTC_FREQUENCY + 1))))
+
+typedef void (*app_timer_timeout_handler_t)(void * p_context);
+
+typedef enum
+{
+	APP_TIMER_MODE_SINGLE_SHOT,
+	APP_TIMER_MODE_REPEATED,
+} app_timer_mode_t;
+
+typedef struct app_timer_s
+{
+	struct app_timer_s *			p_next;
+	app_timer_timeout_handler_t		handler;
+	app_timer_mode_t				mode;
+	bool							is_created;
+	bool							is_running;
+	uint64_t						expiry_ns;
+	uint64_t						period_ns;
+	void *							p_context;
+} app_timer_t;
+
+typedef app_timer_t * app_timer_id_t;
+
+#define APP_TIMER_DEF(timer_id)										\
+	static app_timer_t CONCAT_2(timer_id, _data) = { 0 };			\
+	static const app_timer_id_t timer_id = &CONCAT_2(timer_id, _data)
+
+ret_code_t app_timer_init(void);
+ret_code_t app_timer_create(app_timer_id_t const * p_timer_id, app_timer_mode_t mode, app_timer_timeout_handler_t timeout_handler);
+ret_code_t app_timer_start(app_timer_id_t timer_id, uint32_t timeout_ticks, void * p_context);
+ret_code_t app_timer_stop(app_timer_id_t timer_id);
+
+void app_timer_process(void);
+uint64_t host_app_timer_next_expiry_ns(void);
+
+#endif
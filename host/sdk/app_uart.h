@@ -0,0 +1,84 @@
+/*
+ * Host build: subset of the nRF5 SDK header of the same name (see host/README.md).
+ * The host build plugs a fake transport (ble_pickit_transport_set): app_uart_put / app_uart_get have no line behind,
+ * the fake calls the event handler of app_uart_init() with host_app_uart_evt() (APP_UART_TX_EMPTY, APP_UART_FIFO_ERROR).
+ */
+#ifndef APP_UART_H__
+#define APP_UART_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdk_errors.h"
+#include "nrf_uart.h"
+#include "app_util_platform.h"
+
+#define UART_PIN_DISCONNECTED				0xFFFFFFFF
+
+typedef enum
+{
+	APP_UART_FLOW_CONTROL_DISABLED,
+	APP_UART_FLOW_CONTROL_ENABLED,
+} app_uart_flow_control_t;
+
+typedef struct
+{
+	uint32_t						rx_pin_no;
+	uint32_t						tx_pin_no;
+	uint32_t						rts_pin_no;
+	uint32_t						cts_pin_no;
+	app_uart_flow_control_t			flow_control;
+	bool							use_parity;
+	uint32_t						baud_rate;
+} app_uart_comm_params_t;
+
+typedef struct
+{
+	uint8_t *						rx_buf;
+	uint32_t						rx_buf_size;
+	uint8_t *						tx_buf;
+	uint32_t						tx_buf_size;
+} app_uart_buffers_t;
+
+typedef enum
+{
+	APP_UART_DATA_READY,
+	APP_UART_FIFO_ERROR,
+	APP_UART_COMMUNICATION_ERROR,
+	APP_UART_TX_EMPTY,
+	APP_UART_DATA,
+} app_uart_evt_type_t;
+
+typedef struct
+{
+	app_uart_evt_type_t				evt_type;
+	union
+	{
+		uint32_t					error_communication;
+		uint32_t					error_code;
+		uint8_t						value;
+	} data;
+} app_uart_evt_t;
+
+typedef void (*app_uart_event_handler_t)(app_uart_evt_t * p_app_uart_event);
+
+uint32_t app_uart_init(app_uart_comm_params_t const * p_comm_params, app_uart_buffers_t * p_buffers, app_uart_event_handler_t error_handler, uint8_t irq_priority);
+uint32_t app_uart_put(uint8_t byte);
+uint32_t app_uart_get(uint8_t * p_byte);
+
+void host_app_uart_evt(app_uart_evt_type_t evt_type);
+
+#define APP_UART_FIFO_INIT(P_COMM_PARAMS, RX_BUF_SIZE, TX_BUF_SIZE, EVT_HANDLER, IRQ_PRIO, ERR_CODE)	\
+	do																								\
+	{																								\
+		app_uart_buffers_t buffers;																	\
+		static uint8_t rx_buf[RX_BUF_SIZE];															\
+		static uint8_t tx_buf[TX_BUF_SIZE];															\
+																									\
+		buffers.rx_buf = rx_buf;																	\
+		buffers.rx_buf_size = sizeof(rx_buf);														\
+		buffers.tx_buf = tx_buf;																	\
+		buffers.tx_buf_size = sizeof(tx_buf);														\
+		ERR_CODE = app_uart_init(P_COMM_PARAMS, &buffers, EVT_HANDLER, IRQ_PRIO);					\
+	} while (0)
+
+#endif
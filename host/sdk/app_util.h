@@ -0,0 +1,21 @@
+/*
+ * Host build: subset of the nRF5 SDK header of the same name (see host/README.md).
+ */
+#ifndef APP_UTIL_H__
+#define APP_UTIL_H__
+
+#include <stdint.h>
+
+#define ARRAY_SIZE(arr)						(sizeof(arr) / sizeof((arr)[0]))
+#define IS_POWER_OF_TWO(A)					(((A) != 0) && ((((A) - 1) & (A)) == 0))
+
+enum
+{
+	UNIT_0_625_MS = 625,
+	UNIT_1_25_MS  = 1250,
+	UNIT_10_MS    = 10000
+};
+
+#define MSEC_TO_UNITS(TIME, RESOLUTION)		(((TIME) * 1000) / (RESOLUTION))
+
+#endif
@@ -0,0 +1,21 @@
+/*
+ * Host build: subset of the nRF5 SDK header of the same name (see host/README.md).
+ * The SoftDevice events, the timers and the UART events of the host build are dispatched by the harness between two
+ * passes of the main loop (like interrupts which never preempt a critical region): the critical regions are empty.
+ */
+#ifndef APP_UTIL_PLATFORM_H__
+#define APP_UTIL_PLATFORM_H__
+
+#include <stdint.h>
+#include "app_util.h"
+
+#define APP_IRQ_PRIORITY_HIGHEST			2
+#define APP_IRQ_PRIORITY_HIGH				2
+#define APP_IRQ_PRIORITY_MID				5
+#define APP_IRQ_PRIORITY_LOW				6
+#define APP_IRQ_PRIORITY_LOWEST				7
+
+#define CRITICAL_REGION_ENTER()				{
+#define CRITICAL_REGION_EXIT()				}
+
+#endif
@@ -0,0 +1,569 @@
+/*
+ * Host build: subset of the S132 v6 SoftDevice API (ble.h, ble_gap.h, ble_gatt.h, ble_gatts.h, ble_gattc.h,
+ * ble_types.h) used by the bridge. The sd_xxx calls are served by the fake SoftDevice (host/sdk/softdevice.c).
+ */
+#ifndef BLE_H__
+#define BLE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "nrf_error.h"
+
+/* ble_types.h */
+#define BLE_CONN_HANDLE_INVALID				0xFFFF
+#define BLE_UUID_TYPE_UNKNOWN				0x00
+#define BLE_UUID_TYPE_BLE					0x01
+#define BLE_UUID_TYPE_VENDOR_BEGIN			0x02
+#define BLE_CONN_CFG_TAG_DEFAULT			0
+
+typedef struct
+{
+	uint16_t						uuid;
+	uint8_t							type;
+} ble_uuid_t;
+
+typedef struct
+{
+	uint8_t							uuid128[16];
+} ble_uuid128_t;
+
+typedef struct
+{
+	uint8_t *						p_data;
+	uint16_t						len;
+} ble_data_t;
+
+/* ble_hci.h */
+#define BLE_HCI_STATUS_CODE_SUCCESS						0x00
+#define BLE_HCI_REMOTE_USER_TERMINATED_CONNECTION		0x13
+#define BLE_HCI_LOCAL_HOST_TERMINATED_CONNECTION		0x16
+#define BLE_HCI_CONN_INTERVAL_UNACCEPTABLE				0x3B
+
+/* ble_gap.h */
+#define BLE_GAP_EVT_BASE					0x10
+#define BLE_GATTC_EVT_BASE					0x30
+#define BLE_GATTS_EVT_BASE					0x50
+
+enum
+{
+	BLE_GAP_EVT_CONNECTED = BLE_GAP_EVT_BASE,
+	BLE_GAP_EVT_DISCONNECTED,
+	BLE_GAP_EVT_CONN_PARAM_UPDATE,
+	BLE_GAP_EVT_SEC_PARAMS_REQUEST,
+	BLE_GAP_EVT_SEC_INFO_REQUEST,
+	BLE_GAP_EVT_PASSKEY_DISPLAY,
+	BLE_GAP_EVT_KEY_PRESSED,
+	BLE_GAP_EVT_AUTH_KEY_REQUEST,
+	BLE_GAP_EVT_LESC_DHKEY_REQUEST,
+	BLE_GAP_EVT_AUTH_STATUS,
+	BLE_GAP_EVT_CONN_SEC_UPDATE,
+	BLE_GAP_EVT_TIMEOUT,
+	BLE_GAP_EVT_RSSI_CHANGED,
+	BLE_GAP_EVT_ADV_REPORT,
+	BLE_GAP_EVT_SEC_REQUEST,
+	BLE_GAP_EVT_CONN_PARAM_UPDATE_REQUEST,
+	BLE_GAP_EVT_SCAN_REQ_REPORT,
+	BLE_GAP_EVT_PHY_UPDATE_REQUEST,
+	BLE_GAP_EVT_PHY_UPDATE,
+	BLE_GAP_EVT_DATA_LENGTH_UPDATE_REQUEST,
+	BLE_GAP_EVT_DATA_LENGTH_UPDATE,
+	BLE_GAP_EVT_QOS_CHANNEL_SURVEY_REPORT,
+	BLE_GAP_EVT_ADV_SET_TERMINATED,
+};
+
+enum
+{
+	BLE_GATTC_EVT_TIMEOUT = BLE_GATTC_EVT_BASE + 13,
+};
+
+enum
+{
+	BLE_GATTS_EVT_WRITE = BLE_GATTS_EVT_BASE,
+	BLE_GATTS_EVT_RW_AUTHORIZE_REQUEST,
+	BLE_GATTS_EVT_SYS_ATTR_MISSING,
+	BLE_GATTS_EVT_HVC,
+	BLE_GATTS_EVT_SC_CONFIRM,
+	BLE_GATTS_EVT_EXCHANGE_MTU_REQUEST,
+	BLE_GATTS_EVT_TIMEOUT,
+	BLE_GATTS_EVT_HVN_TX_COMPLETE,
+};
+
+#define BLE_GAP_PHY_AUTO					0x00
+#define BLE_GAP_PHY_1MBPS					0x01
+#define BLE_GAP_PHY_2MBPS					0x02
+#define BLE_GAP_PHY_CODED					0x04
+
+#define BLE_GAP_TX_POWER_ROLE_ADV			1
+#define BLE_GAP_TX_POWER_ROLE_SCAN_INIT		2
+#define BLE_GAP_TX_POWER_ROLE_CONN			3
+
+#define BLE_GAP_DATA_LENGTH_AUTO			0
+#define BLE_GAP_RSSI_THRESHOLD_INVALID		0xFF
+#define BLE_GAP_WHITELIST_ADDR_MAX_COUNT	8
+#define BLE_GAP_CONN_COUNT_DEFAULT			1
+#define BLE_GAP_IO_CAPS_NONE				0x03
+
+#define BLE_GAP_ADV_FLAG_LE_GENERAL_DISC_MODE		0x02
+#define BLE_GAP_ADV_FLAG_BR_EDR_NOT_SUPPORTED		0x04
+#define BLE_GAP_ADV_FLAGS_LE_ONLY_GENERAL_DISC_MODE	(BLE_GAP_ADV_FLAG_LE_GENERAL_DISC_MODE | BLE_GAP_ADV_FLAG_BR_EDR_NOT_SUPPORTED)
+#define BLE_GAP_ADV_SET_DATA_SIZE_MAX						31
+#define BLE_GAP_ADV_SET_DATA_SIZE_EXTENDED_MAX_SUPPORTED	255
+#define BLE_GAP_ADV_SET_HANDLE_NOT_SET						0xFF
+#define BLE_GAP_ADV_TYPE_CONNECTABLE_SCANNABLE_UNDIRECTED			0x01
+#define BLE_GAP_ADV_TYPE_NONCONNECTABLE_NONSCANNABLE_UNDIRECTED		0x05
+#define BLE_GAP_ADV_TYPE_EXTENDED_NONCONNECTABLE_NONSCANNABLE_UNDIRECTED	0x0A
+#define BLE_GAP_ADV_FP_ANY					0x00
+#define BLE_GAP_ADV_TIMEOUT_GENERAL_UNLIMITED	0
+
+#define BLE_GAP_CONN_SEC_MODE_SET_OPEN(ptr)	do { (ptr)->sm = 1; (ptr)->lv = 1; } while (0)
+
+typedef struct
+{
+	uint8_t							sm : 4;
+	uint8_t							lv : 4;
+} ble_gap_conn_sec_mode_t;
+
+typedef struct
+{
+	uint8_t							addr_id_peer : 1;
+	uint8_t							addr_type    : 7;
+	uint8_t							addr[6];
+} ble_gap_addr_t;
+
+typedef struct
+{
+	uint8_t							irk[16];
+} ble_gap_irk_t;
+
+typedef struct
+{
+	uint16_t						min_conn_interval;
+	uint16_t						max_conn_interval;
+	uint16_t						slave_latency;
+	uint16_t						conn_sup_timeout;
+} ble_gap_conn_params_t;
+
+typedef struct
+{
+	uint8_t							tx_phys;
+	uint8_t							rx_phys;
+} ble_gap_phys_t;
+
+typedef struct
+{
+	uint16_t						max_tx_octets;
+	uint16_t						max_rx_octets;
+	uint16_t						max_tx_time_us;
+	uint16_t						max_rx_time_us;
+} ble_gap_data_length_params_t;
+
+typedef struct
+{
+	uint16_t						tx_payload_limited_octets;
+	uint16_t						rx_payload_limited_octets;
+	uint16_t						tx_rx_time_limited_us;
+} ble_gap_data_length_limitation_t;
+
+typedef struct
+{
+	uint8_t							enc  : 1;
+	uint8_t							id   : 1;
+	uint8_t							sign : 1;
+	uint8_t							link : 1;
+} ble_gap_sec_kdist_t;
+
+typedef struct
+{
+	uint8_t							bond     : 1;
+	uint8_t							mitm     : 1;
+	uint8_t							lesc     : 1;
+	uint8_t							keypress : 1;
+	uint8_t							io_caps  : 3;
+	uint8_t							oob      : 1;
+	uint8_t							min_key_size;
+	uint8_t							max_key_size;
+	ble_gap_sec_kdist_t				kdist_own;
+	ble_gap_sec_kdist_t				kdist_peer;
+} ble_gap_sec_params_t;
+
+typedef struct
+{
+	uint8_t							type;
+	uint8_t							anonymous  : 1;
+	uint8_t							include_tx_power : 1;
+} ble_gap_adv_properties_t;
+
+typedef struct
+{
+	ble_gap_adv_properties_t		properties;
+	ble_gap_addr_t const *			p_peer_addr;
+	uint32_t						interval;
+	uint16_t						duration;
+	uint8_t							max_adv_evts;
+	uint8_t							channel_mask[5];
+	uint8_t							filter_policy;
+	uint8_t							primary_phy;
+	uint8_t							secondary_phy;
+	uint8_t							set_id : 4;
+	uint8_t							scan_req_notification : 1;
+} ble_gap_adv_params_t;
+
+typedef struct
+{
+	ble_data_t						adv_data;
+	ble_data_t						scan_rsp_data;
+} ble_gap_adv_data_t;
+
+typedef struct
+{
+	ble_gap_addr_t					peer_addr;
+	uint8_t							role;
+	ble_gap_conn_params_t			conn_params;
+	uint8_t							adv_handle;
+} ble_gap_evt_connected_t;
+
+typedef struct
+{
+	uint8_t							reason;
+} ble_gap_evt_disconnected_t;
+
+typedef struct
+{
+	ble_gap_conn_params_t			conn_params;
+} ble_gap_evt_conn_param_update_t;
+
+typedef struct
+{
+	ble_gap_conn_params_t			conn_params;
+} ble_gap_evt_conn_param_update_request_t;
+
+typedef struct
+{
+	ble_gap_phys_t					peer_preferred_phys;
+} ble_gap_evt_phy_update_request_t;
+
+typedef struct
+{
+	uint8_t							status;
+	uint8_t							tx_phy;
+	uint8_t							rx_phy;
+} ble_gap_evt_phy_update_t;
+
+typedef struct
+{
+	ble_gap_data_length_params_t	peer_params;
+} ble_gap_evt_data_length_update_request_t;
+
+typedef struct
+{
+	ble_gap_data_length_params_t	effective_params;
+} ble_gap_evt_data_length_update_t;
+
+typedef struct
+{
+	int8_t							rssi;
+	uint8_t							ch_index;
+} ble_gap_evt_rssi_changed_t;
+
+typedef struct
+{
+	uint16_t						conn_handle;
+	union
+	{
+		ble_gap_evt_connected_t						connected;
+		ble_gap_evt_disconnected_t					disconnected;
+		ble_gap_evt_conn_param_update_t				conn_param_update;
+		ble_gap_evt_conn_param_update_request_t		conn_param_update_request;
+		ble_gap_evt_phy_update_request_t			phy_update_request;
+		ble_gap_evt_phy_update_t					phy_update;
+		ble_gap_evt_data_length_update_request_t	data_length_update_request;
+		ble_gap_evt_data_length_update_t			data_length_update;
+		ble_gap_evt_rssi_changed_t					rssi_changed;
+	} params;
+} ble_gap_evt_t;
+
+/* ble_gatt.h */
+#define BLE_GATT_ATT_MTU_DEFAULT			23
+#define BLE_GATT_HANDLE_INVALID				0x0000
+#define BLE_GATT_HVX_INVALID				0x00
+#define BLE_GATT_HVX_NOTIFICATION			0x01
+#define BLE_GATT_HVX_INDICATION				0x02
+#define BLE_GATT_STATUS_SUCCESS				0x0000
+#define BLE_GATT_OP_WRITE_REQ				0x01
+#define BLE_GATT_OP_WRITE_CMD				0x02
+
+typedef struct
+{
+	uint8_t							broadcast     : 1;
+	uint8_t							read          : 1;
+	uint8_t							write_wo_resp : 1;
+	uint8_t							write         : 1;
+	uint8_t							notify        : 1;
+	uint8_t							indicate      : 1;
+	uint8_t							auth_signed_wr : 1;
+} ble_gatt_char_props_t;
+
+typedef struct
+{
+	uint8_t							reliable_wr : 1;
+	uint8_t							wr_aux      : 1;
+} ble_gatt_char_ext_props_t;
+
+/* ble_gatts.h */
+#define BLE_GATTS_SRVC_TYPE_PRIMARY			0x01
+#define BLE_GATTS_VLOC_INVALID				0x00
+#define BLE_GATTS_VLOC_STACK				0x01
+#define BLE_GATTS_VLOC_USER					0x02
+#define BLE_GATTS_AUTHORIZE_TYPE_INVALID	0x00
+#define BLE_GATTS_AUTHORIZE_TYPE_READ		0x01
+#define BLE_GATTS_AUTHORIZE_TYPE_WRITE		0x02
+
+typedef struct
+{
+	ble_gap_conn_sec_mode_t			read_perm;
+	ble_gap_conn_sec_mode_t			write_perm;
+	uint8_t							vlen    : 1;
+	uint8_t							vloc    : 2;
+	uint8_t							rd_auth : 1;
+	uint8_t							wr_auth : 1;
+} ble_gatts_attr_md_t;
+
+typedef struct
+{
+	uint8_t							format;
+	int8_t							exponent;
+	uint16_t						unit;
+	uint8_t							name_space;
+	uint16_t						desc;
+} ble_gatts_char_pf_t;
+
+typedef struct
+{
+	ble_gatt_char_props_t			char_props;
+	ble_gatt_char_ext_props_t		char_ext_props;
+	uint8_t const *					p_char_user_desc;
+	uint16_t						char_user_desc_max_size;
+	uint16_t						char_user_desc_size;
+	ble_gatts_char_pf_t const *		p_char_pf;
+	ble_gatts_attr_md_t const *		p_user_desc_md;
+	ble_gatts_attr_md_t const *		p_cccd_md;
+	ble_gatts_attr_md_t const *		p_sccd_md;
+} ble_gatts_char_md_t;
+
+typedef struct
+{
+	ble_uuid_t const *				p_uuid;
+	ble_gatts_attr_md_t const *		p_attr_md;
+	uint16_t						init_len;
+	uint16_t						init_offs;
+	uint16_t						max_len;
+	uint8_t *						p_value;
+} ble_gatts_attr_t;
+
+typedef struct
+{
+	uint16_t						value_handle;
+	uint16_t						user_desc_handle;
+	uint16_t						cccd_handle;
+	uint16_t						sccd_handle;
+} ble_gatts_char_handles_t;
+
+typedef struct
+{
+	uint16_t						len;
+	uint16_t						offset;
+	uint8_t *						p_value;
+} ble_gatts_value_t;
+
+typedef struct
+{
+	uint16_t						handle;
+	uint8_t							type;
+	uint16_t						offset;
+	uint16_t *						p_len;
+	uint8_t const *					p_data;
+} ble_gatts_hvx_params_t;
+
+typedef struct
+{
+	uint16_t						gatt_status;
+	uint8_t							update : 1;
+	uint16_t						offset;
+	uint16_t						len;
+	uint8_t const *					p_data;
+} ble_gatts_authorize_params_t;
+
+typedef struct
+{
+	uint8_t							type;
+	union
+	{
+		ble_gatts_authorize_params_t	read;
+		ble_gatts_authorize_params_t	write;
+	} params;
+} ble_gatts_rw_authorize_reply_params_t;
+
+typedef struct
+{
+	uint16_t						handle;
+	ble_uuid_t						uuid;
+	uint8_t							op;
+	uint8_t							auth_required;
+	uint16_t						offset;
+	uint16_t						len;
+	uint8_t							data[1];							/**< Variable length (len bytes follow the event header). */
+} ble_gatts_evt_write_t;
+
+typedef struct
+{
+	uint16_t						handle;
+	ble_uuid_t						uuid;
+	uint16_t						offset;
+} ble_gatts_evt_read_t;
+
+typedef struct
+{
+	uint8_t							type;
+	union
+	{
+		ble_gatts_evt_read_t		read;
+		ble_gatts_evt_write_t		write;
+	} request;
+} ble_gatts_evt_rw_authorize_request_t;
+
+typedef struct
+{
+	uint8_t							count;
+} ble_gatts_evt_hvn_tx_complete_t;
+
+typedef struct
+{
+	uint8_t							src;
+} ble_gatts_evt_timeout_t;
+
+typedef struct
+{
+	uint16_t						conn_handle;
+	union
+	{
+		ble_gatts_evt_write_t					write;
+		ble_gatts_evt_rw_authorize_request_t	authorize_request;
+		ble_gatts_evt_hvn_tx_complete_t			hvn_tx_complete;
+		ble_gatts_evt_timeout_t					timeout;
+	} params;
+} ble_gatts_evt_t;
+
+/* ble_gattc.h */
+typedef struct
+{
+	uint16_t						conn_handle;
+} ble_gattc_evt_t;
+
+/* ble.h */
+typedef struct
+{
+	uint16_t						evt_id;
+	uint16_t						evt_len;
+} ble_evt_hdr_t;
+
+typedef struct
+{
+	ble_evt_hdr_t					header;
+	union
+	{
+		ble_gap_evt_t				gap_evt;
+		ble_gattc_evt_t				gattc_evt;
+		ble_gatts_evt_t				gatts_evt;
+	} evt;
+} ble_evt_t;
+
+#define BLE_COMMON_OPT_PA_LNA				0x01
+#define BLE_COMMON_OPT_CONN_EVT_EXT			0x02
+
+typedef struct
+{
+	uint8_t							enable      : 1;
+	uint8_t							active_high : 1;
+	uint8_t							gpio_pin    : 6;
+} ble_pa_lna_cfg_t;
+
+typedef struct
+{
+	ble_pa_lna_cfg_t				pa_cfg;
+	ble_pa_lna_cfg_t				lna_cfg;
+	uint8_t							ppi_ch_id_set;
+	uint8_t							ppi_ch_id_clr;
+	uint8_t							gpiote_ch_id;
+} ble_common_opt_pa_lna_t;
+
+typedef struct
+{
+	uint8_t							enable : 1;
+} ble_common_opt_conn_evt_ext_t;
+
+typedef union
+{
+	ble_common_opt_pa_lna_t			pa_lna;
+	ble_common_opt_conn_evt_ext_t	conn_evt_ext;
+} ble_common_opt_t;
+
+typedef union
+{
+	ble_common_opt_t				common_opt;
+} ble_opt_t;
+
+#define BLE_CONN_CFG_GAP					0x20
+
+typedef struct
+{
+	uint8_t							conn_count;
+	uint16_t						event_length;
+} ble_gap_conn_cfg_t;
+
+typedef struct
+{
+	uint16_t						att_mtu;
+} ble_gatt_conn_cfg_t;
+
+typedef struct
+{
+	uint8_t							conn_cfg_tag;
+	union
+	{
+		ble_gap_conn_cfg_t			gap_conn_cfg;
+		ble_gatt_conn_cfg_t			gatt_conn_cfg;
+	} params;
+} ble_conn_cfg_t;
+
+typedef union
+{
+	ble_conn_cfg_t					conn_cfg;
+} ble_cfg_t;
+
+/* SoftDevice calls (host/sdk/softdevice.c) */
+uint32_t sd_ble_cfg_set(uint32_t cfg_id, ble_cfg_t const * p_cfg, uint32_t app_ram_base);
+uint32_t sd_ble_opt_set(uint32_t opt_id, ble_opt_t const * p_opt);
+uint32_t sd_ble_uuid_vs_add(ble_uuid128_t const * p_vs_uuid, uint8_t * p_uuid_type);
+
+uint32_t sd_ble_gap_device_name_set(ble_gap_conn_sec_mode_t const * p_write_perm, uint8_t const * p_dev_name, uint16_t len);
+uint32_t sd_ble_gap_ppcp_set(ble_gap_conn_params_t const * p_conn_params);
+uint32_t sd_ble_gap_conn_param_update(uint16_t conn_handle, ble_gap_conn_params_t const * p_conn_params);
+uint32_t sd_ble_gap_phy_update(uint16_t conn_handle, ble_gap_phys_t const * p_gap_phys);
+uint32_t sd_ble_gap_data_length_update(uint16_t conn_handle, ble_gap_data_length_params_t const * p_dl_params, ble_gap_data_length_limitation_t * p_dl_limitation);
+uint32_t sd_ble_gap_disconnect(uint16_t conn_handle, uint8_t hci_status_code);
+uint32_t sd_ble_gap_rssi_start(uint16_t conn_handle, uint8_t threshold_dbm, uint8_t skip_count);
+uint32_t sd_ble_gap_rssi_get(uint16_t conn_handle, int8_t * p_rssi, uint8_t * p_ch_index);
+uint32_t sd_ble_gap_tx_power_set(uint8_t role, uint16_t handle, int8_t tx_power);
+uint32_t sd_ble_gap_adv_set_configure(uint8_t * p_adv_handle, ble_gap_adv_data_t const * p_adv_data, ble_gap_adv_params_t const * p_adv_params);
+uint32_t sd_ble_gap_adv_start(uint8_t adv_handle, uint8_t conn_cfg_tag);
+uint32_t sd_ble_gap_adv_stop(uint8_t adv_handle);
+
+uint32_t sd_ble_gatts_service_add(uint8_t type, ble_uuid_t const * p_uuid, uint16_t * p_handle);
+uint32_t sd_ble_gatts_characteristic_add(uint16_t service_handle, ble_gatts_char_md_t const * p_char_md, ble_gatts_attr_t const * p_attr_char_value, ble_gatts_char_handles_t * p_handles);
+uint32_t sd_ble_gatts_value_get(uint16_t conn_handle, uint16_t handle, ble_gatts_value_t * p_value);
+uint32_t sd_ble_gatts_hvx(uint16_t conn_handle, ble_gatts_hvx_params_t const * p_hvx_params);
+uint32_t sd_ble_gatts_rw_authorize_reply(uint16_t conn_handle, ble_gatts_rw_authorize_reply_params_t const * p_rw_authorize_reply_params);
+
+uint32_t sd_nvic_SystemReset(void);
+
+#endif
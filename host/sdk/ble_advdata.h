@@ -0,0 +1,87 @@
+/*
+ * Host build: subset of the nRF5 SDK header of the same name (see host/README.md).
+ * ble_advdata_encode() encodes the flags and the manufacturer specific data (the only fields set by the bridge
+ * besides the name, which is not known by the host build).
+ */
+#ifndef BLE_ADVDATA_H__
+#define BLE_ADVDATA_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdk_errors.h"
+#include "ble.h"
+
+#define BLE_GAP_AD_TYPE_FLAGS								0x01
+#define BLE_GAP_AD_TYPE_MANUFACTURER_SPECIFIC_DATA			0xFF
+
+typedef enum
+{
+	BLE_ADVDATA_NO_NAME,
+	BLE_ADVDATA_SHORT_NAME,
+	BLE_ADVDATA_FULL_NAME,
+} ble_advdata_name_type_t;
+
+typedef enum
+{
+	BLE_ADVDATA_ROLE_NOT_PRESENT = 0,
+} ble_advdata_le_role_t;
+
+typedef struct
+{
+	uint16_t						size;
+	uint8_t *						p_data;
+} uint8_array_t;
+
+typedef struct
+{
+	uint16_t						uuid_cnt;
+	ble_uuid_t *					p_uuids;
+} ble_advdata_uuid_list_t;
+
+typedef struct
+{
+	uint16_t						min_conn_interval;
+	uint16_t						max_conn_interval;
+} ble_advdata_conn_int_t;
+
+typedef struct
+{
+	uint16_t						company_identifier;
+	uint8_array_t					data;
+} ble_advdata_manuf_data_t;
+
+typedef struct
+{
+	uint16_t						service_uuid;
+	uint8_array_t					data;
+} ble_advdata_service_data_t;
+
+typedef struct
+{
+	uint8_t							tk[16];
+} ble_advdata_tk_value_t;
+
+typedef struct
+{
+	ble_advdata_name_type_t			name_type;
+	uint8_t							short_name_len;
+	bool							include_appearance;
+	uint8_t							flags;
+	int8_t *						p_tx_power_level;
+	ble_advdata_uuid_list_t			uuids_more_available;
+	ble_advdata_uuid_list_t			uuids_complete;
+	ble_advdata_uuid_list_t			uuids_solicited;
+	ble_advdata_conn_int_t *		p_slave_conn_int;
+	ble_advdata_manuf_data_t *		p_manuf_specific_data;
+	ble_advdata_service_data_t *	p_service_data_array;
+	uint8_t							service_data_count;
+	bool							include_ble_device_addr;
+	ble_advdata_le_role_t			le_role;
+	ble_advdata_tk_value_t *		p_tk_value;
+	uint8_t *						p_sec_mgr_oob_flags;
+	void *							p_lesc_data;
+} ble_advdata_t;
+
+ret_code_t ble_advdata_encode(ble_advdata_t const * const p_advdata, uint8_t * const p_encoded_data, uint16_t * const p_len);
+
+#endif
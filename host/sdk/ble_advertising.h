@@ -0,0 +1,98 @@
+/*
+ * Host build: subset of the nRF5 SDK header of the same name (see host/README.md).
+ * Model of the module: the mode is set by ble_advertising_start() (event of the mode to the application), the
+ * connection ends the advertising, the disconnection restarts the fast advertising.
+ */
+#ifndef BLE_ADVERTISING_H__
+#define BLE_ADVERTISING_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdk_config.h"
+#include "sdk_errors.h"
+#include "ble.h"
+#include "ble_advdata.h"
+#include "nrf_sdh_ble.h"
+
+typedef enum
+{
+	BLE_ADV_MODE_IDLE,
+	BLE_ADV_MODE_DIRECTED_HIGH_DUTY,
+	BLE_ADV_MODE_DIRECTED,
+	BLE_ADV_MODE_FAST,
+	BLE_ADV_MODE_SLOW,
+} ble_adv_mode_t;
+
+typedef enum
+{
+	BLE_ADV_EVT_IDLE,
+	BLE_ADV_EVT_DIRECTED_HIGH_DUTY,
+	BLE_ADV_EVT_DIRECTED,
+	BLE_ADV_EVT_FAST,
+	BLE_ADV_EVT_SLOW,
+	BLE_ADV_EVT_FAST_WHITELIST,
+	BLE_ADV_EVT_SLOW_WHITELIST,
+	BLE_ADV_EVT_WHITELIST_REQUEST,
+	BLE_ADV_EVT_PEER_ADDR_REQUEST,
+} ble_adv_evt_t;
+
+typedef struct
+{
+	bool							ble_adv_on_disconnect_disabled;
+	bool							ble_adv_whitelist_enabled;
+	bool							ble_adv_directed_high_duty_enabled;
+	bool							ble_adv_directed_enabled;
+	bool							ble_adv_fast_enabled;
+	bool							ble_adv_slow_enabled;
+	uint32_t						ble_adv_directed_interval;
+	uint32_t						ble_adv_directed_timeout;
+	uint32_t						ble_adv_fast_interval;
+	uint32_t						ble_adv_fast_timeout;
+	uint32_t						ble_adv_slow_interval;
+	uint32_t						ble_adv_slow_timeout;
+	bool							ble_adv_extended_enabled;
+	uint32_t						ble_adv_secondary_phy;
+	uint32_t						ble_adv_primary_phy;
+} ble_adv_modes_config_t;
+
+typedef void (*ble_adv_evt_handler_t)(ble_adv_evt_t const adv_evt);
+typedef void (*ble_adv_error_handler_t)(uint32_t nrf_error);
+
+typedef struct
+{
+	ble_advdata_t					advdata;
+	ble_advdata_t					srdata;
+	ble_adv_modes_config_t			config;
+	ble_adv_evt_handler_t			evt_handler;
+	ble_adv_error_handler_t			error_handler;
+} ble_advertising_init_t;
+
+typedef struct
+{
+	bool							initialized;
+	bool							advertising_start_pending;
+	ble_adv_mode_t					adv_mode_current;
+	ble_adv_modes_config_t			adv_modes_config;
+	uint8_t							conn_cfg_tag;
+	ble_adv_evt_t					adv_evt;
+	ble_adv_evt_handler_t			evt_handler;
+	ble_adv_error_handler_t			error_handler;
+	uint8_t							adv_handle;
+	uint16_t						current_slave_link_conn_handle;
+} ble_advertising_t;
+
+void ble_advertising_on_ble_evt(ble_evt_t const * p_ble_evt, void * p_adv);
+
+#define BLE_ADVERTISING_DEF(_name)																\
+	static ble_advertising_t _name;																\
+	NRF_SDH_BLE_OBSERVER(_name ## _ble_obs, BLE_ADV_BLE_OBSERVER_PRIO, ble_advertising_on_ble_evt, &_name)
+
+uint32_t ble_advertising_init(ble_advertising_t * const p_advertising, ble_advertising_init_t const * const p_init);
+void ble_advertising_conn_cfg_tag_set(ble_advertising_t * const p_advertising, uint8_t ble_cfg_tag);
+uint32_t ble_advertising_start(ble_advertising_t * const p_advertising, ble_adv_mode_t advertising_mode);
+uint32_t ble_advertising_restart_without_whitelist(ble_advertising_t * const p_advertising);
+uint32_t ble_advertising_whitelist_reply(ble_advertising_t * const p_advertising, ble_gap_addr_t const * p_gap_addrs, uint32_t addr_cnt, ble_gap_irk_t const * p_gap_irks, uint32_t irk_cnt);
+uint32_t ble_advertising_peer_addr_reply(ble_advertising_t * const p_advertising, ble_gap_addr_t * p_peer_addr);
+ret_code_t ble_advertising_advdata_update(ble_advertising_t * const p_advertising, ble_advdata_t const * const p_advdata, ble_advdata_t const * const p_srdata);
+
+#endif
@@ -0,0 +1,3 @@
+/*
+ * Host build: the firmware includes this nRF5 SDK header without using it.
+ */
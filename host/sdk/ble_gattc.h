@@ -0,0 +1,4 @@
+/*
+ * Host build: see ble.h.
+ */
+#include "ble.h"
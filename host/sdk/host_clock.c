@@ -0,0 +1,62 @@
+#include <time.h>
+#include "nrf.h"
+#include "host_clock.h"
+
+NRF_RTC_Type host_rtc2;
+CoreDebug_Type host_core_debug;
+static DWT_Type m_dwt;
+
+static bool m_is_virtual = false;
+static uint64_t m_virtual_ns = 0;
+static uint64_t m_origin_ns = 0;
+
+uint64_t host_clock_real_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + (uint64_t) ts.tv_nsec;
+}
+
+void host_clock_virtual_set(bool is_virtual)
+{
+	m_is_virtual = is_virtual;
+	m_virtual_ns = 0;
+	m_origin_ns = host_clock_real_ns();
+	host_clock_sync();
+}
+
+bool host_clock_is_virtual(void)
+{
+	return m_is_virtual;
+}
+
+uint64_t host_clock_ns(void)
+{
+	if (m_is_virtual)
+	{
+		return m_virtual_ns;
+	}
+	if (m_origin_ns == 0)
+	{
+		m_origin_ns = host_clock_real_ns();
+	}
+	return host_clock_real_ns() - m_origin_ns;
+}
+
+void host_clock_advance(uint64_t ns)
+{
+	m_virtual_ns += ns;
+	host_clock_sync();
+}
+
+void host_clock_sync(void)
+{
+	host_rtc2.COUNTER = (uint32_t) ((host_clock_ns() * HOST_CLOCK_RTC_FREQUENCY) / 1000000000ULL) & HOST_CLOCK_RTC_MASK;
+}
+
+DWT_Type * host_dwt(void)
+{
+	m_dwt.CYCCNT = (uint32_t) ((host_clock_real_ns() * (HOST_CPU_FREQUENCY / 1000000UL)) / 1000UL);
+	return &m_dwt;
+}
@@ -0,0 +1,24 @@
+/*
+ * Host build: time base of the RTC (mGetTick), of the app_timer and of the fake SoftDevice.
+ *  - Real time (default): CLOCK_MONOTONIC, used when the bridge talks to another process (PTY harness).
+ *  - Virtual time: advanced by the harness only (host_clock_advance), used by the deterministic tests.
+ * The RTC counter is a copy of the clock (24 bits at 32768 Hz like the nRF52 RTC2), refreshed by host_clock_sync():
+ * the fake transport and the harness refresh it before the firmware code reads it.
+ */
+#ifndef HOST_CLOCK_H
+#define HOST_CLOCK_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define HOST_CLOCK_RTC_FREQUENCY			32768
+#define HOST_CLOCK_RTC_MASK					0x00ffffff
+
+void host_clock_virtual_set(bool is_virtual);
+bool host_clock_is_virtual(void);
+uint64_t host_clock_ns(void);
+void host_clock_advance(uint64_t ns);
+void host_clock_sync(void);
+uint64_t host_clock_real_ns(void);
+
+#endif
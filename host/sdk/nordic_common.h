@@ -0,0 +1,28 @@
+/*
+ * Host build: subset of the nRF5 SDK header of the same name (see host/README.md).
+ */
+#ifndef NORDIC_COMMON_H__
+#define NORDIC_COMMON_H__
+
+#ifndef MIN
+#define MIN(a, b)							((a) < (b) ? (a) : (b))
+#endif
+#ifndef MAX
+#define MAX(a, b)							((a) < (b) ? (b) : (a))
+#endif
+
+#define UNUSED_VARIABLE(X)					((void)(X))
+#define UNUSED_PARAMETER(X)					UNUSED_VARIABLE(X)
+#define UNUSED_RETURN_VALUE(X)				UNUSED_VARIABLE(X)
+
+#define CONCAT_2_(p1, p2)					p1##p2
+#define CONCAT_2(p1, p2)					CONCAT_2_(p1, p2)
+#define CONCAT_3_(p1, p2, p3)				p1##p2##p3
+#define CONCAT_3(p1, p2, p3)				CONCAT_3_(p1, p2, p3)
+#define STRINGIFY_(val)						#val
+#define STRINGIFY(val)						STRINGIFY_(val)
+
+#define BIT_0								0x01
+#define BIT_1								0x02
+
+#endif
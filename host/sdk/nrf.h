@@ -0,0 +1,66 @@
+/*
+ * Host build: subset of the nRF5 SDK header of the same name (see host/README.md).
+ * The registers read by the firmware are host structures: RTC2 COUNTER follows host_clock (host_clock_sync),
+ * DWT CYCCNT counts the host time in 64 MHz cycles (refreshed by each access to DWT).
+ */
+#ifndef NRF_H
+#define NRF_H
+
+#include <stdint.h>
+#include "host_clock.h"
+
+typedef enum
+{
+	RTC1_IRQn = 17,
+	RTC2_IRQn = 36,
+	SPIM1_SPIS1_TWIM1_TWIS1_SPI1_TWI1_IRQn = 4,
+} IRQn_Type;
+
+typedef struct
+{
+	volatile uint32_t				COUNTER;
+} NRF_RTC_Type;
+
+typedef struct
+{
+	volatile uint32_t				OUT;
+	volatile uint32_t				OUTSET;
+	volatile uint32_t				OUTCLR;
+	volatile uint32_t				IN;
+	volatile uint32_t				DIR;
+	volatile uint32_t				DIRSET;
+	volatile uint32_t				DIRCLR;
+} NRF_GPIO_Type;
+
+typedef struct
+{
+	volatile uint32_t				CTRL;
+	volatile uint32_t				CYCCNT;
+} DWT_Type;
+
+typedef struct
+{
+	volatile uint32_t				DEMCR;
+} CoreDebug_Type;
+
+extern NRF_RTC_Type host_rtc2;
+extern NRF_GPIO_Type host_gpio;
+extern CoreDebug_Type host_core_debug;
+DWT_Type * host_dwt(void);
+
+#define NRF_RTC2							(&host_rtc2)
+#define NRF_GPIO							(&host_gpio)
+#define NRF_P0								(&host_gpio)
+#define DWT									(host_dwt())
+#define CoreDebug							(&host_core_debug)
+
+#define CoreDebug_DEMCR_TRCENA_Msk			(1UL << 24)
+#define DWT_CTRL_CYCCNTENA_Msk				(1UL << 0)
+
+#define HOST_CPU_FREQUENCY					64000000UL
+
+#define __NOP()
+#define __WFE()
+#define __SEV()
+
+#endif
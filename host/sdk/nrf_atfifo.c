@@ -0,0 +1,200 @@
+#include <string.h>
+#include "nordic_common.h"
+#include "nrf_atfifo.h"
+
+static uint32_t tag_load(nrf_atfifo_postag_t * p_tag)
+{
+	return __atomic_load_n(&p_tag->tag, __ATOMIC_SEQ_CST);
+}
+
+static bool tag_cas(nrf_atfifo_postag_t * p_tag, nrf_atfifo_postag_t * p_old, nrf_atfifo_postag_t new_tag)
+{
+	return __atomic_compare_exchange_n(&p_tag->tag, &p_old->tag, new_tag.tag, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+}
+
+static uint16_t pos_next(nrf_atfifo_t const * p_fifo, uint16_t pos)
+{
+	pos += p_fifo->item_size;
+	return (pos >= p_fifo->buf_size) ? 0 : pos;
+}
+
+/**@brief Function for reserving the write space of an item (the queue is full if the next position is not freed yet). */
+static bool wspace_req(nrf_atfifo_t * const p_fifo, nrf_atfifo_postag_t * p_old_tail)
+{
+	nrf_atfifo_postag_t new_tail;
+	nrf_atfifo_postag_t head;
+
+	p_old_tail->tag = tag_load(&p_fifo->tail);
+	do
+	{
+		head.tag = tag_load(&p_fifo->head);
+		new_tail = *p_old_tail;
+		new_tail.pos.wr = pos_next(p_fifo, p_old_tail->pos.wr);
+		if (new_tail.pos.wr == head.pos.wr)
+		{
+			return false;
+		}
+	} while (!tag_cas(&p_fifo->tail, p_old_tail, new_tail));
+
+	return true;
+}
+
+/**@brief Function for committing all the allocated items (outermost producer). */
+static void wspace_close(nrf_atfifo_t * const p_fifo)
+{
+	nrf_atfifo_postag_t old_tail;
+	nrf_atfifo_postag_t new_tail;
+
+	old_tail.tag = tag_load(&p_fifo->tail);
+	do
+	{
+		new_tail = old_tail;
+		new_tail.pos.rd = new_tail.pos.wr;
+	} while (!tag_cas(&p_fifo->tail, &old_tail, new_tail));
+}
+
+/**@brief Function for reserving the next committed item (the queue is empty if the read position reached the committed one). */
+static bool rspace_req(nrf_atfifo_t * const p_fifo, nrf_atfifo_postag_t * p_old_head)
+{
+	nrf_atfifo_postag_t new_head;
+	nrf_atfifo_postag_t tail;
+
+	p_old_head->tag = tag_load(&p_fifo->head);
+	do
+	{
+		tail.tag = tag_load(&p_fifo->tail);
+		if (p_old_head->pos.rd == tail.pos.rd)
+		{
+			return false;
+		}
+		new_head = *p_old_head;
+		new_head.pos.rd = pos_next(p_fifo, p_old_head->pos.rd);
+	} while (!tag_cas(&p_fifo->head, p_old_head, new_head));
+
+	return true;
+}
+
+/**@brief Function for freeing all the read items (outermost consumer). */
+static void rspace_close(nrf_atfifo_t * const p_fifo)
+{
+	nrf_atfifo_postag_t old_head;
+	nrf_atfifo_postag_t new_head;
+
+	old_head.tag = tag_load(&p_fifo->head);
+	do
+	{
+		new_head = old_head;
+		new_head.pos.wr = new_head.pos.rd;
+	} while (!tag_cas(&p_fifo->head, &old_head, new_head));
+}
+
+ret_code_t nrf_atfifo_init(nrf_atfifo_t * const p_fifo, void * p_buf, uint16_t buf_size, uint16_t item_size)
+{
+	if ((p_fifo == NULL) || (p_buf == NULL))
+	{
+		return NRF_ERROR_NULL;
+	}
+	if ((item_size == 0) || ((buf_size % item_size) != 0))
+	{
+		return NRF_ERROR_INVALID_LENGTH;
+	}
+
+	p_fifo->p_buf = p_buf;
+	p_fifo->tail.tag = 0;
+	p_fifo->head.tag = 0;
+	p_fifo->buf_size = buf_size;
+	p_fifo->item_size = item_size;
+
+	return NRF_SUCCESS;
+}
+
+ret_code_t nrf_atfifo_clear(nrf_atfifo_t * const p_fifo)
+{
+	nrf_atfifo_postag_t tail;
+
+	tail.tag = tag_load(&p_fifo->tail);
+	if (tail.pos.wr != tail.pos.rd)
+	{
+		return NRF_ERROR_BUSY;
+	}
+	__atomic_store_n(&p_fifo->head.tag, tail.tag, __ATOMIC_SEQ_CST);
+	return NRF_SUCCESS;
+}
+
+void * nrf_atfifo_item_alloc(nrf_atfifo_t * const p_fifo, nrf_atfifo_item_put_t * p_context)
+{
+	if (wspace_req(p_fifo, &p_context->last_tail))
+	{
+		return ((uint8_t *) p_fifo->p_buf) + p_context->last_tail.pos.wr;
+	}
+	return NULL;
+}
+
+bool nrf_atfifo_item_put(nrf_atfifo_t * const p_fifo, nrf_atfifo_item_put_t * p_context)
+{
+	if (p_context->last_tail.pos.wr == p_context->last_tail.pos.rd)
+	{
+		wspace_close(p_fifo);
+		return true;
+	}
+	return false;
+}
+
+ret_code_t nrf_atfifo_alloc_put(nrf_atfifo_t * const p_fifo, void const * p_var, size_t size, bool * const p_visible)
+{
+	nrf_atfifo_item_put_t context;
+	bool visible;
+	void * p_data = nrf_atfifo_item_alloc(p_fifo, &context);
+
+	if (p_data == NULL)
+	{
+		return NRF_ERROR_NO_MEM;
+	}
+
+	memcpy(p_data, p_var, MIN(size, (size_t) p_fifo->item_size));
+	visible = nrf_atfifo_item_put(p_fifo, &context);
+	if (p_visible != NULL)
+	{
+		*p_visible = visible;
+	}
+	return NRF_SUCCESS;
+}
+
+void * nrf_atfifo_item_get(nrf_atfifo_t * const p_fifo, nrf_atfifo_item_get_t * p_context)
+{
+	if (rspace_req(p_fifo, &p_context->last_head))
+	{
+		return ((uint8_t *) p_fifo->p_buf) + p_context->last_head.pos.rd;
+	}
+	return NULL;
+}
+
+bool nrf_atfifo_item_free(nrf_atfifo_t * const p_fifo, nrf_atfifo_item_get_t * p_context)
+{
+	if (p_context->last_head.pos.wr == p_context->last_head.pos.rd)
+	{
+		rspace_close(p_fifo);
+		return true;
+	}
+	return false;
+}
+
+ret_code_t nrf_atfifo_get_free(nrf_atfifo_t * const p_fifo, void * const p_var, size_t size, bool * p_released)
+{
+	nrf_atfifo_item_get_t context;
+	bool released;
+	void const * p_data = nrf_atfifo_item_get(p_fifo, &context);
+
+	if (p_data == NULL)
+	{
+		return NRF_ERROR_NOT_FOUND;
+	}
+
+	memcpy(p_var, p_data, MIN(size, (size_t) p_fifo->item_size));
+	released = nrf_atfifo_item_free(p_fifo, &context);
+	if (p_released != NULL)
+	{
+		*p_released = released;
+	}
+	return NRF_SUCCESS;
+}
@@ -0,0 +1,64 @@
+/*
+ * Host build: nRF5 SDK nrf_atfifo (same API and algorithm). The LDREX / STREX loops of the Cortex-M4 version are
+ * compare-and-swap loops on the same 32-bit position tags (GCC __atomic builtins): the queue can be exercised by a
+ * producer and a consumer running in two threads (host/tests/test_spsc.c).
+ */
+#ifndef NRF_ATFIFO_H__
+#define NRF_ATFIFO_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "sdk_errors.h"
+#include "nordic_common.h"
+
+typedef union
+{
+	struct
+	{
+		uint16_t					wr;
+		uint16_t					rd;
+	} pos;
+	uint32_t						tag;
+} nrf_atfifo_postag_t;
+
+typedef struct
+{
+	void *							p_buf;
+	nrf_atfifo_postag_t				tail;								/**< Producers: wr = allocated, rd = committed. */
+	nrf_atfifo_postag_t				head;								/**< Consumers: rd = read, wr = freed. */
+	uint16_t						buf_size;
+	uint16_t						item_size;
+} nrf_atfifo_t;
+
+typedef struct
+{
+	nrf_atfifo_postag_t				last_tail;
+} nrf_atfifo_item_put_t;
+
+typedef struct
+{
+	nrf_atfifo_postag_t				last_head;
+} nrf_atfifo_item_get_t;
+
+#define NRF_ATFIFO_BUF_NAME(fifo_id)		CONCAT_2(fifo_id, _data)
+#define NRF_ATFIFO_INST_NAME(fifo_id)		CONCAT_2(fifo_id, _inst)
+
+#define NRF_ATFIFO_DEF(fifo_id, storage_type, item_cnt)								\
+	static storage_type NRF_ATFIFO_BUF_NAME(fifo_id)[(item_cnt) + 1];				\
+	static nrf_atfifo_t NRF_ATFIFO_INST_NAME(fifo_id);								\
+	static nrf_atfifo_t * const fifo_id = &NRF_ATFIFO_INST_NAME(fifo_id)
+
+#define NRF_ATFIFO_INIT(fifo_id)													\
+	nrf_atfifo_init(fifo_id, NRF_ATFIFO_BUF_NAME(fifo_id), sizeof(NRF_ATFIFO_BUF_NAME(fifo_id)), sizeof(NRF_ATFIFO_BUF_NAME(fifo_id)[0]))
+
+ret_code_t nrf_atfifo_init(nrf_atfifo_t * const p_fifo, void * p_buf, uint16_t buf_size, uint16_t item_size);
+ret_code_t nrf_atfifo_clear(nrf_atfifo_t * const p_fifo);
+ret_code_t nrf_atfifo_alloc_put(nrf_atfifo_t * const p_fifo, void const * p_var, size_t size, bool * const p_visible);
+void * nrf_atfifo_item_alloc(nrf_atfifo_t * const p_fifo, nrf_atfifo_item_put_t * p_context);
+bool nrf_atfifo_item_put(nrf_atfifo_t * const p_fifo, nrf_atfifo_item_put_t * p_context);
+ret_code_t nrf_atfifo_get_free(nrf_atfifo_t * const p_fifo, void * const p_var, size_t size, bool * p_released);
+void * nrf_atfifo_item_get(nrf_atfifo_t * const p_fifo, nrf_atfifo_item_get_t * p_context);
+bool nrf_atfifo_item_free(nrf_atfifo_t * const p_fifo, nrf_atfifo_item_get_t * p_context);
+
+#endif
@@ -0,0 +1,21 @@
+/*
+ * Host build: subset of the nRF5 SDK header of the same name (see host/README.md).
+ */
+#ifndef NRF_BLE_GATT_H__
+#define NRF_BLE_GATT_H__
+
+#include <stdint.h>
+#include "sdk_errors.h"
+
+typedef struct
+{
+	uint16_t						att_mtu_desired_periph;
+} nrf_ble_gatt_t;
+
+typedef void (*nrf_ble_gatt_evt_handler_t)(nrf_ble_gatt_t * p_gatt, void const * p_evt);
+
+#define NRF_BLE_GATT_DEF(_name)				static nrf_ble_gatt_t _name
+
+ret_code_t nrf_ble_gatt_init(nrf_ble_gatt_t * p_gatt, nrf_ble_gatt_evt_handler_t evt_handler);
+
+#endif
@@ -0,0 +1,40 @@
+/*
+ * Host build: subset of the nRF5 SDK header of the same name (see host/README.md).
+ * host_gpiote_input_set() changes the level of an input pin and calls its handler (button press of a test).
+ */
+#ifndef NRF_DRV_GPIOTE_H__
+#define NRF_DRV_GPIOTE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdk_errors.h"
+#include "nrf_gpio.h"
+
+typedef uint32_t nrf_drv_gpiote_pin_t;
+
+typedef enum
+{
+	NRF_GPIOTE_POLARITY_LOTOHI = 1,
+	NRF_GPIOTE_POLARITY_HITOLO = 2,
+	NRF_GPIOTE_POLARITY_TOGGLE = 3,
+} nrf_gpiote_polarity_t;
+
+typedef struct
+{
+	nrf_gpiote_polarity_t			sense;
+	nrf_gpio_pin_pull_t				pull;
+	bool							is_watcher;
+	bool							hi_accuracy;
+} nrf_drv_gpiote_in_config_t;
+
+typedef void (*nrf_drv_gpiote_evt_handler_t)(nrf_drv_gpiote_pin_t pin, nrf_gpiote_polarity_t action);
+
+bool nrf_drv_gpiote_is_init(void);
+ret_code_t nrf_drv_gpiote_init(void);
+ret_code_t nrf_drv_gpiote_in_init(nrf_drv_gpiote_pin_t pin, nrf_drv_gpiote_in_config_t const * p_config, nrf_drv_gpiote_evt_handler_t evt_handler);
+void nrf_drv_gpiote_in_event_enable(nrf_drv_gpiote_pin_t pin, bool int_enable);
+bool nrf_drv_gpiote_in_is_set(nrf_drv_gpiote_pin_t pin);
+
+void host_gpiote_input_set(nrf_drv_gpiote_pin_t pin, bool level);
+
+#endif
@@ -0,0 +1,45 @@
+/*
+ * Host build: subset of the nRF5 SDK header of the same name (see host/README.md).
+ */
+#ifndef NRF_DRV_RTC_H__
+#define NRF_DRV_RTC_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdk_config.h"
+#include "sdk_errors.h"
+#include "nrf.h"
+
+#define NRFX_CONCAT_2_(p1, p2)				p1 ## p2
+#define NRFX_CONCAT_2(p1, p2)				NRFX_CONCAT_2_(p1, p2)
+#define NRFX_CONCAT_3_(p1, p2, p3)			p1 ## p2 ## p3
+#define NRFX_CONCAT_3(p1, p2, p3)			NRFX_CONCAT_3_(p1, p2, p3)
+
+#define NRF_RTC_CC_CHANNEL_COUNT(id)		4
+#define NRFX_RTC_US_TO_TICKS(us, freq)		((((uint64_t) (us)) * (freq)) / 1000000U)
+
+typedef struct
+{
+	NRF_RTC_Type *					p_reg;
+	IRQn_Type						irq;
+	uint8_t							instance_id;
+	uint8_t							cc_channel_count;
+} nrfx_rtc_t;
+
+typedef nrfx_rtc_t nrf_drv_rtc_t;
+
+typedef struct
+{
+	uint16_t						prescaler;
+	uint8_t							interrupt_priority;
+	uint8_t							tick_latency;
+	bool							reliable;
+} nrf_drv_rtc_config_t;
+
+typedef void (*nrf_drv_rtc_handler_t)(uint32_t int_type);
+
+ret_code_t nrf_drv_rtc_init(nrf_drv_rtc_t const * p_instance, nrf_drv_rtc_config_t const * p_config, nrf_drv_rtc_handler_t handler);
+void nrf_drv_rtc_tick_enable(nrf_drv_rtc_t const * p_instance, bool enable_irq);
+void nrf_drv_rtc_enable(nrf_drv_rtc_t const * p_instance);
+
+#endif
@@ -0,0 +1,59 @@
+/*
+ * Host build: subset of the nRF5 SDK header of the same name (see host/README.md).
+ * The pins are the bits of host_gpio (OUT, DIR and IN which are all high by default: pull-up, buttons released).
+ */
+#ifndef NRF_GPIO_H__
+#define NRF_GPIO_H__
+
+#include <stdint.h>
+#include "nrf.h"
+
+typedef enum
+{
+	NRF_GPIO_PIN_NOPULL   = 0,
+	NRF_GPIO_PIN_PULLDOWN = 1,
+	NRF_GPIO_PIN_PULLUP   = 3,
+} nrf_gpio_pin_pull_t;
+
+static inline void nrf_gpio_cfg_output(uint32_t pin_number)
+{
+	host_gpio.DIR |= (1UL << pin_number);
+}
+
+static inline void nrf_gpio_cfg_input(uint32_t pin_number, nrf_gpio_pin_pull_t pull_config)
+{
+	(void) pull_config;
+	host_gpio.DIR &= ~(1UL << pin_number);
+}
+
+static inline void nrf_gpio_pin_set(uint32_t pin_number)
+{
+	host_gpio.OUT |= (1UL << pin_number);
+}
+
+static inline void nrf_gpio_pin_clear(uint32_t pin_number)
+{
+	host_gpio.OUT &= ~(1UL << pin_number);
+}
+
+static inline void nrf_gpio_pin_toggle(uint32_t pin_number)
+{
+	host_gpio.OUT ^= (1UL << pin_number);
+}
+
+static inline void nrf_gpio_pin_write(uint32_t pin_number, uint32_t value)
+{
+	(value) ? nrf_gpio_pin_set(pin_number) : nrf_gpio_pin_clear(pin_number);
+}
+
+static inline uint32_t nrf_gpio_pin_read(uint32_t pin_number)
+{
+	return (host_gpio.IN >> pin_number) & 1UL;
+}
+
+static inline uint32_t nrf_gpio_pin_out_read(uint32_t pin_number)
+{
+	return (host_gpio.OUT >> pin_number) & 1UL;
+}
+
+#endif
@@ -0,0 +1,37 @@
+/*
+ * Host build: subset of the nRF5 SDK header of the same name (see host/README.md).
+ * The logs are printed on stderr at or above the level set by host_log_level_set() (errors only by default).
+ */
+#ifndef NRF_LOG_H__
+#define NRF_LOG_H__
+
+#include <stdint.h>
+
+typedef enum
+{
+	HOST_LOG_LEVEL_NONE,
+	HOST_LOG_LEVEL_ERROR,
+	HOST_LOG_LEVEL_WARNING,
+	HOST_LOG_LEVEL_INFO,
+	HOST_LOG_LEVEL_DEBUG,
+} host_log_level_t;
+
+void host_log(host_log_level_t level, char const * p_format, ...);
+void host_log_level_set(host_log_level_t level);
+
+#define NRF_LOG_ERROR(...)					host_log(HOST_LOG_LEVEL_ERROR, __VA_ARGS__)
+#define NRF_LOG_WARNING(...)				host_log(HOST_LOG_LEVEL_WARNING, __VA_ARGS__)
+#define NRF_LOG_INFO(...)					host_log(HOST_LOG_LEVEL_INFO, __VA_ARGS__)
+#define NRF_LOG_DEBUG(...)					host_log(HOST_LOG_LEVEL_DEBUG, __VA_ARGS__)
+#define NRF_LOG_HEXDUMP_INFO(p_data, len)	((void) (p_data), (void) (len))
+#define NRF_LOG_HEXDUMP_DEBUG(p_data, len)	((void) (p_data), (void) (len))
+#define NRF_LOG_PUSH(_str)					(_str)
+#define NRF_LOG_PROCESS()					false
+#define NRF_LOG_FLUSH()
+
+#define NRF_LOG_FLOAT_MARKER				"%s%d.%02d"
+#define NRF_LOG_FLOAT(val)					(((val) < 0 && (val) > -1.0) ? "-" : ""),					\
+											(int) (val),												\
+											(int) ((((val) > 0) ? (val) - (int) (val) : (int) (val) - (val)) * 100)
+
+#endif
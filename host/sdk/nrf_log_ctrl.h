@@ -0,0 +1,11 @@
+/*
+ * Host build: subset of the nRF5 SDK header of the same name (see host/README.md).
+ */
+#ifndef NRF_LOG_CTRL_H__
+#define NRF_LOG_CTRL_H__
+
+#include "nrf_error.h"
+
+#define NRF_LOG_INIT(timestamp_func)		NRF_SUCCESS
+
+#endif
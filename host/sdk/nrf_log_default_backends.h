@@ -0,0 +1,9 @@
+/*
+ * Host build: subset of the nRF5 SDK header of the same name (see host/README.md).
+ */
+#ifndef NRF_LOG_DEFAULT_BACKENDS_H__
+#define NRF_LOG_DEFAULT_BACKENDS_H__
+
+#define NRF_LOG_DEFAULT_BACKENDS_INIT()
+
+#endif
@@ -0,0 +1,12 @@
+/*
+ * Host build: subset of the nRF5 SDK header of the same name (see host/README.md).
+ */
+#ifndef NRF_PWR_MGMT_H__
+#define NRF_PWR_MGMT_H__
+
+#include "sdk_errors.h"
+
+ret_code_t nrf_pwr_mgmt_init(void);
+void nrf_pwr_mgmt_run(void);
+
+#endif
@@ -0,0 +1,11 @@
+/*
+ * Host build: subset of the nRF5 SDK header of the same name (see host/README.md).
+ */
+#ifndef NRF_SDH_H__
+#define NRF_SDH_H__
+
+#include "sdk_errors.h"
+
+ret_code_t nrf_sdh_enable_request(void);
+
+#endif
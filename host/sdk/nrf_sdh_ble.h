@@ -0,0 +1,37 @@
+/*
+ * Host build: subset of the nRF5 SDK header of the same name (see host/README.md).
+ * The observers are registered in the section sdh_ble_observers like on the target (the macro is valid in a function
+ * as well), host_sdh_ble_evt_dispatch() calls them by increasing priority like the SoftDevice handler.
+ */
+#ifndef NRF_SDH_BLE_H__
+#define NRF_SDH_BLE_H__
+
+#include <stdint.h>
+#include "sdk_config.h"
+#include "sdk_errors.h"
+#include "ble.h"
+
+typedef void (*nrf_sdh_ble_evt_handler_t)(ble_evt_t const * p_ble_evt, void * p_context);
+
+typedef struct
+{
+	uint8_t							prio;
+	nrf_sdh_ble_evt_handler_t		handler;
+	void *							p_context;
+} nrf_sdh_ble_evt_observer_t;
+
+#define NRF_SDH_BLE_OBSERVER(_name, _prio, _handler, _context)								\
+	static nrf_sdh_ble_evt_observer_t const _name											\
+	__attribute__((section("sdh_ble_observers"), used, aligned(8))) =						\
+	{																						\
+		.prio = (_prio),																	\
+		.handler = (_handler),																\
+		.p_context = (_context),															\
+	}
+
+ret_code_t nrf_sdh_ble_default_cfg_set(uint8_t conn_cfg_tag, uint32_t * p_ram_start);
+ret_code_t nrf_sdh_ble_enable(uint32_t * p_app_ram_start);
+
+void host_sdh_ble_evt_dispatch(ble_evt_t const * p_ble_evt);
+
+#endif
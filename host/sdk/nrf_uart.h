@@ -0,0 +1,10 @@
+/*
+ * Host build: subset of the nRF5 SDK header of the same name (see host/README.md).
+ */
+#ifndef NRF_UART_H__
+#define NRF_UART_H__
+
+#define NRF_UART_BAUDRATE_115200			0x01D7E000UL
+#define NRF_UART_BAUDRATE_1000000			0x10000000UL
+
+#endif
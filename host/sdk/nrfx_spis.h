@@ -0,0 +1,25 @@
+/*
+ * Host build: subset of the nRF5 SDK header of the same name (see host/README.md). The SPIS back end is only built
+ * if SPIS_CSN_PIN is defined (never on the host build): the types are declared for completeness.
+ */
+#ifndef NRFX_SPIS_H__
+#define NRFX_SPIS_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include "sdk_errors.h"
+
+typedef enum
+{
+	NRFX_SPIS_BUFFERS_SET_DONE,
+	NRFX_SPIS_XFER_DONE,
+} nrfx_spis_evt_type_t;
+
+typedef struct
+{
+	nrfx_spis_evt_type_t			evt_type;
+	size_t							rx_amount;
+	size_t							tx_amount;
+} nrfx_spis_evt_t;
+
+#endif
@@ -0,0 +1,55 @@
+/*
+ * Host build: subset of the nRF5 SDK header of the same name (see host/README.md). No bond is ever stored.
+ */
+#ifndef PEER_MANAGER_H__
+#define PEER_MANAGER_H__
+
+#include <stdint.h>
+#include "sdk_errors.h"
+#include "ble.h"
+
+typedef uint16_t pm_peer_id_t;
+
+#define PM_PEER_ID_INVALID					0xFFFF
+
+typedef enum
+{
+	PM_EVT_BONDED_PEER_CONNECTED,
+	PM_EVT_CONN_SEC_START,
+	PM_EVT_CONN_SEC_SUCCEEDED,
+	PM_EVT_CONN_SEC_FAILED,
+	PM_EVT_LOCAL_DB_CACHE_APPLIED,
+	PM_EVT_PEERS_DELETE_SUCCEEDED,
+} pm_evt_id_t;
+
+typedef struct
+{
+	pm_evt_id_t						evt_id;
+	uint16_t						conn_handle;
+	pm_peer_id_t					peer_id;
+} pm_evt_t;
+
+typedef struct
+{
+	ble_gap_irk_t					id_info;
+	ble_gap_addr_t					id_addr_info;
+} ble_gap_id_key_t;
+
+typedef struct
+{
+	uint8_t							own_role;
+	ble_gap_id_key_t				peer_ble_id;
+} pm_peer_data_bonding_t;
+
+typedef void (*pm_evt_handler_t)(pm_evt_t const * p_event);
+
+ret_code_t pm_init(void);
+ret_code_t pm_sec_params_set(ble_gap_sec_params_t * p_sec_params);
+ret_code_t pm_register(pm_evt_handler_t event_handler);
+ret_code_t pm_whitelist_set(pm_peer_id_t const * p_peers, uint32_t peer_cnt);
+ret_code_t pm_whitelist_get(ble_gap_addr_t * p_addrs, uint32_t * p_addr_cnt, ble_gap_irk_t * p_irks, uint32_t * p_irk_cnt);
+ret_code_t pm_peer_rank_highest(pm_peer_id_t peer_id);
+ret_code_t pm_peer_ranks_get(pm_peer_id_t * p_highest_ranked_peer, uint32_t * p_highest_rank, pm_peer_id_t * p_lowest_ranked_peer, uint32_t * p_lowest_rank);
+ret_code_t pm_peer_data_bonding_load(pm_peer_id_t peer_id, pm_peer_data_bonding_t * p_data);
+
+#endif
@@ -0,0 +1,12 @@
+/*
+ * Host build: subset of the nRF5 SDK header of the same name (see host/README.md).
+ */
+#ifndef PEER_MANAGER_HANDLER_H__
+#define PEER_MANAGER_HANDLER_H__
+
+#include "peer_manager.h"
+
+void pm_handler_on_pm_evt(pm_evt_t const * p_pm_evt);
+void pm_handler_flash_clean(pm_evt_t const * p_pm_evt);
+
+#endif
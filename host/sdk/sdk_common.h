@@ -0,0 +1,19 @@
+/*
+ * Host build: subset of the nRF5 SDK header of the same name (see host/README.md).
+ * The configuration is the one of the firmware (pca10040/s132/config/sdk_config.h).
+ */
+#ifndef SDK_COMMON_H__
+#define SDK_COMMON_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "sdk_config.h"
+#include "nordic_common.h"
+#include "sdk_errors.h"
+#include "sdk_macros.h"
+#include "app_util.h"
+#include "app_error.h"
+
+#endif
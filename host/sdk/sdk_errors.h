@@ -0,0 +1,16 @@
+/*
+ * Host build: subset of the nRF5 SDK header of the same name (see host/README.md).
+ */
+#ifndef SDK_ERRORS_H__
+#define SDK_ERRORS_H__
+
+#include <stdint.h>
+#include "nrf_error.h"
+
+typedef uint32_t ret_code_t;
+
+#define NRFX_SUCCESS						NRF_SUCCESS
+#define NRFX_ERROR_NO_MEM					NRF_ERROR_NO_MEM
+#define NRFX_ERROR_INVALID_STATE			NRF_ERROR_INVALID_STATE
+
+#endif
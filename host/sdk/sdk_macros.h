@@ -0,0 +1,28 @@
+/*
+ * Host build: subset of the nRF5 SDK header of the same name (see host/README.md).
+ */
+#ifndef SDK_MACROS_H__
+#define SDK_MACROS_H__
+
+#include "nrf_error.h"
+
+#define VERIFY_SUCCESS(statement)					\
+	do												\
+	{												\
+		uint32_t _err_code = (uint32_t) (statement);	\
+		if (_err_code != NRF_SUCCESS)				\
+		{											\
+			return _err_code;						\
+		}											\
+	} while (0)
+
+#define VERIFY_PARAM_NOT_NULL(param)				\
+	do												\
+	{												\
+		if ((param) == NULL)						\
+		{											\
+			return NRF_ERROR_NULL;					\
+		}											\
+	} while (0)
+
+#endif
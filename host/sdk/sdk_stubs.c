@@ -0,0 +1,634 @@
+/*
+ * Host build: implementations of the nRF5 SDK modules used by the bridge (see host/README.md).
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include "sdk_common.h"
+#include "nrf.h"
+#include "nrf_log.h"
+#include "nrf_gpio.h"
+#include "nrf_drv_gpiote.h"
+#include "nrf_drv_rtc.h"
+#include "app_timer.h"
+#include "app_fifo.h"
+#include "app_uart.h"
+#include "nrf_sdh.h"
+#include "nrf_sdh_ble.h"
+#include "ble_advdata.h"
+#include "ble_advertising.h"
+#include "peer_manager.h"
+#include "peer_manager_handler.h"
+#include "nrf_ble_gatt.h"
+#include "nrf_ble_qwr.h"
+#include "nrf_pwr_mgmt.h"
+#include "ble_conn_params.h"
+
+NRF_GPIO_Type host_gpio = {.IN = 0xffffffff};
+uint8_t __data_start__;
+
+/* app_error */
+
+static host_app_error_hook_t m_app_error_hook = NULL;
+
+void host_app_error_hook_set(host_app_error_hook_t hook)
+{
+	m_app_error_hook = hook;
+}
+
+void app_error_handler(ret_code_t error_code, uint32_t line_num, const uint8_t * p_file_name)
+{
+	if (m_app_error_hook != NULL)
+	{
+		m_app_error_hook(error_code, line_num, p_file_name);
+	}
+	fprintf(stderr, "app_error_handler: error 0x%x at %s:%u\n", (unsigned) error_code, (char const *) p_file_name, (unsigned) line_num);
+	abort();
+}
+
+/* nrf_log */
+
+static host_log_level_t m_log_level = HOST_LOG_LEVEL_ERROR;
+
+void host_log_level_set(host_log_level_t level)
+{
+	m_log_level = level;
+}
+
+void host_log(host_log_level_t level, char const * p_format, ...)
+{
+	va_list args;
+
+	if (level > m_log_level)
+	{
+		return;
+	}
+	va_start(args, p_format);
+	vfprintf(stderr, p_format, args);
+	va_end(args);
+	fputc('\n', stderr);
+}
+
+/* nrf_drv_rtc */
+
+ret_code_t nrf_drv_rtc_init(nrf_drv_rtc_t const * p_instance, nrf_drv_rtc_config_t const * p_config, nrf_drv_rtc_handler_t handler)
+{
+	host_clock_sync();
+	return NRF_SUCCESS;
+}
+
+void nrf_drv_rtc_tick_enable(nrf_drv_rtc_t const * p_instance, bool enable_irq)
+{
+}
+
+void nrf_drv_rtc_enable(nrf_drv_rtc_t const * p_instance)
+{
+}
+
+/* nrf_drv_gpiote */
+
+#define GPIOTE_PIN_COUNT					32
+
+static bool m_gpiote_is_init = false;
+static nrf_drv_gpiote_evt_handler_t m_gpiote_handlers[GPIOTE_PIN_COUNT];
+
+bool nrf_drv_gpiote_is_init(void)
+{
+	return m_gpiote_is_init;
+}
+
+ret_code_t nrf_drv_gpiote_init(void)
+{
+	m_gpiote_is_init = true;
+	return NRF_SUCCESS;
+}
+
+ret_code_t nrf_drv_gpiote_in_init(nrf_drv_gpiote_pin_t pin, nrf_drv_gpiote_in_config_t const * p_config, nrf_drv_gpiote_evt_handler_t evt_handler)
+{
+	if (pin >= GPIOTE_PIN_COUNT)
+	{
+		return NRF_ERROR_INVALID_PARAM;
+	}
+	m_gpiote_handlers[pin] = evt_handler;
+	return NRF_SUCCESS;
+}
+
+void nrf_drv_gpiote_in_event_enable(nrf_drv_gpiote_pin_t pin, bool int_enable)
+{
+}
+
+bool nrf_drv_gpiote_in_is_set(nrf_drv_gpiote_pin_t pin)
+{
+	return nrf_gpio_pin_read(pin) != 0;
+}
+
+void host_gpiote_input_set(nrf_drv_gpiote_pin_t pin, bool level)
+{
+	if (level == (nrf_gpio_pin_read(pin) != 0))
+	{
+		return;
+	}
+	host_gpio.IN ^= (1UL << pin);
+	if ((pin < GPIOTE_PIN_COUNT) && (m_gpiote_handlers[pin] != NULL))
+	{
+		m_gpiote_handlers[pin](pin, NRF_GPIOTE_POLARITY_TOGGLE);
+	}
+}
+
+/* app_timer */
+
+static app_timer_t * mp_timers = NULL;
+
+ret_code_t app_timer_init(void)
+{
+	return NRF_SUCCESS;
+}
+
+ret_code_t app_timer_create(app_timer_id_t const * p_timer_id, app_timer_mode_t mode, app_timer_timeout_handler_t timeout_handler)
+{
+	app_timer_t * p_timer = *p_timer_id;
+
+	if (timeout_handler == NULL)
+	{
+		return NRF_ERROR_INVALID_PARAM;
+	}
+	if (!p_timer->is_created)
+	{
+		p_timer->p_next = mp_timers;
+		mp_timers = p_timer;
+	}
+	p_timer->handler = timeout_handler;
+	p_timer->mode = mode;
+	p_timer->is_created = true;
+	p_timer->is_running = false;
+	return NRF_SUCCESS;
+}
+
+ret_code_t app_timer_start(app_timer_id_t timer_id, uint32_t timeout_ticks, void * p_context)
+{
+	uint64_t period_ns = ((uint64_t) timeout_ticks * (APP_TIMER_CONFIG_RTC_FREQUENCY + 1) * 1000000000ULL) / APP_TIMER_CLOCK_FREQ;
+
+	if (!timer_id->is_created)
+	{
+		return NRF_ERROR_INVALID_STATE;
+	}
+	if (timeout_ticks < APP_TIMER_MIN_TIMEOUT_TICKS)
+	{
+		return NRF_ERROR_INVALID_PARAM;
+	}
+	if (timer_id->is_running)
+	{
+		// The SDK ignores a start of a running timer.
+		return NRF_SUCCESS;
+	}
+	timer_id->period_ns = period_ns;
+	timer_id->expiry_ns = host_clock_ns() + period_ns;
+	timer_id->p_context = p_context;
+	timer_id->is_running = true;
+	return NRF_SUCCESS;
+}
+
+ret_code_t app_timer_stop(app_timer_id_t timer_id)
+{
+	timer_id->is_running = false;
+	return NRF_SUCCESS;
+}
+
+void app_timer_process(void)
+{
+	uint64_t now = host_clock_ns();
+	app_timer_t * p_timer;
+
+	for (p_timer = mp_timers ; p_timer != NULL ; p_timer = p_timer->p_next)
+	{
+		if (p_timer->is_running && (p_timer->expiry_ns <= now))
+		{
+			if (p_timer->mode == APP_TIMER_MODE_REPEATED)
+			{
+				p_timer->expiry_ns += p_timer->period_ns;
+			}
+			else
+			{
+				p_timer->is_running = false;
+			}
+			p_timer->handler(p_timer->p_context);
+		}
+	}
+}
+
+uint64_t host_app_timer_next_expiry_ns(void)
+{
+	uint64_t next = UINT64_MAX;
+	app_timer_t * p_timer;
+
+	for (p_timer = mp_timers ; p_timer != NULL ; p_timer = p_timer->p_next)
+	{
+		if (p_timer->is_running && (p_timer->expiry_ns < next))
+		{
+			next = p_timer->expiry_ns;
+		}
+	}
+	return next;
+}
+
+/* app_fifo */
+
+static uint32_t fifo_length(app_fifo_t * p_fifo)
+{
+	return p_fifo->write_pos - p_fifo->read_pos;
+}
+
+uint32_t app_fifo_init(app_fifo_t * p_fifo, uint8_t * p_buf, uint16_t buf_size)
+{
+	if (p_buf == NULL)
+	{
+		return NRF_ERROR_NULL;
+	}
+	if (!IS_POWER_OF_TWO(buf_size))
+	{
+		return NRF_ERROR_INVALID_LENGTH;
+	}
+	p_fifo->p_buf = p_buf;
+	p_fifo->buf_size_mask = buf_size - 1;
+	p_fifo->read_pos = 0;
+	p_fifo->write_pos = 0;
+	return NRF_SUCCESS;
+}
+
+uint32_t app_fifo_put(app_fifo_t * p_fifo, uint8_t byte)
+{
+	if (fifo_length(p_fifo) > p_fifo->buf_size_mask)
+	{
+		return NRF_ERROR_NO_MEM;
+	}
+	p_fifo->p_buf[p_fifo->write_pos & p_fifo->buf_size_mask] = byte;
+	p_fifo->write_pos++;
+	return NRF_SUCCESS;
+}
+
+uint32_t app_fifo_get(app_fifo_t * p_fifo, uint8_t * p_byte)
+{
+	if (fifo_length(p_fifo) == 0)
+	{
+		return NRF_ERROR_NOT_FOUND;
+	}
+	*p_byte = p_fifo->p_buf[p_fifo->read_pos & p_fifo->buf_size_mask];
+	p_fifo->read_pos++;
+	return NRF_SUCCESS;
+}
+
+uint32_t app_fifo_peek(app_fifo_t * p_fifo, uint16_t index, uint8_t * p_byte_out)
+{
+	if (fifo_length(p_fifo) <= index)
+	{
+		return NRF_ERROR_NOT_FOUND;
+	}
+	*p_byte_out = p_fifo->p_buf[(p_fifo->read_pos + index) & p_fifo->buf_size_mask];
+	return NRF_SUCCESS;
+}
+
+uint32_t app_fifo_flush(app_fifo_t * p_fifo)
+{
+	p_fifo->read_pos = p_fifo->write_pos;
+	return NRF_SUCCESS;
+}
+
+uint32_t app_fifo_read(app_fifo_t * p_fifo, uint8_t * p_byte_array, uint32_t * p_size)
+{
+	uint32_t available = fifo_length(p_fifo);
+	uint32_t requested = *p_size;
+	uint32_t i;
+
+	*p_size = MIN(requested, available);
+	if (p_byte_array == NULL)
+	{
+		// Size request: the whole content is returned.
+		*p_size = available;
+		return NRF_SUCCESS;
+	}
+	if (available == 0)
+	{
+		return NRF_ERROR_NOT_FOUND;
+	}
+	for (i = 0 ; i < *p_size ; i++)
+	{
+		(void) app_fifo_get(p_fifo, &p_byte_array[i]);
+	}
+	return NRF_SUCCESS;
+}
+
+uint32_t app_fifo_write(app_fifo_t * p_fifo, uint8_t const * p_byte_array, uint32_t * p_size)
+{
+	uint32_t available = (p_fifo->buf_size_mask + 1) - fifo_length(p_fifo);
+	uint32_t requested = *p_size;
+	uint32_t i;
+
+	*p_size = MIN(requested, available);
+	if (p_byte_array == NULL)
+	{
+		// Size request: the whole free space is returned.
+		*p_size = available;
+		return NRF_SUCCESS;
+	}
+	if (available == 0)
+	{
+		return NRF_ERROR_NO_MEM;
+	}
+	for (i = 0 ; i < *p_size ; i++)
+	{
+		(void) app_fifo_put(p_fifo, p_byte_array[i]);
+	}
+	return NRF_SUCCESS;
+}
+
+/* app_uart: the line is the fake transport (host/fake_uart.c), only the event handler is kept. */
+
+static app_uart_event_handler_t m_app_uart_handler = NULL;
+
+uint32_t app_uart_init(app_uart_comm_params_t const * p_comm_params, app_uart_buffers_t * p_buffers, app_uart_event_handler_t error_handler, uint8_t irq_priority)
+{
+	m_app_uart_handler = error_handler;
+	return NRF_SUCCESS;
+}
+
+uint32_t app_uart_put(uint8_t byte)
+{
+	return NRF_ERROR_NO_MEM;
+}
+
+uint32_t app_uart_get(uint8_t * p_byte)
+{
+	return NRF_ERROR_NOT_FOUND;
+}
+
+void host_app_uart_evt(app_uart_evt_type_t evt_type)
+{
+	app_uart_evt_t evt = {.evt_type = evt_type};
+
+	if (m_app_uart_handler != NULL)
+	{
+		m_app_uart_handler(&evt);
+	}
+}
+
+/* nrf_sdh / nrf_sdh_ble */
+
+extern nrf_sdh_ble_evt_observer_t const __start_sdh_ble_observers[];
+extern nrf_sdh_ble_evt_observer_t const __stop_sdh_ble_observers[];
+
+ret_code_t nrf_sdh_enable_request(void)
+{
+	return NRF_SUCCESS;
+}
+
+ret_code_t nrf_sdh_ble_default_cfg_set(uint8_t conn_cfg_tag, uint32_t * p_ram_start)
+{
+	*p_ram_start = (uint32_t) (uintptr_t) &__data_start__;
+	return NRF_SUCCESS;
+}
+
+ret_code_t nrf_sdh_ble_enable(uint32_t * p_app_ram_start)
+{
+	*p_app_ram_start = (uint32_t) (uintptr_t) &__data_start__;
+	return NRF_SUCCESS;
+}
+
+void host_sdh_ble_evt_dispatch(ble_evt_t const * p_ble_evt)
+{
+	nrf_sdh_ble_evt_observer_t const * p_observer;
+	uint8_t prio;
+
+	for (prio = 0 ; prio < NRF_SDH_BLE_OBSERVER_PRIO_LEVELS ; prio++)
+	{
+		for (p_observer = __start_sdh_ble_observers ; p_observer < __stop_sdh_ble_observers ; p_observer++)
+		{
+			if ((p_observer->prio == prio) && (p_observer->handler != NULL))
+			{
+				p_observer->handler(p_ble_evt, p_observer->p_context);
+			}
+		}
+	}
+}
+
+/* ble_advdata */
+
+ret_code_t ble_advdata_encode(ble_advdata_t const * const p_advdata, uint8_t * const p_encoded_data, uint16_t * const p_len)
+{
+	uint16_t max_len = *p_len;
+	uint16_t len = 0;
+
+	if (p_advdata->flags != 0)
+	{
+		if ((len + 3) > max_len)
+		{
+			return NRF_ERROR_DATA_SIZE;
+		}
+		p_encoded_data[len++] = 2;
+		p_encoded_data[len++] = BLE_GAP_AD_TYPE_FLAGS;
+		p_encoded_data[len++] = p_advdata->flags;
+	}
+	if (p_advdata->p_manuf_specific_data != NULL)
+	{
+		ble_advdata_manuf_data_t const * p_manuf = p_advdata->p_manuf_specific_data;
+
+		if ((len + 4 + p_manuf->data.size) > max_len)
+		{
+			return NRF_ERROR_DATA_SIZE;
+		}
+		p_encoded_data[len++] = 3 + p_manuf->data.size;
+		p_encoded_data[len++] = BLE_GAP_AD_TYPE_MANUFACTURER_SPECIFIC_DATA;
+		p_encoded_data[len++] = p_manuf->company_identifier & 0xff;
+		p_encoded_data[len++] = p_manuf->company_identifier >> 8;
+		memcpy(&p_encoded_data[len], p_manuf->data.p_data, p_manuf->data.size);
+		len += p_manuf->data.size;
+	}
+	*p_len = len;
+	return NRF_SUCCESS;
+}
+
+/* ble_advertising */
+
+static void advertising_evt(ble_advertising_t * const p_advertising, ble_adv_evt_t evt)
+{
+	p_advertising->adv_evt = evt;
+	if (p_advertising->evt_handler != NULL)
+	{
+		p_advertising->evt_handler(evt);
+	}
+}
+
+uint32_t ble_advertising_init(ble_advertising_t * const p_advertising, ble_advertising_init_t const * const p_init)
+{
+	memset(p_advertising, 0, sizeof(*p_advertising));
+	p_advertising->initialized = true;
+	p_advertising->adv_mode_current = BLE_ADV_MODE_IDLE;
+	p_advertising->adv_modes_config = p_init->config;
+	p_advertising->evt_handler = p_init->evt_handler;
+	p_advertising->error_handler = p_init->error_handler;
+	p_advertising->adv_handle = BLE_GAP_ADV_SET_HANDLE_NOT_SET;
+	p_advertising->current_slave_link_conn_handle = BLE_CONN_HANDLE_INVALID;
+	return NRF_SUCCESS;
+}
+
+void ble_advertising_conn_cfg_tag_set(ble_advertising_t * const p_advertising, uint8_t ble_cfg_tag)
+{
+	p_advertising->conn_cfg_tag = ble_cfg_tag;
+}
+
+uint32_t ble_advertising_start(ble_advertising_t * const p_advertising, ble_adv_mode_t advertising_mode)
+{
+	if (!p_advertising->initialized)
+	{
+		return NRF_ERROR_INVALID_STATE;
+	}
+	if ((advertising_mode == BLE_ADV_MODE_DIRECTED_HIGH_DUTY) && !p_advertising->adv_modes_config.ble_adv_directed_high_duty_enabled)
+	{
+		advertising_mode = BLE_ADV_MODE_FAST;
+	}
+	p_advertising->adv_mode_current = advertising_mode;
+	p_advertising->adv_handle = 0;
+	advertising_evt(p_advertising, (advertising_mode == BLE_ADV_MODE_DIRECTED_HIGH_DUTY) ? BLE_ADV_EVT_DIRECTED_HIGH_DUTY : BLE_ADV_EVT_FAST);
+	return NRF_SUCCESS;
+}
+
+uint32_t ble_advertising_restart_without_whitelist(ble_advertising_t * const p_advertising)
+{
+	return ble_advertising_start(p_advertising, BLE_ADV_MODE_FAST);
+}
+
+uint32_t ble_advertising_whitelist_reply(ble_advertising_t * const p_advertising, ble_gap_addr_t const * p_gap_addrs, uint32_t addr_cnt, ble_gap_irk_t const * p_gap_irks, uint32_t irk_cnt)
+{
+	return NRF_SUCCESS;
+}
+
+uint32_t ble_advertising_peer_addr_reply(ble_advertising_t * const p_advertising, ble_gap_addr_t * p_peer_addr)
+{
+	return NRF_SUCCESS;
+}
+
+ret_code_t ble_advertising_advdata_update(ble_advertising_t * const p_advertising, ble_advdata_t const * const p_advdata, ble_advdata_t const * const p_srdata)
+{
+	uint8_t encoded[BLE_GAP_ADV_SET_DATA_SIZE_MAX];
+	uint16_t len = sizeof(encoded);
+
+	if (p_advertising->adv_mode_current == BLE_ADV_MODE_IDLE)
+	{
+		return NRF_ERROR_INVALID_STATE;
+	}
+	return ble_advdata_encode(p_advdata, encoded, &len);
+}
+
+void ble_advertising_on_ble_evt(ble_evt_t const * p_ble_evt, void * p_adv)
+{
+	ble_advertising_t * p_advertising = (ble_advertising_t *) p_adv;
+
+	if (!p_advertising->initialized)
+	{
+		return;
+	}
+	switch (p_ble_evt->header.evt_id)
+	{
+		case BLE_GAP_EVT_CONNECTED:
+			p_advertising->current_slave_link_conn_handle = p_ble_evt->evt.gap_evt.conn_handle;
+			p_advertising->adv_mode_current = BLE_ADV_MODE_IDLE;
+			break;
+
+		case BLE_GAP_EVT_DISCONNECTED:
+			p_advertising->current_slave_link_conn_handle = BLE_CONN_HANDLE_INVALID;
+			if (!p_advertising->adv_modes_config.ble_adv_on_disconnect_disabled)
+			{
+				(void) ble_advertising_start(p_advertising, BLE_ADV_MODE_FAST);
+			}
+			break;
+
+		default:
+			break;
+	}
+}
+
+/* peer_manager: no bond is stored */
+
+ret_code_t pm_init(void)
+{
+	return NRF_SUCCESS;
+}
+
+ret_code_t pm_sec_params_set(ble_gap_sec_params_t * p_sec_params)
+{
+	return NRF_SUCCESS;
+}
+
+ret_code_t pm_register(pm_evt_handler_t event_handler)
+{
+	return NRF_SUCCESS;
+}
+
+ret_code_t pm_whitelist_set(pm_peer_id_t const * p_peers, uint32_t peer_cnt)
+{
+	return NRF_SUCCESS;
+}
+
+ret_code_t pm_whitelist_get(ble_gap_addr_t * p_addrs, uint32_t * p_addr_cnt, ble_gap_irk_t * p_irks, uint32_t * p_irk_cnt)
+{
+	*p_addr_cnt = 0;
+	*p_irk_cnt = 0;
+	return NRF_SUCCESS;
+}
+
+ret_code_t pm_peer_rank_highest(pm_peer_id_t peer_id)
+{
+	return NRF_SUCCESS;
+}
+
+ret_code_t pm_peer_ranks_get(pm_peer_id_t * p_highest_ranked_peer, uint32_t * p_highest_rank, pm_peer_id_t * p_lowest_ranked_peer, uint32_t * p_lowest_rank)
+{
+	return NRF_ERROR_NOT_FOUND;
+}
+
+ret_code_t pm_peer_data_bonding_load(pm_peer_id_t peer_id, pm_peer_data_bonding_t * p_data)
+{
+	return NRF_ERROR_NOT_FOUND;
+}
+
+void pm_handler_on_pm_evt(pm_evt_t const * p_pm_evt)
+{
+}
+
+void pm_handler_flash_clean(pm_evt_t const * p_pm_evt)
+{
+}
+
+/* nrf_ble_gatt, nrf_ble_qwr, nrf_pwr_mgmt, ble_conn_params */
+
+ret_code_t nrf_ble_gatt_init(nrf_ble_gatt_t * p_gatt, nrf_ble_gatt_evt_handler_t evt_handler)
+{
+	p_gatt->att_mtu_desired_periph = NRF_SDH_BLE_GATT_MAX_MTU_SIZE;
+	return NRF_SUCCESS;
+}
+
+ret_code_t nrf_ble_qwr_init(nrf_ble_qwr_t * p_qwr, nrf_ble_qwr_init_t const * p_qwr_init)
+{
+	p_qwr->conn_handle = BLE_CONN_HANDLE_INVALID;
+	p_qwr->error_handler = p_qwr_init->error_handler;
+	return NRF_SUCCESS;
+}
+
+ret_code_t nrf_ble_qwr_conn_handle_assign(nrf_ble_qwr_t * p_qwr, uint16_t conn_handle)
+{
+	p_qwr->conn_handle = conn_handle;
+	return NRF_SUCCESS;
+}
+
+ret_code_t nrf_pwr_mgmt_init(void)
+{
+	return NRF_SUCCESS;
+}
+
+void nrf_pwr_mgmt_run(void)
+{
+}
+
+uint32_t ble_conn_params_init(ble_conn_params_init_t const * p_init)
+{
+	return NRF_SUCCESS;
+}
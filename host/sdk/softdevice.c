@@ -0,0 +1,872 @@
+#include <string.h>
+#include "nordic_common.h"
+#include "nrf_sdh_ble.h"
+#include "nrf_nvic.h"
+#include "host_clock.h"
+#include "softdevice.h"
+
+#define T_IFS_US							150
+#define EVENT_MARGIN_US						150
+#define ATT_MTU								NRF_SDH_BLE_GATT_MAX_MTU_SIZE
+#define ATTRIBUTE_VALUE_MAX					512
+#define LL_HEADERS_SIZE						7									// ATT opcode + handle, L2CAP length + channel
+
+typedef struct
+{
+	uint16_t						uuid;
+	uint16_t						value_handle;
+	uint16_t						cccd_handle;
+	uint16_t						cccd;
+	bool							is_read_authorized;
+	uint16_t						length;
+	uint8_t							value[ATTRIBUTE_VALUE_MAX];
+} attribute_t;
+
+typedef struct
+{
+	uint16_t						handle;
+	uint16_t						length;
+	uint8_t							data[ATT_MTU];
+} packet_t;
+
+typedef struct
+{
+	packet_t						items[HOST_SD_WRITE_QUEUE_SIZE];
+	uint32_t						read;
+	uint32_t						write;
+	uint32_t						size;
+} packet_queue_t;
+
+typedef union
+{
+	ble_evt_t						evt;
+	uint8_t							raw[sizeof(ble_evt_t) + ATTRIBUTE_VALUE_MAX];
+} evt_buffer_t;
+
+static host_sd_config_t m_config;
+static host_sd_central_t m_central;
+static host_sd_stats_t m_stats;
+
+static attribute_t m_attributes[HOST_SD_ATTRIBUTE_MAX];
+static uint8_t m_attribute_count;
+static uint16_t m_next_handle;
+static uint8_t m_vs_uuid_count;
+
+static uint16_t m_event_length;
+static bool m_is_event_extension;
+
+static bool m_is_connected;
+static bool m_is_disconnect_pending;
+static uint16_t m_conn_interval;
+static uint8_t m_phy;
+static uint16_t m_tx_octets;
+static uint16_t m_rx_octets;
+static uint64_t m_next_event_ns;
+
+static bool m_is_conn_param_pending;
+static ble_gap_conn_params_t m_conn_param_requested;
+static bool m_is_phy_pending;
+static ble_gap_phys_t m_phy_requested;
+static bool m_is_data_length_pending;
+static ble_gap_data_length_params_t m_data_length_requested;
+
+static packet_queue_t m_writes;
+static packet_queue_t m_notifications;
+
+static uint16_t m_read_handle;
+static uint16_t m_read_offset;
+static bool m_is_read_requested;
+static bool m_is_read_authorizing;
+static bool m_is_hvx_sink;
+
+static bool queue_push(packet_queue_t * p_queue, uint32_t capacity, uint16_t handle, uint8_t const * p_data, uint16_t length)
+{
+	packet_t * p_packet;
+
+	if ((p_queue->write - p_queue->read) >= MIN(capacity, HOST_SD_WRITE_QUEUE_SIZE))
+	{
+		return false;
+	}
+	p_packet = &p_queue->items[p_queue->write % HOST_SD_WRITE_QUEUE_SIZE];
+	p_packet->handle = handle;
+	p_packet->length = MIN(length, sizeof(p_packet->data));
+	memcpy(p_packet->data, p_data, p_packet->length);
+	p_queue->write++;
+	return true;
+}
+
+static packet_t const * queue_peek(packet_queue_t const * p_queue)
+{
+	return (p_queue->write != p_queue->read) ? &p_queue->items[p_queue->read % HOST_SD_WRITE_QUEUE_SIZE] : NULL;
+}
+
+static void queue_pop(packet_queue_t * p_queue)
+{
+	p_queue->read++;
+}
+
+static uint32_t queue_length(packet_queue_t const * p_queue)
+{
+	return p_queue->write - p_queue->read;
+}
+
+static attribute_t * attribute_find(uint16_t handle)
+{
+	uint8_t i;
+
+	for (i = 0 ; i < m_attribute_count ; i++)
+	{
+		if ((m_attributes[i].value_handle == handle) || ((m_attributes[i].cccd_handle != 0) && (m_attributes[i].cccd_handle == handle)))
+		{
+			return &m_attributes[i];
+		}
+	}
+	return NULL;
+}
+
+static attribute_t * attribute_find_uuid(uint16_t uuid)
+{
+	uint8_t i;
+
+	for (i = 0 ; i < m_attribute_count ; i++)
+	{
+		if (m_attributes[i].uuid == uuid)
+		{
+			return &m_attributes[i];
+		}
+	}
+	return NULL;
+}
+
+static void evt_dispatch(evt_buffer_t * p_buffer, uint16_t evt_id)
+{
+	p_buffer->evt.header.evt_id = evt_id;
+	p_buffer->evt.header.evt_len = sizeof(evt_buffer_t);
+	host_sdh_ble_evt_dispatch(&p_buffer->evt);
+}
+
+static uint64_t conn_interval_ns(void)
+{
+	return (uint64_t) m_conn_interval * 1250000ULL;
+}
+
+/**@brief Air time of an LL packet (preamble, access address, header, payload, CRC).
+ */
+static uint32_t air_time_us(uint16_t payload)
+{
+	uint32_t bits = (4 + 2 + payload + 3) * 8;
+
+	if (m_phy == BLE_GAP_PHY_2MBPS)
+	{
+		return (16 + bits) / 2;
+	}
+	else if (m_phy == BLE_GAP_PHY_CODED)
+	{
+		// S8 coding: 80 us preamble, each bit 8 us.
+		return 80 + bits * 8;
+	}
+	return 8 + bits;
+}
+
+static uint16_t ll_packets(uint16_t att_length, uint16_t octets)
+{
+	uint16_t length = att_length + LL_HEADERS_SIZE;
+
+	return (length + octets - 1) / octets;
+}
+
+static uint32_t exchange_time_us(uint16_t att_length, uint16_t octets)
+{
+	uint16_t length = att_length + LL_HEADERS_SIZE;
+	uint32_t time_us = 0;
+
+	while (length > 0)
+	{
+		uint16_t payload = MIN(length, octets);
+
+		time_us += air_time_us(payload) + T_IFS_US + air_time_us(0) + T_IFS_US;
+		length -= payload;
+	}
+	return time_us;
+}
+
+static void write_dispatch(packet_t const * p_write)
+{
+	evt_buffer_t buffer;
+	ble_gatts_evt_write_t * p_evt_write = &buffer.evt.evt.gatts_evt.params.write;
+	attribute_t * p_attribute = attribute_find(p_write->handle);
+
+	if (p_attribute == NULL)
+	{
+		return;
+	}
+	if (p_write->handle == p_attribute->cccd_handle)
+	{
+		p_attribute->cccd = (p_write->length >= 2) ? (p_write->data[0] | (p_write->data[1] << 8)) : 0;
+	}
+	else
+	{
+		p_attribute->length = MIN(p_write->length, ATTRIBUTE_VALUE_MAX);
+		memcpy(p_attribute->value, p_write->data, p_attribute->length);
+	}
+
+	memset(&buffer, 0, sizeof(buffer));
+	buffer.evt.evt.gatts_evt.conn_handle = HOST_SD_CONN_HANDLE;
+	p_evt_write->handle = p_write->handle;
+	p_evt_write->uuid.uuid = p_attribute->uuid;
+	p_evt_write->op = BLE_GATT_OP_WRITE_REQ;
+	p_evt_write->len = p_write->length;
+	memcpy(p_evt_write->data, p_write->data, p_write->length);
+	m_stats.writes++;
+	evt_dispatch(&buffer, BLE_GATTS_EVT_WRITE);
+}
+
+static void read_dispatch(void)
+{
+	evt_buffer_t buffer;
+	attribute_t * p_attribute = attribute_find(m_read_handle);
+
+	memset(&buffer, 0, sizeof(buffer));
+	buffer.evt.evt.gatts_evt.conn_handle = HOST_SD_CONN_HANDLE;
+	buffer.evt.evt.gatts_evt.params.authorize_request.type = BLE_GATTS_AUTHORIZE_TYPE_READ;
+	buffer.evt.evt.gatts_evt.params.authorize_request.request.read.handle = m_read_handle;
+	buffer.evt.evt.gatts_evt.params.authorize_request.request.read.uuid.uuid = p_attribute->uuid;
+	buffer.evt.evt.gatts_evt.params.authorize_request.request.read.offset = m_read_offset;
+	m_is_read_requested = false;
+	m_is_read_authorizing = true;
+	evt_dispatch(&buffer, BLE_GATTS_EVT_RW_AUTHORIZE_REQUEST);
+}
+
+/**@brief Function for completing one pending GAP procedure with the values granted by the central.
+ */
+static void procedure_complete(void)
+{
+	evt_buffer_t buffer;
+
+	memset(&buffer, 0, sizeof(buffer));
+	buffer.evt.evt.gap_evt.conn_handle = HOST_SD_CONN_HANDLE;
+
+	if (m_is_conn_param_pending)
+	{
+		ble_gap_conn_params_t * p_params = &buffer.evt.evt.gap_evt.params.conn_param_update.conn_params;
+
+		m_is_conn_param_pending = false;
+		m_conn_interval = (m_config.conn_interval != 0) ? m_config.conn_interval : m_conn_param_requested.max_conn_interval;
+		p_params->min_conn_interval = m_conn_interval;
+		p_params->max_conn_interval = m_conn_interval;
+		p_params->slave_latency = m_conn_param_requested.slave_latency;
+		p_params->conn_sup_timeout = m_conn_param_requested.conn_sup_timeout;
+		evt_dispatch(&buffer, BLE_GAP_EVT_CONN_PARAM_UPDATE);
+	}
+	else if (m_is_phy_pending)
+	{
+		uint8_t phys = (m_phy_requested.tx_phys == BLE_GAP_PHY_AUTO) ? (BLE_GAP_PHY_1MBPS | BLE_GAP_PHY_2MBPS) : m_phy_requested.tx_phys;
+
+		if (m_config.phy != 0)
+		{
+			phys = m_config.phy;
+		}
+		m_is_phy_pending = false;
+		m_phy = (phys & BLE_GAP_PHY_2MBPS) ? BLE_GAP_PHY_2MBPS : ((phys & BLE_GAP_PHY_CODED) ? BLE_GAP_PHY_CODED : BLE_GAP_PHY_1MBPS);
+		buffer.evt.evt.gap_evt.params.phy_update.status = BLE_HCI_STATUS_CODE_SUCCESS;
+		buffer.evt.evt.gap_evt.params.phy_update.tx_phy = m_phy;
+		buffer.evt.evt.gap_evt.params.phy_update.rx_phy = m_phy;
+		evt_dispatch(&buffer, BLE_GAP_EVT_PHY_UPDATE);
+	}
+	else if (m_is_data_length_pending)
+	{
+		ble_gap_data_length_params_t * p_params = &buffer.evt.evt.gap_evt.params.data_length_update.effective_params;
+		uint16_t tx_octets = (m_data_length_requested.max_tx_octets == BLE_GAP_DATA_LENGTH_AUTO) ? 251 : m_data_length_requested.max_tx_octets;
+		uint16_t rx_octets = (m_data_length_requested.max_rx_octets == BLE_GAP_DATA_LENGTH_AUTO) ? 251 : m_data_length_requested.max_rx_octets;
+
+		if (m_config.max_octets != 0)
+		{
+			tx_octets = MIN(tx_octets, m_config.max_octets);
+			rx_octets = MIN(rx_octets, m_config.max_octets);
+		}
+		m_is_data_length_pending = false;
+		m_tx_octets = MAX(MIN(tx_octets, 251), 27);
+		m_rx_octets = MAX(MIN(rx_octets, 251), 27);
+		p_params->max_tx_octets = m_tx_octets;
+		p_params->max_rx_octets = m_rx_octets;
+		p_params->max_tx_time_us = (m_tx_octets + 14) * 8;
+		p_params->max_rx_time_us = (m_rx_octets + 14) * 8;
+		evt_dispatch(&buffer, BLE_GAP_EVT_DATA_LENGTH_UPDATE);
+	}
+}
+
+/**@brief Function for running one connection event: writes of the central, then the queued notifications.
+ */
+static void conn_event_run(void)
+{
+	uint32_t event_us = m_is_event_extension ? (m_conn_interval * 1250UL) : MIN(m_event_length * 1250UL, m_conn_interval * 1250UL);
+	uint32_t budget_us = (event_us > EVENT_MARGIN_US) ? (event_us - EVENT_MARGIN_US) : 0;
+	uint32_t used_us = 0;
+	uint8_t writes = 0;
+	uint8_t sent = 0;
+	packet_t const * p_packet;
+
+	m_stats.conn_events++;
+	if (m_central.on_conn_event != NULL)
+	{
+		m_central.on_conn_event(m_central.p_context);
+	}
+
+	procedure_complete();
+	if (!m_is_connected)
+	{
+		return;
+	}
+	if (m_is_read_requested && !m_is_read_authorizing)
+	{
+		read_dispatch();
+	}
+
+	while (((p_packet = queue_peek(&m_writes)) != NULL) && (writes < m_config.writes_per_event))
+	{
+		used_us += exchange_time_us(p_packet->length, m_rx_octets);
+		write_dispatch(p_packet);
+		queue_pop(&m_writes);
+		writes++;
+		if (!m_is_connected)
+		{
+			return;
+		}
+	}
+
+	while ((p_packet = queue_peek(&m_notifications)) != NULL)
+	{
+		uint32_t time_us = exchange_time_us(p_packet->length, m_tx_octets);
+
+		if (m_config.packets_per_event > 0)
+		{
+			if (sent >= m_config.packets_per_event)
+			{
+				break;
+			}
+		}
+		else if (((used_us + time_us) > budget_us) && ((sent > 0) || (writes > 0)))
+		{
+			break;
+		}
+		used_us += time_us;
+		sent++;
+		m_stats.notifications++;
+		m_stats.notification_bytes += p_packet->length;
+		m_stats.ll_packets += ll_packets(p_packet->length, m_tx_octets);
+		if (m_central.on_notification != NULL)
+		{
+			m_central.on_notification(p_packet->handle, p_packet->data, p_packet->length, m_central.p_context);
+		}
+		queue_pop(&m_notifications);
+	}
+
+	if (sent > 0)
+	{
+		evt_buffer_t buffer;
+
+		memset(&buffer, 0, sizeof(buffer));
+		buffer.evt.evt.gatts_evt.conn_handle = HOST_SD_CONN_HANDLE;
+		buffer.evt.evt.gatts_evt.params.hvn_tx_complete.count = sent;
+		evt_dispatch(&buffer, BLE_GATTS_EVT_HVN_TX_COMPLETE);
+	}
+}
+
+static void disconnect_run(uint8_t reason)
+{
+	evt_buffer_t buffer;
+	uint8_t i;
+
+	m_is_connected = false;
+	m_is_disconnect_pending = false;
+	m_is_conn_param_pending = false;
+	m_is_phy_pending = false;
+	m_is_data_length_pending = false;
+	m_is_read_requested = false;
+	m_is_read_authorizing = false;
+	memset(&m_writes, 0, sizeof(m_writes));
+	memset(&m_notifications, 0, sizeof(m_notifications));
+	for (i = 0 ; i < m_attribute_count ; i++)
+	{
+		// Not bonded: the CCCDs are cleared on disconnection.
+		m_attributes[i].cccd = 0;
+	}
+
+	memset(&buffer, 0, sizeof(buffer));
+	buffer.evt.evt.gap_evt.conn_handle = HOST_SD_CONN_HANDLE;
+	buffer.evt.evt.gap_evt.params.disconnected.reason = reason;
+	evt_dispatch(&buffer, BLE_GAP_EVT_DISCONNECTED);
+
+	if (m_central.on_disconnected != NULL)
+	{
+		m_central.on_disconnected(reason, m_central.p_context);
+	}
+}
+
+void host_sd_init(host_sd_config_t const * p_config)
+{
+	static host_sd_config_t const config_default = HOST_SD_CONFIG_DEFAULT;
+
+	m_config = (p_config != NULL) ? *p_config : config_default;
+	if (m_config.writes_per_event == 0)
+	{
+		m_config.writes_per_event = 1;
+	}
+	memset(&m_central, 0, sizeof(m_central));
+	memset(&m_stats, 0, sizeof(m_stats));
+	memset(m_attributes, 0, sizeof(m_attributes));
+	memset(&m_writes, 0, sizeof(m_writes));
+	memset(&m_notifications, 0, sizeof(m_notifications));
+	m_attribute_count = 0;
+	m_next_handle = m_config.first_handle;
+	m_vs_uuid_count = 0;
+	m_event_length = 3;
+	m_is_event_extension = false;
+	m_is_connected = false;
+	m_is_disconnect_pending = false;
+	m_is_conn_param_pending = false;
+	m_is_phy_pending = false;
+	m_is_data_length_pending = false;
+	m_is_read_requested = false;
+	m_is_read_authorizing = false;
+}
+
+host_sd_config_t const * host_sd_config_get(void)
+{
+	return &m_config;
+}
+
+void host_sd_central_set(host_sd_central_t const * p_central)
+{
+	m_central = *p_central;
+}
+
+void host_sd_connect(void)
+{
+	evt_buffer_t buffer;
+	ble_gap_conn_params_t * p_params = &buffer.evt.evt.gap_evt.params.connected.conn_params;
+
+	if (m_is_connected)
+	{
+		return;
+	}
+	m_is_connected = true;
+	m_conn_interval = (m_config.conn_interval != 0) ? m_config.conn_interval : 24;
+	m_phy = BLE_GAP_PHY_1MBPS;
+	m_tx_octets = 27;
+	m_rx_octets = 27;
+	m_next_event_ns = host_clock_ns() + conn_interval_ns();
+
+	memset(&buffer, 0, sizeof(buffer));
+	buffer.evt.evt.gap_evt.conn_handle = HOST_SD_CONN_HANDLE;
+	p_params->min_conn_interval = m_conn_interval;
+	p_params->max_conn_interval = m_conn_interval;
+	p_params->slave_latency = 0;
+	p_params->conn_sup_timeout = 400;
+	evt_dispatch(&buffer, BLE_GAP_EVT_CONNECTED);
+}
+
+void host_sd_disconnect(uint8_t reason)
+{
+	if (m_is_connected)
+	{
+		disconnect_run(reason);
+	}
+}
+
+bool host_sd_is_connected(void)
+{
+	return m_is_connected;
+}
+
+uint16_t host_sd_value_handle(uint16_t uuid)
+{
+	attribute_t const * p_attribute = attribute_find_uuid(uuid);
+
+	return (p_attribute != NULL) ? p_attribute->value_handle : BLE_GATT_HANDLE_INVALID;
+}
+
+uint16_t host_sd_cccd_handle(uint16_t uuid)
+{
+	attribute_t const * p_attribute = attribute_find_uuid(uuid);
+
+	return (p_attribute != NULL) ? p_attribute->cccd_handle : BLE_GATT_HANDLE_INVALID;
+}
+
+bool host_sd_notification_enable(uint16_t uuid, bool enable)
+{
+	uint8_t const cccd[2] = {enable ? BLE_GATT_HVX_NOTIFICATION : 0, 0};
+	uint16_t handle = host_sd_cccd_handle(uuid);
+
+	return (handle != BLE_GATT_HANDLE_INVALID) && host_sd_write(handle, cccd, sizeof(cccd));
+}
+
+bool host_sd_write(uint16_t handle, uint8_t const * p_data, uint16_t length)
+{
+	if (!m_is_connected || (length > (ATT_MTU - 3)))
+	{
+		return false;
+	}
+	return queue_push(&m_writes, HOST_SD_WRITE_QUEUE_SIZE, handle, p_data, length);
+}
+
+uint32_t host_sd_write_queue_free(void)
+{
+	return HOST_SD_WRITE_QUEUE_SIZE - queue_length(&m_writes);
+}
+
+bool host_sd_read(uint16_t handle)
+{
+	attribute_t * p_attribute = attribute_find(handle);
+
+	if (!m_is_connected || (p_attribute == NULL) || m_is_read_requested || m_is_read_authorizing)
+	{
+		return false;
+	}
+	m_read_handle = handle;
+	m_read_offset = 0;
+	if (p_attribute->is_read_authorized)
+	{
+		m_is_read_requested = true;
+	}
+	else if (m_central.on_read_response != NULL)
+	{
+		m_central.on_read_response(handle, p_attribute->value, p_attribute->length, m_central.p_context);
+	}
+	return true;
+}
+
+void host_sd_process(void)
+{
+	if (m_is_disconnect_pending)
+	{
+		disconnect_run(BLE_HCI_LOCAL_HOST_TERMINATED_CONNECTION);
+	}
+	while (m_is_connected && (host_clock_ns() >= m_next_event_ns))
+	{
+		conn_event_run();
+		m_next_event_ns += conn_interval_ns();
+	}
+}
+
+uint64_t host_sd_next_event_ns(void)
+{
+	return m_is_connected ? m_next_event_ns : UINT64_MAX;
+}
+
+uint16_t host_sd_conn_interval(void)
+{
+	return m_is_connected ? m_conn_interval : 0;
+}
+
+host_sd_stats_t const * host_sd_stats_get(void)
+{
+	return &m_stats;
+}
+
+void host_sd_hvx_sink_set(bool is_sink)
+{
+	m_is_hvx_sink = is_sink;
+}
+
+/* SoftDevice calls */
+
+uint32_t sd_ble_cfg_set(uint32_t cfg_id, ble_cfg_t const * p_cfg, uint32_t app_ram_base)
+{
+	if (cfg_id == BLE_CONN_CFG_GAP)
+	{
+		m_event_length = p_cfg->conn_cfg.params.gap_conn_cfg.event_length;
+	}
+	return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_opt_set(uint32_t opt_id, ble_opt_t const * p_opt)
+{
+	if (opt_id == BLE_COMMON_OPT_CONN_EVT_EXT)
+	{
+		m_is_event_extension = p_opt->common_opt.conn_evt_ext.enable;
+	}
+	return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_uuid_vs_add(ble_uuid128_t const * p_vs_uuid, uint8_t * p_uuid_type)
+{
+	*p_uuid_type = BLE_UUID_TYPE_VENDOR_BEGIN + m_vs_uuid_count++;
+	return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gap_device_name_set(ble_gap_conn_sec_mode_t const * p_write_perm, uint8_t const * p_dev_name, uint16_t len)
+{
+	return (len <= 248) ? NRF_SUCCESS : NRF_ERROR_DATA_SIZE;
+}
+
+uint32_t sd_ble_gap_ppcp_set(ble_gap_conn_params_t const * p_conn_params)
+{
+	return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gap_conn_param_update(uint16_t conn_handle, ble_gap_conn_params_t const * p_conn_params)
+{
+	if (!m_is_connected || (conn_handle != HOST_SD_CONN_HANDLE))
+	{
+		return BLE_ERROR_INVALID_CONN_HANDLE;
+	}
+	if (m_is_conn_param_pending)
+	{
+		return NRF_ERROR_BUSY;
+	}
+	m_is_conn_param_pending = true;
+	m_conn_param_requested = *p_conn_params;
+	return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gap_phy_update(uint16_t conn_handle, ble_gap_phys_t const * p_gap_phys)
+{
+	if (!m_is_connected || (conn_handle != HOST_SD_CONN_HANDLE))
+	{
+		return BLE_ERROR_INVALID_CONN_HANDLE;
+	}
+	if (m_is_phy_pending)
+	{
+		return NRF_ERROR_BUSY;
+	}
+	m_is_phy_pending = true;
+	m_phy_requested = *p_gap_phys;
+	return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gap_data_length_update(uint16_t conn_handle, ble_gap_data_length_params_t const * p_dl_params, ble_gap_data_length_limitation_t * p_dl_limitation)
+{
+	if (!m_is_connected || (conn_handle != HOST_SD_CONN_HANDLE))
+	{
+		return BLE_ERROR_INVALID_CONN_HANDLE;
+	}
+	if (m_is_data_length_pending)
+	{
+		return NRF_ERROR_BUSY;
+	}
+	m_is_data_length_pending = true;
+	if (p_dl_params != NULL)
+	{
+		m_data_length_requested = *p_dl_params;
+	}
+	else
+	{
+		memset(&m_data_length_requested, 0, sizeof(m_data_length_requested));
+	}
+	return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gap_disconnect(uint16_t conn_handle, uint8_t hci_status_code)
+{
+	if (!m_is_connected || (conn_handle != HOST_SD_CONN_HANDLE))
+	{
+		return BLE_ERROR_INVALID_CONN_HANDLE;
+	}
+	m_is_disconnect_pending = true;
+	return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gap_rssi_start(uint16_t conn_handle, uint8_t threshold_dbm, uint8_t skip_count)
+{
+	return (m_is_connected && (conn_handle == HOST_SD_CONN_HANDLE)) ? NRF_SUCCESS : BLE_ERROR_INVALID_CONN_HANDLE;
+}
+
+uint32_t sd_ble_gap_rssi_get(uint16_t conn_handle, int8_t * p_rssi, uint8_t * p_ch_index)
+{
+	if (!m_is_connected || (conn_handle != HOST_SD_CONN_HANDLE))
+	{
+		return BLE_ERROR_INVALID_CONN_HANDLE;
+	}
+	*p_rssi = m_config.rssi;
+	*p_ch_index = 0;
+	return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gap_tx_power_set(uint8_t role, uint16_t handle, int8_t tx_power)
+{
+	return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gap_adv_set_configure(uint8_t * p_adv_handle, ble_gap_adv_data_t const * p_adv_data, ble_gap_adv_params_t const * p_adv_params)
+{
+	if (p_adv_handle != NULL)
+	{
+		*p_adv_handle = 0;
+	}
+	return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gap_adv_start(uint8_t adv_handle, uint8_t conn_cfg_tag)
+{
+	return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gap_adv_stop(uint8_t adv_handle)
+{
+	return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gatts_service_add(uint8_t type, ble_uuid_t const * p_uuid, uint16_t * p_handle)
+{
+	*p_handle = m_next_handle++;
+	return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gatts_characteristic_add(uint16_t service_handle, ble_gatts_char_md_t const * p_char_md, ble_gatts_attr_t const * p_attr_char_value, ble_gatts_char_handles_t * p_handles)
+{
+	attribute_t * p_attribute;
+
+	if (m_attribute_count >= HOST_SD_ATTRIBUTE_MAX)
+	{
+		return NRF_ERROR_NO_MEM;
+	}
+	if (p_attr_char_value->max_len > ATTRIBUTE_VALUE_MAX)
+	{
+		return NRF_ERROR_INVALID_PARAM;
+	}
+	p_attribute = &m_attributes[m_attribute_count++];
+	memset(p_attribute, 0, sizeof(*p_attribute));
+	p_attribute->uuid = p_attr_char_value->p_uuid->uuid;
+	p_attribute->is_read_authorized = (p_attr_char_value->p_attr_md != NULL) && p_attr_char_value->p_attr_md->rd_auth;
+	p_attribute->length = MIN(p_attr_char_value->init_len, ATTRIBUTE_VALUE_MAX);
+	if (p_attr_char_value->p_value != NULL)
+	{
+		memcpy(p_attribute->value, p_attr_char_value->p_value, p_attribute->length);
+	}
+
+	memset(p_handles, 0, sizeof(*p_handles));
+	m_next_handle++;													// Characteristic declaration
+	p_attribute->value_handle = m_next_handle++;
+	if (p_char_md->char_props.notify || p_char_md->char_props.indicate)
+	{
+		p_attribute->cccd_handle = m_next_handle++;
+	}
+	p_handles->value_handle = p_attribute->value_handle;
+	p_handles->cccd_handle = p_attribute->cccd_handle;
+	return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gatts_value_get(uint16_t conn_handle, uint16_t handle, ble_gatts_value_t * p_value)
+{
+	attribute_t const * p_attribute = attribute_find(handle);
+	uint8_t cccd[2];
+	uint8_t const * p_data;
+	uint16_t length;
+
+	if (p_attribute == NULL)
+	{
+		return BLE_ERROR_INVALID_ATTR_HANDLE;
+	}
+	if (handle == p_attribute->cccd_handle)
+	{
+		if (!m_is_connected || (conn_handle != HOST_SD_CONN_HANDLE))
+		{
+			return BLE_ERROR_INVALID_CONN_HANDLE;
+		}
+		cccd[0] = p_attribute->cccd & 0xff;
+		cccd[1] = p_attribute->cccd >> 8;
+		p_data = cccd;
+		length = sizeof(cccd);
+	}
+	else
+	{
+		p_data = p_attribute->value;
+		length = p_attribute->length;
+	}
+	if (p_value->offset > length)
+	{
+		return NRF_ERROR_INVALID_PARAM;
+	}
+	length -= p_value->offset;
+	if (p_value->p_value != NULL)
+	{
+		memcpy(p_value->p_value, &p_data[p_value->offset], MIN(length, p_value->len));
+	}
+	p_value->len = length;
+	return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gatts_hvx(uint16_t conn_handle, ble_gatts_hvx_params_t const * p_hvx_params)
+{
+	attribute_t const * p_attribute = attribute_find(p_hvx_params->handle);
+	uint16_t length = (p_hvx_params->p_len != NULL) ? *p_hvx_params->p_len : 0;
+
+	if (!m_is_connected || (conn_handle != HOST_SD_CONN_HANDLE))
+	{
+		return BLE_ERROR_INVALID_CONN_HANDLE;
+	}
+	if ((p_attribute == NULL) || (p_attribute->value_handle != p_hvx_params->handle))
+	{
+		return BLE_ERROR_INVALID_ATTR_HANDLE;
+	}
+	if ((p_hvx_params->type != BLE_GATT_HVX_NOTIFICATION) || !(p_attribute->cccd & BLE_GATT_HVX_NOTIFICATION))
+	{
+		return NRF_ERROR_INVALID_STATE;
+	}
+	if ((p_hvx_params->offset != 0) || (length > (ATT_MTU - 3)))
+	{
+		return NRF_ERROR_DATA_SIZE;
+	}
+	if (m_is_hvx_sink)
+	{
+		return NRF_SUCCESS;
+	}
+	if (!queue_push(&m_notifications, MIN(m_config.hvn_queue_size, HOST_SD_HVN_QUEUE_MAX), p_hvx_params->handle, p_hvx_params->p_data, length))
+	{
+		m_stats.hvx_resources++;
+		return NRF_ERROR_RESOURCES;
+	}
+	return NRF_SUCCESS;
+}
+
+uint32_t sd_ble_gatts_rw_authorize_reply(uint16_t conn_handle, ble_gatts_rw_authorize_reply_params_t const * p_rw_authorize_reply_params)
+{
+	ble_gatts_authorize_params_t const * p_read = &p_rw_authorize_reply_params->params.read;
+	attribute_t * p_attribute = attribute_find(m_read_handle);
+	static uint8_t response[ATTRIBUTE_VALUE_MAX];
+	uint16_t length;
+
+	if (!m_is_connected || (conn_handle != HOST_SD_CONN_HANDLE))
+	{
+		return BLE_ERROR_INVALID_CONN_HANDLE;
+	}
+	if (!m_is_read_authorizing || (p_rw_authorize_reply_params->type != BLE_GATTS_AUTHORIZE_TYPE_READ))
+	{
+		return NRF_ERROR_INVALID_STATE;
+	}
+	m_is_read_authorizing = false;
+	if (p_read->update)
+	{
+		if ((p_read->offset + p_read->len) > ATTRIBUTE_VALUE_MAX)
+		{
+			return NRF_ERROR_INVALID_LENGTH;
+		}
+		memcpy(&p_attribute->value[p_read->offset], p_read->p_data, p_read->len);
+		p_attribute->length = p_read->offset + p_read->len;
+	}
+
+	// Read (Blob) response: ATT_MTU - 1 bytes at most, the central reads the next part while the response is full.
+	length = (m_read_offset < p_attribute->length) ? MIN(p_attribute->length - m_read_offset, ATT_MTU - 1) : 0;
+	memcpy(&response[m_read_offset], &p_attribute->value[m_read_offset], length);
+	m_read_offset += length;
+	if (length == (ATT_MTU - 1))
+	{
+		m_is_read_requested = true;
+	}
+	else if (m_central.on_read_response != NULL)
+	{
+		m_central.on_read_response(m_read_handle, response, m_read_offset, m_central.p_context);
+	}
+	return NRF_SUCCESS;
+}
+
+uint32_t sd_nvic_SystemReset(void)
+{
+	m_stats.system_resets++;
+	if (m_central.on_system_reset != NULL)
+	{
+		m_central.on_system_reset(m_central.p_context);
+	}
+	return NRF_SUCCESS;
+}
@@ -0,0 +1,94 @@
+/*
+ * Host build: fake S132 SoftDevice. The sd_xxx calls of the firmware (ble.h) are served here and the events are
+ * dispatched to the observers (host_sdh_ble_evt_dispatch) from host_sd_process(), called by the harness like the
+ * SoftDevice interrupt.
+ *  - GATT table: the handles are assigned like the SoftDevice (declaration, value, CCCD) from first_handle.
+ *  - Link: one connection event every conn_interval. Each event carries the writes of the central (writes_per_event,
+ *    one write request per event by default) and then the queued notifications, up to packets_per_event or, if 0, as
+ *    many LL packets as fit in the event (event length of sd_ble_cfg_set, up to the interval with the event extension):
+ *      exchange = air time (data) + T_IFS + air time (empty) + T_IFS, LL payload = ATT payload + 7 (ATT / L2CAP headers)
+ *    The sent notifications are given to the central and acknowledged by one BLE_GATTS_EVT_HVN_TX_COMPLETE per event.
+ *  - sd_ble_gatts_hvx() returns NRF_ERROR_RESOURCES when hvn_queue_size notifications are queued. With the sink
+ *    (host_sd_hvx_sink_set, micro benchmarks) the notifications are checked and then discarded: nothing is queued.
+ *  - The GAP procedures (connection parameters, PHY, data length) complete on the next connection event with the
+ *    values granted by the central (conn_interval, phy and max_octets of the configuration, 0: as requested).
+ * The central side (host_sd_central_xxx) is used by the tests, the bridge emulator and the replay tool.
+ */
+#ifndef HOST_SOFTDEVICE_H
+#define HOST_SOFTDEVICE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "ble.h"
+
+#define HOST_SD_CONN_HANDLE					0
+#define HOST_SD_WRITE_QUEUE_SIZE			64
+#define HOST_SD_HVN_QUEUE_MAX				64
+#define HOST_SD_ATTRIBUTE_MAX				32
+
+typedef struct
+{
+	uint16_t						first_handle;						/**< Handle of the first service added by the application. */
+	uint16_t						conn_interval;						/**< 1.25 ms units: interval at connection and granted on update (0: 30 ms, then as requested). */
+	uint8_t							hvn_queue_size;						/**< Notifications queued in the SoftDevice. */
+	uint8_t							packets_per_event;					/**< Notifications per event (0: as many as fit in the event). */
+	uint8_t							writes_per_event;					/**< Writes of the central per event (1: write requests). */
+	uint8_t							phy;								/**< PHY granted by the central (BLE_GAP_PHY_xxx, 0: as requested). */
+	uint8_t							max_octets;							/**< LL payload granted by the central (27 to 251, 0: as requested). */
+	int8_t							rssi;
+} host_sd_config_t;
+
+#define HOST_SD_CONFIG_DEFAULT																\
+{																							\
+	.first_handle = 0x000C,																	\
+	.conn_interval = 0,																		\
+	.hvn_queue_size = 8,																	\
+	.packets_per_event = 0,																	\
+	.writes_per_event = 1,																	\
+	.phy = 0,																				\
+	.max_octets = 0,																		\
+	.rssi = -50,																			\
+}
+
+typedef struct
+{
+	void (*on_notification)(uint16_t handle, uint8_t const * p_data, uint16_t length, void * p_context);
+	void (*on_read_response)(uint16_t handle, uint8_t const * p_data, uint16_t length, void * p_context);
+	void (*on_conn_event)(void * p_context);							/**< Start of a connection event (writes may be queued). */
+	void (*on_disconnected)(uint8_t reason, void * p_context);
+	void (*on_system_reset)(void * p_context);
+	void * p_context;
+} host_sd_central_t;
+
+typedef struct
+{
+	uint32_t						conn_events;
+	uint32_t						notifications;						/**< Notifications sent to the central. */
+	uint32_t						notification_bytes;
+	uint32_t						ll_packets;							/**< LL packets of the notifications (fragmentation included). */
+	uint32_t						hvx_resources;						/**< sd_ble_gatts_hvx() refused (NRF_ERROR_RESOURCES). */
+	uint32_t						writes;
+	uint32_t						system_resets;
+} host_sd_stats_t;
+
+void host_sd_init(host_sd_config_t const * p_config);
+host_sd_config_t const * host_sd_config_get(void);
+
+void host_sd_central_set(host_sd_central_t const * p_central);
+void host_sd_connect(void);
+void host_sd_disconnect(uint8_t reason);
+bool host_sd_is_connected(void);
+uint16_t host_sd_value_handle(uint16_t uuid);
+uint16_t host_sd_cccd_handle(uint16_t uuid);
+bool host_sd_notification_enable(uint16_t uuid, bool enable);
+bool host_sd_write(uint16_t handle, uint8_t const * p_data, uint16_t length);
+uint32_t host_sd_write_queue_free(void);
+bool host_sd_read(uint16_t handle);
+
+void host_sd_process(void);
+uint64_t host_sd_next_event_ns(void);
+uint16_t host_sd_conn_interval(void);
+host_sd_stats_t const * host_sd_stats_get(void);
+void host_sd_hvx_sink_set(bool is_sink);
+
+#endif
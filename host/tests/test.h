@@ -0,0 +1,24 @@
+/*
+ * Host build: checks of the tests (no framework). A failed check prints its location and fails the test at exit.
+ */
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static int m_test_failures = 0;
+
+#define CHECK(condition)																	\
+	do																						\
+	{																						\
+		if (!(condition))																	\
+		{																					\
+			fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition);	\
+			m_test_failures++;																\
+		}																					\
+	} while (0)
+
+#define TEST_RESULT()						((m_test_failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE)
+
+#endif
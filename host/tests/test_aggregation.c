@@ -0,0 +1,220 @@
+/*
+ * Aggregation of the ID_CHAR_BUFFER records (ID_NOTIF_AGGREGATION, _notif_buffer): goodput against added latency.
+ * The host MCU sends a burst of small frames, the central parses the app notifications (ID - Length - Data records):
+ *  - Without aggregation: one record per notification.
+ *  - With aggregation: several records per notification, every record received once and in order, the latency added
+ *    bounded by the timeout and a connection interval.
+ *  - ID_CHAR_BUFFER_FLUSH: the record is sent without waiting for the timeout.
+ * One JSON line per configuration: notifications, payload per notification, goodput (payload bytes per second of the
+ * burst) and latency (frame queued by the host MCU to record received by the central).
+ */
+#include <string.h>
+#include "host_clock.h"
+#include "fake_uart.h"
+#include "host_mcu.h"
+#include "bridge.h"
+#include "ble_vsd.h"
+#include "ble_pickit_board.h"
+#include "ble_pickit_service.h"
+#include "tests/test.h"
+
+#define TIMEOUT_NS							2000000000ULL
+#define CCCD_WRITE_NS						200000000ULL						// Writes of the central: one per connection event
+#define BURST_FRAMES						48
+#define FRAME_SIZE							16
+#define AGGREGATION_TIMEOUT_MS				20
+#define FLUSH_TIMEOUT_MS					500
+
+typedef struct
+{
+	uint32_t						notifications;
+	uint32_t						notification_bytes;
+	uint32_t						payload_bytes;
+	uint64_t						goodput;							/**< Payload bytes per second of the burst. */
+	uint64_t						latency_p50_ns;
+	uint64_t						latency_max_ns;
+} result_t;
+
+static host_mcu_t m_mcu;
+static uint64_t m_queued_ns[BURST_FRAMES];
+static uint64_t m_latency_ns[BURST_FRAMES];
+static uint32_t m_received = 0;
+static uint32_t m_errors = 0;
+static uint32_t m_notifications = 0;
+static uint32_t m_notification_bytes = 0;
+static uint32_t m_payload_bytes = 0;
+
+static uint32_t mcu_write(uint8_t const * p_data, uint32_t length, void * p_context)
+{
+	fake_uart_host_write(p_data, length);
+	return length;
+}
+
+static uint32_t mcu_read(uint8_t * p_data, uint32_t length, void * p_context)
+{
+	return fake_uart_host_read(p_data, length);
+}
+
+static void central_on_notification(uint16_t handle, uint8_t const * p_data, uint16_t length, void * p_context)
+{
+	uint16_t i = 0;
+
+	if (handle != host_sd_value_handle(MESSAGE_APP_CHAR_UUID))
+	{
+		return;
+	}
+	m_notifications++;
+	m_notification_bytes += length;
+	while ((i + 2) <= length)
+	{
+		uint8_t record_length = p_data[i + 1];
+
+		// Record: ID_CHAR_BUFFER - Length - Sequence - Data, in the order of the frames.
+		if (	(p_data[i] != ID_CHAR_BUFFER) || ((i + 2 + record_length) > length) || (record_length == 0) ||		\
+				(p_data[i + 2] != m_received) || (m_received == BURST_FRAMES))
+		{
+			m_errors++;
+			return;
+		}
+		m_latency_ns[m_received++] = host_clock_ns() - m_queued_ns[p_data[i + 2]];
+		m_payload_bytes += record_length;
+		i += record_length + 2;
+	}
+	if (i != length)
+	{
+		m_errors++;
+	}
+}
+
+static void hook(void * p_context)
+{
+	host_mcu_process(&m_mcu);
+}
+
+static bool is_started(void * p_context)
+{
+	return bridge_is_started() && host_mcu_is_idle(&m_mcu);
+}
+
+static bool is_connected(void * p_context)
+{
+	return bridge_is_connected();
+}
+
+static bool is_mcu_idle(void * p_context)
+{
+	return host_mcu_is_idle(&m_mcu) && fake_uart_is_idle();
+}
+
+static bool is_received(void * p_context)
+{
+	return m_received >= *(uint32_t const *) p_context;
+}
+
+static int latency_compare(void const * p_a, void const * p_b)
+{
+	uint64_t a = *(uint64_t const *) p_a;
+	uint64_t b = *(uint64_t const *) p_b;
+
+	return (a > b) - (a < b);
+}
+
+static void aggregation_set(bool enable, uint16_t timeout_ms)
+{
+	uint8_t const data[3] = {enable ? 0x01 : 0x00, (timeout_ms >> 8) & 0xff, (timeout_ms >> 0) & 0xff};
+
+	CHECK(host_mcu_send(&m_mcu, ID_NOTIF_AGGREGATION, data, sizeof(data)));
+	CHECK(bridge_run_until(is_mcu_idle, NULL, TIMEOUT_NS));
+}
+
+/**@brief Function for sending frames (Sequence - Data) and receiving them as app notification records.
+ */
+static void burst_run(uint8_t id, uint32_t frames, result_t * p_result)
+{
+	uint8_t data[FRAME_SIZE];
+	uint64_t start_ns = host_clock_ns();
+	uint32_t i;
+
+	m_received = 0;
+	m_notifications = 0;
+	m_notification_bytes = 0;
+	m_payload_bytes = 0;
+	for (i = 0 ; i < frames ; i++)
+	{
+		memset(data, i, sizeof(data));
+		data[0] = i;
+		m_queued_ns[i] = host_clock_ns();
+		CHECK(host_mcu_send(&m_mcu, id, data, sizeof(data)));
+	}
+	CHECK(bridge_run_until(is_received, &frames, TIMEOUT_NS));
+	CHECK(m_received == frames);
+
+	p_result->notifications = m_notifications;
+	p_result->notification_bytes = m_notification_bytes;
+	p_result->payload_bytes = m_payload_bytes;
+	p_result->goodput = (m_payload_bytes * 1000000000ULL) / (host_clock_ns() - start_ns);
+	qsort(m_latency_ns, m_received, sizeof(m_latency_ns[0]), latency_compare);
+	p_result->latency_p50_ns = m_latency_ns[m_received / 2];
+	p_result->latency_max_ns = m_latency_ns[m_received - 1];
+	CHECK(bridge_run_until(is_mcu_idle, NULL, TIMEOUT_NS));
+}
+
+static void result_print(bool is_aggregation, uint16_t timeout_ms, result_t const * p_result)
+{
+	printf("{\"test\":\"aggregation\",\"aggregation\":%s,\"timeout_ms\":%u,\"frames\":%u,\"frame_size\":%u,\"notifications\":%u,"
+			"\"payload_per_notification\":%.1f,\"goodput_bytes_per_s\":%llu,\"latency_us\":{\"p50\":%.1f,\"max\":%.1f}}\n",
+			is_aggregation ? "true" : "false", timeout_ms, BURST_FRAMES, FRAME_SIZE, p_result->notifications,
+			(double) p_result->payload_bytes / p_result->notifications, (unsigned long long) p_result->goodput,
+			p_result->latency_p50_ns / 1e3, p_result->latency_max_ns / 1e3);
+}
+
+int main(void)
+{
+	host_sd_config_t const config = HOST_SD_CONFIG_DEFAULT;
+	host_sd_central_t const central = {.on_notification = central_on_notification};
+	host_mcu_init_t const mcu_init = {.write = mcu_write, .read = mcu_read, .baud_rate = FAKE_UART_BAUD_RATE};
+	uint64_t interval_ns;
+	result_t single, aggregated, flushed;
+
+	host_clock_virtual_set(true);
+	bridge_init(&config);
+	host_mcu_init(&m_mcu, &mcu_init);
+	bridge_hook_set(hook, NULL);
+	host_sd_central_set(&central);
+
+	CHECK(bridge_run_until(is_started, NULL, TIMEOUT_NS));
+	host_sd_connect();
+	CHECK(bridge_run_until(is_connected, NULL, TIMEOUT_NS));
+	CHECK(host_sd_notification_enable(MESSAGE_APP_CHAR_UUID, true));
+	bridge_run_for(CCCD_WRITE_NS);
+	CHECK(bridge_run_until(is_mcu_idle, NULL, TIMEOUT_NS));
+	interval_ns = host_sd_conn_interval() * 1250000ULL;
+
+	// Without aggregation: one record per notification.
+	aggregation_set(false, AGGREGATION_TIMEOUT_MS);
+	burst_run(ID_CHAR_BUFFER, BURST_FRAMES, &single);
+	result_print(false, AGGREGATION_TIMEOUT_MS, &single);
+	CHECK(single.notifications == BURST_FRAMES);
+
+	// With aggregation: fewer notifications carrying the same records, latency added bounded by the timeout.
+	aggregation_set(true, AGGREGATION_TIMEOUT_MS);
+	burst_run(ID_CHAR_BUFFER, BURST_FRAMES, &aggregated);
+	result_print(true, AGGREGATION_TIMEOUT_MS, &aggregated);
+	CHECK(aggregated.payload_bytes == single.payload_bytes);
+	CHECK((aggregated.notifications * 4) <= single.notifications);
+	CHECK((aggregated.payload_bytes / aggregated.notifications) > (single.payload_bytes / single.notifications));
+	CHECK(aggregated.latency_max_ns <= (single.latency_max_ns + (AGGREGATION_TIMEOUT_MS * 1000000ULL) + interval_ns));
+
+	// Flush: a lone record does not wait for the (long) timeout.
+	aggregation_set(true, FLUSH_TIMEOUT_MS);
+	burst_run(ID_CHAR_BUFFER_FLUSH, 1, &flushed);
+	CHECK(flushed.notifications == 1);
+	CHECK(flushed.latency_max_ns < (FLUSH_TIMEOUT_MS * 1000000ULL / 2));
+	burst_run(ID_CHAR_BUFFER, 1, &flushed);
+	CHECK(flushed.latency_max_ns >= (FLUSH_TIMEOUT_MS * 1000000ULL));
+
+	CHECK(m_errors == 0);
+	CHECK(fake_uart_stats_get()->rx_overflows == 0);
+
+	return TEST_RESULT();
+}
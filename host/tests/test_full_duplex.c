@@ -0,0 +1,249 @@
+/*
+ * Full-duplex UART (ID_UART_FULL_DUPLEX): latency and throughput under concurrent bidirectional load.
+ * The host MCU sends FRAMES frames (up: host MCU -> central) while the central writes FRAMES frames (down: central ->
+ * host MCU, within the credits of the central), first in half duplex (300 us idle delimiter, 400 us guard, no
+ * transmission while receiving) and then in full duplex:
+ *  - Every frame received once, in order and intact in both modes, without UART error.
+ *  - Full duplex completes the load sooner and delivers the down frames with a lower median latency.
+ * One JSON line per mode: duration, throughput and p50 / max latency per direction (queued to received).
+ */
+#include <string.h>
+#include "host_clock.h"
+#include "fake_uart.h"
+#include "host_mcu.h"
+#include "bridge.h"
+#include "ble_vsd.h"
+#include "ble_pickit_board.h"
+#include "ble_pickit_service.h"
+#include "tests/test.h"
+
+#define TIMEOUT_NS							5000000000ULL
+#define CCCD_WRITE_NS						200000000ULL						// Writes of the central: one per connection event
+#define FRAMES								48
+#define FRAME_SIZE							200
+#define WRITES_PER_EVENT					6
+
+typedef struct
+{
+	uint64_t						sent_ns[FRAMES];
+	uint64_t						latency_ns[FRAMES];
+	uint32_t						sent;
+	uint32_t						received;
+	uint32_t						errors;
+} flow_t;
+
+typedef struct
+{
+	uint64_t						duration_ns;
+	uint64_t						up_p50_ns;
+	uint64_t						up_max_ns;
+	uint64_t						down_p50_ns;
+	uint64_t						down_max_ns;
+} result_t;
+
+static host_mcu_t m_mcu;
+static flow_t m_up;
+static flow_t m_down;
+static bool m_is_running = false;
+
+static uint32_t mcu_write(uint8_t const * p_data, uint32_t length, void * p_context)
+{
+	fake_uart_host_write(p_data, length);
+	return length;
+}
+
+static uint32_t mcu_read(uint8_t * p_data, uint32_t length, void * p_context)
+{
+	return fake_uart_host_read(p_data, length);
+}
+
+static bool frame_is_valid(uint8_t const * p_data, uint16_t length, uint32_t sequence)
+{
+	uint16_t i;
+
+	if ((length != FRAME_SIZE) || (p_data[0] != sequence))
+	{
+		return false;
+	}
+	for (i = 1 ; i < length ; i++)
+	{
+		if (p_data[i] != (uint8_t) (sequence + i))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+static void frame_fill(uint8_t * p_data, uint32_t sequence)
+{
+	uint16_t i;
+
+	p_data[0] = sequence;
+	for (i = 1 ; i < FRAME_SIZE ; i++)
+	{
+		p_data[i] = (uint8_t) (sequence + i);
+	}
+}
+
+static void flow_receive(flow_t * p_flow, uint8_t const * p_data, uint16_t length)
+{
+	if (!m_is_running || (p_flow->received == p_flow->sent) || !frame_is_valid(p_data, length, p_flow->received))
+	{
+		p_flow->errors++;
+		return;
+	}
+	p_flow->latency_ns[p_flow->received] = host_clock_ns() - p_flow->sent_ns[p_flow->received];
+	p_flow->received++;
+}
+
+static void mcu_on_frame(host_mcu_t * p_mcu, uint8_t id, uint8_t const * p_data, uint16_t length, void * p_context)
+{
+	if (id == ID_CHAR_BUFFER)
+	{
+		flow_receive(&m_down, p_data, length);
+	}
+}
+
+static void central_on_notification(uint16_t handle, uint8_t const * p_data, uint16_t length, void * p_context)
+{
+	// One record per notification: ID_CHAR_BUFFER - Length - Data.
+	if ((handle == host_sd_value_handle(MESSAGE_APP_CHAR_UUID)) && (length >= 2) && (p_data[0] == ID_CHAR_BUFFER))
+	{
+		flow_receive(&m_up, &p_data[2], length - 2);
+	}
+}
+
+static void central_on_conn_event(void * p_context)
+{
+	uint8_t data[FRAME_SIZE + 2];
+
+	// Credits: a message leaves the ring of the bridge on the ACK of the host MCU, one frame may still wait for it.
+	while (	m_is_running && (m_down.sent < FRAMES) && ((m_down.sent - m_down.received) < (OUTGOING_MESSAGE_RING_SIZE - 1)) &&	\
+			(host_sd_write_queue_free() > 0))
+	{
+		data[0] = ID_CHAR_BUFFER;
+		data[1] = FRAME_SIZE;
+		frame_fill(&data[2], m_down.sent);
+		m_down.sent_ns[m_down.sent] = host_clock_ns();
+		CHECK(host_sd_write(host_sd_value_handle(MESSAGE_APP_CHAR_UUID), data, sizeof(data)));
+		m_down.sent++;
+	}
+}
+
+static void hook(void * p_context)
+{
+	host_mcu_process(&m_mcu);
+}
+
+static bool is_started(void * p_context)
+{
+	return bridge_is_started() && host_mcu_is_idle(&m_mcu);
+}
+
+static bool is_connected(void * p_context)
+{
+	return bridge_is_connected();
+}
+
+static bool is_mcu_idle(void * p_context)
+{
+	return host_mcu_is_idle(&m_mcu) && fake_uart_is_idle();
+}
+
+static bool is_load_done(void * p_context)
+{
+	return (m_up.received == FRAMES) && (m_down.received == FRAMES);
+}
+
+static int latency_compare(void const * p_a, void const * p_b)
+{
+	uint64_t a = *(uint64_t const *) p_a;
+	uint64_t b = *(uint64_t const *) p_b;
+
+	return (a > b) - (a < b);
+}
+
+static void load_run(result_t * p_result)
+{
+	uint8_t data[FRAME_SIZE];
+	uint64_t start_ns = host_clock_ns();
+	uint32_t i;
+
+	memset(&m_up, 0, sizeof(m_up));
+	memset(&m_down, 0, sizeof(m_down));
+	m_is_running = true;
+	for (i = 0 ; i < FRAMES ; i++)
+	{
+		frame_fill(data, i);
+		m_up.sent_ns[i] = host_clock_ns();
+		CHECK(host_mcu_send(&m_mcu, ID_CHAR_BUFFER, data, sizeof(data)));
+		m_up.sent++;
+	}
+	CHECK(bridge_run_until(is_load_done, NULL, TIMEOUT_NS));
+	p_result->duration_ns = host_clock_ns() - start_ns;
+	CHECK(bridge_run_until(is_mcu_idle, NULL, TIMEOUT_NS));
+	m_is_running = false;
+
+	CHECK((m_up.errors == 0) && (m_down.errors == 0));
+	qsort(m_up.latency_ns, m_up.received, sizeof(m_up.latency_ns[0]), latency_compare);
+	qsort(m_down.latency_ns, m_down.received, sizeof(m_down.latency_ns[0]), latency_compare);
+	p_result->up_p50_ns = m_up.latency_ns[FRAMES / 2];
+	p_result->up_max_ns = m_up.latency_ns[FRAMES - 1];
+	p_result->down_p50_ns = m_down.latency_ns[FRAMES / 2];
+	p_result->down_max_ns = m_down.latency_ns[FRAMES - 1];
+}
+
+static void result_print(char const * p_mode, result_t const * p_result)
+{
+	double throughput = (FRAMES * FRAME_SIZE * 1e9) / p_result->duration_ns;
+
+	printf("{\"test\":\"full_duplex\",\"uart\":\"%s\",\"frames\":%u,\"frame_size\":%u,\"duration_s\":%.3f,"
+			"\"up\":{\"throughput_bytes_per_s\":%.0f,\"latency_us\":{\"p50\":%.1f,\"max\":%.1f}},"
+			"\"down\":{\"throughput_bytes_per_s\":%.0f,\"latency_us\":{\"p50\":%.1f,\"max\":%.1f}}}\n",
+			p_mode, FRAMES, FRAME_SIZE, p_result->duration_ns / 1e9,
+			throughput, p_result->up_p50_ns / 1e3, p_result->up_max_ns / 1e3,
+			throughput, p_result->down_p50_ns / 1e3, p_result->down_max_ns / 1e3);
+}
+
+int main(void)
+{
+	host_sd_config_t config = HOST_SD_CONFIG_DEFAULT;
+	host_sd_central_t const central = {.on_notification = central_on_notification, .on_conn_event = central_on_conn_event};
+	host_mcu_init_t const mcu_init = {.write = mcu_write, .read = mcu_read, .on_frame = mcu_on_frame, .baud_rate = FAKE_UART_BAUD_RATE};
+	uint8_t const full_duplex = 1;
+	result_t half, full;
+
+	config.writes_per_event = WRITES_PER_EVENT;
+	host_clock_virtual_set(true);
+	bridge_init(&config);
+	host_mcu_init(&m_mcu, &mcu_init);
+	bridge_hook_set(hook, NULL);
+	host_sd_central_set(&central);
+
+	CHECK(bridge_run_until(is_started, NULL, TIMEOUT_NS));
+	host_sd_connect();
+	CHECK(bridge_run_until(is_connected, NULL, TIMEOUT_NS));
+	CHECK(host_sd_notification_enable(MESSAGE_APP_CHAR_UUID, true));
+	bridge_run_for(CCCD_WRITE_NS);
+	CHECK(bridge_run_until(is_mcu_idle, NULL, TIMEOUT_NS));
+
+	load_run(&half);
+	result_print("half-duplex", &half);
+
+	// The switch is acknowledged in half duplex, the next frames of both sides are sent back to back.
+	CHECK(host_mcu_send(&m_mcu, ID_UART_FULL_DUPLEX, &full_duplex, sizeof(full_duplex)));
+	CHECK(bridge_run_until(is_mcu_idle, NULL, TIMEOUT_NS));
+	m_mcu.init.is_full_duplex = true;
+
+	load_run(&full);
+	result_print("full-duplex", &full);
+
+	CHECK(full.duration_ns < half.duration_ns);
+	CHECK(full.down_p50_ns < half.down_p50_ns);
+	CHECK(m_mcu.stats.crc_errors == 0);
+	CHECK(m_mcu.stats.nacks_received == 0);
+	CHECK(fake_uart_stats_get()->rx_overflows == 0);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,200 @@
+/*
+ * Link layer model (ble_pickit_link_model.h) against the throughput test measured on the fake SoftDevice.
+ * For each configuration granted by the central (connection interval, PHY, LL payload): the central writes the test
+ * characteristic (1 MB throughput test) and counts the ATT payload notified over MEASURE_EVENTS connection events, the
+ * host MCU then asks the model for the current parameters of the firmware (ID_LINK_MODEL - Length (0)):
+ *  - The parameters used by the model are the ones granted (interval, PHY, LL payload - 4).
+ *  - The prediction is an upper bound of the measure, within TOLERANCE_PERCENT of it.
+ * The SoftDevice queue is large enough not to limit an event (the model is run with hvn_queue_size 0).
+ * One JSON line per configuration: predicted and measured throughput, packets per event.
+ */
+#include <string.h>
+#include "host_clock.h"
+#include "fake_uart.h"
+#include "host_mcu.h"
+#include "bridge.h"
+#include "ble_vsd.h"
+#include "ble_pickit_board.h"
+#include "ble_pickit_service.h"
+#include "ble_pickit_link_model.h"
+#include "tests/test.h"
+
+#define TIMEOUT_NS							5000000000ULL
+#define SETUP_NS							1000000000ULL						// GAP procedures (PHY, data length) completed
+#define WARMUP_EVENTS						4
+#define MEASURE_EVENTS						40
+#define TOLERANCE_PERCENT					5
+#define THROUGHPUT_TEST_1MB					0x03
+#define THROUGHPUT_TEST_STOP				0x01
+
+typedef struct
+{
+	uint16_t						conn_interval;						/**< 1.25 ms units. */
+	uint8_t							phy;
+	uint8_t							max_octets;							/**< LL payload. */
+} link_config_t;
+
+static host_mcu_t m_mcu;
+static uint8_t m_model[LINK_MODEL_RESULT_SIZE];
+static bool m_is_model_received = false;
+static bool m_is_measuring = false;
+static uint32_t m_conn_events = 0;
+static uint32_t m_test_bytes = 0;
+static uint32_t m_test_notifications = 0;
+
+static uint32_t mcu_write(uint8_t const * p_data, uint32_t length, void * p_context)
+{
+	fake_uart_host_write(p_data, length);
+	return length;
+}
+
+static uint32_t mcu_read(uint8_t * p_data, uint32_t length, void * p_context)
+{
+	return fake_uart_host_read(p_data, length);
+}
+
+static void mcu_on_frame(host_mcu_t * p_mcu, uint8_t id, uint8_t const * p_data, uint16_t length, void * p_context)
+{
+	if ((id == ID_LINK_MODEL) && (length == LINK_MODEL_RESULT_SIZE))
+	{
+		memcpy(m_model, p_data, length);
+		m_is_model_received = true;
+	}
+}
+
+static void central_on_notification(uint16_t handle, uint8_t const * p_data, uint16_t length, void * p_context)
+{
+	if ((handle == host_sd_value_handle(MESSAGE_TEST_UUID)) && m_is_measuring)
+	{
+		m_test_bytes += length;
+		m_test_notifications++;
+	}
+}
+
+static void central_on_conn_event(void * p_context)
+{
+	m_conn_events++;
+}
+
+static void hook(void * p_context)
+{
+	host_mcu_process(&m_mcu);
+}
+
+static bool is_started(void * p_context)
+{
+	return bridge_is_started() && host_mcu_is_idle(&m_mcu);
+}
+
+static bool is_connected(void * p_context)
+{
+	return bridge_is_connected();
+}
+
+static bool is_mcu_idle(void * p_context)
+{
+	return host_mcu_is_idle(&m_mcu) && fake_uart_is_idle();
+}
+
+static bool is_model_received(void * p_context)
+{
+	return m_is_model_received;
+}
+
+static bool is_events_done(void * p_context)
+{
+	return m_conn_events >= *(uint32_t const *) p_context;
+}
+
+static void events_run(uint32_t events)
+{
+	uint32_t target = m_conn_events + events;
+
+	CHECK(bridge_run_until(is_events_done, &target, TIMEOUT_NS));
+}
+
+static void config_run(link_config_t const * p_config)
+{
+	host_sd_config_t config = HOST_SD_CONFIG_DEFAULT;
+	host_sd_central_t const central = {.on_notification = central_on_notification, .on_conn_event = central_on_conn_event};
+	host_mcu_init_t const mcu_init = {.write = mcu_write, .read = mcu_read, .on_frame = mcu_on_frame, .baud_rate = FAKE_UART_BAUD_RATE};
+	uint8_t command = THROUGHPUT_TEST_1MB;
+	uint64_t start_ns, duration_ns;
+	ble_pickit_link_model_params_t params;
+	uint16_t packets_per_event;
+	uint32_t predicted, measured;
+
+	config.conn_interval = p_config->conn_interval;
+	config.phy = p_config->phy;
+	config.max_octets = p_config->max_octets;
+	config.hvn_queue_size = HOST_SD_HVN_QUEUE_MAX;
+	host_clock_virtual_set(true);
+	bridge_init(&config);
+	host_mcu_init(&m_mcu, &mcu_init);
+	bridge_hook_set(hook, NULL);
+	host_sd_central_set(&central);
+
+	CHECK(bridge_run_until(is_started, NULL, TIMEOUT_NS));
+	host_sd_connect();
+	CHECK(bridge_run_until(is_connected, NULL, TIMEOUT_NS));
+	CHECK(host_sd_notification_enable(MESSAGE_TEST_UUID, true));
+	bridge_run_for(SETUP_NS);
+	CHECK(bridge_run_until(is_mcu_idle, NULL, TIMEOUT_NS));
+
+	// Measure: whole connection events of the throughput test, once the notifications fill the events.
+	CHECK(host_sd_write(host_sd_value_handle(MESSAGE_TEST_UUID), &command, sizeof(command)));
+	events_run(WARMUP_EVENTS);
+	m_test_bytes = 0;
+	m_test_notifications = 0;
+	m_is_measuring = true;
+	start_ns = host_clock_ns();
+	events_run(MEASURE_EVENTS);
+	duration_ns = host_clock_ns() - start_ns;
+	m_is_measuring = false;
+	command = THROUGHPUT_TEST_STOP;
+	CHECK(host_sd_write(host_sd_value_handle(MESSAGE_TEST_UUID), &command, sizeof(command)));
+	events_run(WARMUP_EVENTS);
+	measured = (uint32_t) (((uint64_t) m_test_bytes * 1000000000ULL) / duration_ns);
+
+	// Model of the current parameters of the firmware.
+	m_is_model_received = false;
+	CHECK(host_mcu_send(&m_mcu, ID_LINK_MODEL, NULL, 0));
+	CHECK(bridge_run_until(is_model_received, NULL, TIMEOUT_NS));
+	ble_pickit_link_model_params_decode(m_model, &params);
+	packets_per_event = (m_model[LINK_MODEL_PARAMS_SIZE + 2] << 8) | m_model[LINK_MODEL_PARAMS_SIZE + 3];
+	predicted = ((uint32_t) m_model[LINK_MODEL_PARAMS_SIZE + 4] << 24) | ((uint32_t) m_model[LINK_MODEL_PARAMS_SIZE + 5] << 16) |
+				((uint32_t) m_model[LINK_MODEL_PARAMS_SIZE + 6] << 8) | m_model[LINK_MODEL_PARAMS_SIZE + 7];
+
+	printf("{\"test\":\"link_model\",\"conn_interval_ms\":%.2f,\"phy\":%u,\"max_octets\":%u,\"packets_per_event\":{\"predicted\":%u,\"measured\":%.1f},"
+			"\"throughput_bytes_per_s\":{\"predicted\":%u,\"measured\":%u},\"error_percent\":%.1f}\n",
+			p_config->conn_interval * 1.25, p_config->phy, p_config->max_octets, packets_per_event,
+			(double) m_test_notifications / MEASURE_EVENTS, predicted, measured,
+			(predicted > 0) ? (100.0 * ((double) predicted - measured) / predicted) : 0.0);
+
+	CHECK(params.conn_interval == p_config->conn_interval);
+	CHECK(params.phy == p_config->phy);
+	CHECK(params.max_tx_octets == (p_config->max_octets - 4));
+	CHECK(params.hvn_queue_size == 0);
+	CHECK(m_test_notifications > 0);
+	CHECK(measured <= predicted);
+	CHECK(((uint64_t) measured * 100) >= ((uint64_t) predicted * (100 - TOLERANCE_PERCENT)));
+}
+
+int main(void)
+{
+	static const link_config_t configs[] =
+	{
+		{24,	BLE_GAP_PHY_1MBPS,	27},
+		{24,	BLE_GAP_PHY_2MBPS,	251},
+		{6,		BLE_GAP_PHY_2MBPS,	251},
+		{80,	BLE_GAP_PHY_1MBPS,	251},
+	};
+	uint8_t i;
+
+	for (i = 0 ; i < ARRAY_SIZE(configs) ; i++)
+	{
+		config_run(&configs[i]);
+	}
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,324 @@
+/*
+ * Compressed extended messages (ble_pickit_lz.h, ID_CHAR_EXT_BUFFER_LZ): compression ratio and effective throughput.
+ * The central side compresses with the reference encoder below (greedy LZSS, 4096 bytes window) three sample payloads
+ * of MAXIMUM_SIZE_EXTENDED_MESSAGE bytes: configuration image, text log and random bytes.
+ *  - Decoder: the stream fed in BLE fragments (and byte per byte) gives the payload back, a match before the start of
+ *    the output and an output overflow are refused.
+ *  - Bridge: the compressed message written in fragments reaches the host MCU decompressed (ID_CHAR_EXT_BUFFER_NO_CRC),
+ *    sooner than the raw message for a compressible payload.
+ * One JSON line per sample: ratio (plain / compressed), decoding speed on the host, transfer time and effective
+ * throughput (plain bytes per second, first fragment written to message received) raw and compressed.
+ */
+#include <string.h>
+#include "nordic_common.h"
+#include "host_clock.h"
+#include "fake_uart.h"
+#include "host_mcu.h"
+#include "bridge.h"
+#include "ble_vsd.h"
+#include "ble_pickit_lz.h"
+#include "ble_pickit_board.h"
+#include "ble_pickit_service.h"
+#include "tests/test.h"
+
+#define TIMEOUT_NS							2000000000ULL
+#define CCCD_WRITE_NS						200000000ULL						// Writes of the central: one per connection event
+#define SAMPLE_SIZE							MAXIMUM_SIZE_EXTENDED_MESSAGE
+#define COMPRESSED_MAX						(SAMPLE_SIZE + (SAMPLE_SIZE / 8) + 1)	// All literals
+#define FRAGMENT_SIZE						240									// ATT payload (244) - ID - Length - Total - Current
+#define DECODE_REPETITIONS					200
+#define WRITES_PER_EVENT					6
+
+typedef enum
+{
+	SAMPLE_CONFIG,
+	SAMPLE_LOG,
+	SAMPLE_RANDOM,
+	SAMPLE_COUNT,
+} sample_t;
+
+static char const * const m_sample_names[SAMPLE_COUNT] = {"config", "log", "random"};
+static host_mcu_t m_mcu;
+static uint8_t m_sample[SAMPLE_SIZE];
+static uint8_t m_compressed[COMPRESSED_MAX];
+static uint8_t m_decoded[SAMPLE_SIZE];
+static uint8_t const * m_p_message;										/**< Written by the central (Data of the fragments). */
+static uint32_t m_message_length;
+static uint8_t m_message_id;
+static uint32_t m_message_fragment;										/**< Next fragment to write (0: message written). */
+static bool m_is_message_received;
+static bool m_is_message_equal;
+
+static uint32_t mcu_write(uint8_t const * p_data, uint32_t length, void * p_context)
+{
+	fake_uart_host_write(p_data, length);
+	return length;
+}
+
+static uint32_t mcu_read(uint8_t * p_data, uint32_t length, void * p_context)
+{
+	return fake_uart_host_read(p_data, length);
+}
+
+static void mcu_on_frame(host_mcu_t * p_mcu, uint8_t id, uint8_t const * p_data, uint16_t length, void * p_context)
+{
+	if (id == ID_CHAR_EXT_BUFFER_NO_CRC)
+	{
+		m_is_message_received = true;
+		m_is_message_equal = (length == SAMPLE_SIZE) && (memcmp(p_data, m_sample, SAMPLE_SIZE) == 0);
+	}
+}
+
+/**@brief Function for writing the fragments of the message (ID - Length - Total - Current - Data) as the write queue
+ *        of the SoftDevice frees up.
+ */
+static void central_on_conn_event(void * p_context)
+{
+	uint8_t const total = (m_message_length + FRAGMENT_SIZE - 1) / FRAGMENT_SIZE;
+	uint8_t data[FRAGMENT_SIZE + 4];
+	uint32_t offset;
+	uint32_t length;
+
+	while ((m_message_fragment > 0) && (host_sd_write_queue_free() > 0))
+	{
+		offset = (m_message_fragment - 1) * FRAGMENT_SIZE;
+		length = MIN(FRAGMENT_SIZE, m_message_length - offset);
+		data[0] = m_message_id;
+		data[1] = length + 2;
+		data[2] = total;
+		data[3] = m_message_fragment;
+		memcpy(&data[4], &m_p_message[offset], length);
+		(void) host_sd_write(host_sd_value_handle(MESSAGE_APP_CHAR_UUID), data, length + 4);
+		m_message_fragment = (m_message_fragment == total) ? 0 : (m_message_fragment + 1);
+	}
+}
+
+static void hook(void * p_context)
+{
+	host_mcu_process(&m_mcu);
+}
+
+static bool is_started(void * p_context)
+{
+	return bridge_is_started() && host_mcu_is_idle(&m_mcu);
+}
+
+static bool is_connected(void * p_context)
+{
+	return bridge_is_connected();
+}
+
+static bool is_mcu_idle(void * p_context)
+{
+	return host_mcu_is_idle(&m_mcu) && fake_uart_is_idle();
+}
+
+static bool is_message_received(void * p_context)
+{
+	return m_is_message_received;
+}
+
+static void sample_fill(sample_t sample)
+{
+	uint32_t seed = 0x12345678;
+	uint32_t length = 0;
+	uint32_t i;
+
+	switch (sample)
+	{
+		case SAMPLE_CONFIG:
+			// Records of 32 bytes: index, type, a few changing fields and constant defaults.
+			for (i = 0 ; i < SAMPLE_SIZE ; i++)
+			{
+				uint32_t field = i % 32;
+
+				m_sample[i] = (field == 0) ? (uint8_t) (i / 32) : (field == 1) ? (uint8_t) ((i / 32) % 4) : (field < 8) ? (uint8_t) (i / 128) : (uint8_t) (0xa0 + field);
+			}
+			break;
+
+		case SAMPLE_LOG:
+			while (length < SAMPLE_SIZE)
+			{
+				char line[64];
+				int n = snprintf(line, sizeof(line), "[%08u] sensor %u: value=%d status=OK\n", length * 7, length % 5, (int) (length % 97) - 40);
+
+				memcpy(&m_sample[length], line, MIN((uint32_t) n, SAMPLE_SIZE - length));
+				length += n;
+			}
+			break;
+
+		default:
+			for (i = 0 ; i < SAMPLE_SIZE ; i++)
+			{
+				seed = (seed * 1103515245) + 12345;
+				m_sample[i] = (uint8_t) (seed >> 16);
+			}
+			break;
+	}
+}
+
+/**@brief Function for compressing with the format of ble_pickit_lz.h (greedy longest match, central side).
+ *
+ * @return Length of the stream.
+ */
+static uint32_t lz_encode(uint8_t const * p_in, uint32_t in_length, uint8_t * p_out)
+{
+	uint32_t flags_index = 0;
+	uint32_t items = 8;
+	uint32_t out_length = 0;
+	uint32_t i = 0;
+
+	while (i < in_length)
+	{
+		uint32_t best_length = 0;
+		uint32_t best_offset = 0;
+		uint32_t offset, length;
+
+		if (items == 8)
+		{
+			flags_index = out_length++;
+			p_out[flags_index] = 0;
+			items = 0;
+		}
+		for (offset = 1 ; (offset <= i) && (offset <= LZ_WINDOW_SIZE) ; offset++)
+		{
+			for (length = 0 ; (length < LZ_MAX_MATCH) && ((i + length) < in_length) && (p_in[i + length - offset] == p_in[i + length]) ; length++);
+			if (length > best_length)
+			{
+				best_length = length;
+				best_offset = offset;
+			}
+		}
+		if (best_length >= LZ_MIN_MATCH)
+		{
+			p_out[out_length++] = (uint8_t) ((best_offset - 1) >> 4);
+			p_out[out_length++] = (uint8_t) ((((best_offset - 1) & 0x0f) << 4) | (best_length - LZ_MIN_MATCH));
+			i += best_length;
+		}
+		else
+		{
+			p_out[flags_index] |= (1 << items);
+			p_out[out_length++] = p_in[i++];
+		}
+		items++;
+	}
+	return out_length;
+}
+
+/**@brief Function for decoding a stream fed by fragments of fragment_size bytes.
+ */
+static uint32_t lz_decode(uint8_t const * p_in, uint32_t in_length, uint32_t fragment_size, uint16_t * p_out_length)
+{
+	ble_pickit_lz_t lz;
+	uint32_t err_code = NRF_SUCCESS;
+	uint32_t i;
+
+	ble_pickit_lz_init(&lz);
+	*p_out_length = 0;
+	for (i = 0 ; (i < in_length) && (err_code == NRF_SUCCESS) ; i += fragment_size)
+	{
+		err_code = ble_pickit_lz_decode(&lz, &p_in[i], MIN(fragment_size, in_length - i), m_decoded, p_out_length, SAMPLE_SIZE);
+	}
+	return err_code;
+}
+
+/**@brief Function for writing a message from the central and timing its reception by the host MCU.
+ */
+static uint64_t transfer_run(uint8_t id, uint8_t const * p_message, uint32_t length)
+{
+	uint64_t start_ns = host_clock_ns();
+
+	m_message_id = id;
+	m_p_message = p_message;
+	m_message_length = length;
+	m_message_fragment = 1;
+	m_is_message_received = false;
+	m_is_message_equal = false;
+	CHECK(bridge_run_until(is_message_received, NULL, TIMEOUT_NS));
+	CHECK(m_is_message_equal);
+	start_ns = host_clock_ns() - start_ns;
+	CHECK(bridge_run_until(is_mcu_idle, NULL, TIMEOUT_NS));
+	return start_ns;
+}
+
+int main(void)
+{
+	host_sd_config_t config = HOST_SD_CONFIG_DEFAULT;
+	host_sd_central_t const central = {.on_conn_event = central_on_conn_event};
+	host_mcu_init_t const mcu_init = {.write = mcu_write, .read = mcu_read, .on_frame = mcu_on_frame, .baud_rate = FAKE_UART_BAUD_RATE};
+	uint8_t const bad_offset[] = {0x00, 0x00, 0x10};						// Match 2 bytes back on an empty output
+	uint32_t compressed_length[SAMPLE_COUNT];
+	double decode_ns_per_byte[SAMPLE_COUNT];
+	uint16_t decoded_length;
+	uint32_t sample, r;
+	uint64_t start_ns;
+	ble_pickit_lz_t lz;
+
+	// Decoder, in real time for the speed.
+	for (sample = 0 ; sample < SAMPLE_COUNT ; sample++)
+	{
+		sample_fill(sample);
+		compressed_length[sample] = lz_encode(m_sample, SAMPLE_SIZE, m_compressed);
+		CHECK(compressed_length[sample] <= COMPRESSED_MAX);
+
+		CHECK(lz_decode(m_compressed, compressed_length[sample], FRAGMENT_SIZE, &decoded_length) == NRF_SUCCESS);
+		CHECK((decoded_length == SAMPLE_SIZE) && (memcmp(m_decoded, m_sample, SAMPLE_SIZE) == 0));
+		CHECK(lz_decode(m_compressed, compressed_length[sample], 1, &decoded_length) == NRF_SUCCESS);
+		CHECK((decoded_length == SAMPLE_SIZE) && (memcmp(m_decoded, m_sample, SAMPLE_SIZE) == 0));
+
+		start_ns = host_clock_ns();
+		for (r = 0 ; r < DECODE_REPETITIONS ; r++)
+		{
+			(void) lz_decode(m_compressed, compressed_length[sample], FRAGMENT_SIZE, &decoded_length);
+		}
+		decode_ns_per_byte[sample] = (double) (host_clock_ns() - start_ns) / ((double) DECODE_REPETITIONS * SAMPLE_SIZE);
+	}
+	ble_pickit_lz_init(&lz);
+	decoded_length = 0;
+	CHECK(ble_pickit_lz_decode(&lz, bad_offset, sizeof(bad_offset), m_decoded, &decoded_length, SAMPLE_SIZE) == NRF_ERROR_INVALID_DATA);
+	sample_fill(SAMPLE_CONFIG);
+	(void) lz_encode(m_sample, SAMPLE_SIZE, m_compressed);
+	CHECK(lz_decode(m_compressed, compressed_length[SAMPLE_CONFIG], FRAGMENT_SIZE, &decoded_length) == NRF_SUCCESS);
+	ble_pickit_lz_init(&lz);
+	decoded_length = 0;
+	CHECK(ble_pickit_lz_decode(&lz, m_compressed, compressed_length[SAMPLE_CONFIG], m_decoded, &decoded_length, SAMPLE_SIZE / 2) == NRF_ERROR_DATA_SIZE);
+
+	// Bridge: raw and compressed transfers of each sample, in virtual time.
+	config.writes_per_event = WRITES_PER_EVENT;
+	host_clock_virtual_set(true);
+	bridge_init(&config);
+	host_mcu_init(&m_mcu, &mcu_init);
+	bridge_hook_set(hook, NULL);
+	host_sd_central_set(&central);
+
+	CHECK(bridge_run_until(is_started, NULL, TIMEOUT_NS));
+	host_sd_connect();
+	CHECK(bridge_run_until(is_connected, NULL, TIMEOUT_NS));
+	CHECK(host_sd_notification_enable(MESSAGE_APP_CHAR_UUID, true));
+	bridge_run_for(CCCD_WRITE_NS);
+	CHECK(bridge_run_until(is_mcu_idle, NULL, TIMEOUT_NS));
+
+	for (sample = 0 ; sample < SAMPLE_COUNT ; sample++)
+	{
+		uint64_t raw_ns, lz_ns;
+
+		sample_fill(sample);
+		(void) lz_encode(m_sample, SAMPLE_SIZE, m_compressed);
+		raw_ns = transfer_run(ID_CHAR_EXT_BUFFER_NO_CRC, m_sample, SAMPLE_SIZE);
+		lz_ns = transfer_run(ID_CHAR_EXT_BUFFER_LZ, m_compressed, compressed_length[sample]);
+		if (sample != SAMPLE_RANDOM)
+		{
+			CHECK((compressed_length[sample] * 2) < SAMPLE_SIZE);
+			CHECK(lz_ns < raw_ns);
+		}
+
+		printf("{\"test\":\"lz\",\"sample\":\"%s\",\"plain\":%u,\"compressed\":%u,\"ratio\":%.2f,\"decode_ns_per_byte\":%.2f,"
+				"\"transfer_us\":{\"raw\":%.0f,\"lz\":%.0f},\"throughput_bytes_per_s\":{\"raw\":%.0f,\"lz\":%.0f}}\n",
+				m_sample_names[sample], SAMPLE_SIZE, compressed_length[sample], (double) SAMPLE_SIZE / compressed_length[sample],
+				decode_ns_per_byte[sample], raw_ns / 1e3, lz_ns / 1e3, SAMPLE_SIZE * 1e9 / raw_ns, SAMPLE_SIZE * 1e9 / lz_ns);
+	}
+
+	CHECK(fake_uart_stats_get()->rx_overflows == 0);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,307 @@
+/*
+ * Cycle profiler (ble_pickit_profiler.h): records, overhead of the probes and export of the main loop regions.
+ *  - Record: count / min / avg / max of the cycles, encoded big endian (Region - Count - Min - Avg - Max), reset.
+ *  - Overhead: ns and cycles of an empty PROFILER_BEGIN / PROFILER_END pair and added to fu_crc_16_ibm (258 bytes).
+ *  - Bridge under load (probes of main.c built in, DWT CYCCNT on the host time in 64 MHz cycles): the regions of the
+ *    main loop are exported over the UART (ID_PROFILER) and over a GATT read (cache key CACHE_KEY_PROFILER + region),
+ *    the worst main loop iteration bounded, ID_PROFILER 0x01 resets the records.
+ * JSON lines: the probe overhead and the regions read over the UART.
+ * The test includes bridge.c for the probes of main.c (the regions of ble_vsd.c are not built in the host library).
+ */
+#define BLE_PICKIT_PROFILER_ENABLED
+
+#include "host_clock.h"
+#include "host_mcu.h"
+#include "../bridge.c"
+#include "tests/test.h"
+
+#define TIMEOUT_NS							2000000000ULL
+#define CCCD_WRITE_NS						200000000ULL
+#define PROBE_ITERATIONS					1000000
+#define CRC_ITERATIONS						100000
+#define CRC_LENGTH							258
+#define LOAD_FRAMES							32
+#define LOAD_FRAME_SIZE						64
+#define MAIN_LOOP_WORST_CASE_CYCLES			(HOST_CPU_FREQUENCY / 100)			// 10 ms: a pass never waits
+
+static const char * const m_region_names[PROFILER_REGION_COUNT] = {"main_loop", "main_evt", "leds", "uart_rx", "flags", "crc", "ble_evt", "service_evt"};
+
+static host_mcu_t m_mcu;
+static ble_pickit_profiler_record_t m_uart_records[PROFILER_REGION_COUNT];
+static bool m_is_uart_received = false;
+static uint8_t m_read_value[PROFILER_RECORD_SIZE + 2];
+static uint16_t m_read_length = 0;
+static uint32_t m_received = 0;
+static volatile uint32_t m_sink;
+
+static uint32_t mcu_write(uint8_t const * p_data, uint32_t length, void * p_context)
+{
+	fake_uart_host_write(p_data, length);
+	return length;
+}
+
+static uint32_t mcu_read(uint8_t * p_data, uint32_t length, void * p_context)
+{
+	return fake_uart_host_read(p_data, length);
+}
+
+static uint32_t u32_decode(uint8_t const * p_data)
+{
+	return ((uint32_t) p_data[0] << 24) | ((uint32_t) p_data[1] << 16) | ((uint32_t) p_data[2] << 8) | p_data[3];
+}
+
+/**@brief Function for decoding a record (Region - Count - Min - Avg - Max): the sum is rebuilt from the average.
+ */
+static uint8_t record_decode(uint8_t const * p_data, ble_pickit_profiler_record_t * p_record)
+{
+	p_record->count = u32_decode(&p_data[1]);
+	p_record->min = u32_decode(&p_data[5]);
+	p_record->sum = (uint64_t) u32_decode(&p_data[9]) * p_record->count;
+	p_record->max = u32_decode(&p_data[13]);
+	return p_data[0];
+}
+
+static void mcu_on_frame(host_mcu_t * p_mcu, uint8_t id, uint8_t const * p_data, uint16_t length, void * p_context)
+{
+	uint16_t i;
+
+	if (id != ID_PROFILER)
+	{
+		return;
+	}
+	CHECK(length == (PROFILER_REGION_COUNT * PROFILER_RECORD_SIZE));
+	for (i = 0 ; (i + PROFILER_RECORD_SIZE) <= length ; i += PROFILER_RECORD_SIZE)
+	{
+		CHECK(p_data[i] == (i / PROFILER_RECORD_SIZE));
+		(void) record_decode(&p_data[i], &m_uart_records[i / PROFILER_RECORD_SIZE]);
+	}
+	m_is_uart_received = true;
+}
+
+static void central_on_notification(uint16_t handle, uint8_t const * p_data, uint16_t length, void * p_context)
+{
+	if (handle == host_sd_value_handle(MESSAGE_APP_CHAR_UUID))
+	{
+		m_received++;
+	}
+}
+
+static void central_on_read_response(uint16_t handle, uint8_t const * p_data, uint16_t length, void * p_context)
+{
+	if ((handle == host_sd_value_handle(MESSAGE_CACHE_UUID)) && (length <= sizeof(m_read_value)))
+	{
+		memcpy(m_read_value, p_data, length);
+		m_read_length = length;
+	}
+}
+
+static void hook(void * p_context)
+{
+	host_mcu_process(&m_mcu);
+}
+
+static bool is_started(void * p_context)
+{
+	return bridge_is_started() && host_mcu_is_idle(&m_mcu);
+}
+
+static bool is_connected(void * p_context)
+{
+	return bridge_is_connected();
+}
+
+static bool is_mcu_idle(void * p_context)
+{
+	return host_mcu_is_idle(&m_mcu) && fake_uart_is_idle();
+}
+
+static bool is_flag_set(void * p_context)
+{
+	return *(bool const *) p_context;
+}
+
+static bool is_read(void * p_context)
+{
+	return m_read_length > 0;
+}
+
+static bool is_load_received(void * p_context)
+{
+	return m_received == LOAD_FRAMES;
+}
+
+static void record_check(void)
+{
+	ble_pickit_profiler_record_t record;
+	uint8_t buffer[PROFILER_RECORD_SIZE];
+
+	ble_pickit_profiler_reset();
+	ble_pickit_profiler_record(PROFILER_REGION_CRC, 30);
+	ble_pickit_profiler_record(PROFILER_REGION_CRC, 10);
+	ble_pickit_profiler_record(PROFILER_REGION_CRC, 21);
+	CHECK(ble_pickit_profiler_encode(PROFILER_REGION_CRC, buffer) == PROFILER_RECORD_SIZE);
+	CHECK(record_decode(buffer, &record) == PROFILER_REGION_CRC);
+	CHECK((record.count == 3) && (record.min == 10) && (record.sum == 60) && (record.max == 30));
+	CHECK((buffer[1] == 0) && (buffer[4] == 3) && (buffer[12] == 20));
+
+	// Region without execution: zeros (no division by zero), unknown region: nothing encoded.
+	CHECK(ble_pickit_profiler_encode(PROFILER_REGION_LEDS, buffer) == PROFILER_RECORD_SIZE);
+	CHECK(record_decode(buffer, &record) == PROFILER_REGION_LEDS);
+	CHECK((record.count == 0) && (record.min == 0) && (record.sum == 0) && (record.max == 0));
+	CHECK(ble_pickit_profiler_encode(PROFILER_REGION_COUNT, buffer) == 0);
+
+	ble_pickit_profiler_reset();
+	CHECK(ble_pickit_profiler_encode(PROFILER_REGION_CRC, buffer) == PROFILER_RECORD_SIZE);
+	CHECK(record_decode(buffer, &record) == PROFILER_REGION_CRC);
+	CHECK(record.count == 0);
+}
+
+static void overhead_measure(void)
+{
+	static uint8_t data[CRC_LENGTH];
+	ble_pickit_profiler_record_t record;
+	uint8_t buffer[PROFILER_RECORD_SIZE];
+	uint64_t start, probe_ns, crc_ns, crc_probed_ns;
+	uint32_t i;
+
+	ble_pickit_profiler_reset();
+	start = host_clock_real_ns();
+	for (i = 0 ; i < PROBE_ITERATIONS ; i++)
+	{
+		PROFILER_BEGIN(PROFILER_REGION_CRC);
+		PROFILER_END(PROFILER_REGION_CRC);
+	}
+	probe_ns = host_clock_real_ns() - start;
+	(void) ble_pickit_profiler_encode(PROFILER_REGION_CRC, buffer);
+	(void) record_decode(buffer, &record);
+	CHECK(record.count == PROBE_ITERATIONS);
+	CHECK((record.min <= (record.sum / record.count)) && ((record.sum / record.count) <= record.max));
+
+	start = host_clock_real_ns();
+	for (i = 0 ; i < CRC_ITERATIONS ; i++)
+	{
+		m_sink += fu_crc_16_ibm(data, CRC_LENGTH);
+	}
+	crc_ns = host_clock_real_ns() - start;
+	start = host_clock_real_ns();
+	for (i = 0 ; i < CRC_ITERATIONS ; i++)
+	{
+		PROFILER_BEGIN(PROFILER_REGION_CRC);
+		m_sink += fu_crc_16_ibm(data, CRC_LENGTH);
+		PROFILER_END(PROFILER_REGION_CRC);
+	}
+	crc_probed_ns = host_clock_real_ns() - start;
+
+	printf("{\"test\":\"profiler\",\"probe\":{\"ns_per_pair\":%.1f,\"cycles\":{\"min\":%u,\"avg\":%llu,\"max\":%u}},"
+			"\"crc16_%u\":{\"ns\":%.1f,\"ns_probed\":%.1f}}\n",
+			(double) probe_ns / PROBE_ITERATIONS, record.min, (unsigned long long) (record.sum / record.count), record.max,
+			CRC_LENGTH, (double) crc_ns / CRC_ITERATIONS, (double) crc_probed_ns / CRC_ITERATIONS);
+	ble_pickit_profiler_reset();
+}
+
+static void regions_print(void)
+{
+	uint8_t region;
+
+	printf("{\"test\":\"profiler\",\"regions\":{");
+	for (region = 0 ; region < PROFILER_REGION_COUNT ; region++)
+	{
+		ble_pickit_profiler_record_t const * p_record = &m_uart_records[region];
+
+		printf("%s\"%s\":{\"count\":%u,\"cycles\":{\"min\":%u,\"avg\":%llu,\"max\":%u}}", (region > 0) ? "," : "",
+				m_region_names[region], p_record->count, p_record->min,
+				(unsigned long long) ((p_record->count > 0) ? (p_record->sum / p_record->count) : 0), p_record->max);
+	}
+	printf("},\"main_loop_worst_us\":%.1f}\n", m_uart_records[PROFILER_REGION_MAIN_LOOP].max * 1e6 / HOST_CPU_FREQUENCY);
+}
+
+static void uart_read(void)
+{
+	m_is_uart_received = false;
+	CHECK(host_mcu_send(&m_mcu, ID_PROFILER, NULL, 0));
+	CHECK(bridge_run_until(is_flag_set, &m_is_uart_received, TIMEOUT_NS));
+}
+
+static void gatt_read(uint8_t region)
+{
+	uint8_t const key = CACHE_KEY_PROFILER + region;
+
+	CHECK(host_sd_write(host_sd_value_handle(MESSAGE_CACHE_UUID), &key, sizeof(key)));
+	bridge_run_for(CCCD_WRITE_NS);
+	m_read_length = 0;
+	CHECK(host_sd_read(host_sd_value_handle(MESSAGE_CACHE_UUID)));
+	CHECK(bridge_run_until(is_read, NULL, TIMEOUT_NS));
+}
+
+int main(void)
+{
+	host_sd_config_t const config = HOST_SD_CONFIG_DEFAULT;
+	host_sd_central_t const central = {.on_notification = central_on_notification, .on_read_response = central_on_read_response};
+	host_mcu_init_t const mcu_init = {.write = mcu_write, .read = mcu_read, .on_frame = mcu_on_frame, .baud_rate = FAKE_UART_BAUD_RATE};
+	uint8_t const reset = 0x01;
+	uint8_t data[LOAD_FRAME_SIZE];
+	ble_pickit_profiler_record_t record;
+	ble_pickit_profiler_record_t const * p_main_loop = &m_uart_records[PROFILER_REGION_MAIN_LOOP];
+	uint32_t main_loop_count;
+	uint32_t i;
+
+	record_check();
+	overhead_measure();
+
+	host_clock_virtual_set(true);
+	bridge_init(&config);
+	host_mcu_init(&m_mcu, &mcu_init);
+	bridge_hook_set(hook, NULL);
+	host_sd_central_set(&central);
+
+	CHECK(bridge_run_until(is_started, NULL, TIMEOUT_NS));
+	host_sd_connect();
+	CHECK(bridge_run_until(is_connected, NULL, TIMEOUT_NS));
+	CHECK(host_sd_notification_enable(MESSAGE_APP_CHAR_UUID, true));
+	bridge_run_for(CCCD_WRITE_NS);
+	CHECK(bridge_run_until(is_mcu_idle, NULL, TIMEOUT_NS));
+
+	// Load: frames of the host MCU notified to the central.
+	memset(data, 0x5a, sizeof(data));
+	for (i = 0 ; i < LOAD_FRAMES ; i++)
+	{
+		CHECK(host_mcu_send(&m_mcu, ID_CHAR_BUFFER, data, sizeof(data)));
+	}
+	CHECK(bridge_run_until(is_load_received, NULL, TIMEOUT_NS));
+	CHECK(bridge_run_until(is_mcu_idle, NULL, TIMEOUT_NS));
+
+	// UART export: the regions probed by main.c are counted, min <= avg <= max.
+	uart_read();
+	regions_print();
+	CHECK(p_main_loop->count > 0);
+	CHECK(m_uart_records[PROFILER_REGION_MAIN_EVT].count > 0);
+	CHECK(m_uart_records[PROFILER_REGION_BLE_EVT].count > 0);
+	for (i = 0 ; i < PROFILER_REGION_COUNT ; i++)
+	{
+		if (m_uart_records[i].count > 0)
+		{
+			CHECK(m_uart_records[i].min <= (m_uart_records[i].sum / m_uart_records[i].count));
+			CHECK((m_uart_records[i].sum / m_uart_records[i].count) <= m_uart_records[i].max);
+		}
+	}
+	CHECK(p_main_loop->max < MAIN_LOOP_WORST_CASE_CYCLES);
+	main_loop_count = p_main_loop->count;
+
+	// GATT export: the same record, counted since (the main loop keeps running).
+	gatt_read(PROFILER_REGION_MAIN_LOOP);
+	CHECK(m_read_length == (PROFILER_RECORD_SIZE + 2));
+	CHECK((m_read_value[0] == (CACHE_KEY_PROFILER + PROFILER_REGION_MAIN_LOOP)) && (m_read_value[1] == CACHE_STATUS_FRESH));
+	CHECK(record_decode(&m_read_value[2], &record) == PROFILER_REGION_MAIN_LOOP);
+	CHECK(record.count > main_loop_count);
+	CHECK(record.max >= p_main_loop->max);
+	gatt_read(PROFILER_REGION_COUNT);
+	CHECK((m_read_length == 2) && (m_read_value[1] == CACHE_STATUS_MISS));
+
+	// Reset: counted again from zero.
+	CHECK(host_mcu_send(&m_mcu, ID_PROFILER, &reset, sizeof(reset)));
+	CHECK(bridge_run_until(is_mcu_idle, NULL, TIMEOUT_NS));
+	uart_read();
+	CHECK((p_main_loop->count > 0) && (p_main_loop->count < record.count));
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,289 @@
+/*
+ * Message schema (ble_pickit_schema.h): encoders, decoders and dispatch tables generated from the X-macro lists.
+ *  - Parameters snapshot: BLE_PICKIT_PARAMS_SIZE bytes, big endian, decoded back to the same fields.
+ *  - Connection parameters: encoded from BLE_PICKIT_CONN_PARAMS_LAYOUT and decoded by ble_pickit_conn_params_decode.
+ *  - Constant frame (_boot): the precomputed CRC16 is fu_crc_16_ibm of the frame.
+ *  - UART jump table: one handler per ID of BLE_PICKIT_UART_RX_SCHEMA, the frames out of their length range and the
+ *    IDs without entry ignored. Params writes: one entry per (sub-command, length).
+ * One JSON line per message: ns per call (min over the repetitions of a calibrated batch, CLOCK_MONOTONIC).
+ * The test includes ble_vsd.c for its jump table and frame builders, the bridge is not started.
+ */
+#include "../ble_vsd.c"
+
+#include "host_clock.h"
+#include "tests/test.h"
+
+#define BENCH_REPETITIONS					15
+#define BENCH_SAMPLE_MIN_NS					200000ULL
+#define BOOT_FRAME_LENGTH					6
+
+#define _SCHEMA_COUNT(...)					+ 1
+#define _SCHEMA_FIELD_CHECK(_size, _field)	CHECK(p_decoded->_field == p_struct->_field);
+#define _SCHEMA_RX_CHECK(_id, _min_length, _max_length, _handler)										\
+	CHECK(m_uart_rx_schema[_id].handler == _handler);													\
+	CHECK((m_uart_rx_schema[_id].min_length == (_min_length)) && (m_uart_rx_schema[_id].max_length == (_max_length)));
+#define _SCHEMA_WRITE_ENTRY(_sub_command, _length, _handler)	{_sub_command, _length},
+
+typedef struct
+{
+	char const *					p_name;
+	uint32_t						bytes;								/**< Bytes of the message (0: no frame). */
+	void (*run)(void);
+} bench_message_t;
+
+static ble_pickit_t m_vsd = {.params = BLE_PICKIT_PARAMS_INSTANCE()};
+static uint8_t m_frame[64];
+static uint8_t m_conn_params_frame[BLE_PICKIT_CONN_PARAMS_SIZE];
+static ble_gap_conn_params_t m_conn_params;
+static volatile uint32_t m_sink;
+
+/**@brief Function for encoding the connection parameters (the bridge only decodes them).
+ */
+static uint8_t conn_params_encode(ble_gap_conn_params_t const * p_struct, uint8_t * p_buffer)
+{
+	uint8_t i;
+
+	BLE_PICKIT_CONN_PARAMS_LAYOUT(_SCHEMA_ENCODE)
+	return BLE_PICKIT_CONN_PARAMS_SIZE;
+}
+
+/**@brief Function for decoding the parameters snapshot (the bridge only encodes it).
+ */
+static void params_decode(uint8_t const * p_buffer, ble_pickit_params * p_struct)
+{
+	uint8_t i;
+
+	BLE_PICKIT_PARAMS_LAYOUT(_SCHEMA_DECODE)
+}
+
+static void params_check(ble_pickit_params const * p_decoded, ble_pickit_params const * p_struct)
+{
+	BLE_PICKIT_PARAMS_LAYOUT(_SCHEMA_FIELD_CHECK)
+}
+
+static void params_round_trip_check(void)
+{
+	ble_pickit_params decoded;
+	uint8_t buffer[BLE_PICKIT_PARAMS_SIZE + 1];
+
+	m_vsd.params.current_gap_params.conn_params.min_conn_interval = 0x0006;
+	m_vsd.params.current_gap_params.conn_params.max_conn_interval = 0x0c80;
+	m_vsd.params.current_gap_params.conn_params.slave_latency = 0x01f3;
+	m_vsd.params.current_gap_params.conn_params.conn_sup_timeout = 0x0c80;
+	m_vsd.params.current_gap_params.phys_params.tx_phys = BLE_GAP_PHY_2MBPS;
+	m_vsd.params.current_gap_params.mtu_size_params.max_tx_octets = 251;
+	m_vsd.params.current_gap_params.mtu_size_params.max_rx_octets = 27;
+	m_vsd.params.pa_lna_enable = true;
+	m_vsd.params.leds_status_enable = false;
+
+	memset(buffer, 0xa5, sizeof(buffer));
+	CHECK(ble_pickit_params_encode(&m_vsd.params, buffer) == BLE_PICKIT_PARAMS_SIZE);
+	CHECK(BLE_PICKIT_PARAMS_SIZE == 13);
+	CHECK(buffer[BLE_PICKIT_PARAMS_SIZE] == 0xa5);
+	// Big endian, in the order of the layout.
+	CHECK((buffer[2] == 0x0c) && (buffer[3] == 0x80) && (buffer[4] == 0x01) && (buffer[5] == 0xf3));
+	CHECK((buffer[8] == BLE_GAP_PHY_2MBPS) && (buffer[9] == 251) && (buffer[10] == 27) && (buffer[11] == 1) && (buffer[12] == 0));
+
+	memset(&decoded, 0, sizeof(decoded));
+	params_decode(buffer, &decoded);
+	params_check(&decoded, &m_vsd.params);
+}
+
+static void conn_params_round_trip_check(void)
+{
+	ble_gap_conn_params_t const conn_params = {.min_conn_interval = 0x0010, .max_conn_interval = 0x0028, .slave_latency = 0x0102, .conn_sup_timeout = 0x0258};
+	ble_gap_conn_params_t decoded;
+
+	CHECK(conn_params_encode(&conn_params, m_conn_params_frame) == BLE_PICKIT_CONN_PARAMS_SIZE);
+	CHECK(BLE_PICKIT_CONN_PARAMS_SIZE == 8);
+	CHECK((m_conn_params_frame[4] == 0x01) && (m_conn_params_frame[5] == 0x02));
+	memset(&decoded, 0xff, sizeof(decoded));
+	ble_pickit_conn_params_decode(m_conn_params_frame, &decoded);
+	CHECK(memcmp(&decoded, &conn_params, sizeof(decoded)) == 0);
+}
+
+static void constant_frame_check(void)
+{
+	uint16_t crc;
+
+	_boot(m_frame);
+	crc = fu_crc_16_ibm(m_frame, m_frame[2] + 3);
+	CHECK((m_frame[0] == ID_BOOT_MODE) && (m_frame[1] == 'N') && (m_frame[2] + 5 == BOOT_FRAME_LENGTH));
+	CHECK((m_frame[4] == (crc >> 8)) && (m_frame[5] == (crc & 0xff)));
+}
+
+static void dispatch_check(void)
+{
+	static const struct
+	{
+		uint8_t						sub_command;
+		uint8_t						length;
+	} params_write_schema[] = {BLE_PICKIT_PARAMS_WRITE_SCHEMA(_SCHEMA_WRITE_ENTRY)};
+	uint8_t data[UINT8_MAX];
+	uint32_t handlers = 0;
+	uint32_t i, j;
+
+	// Jump table: every entry of the list at its ID (no ID listed twice), nothing else.
+	BLE_PICKIT_UART_RX_SCHEMA(_SCHEMA_RX_CHECK)
+	for (i = 0 ; i < ARRAY_SIZE(m_uart_rx_schema) ; i++)
+	{
+		handlers += (m_uart_rx_schema[i].handler != NULL) ? 1 : 0;
+		if (m_uart_rx_schema[i].handler != NULL)
+		{
+			CHECK(m_uart_rx_schema[i].min_length <= m_uart_rx_schema[i].max_length);
+			CHECK((i & ID_CHANNEL_MASK) != ID_CHANNEL_BUFFER);
+		}
+	}
+	CHECK(handlers == (0 BLE_PICKIT_UART_RX_SCHEMA(_SCHEMA_COUNT)));
+
+	// Length range: the frames too short or too long are ignored.
+	memset(data, 0, sizeof(data));
+	data[0] = 0x01;
+	m_vsd.params.pa_lna_enable = false;
+	_uart_rx_dispatch(ID_PA_LNA, data, 0);
+	CHECK(!m_vsd.params.pa_lna_enable);
+	_uart_rx_dispatch(ID_PA_LNA, data, 1);
+	CHECK(m_vsd.params.pa_lna_enable);
+	m_vsd.params.rpc_timeout = 1000;
+	_uart_rx_dispatch(ID_RPC_TIMEOUT, data, 1);
+	CHECK(m_vsd.params.rpc_timeout == 1000);
+	m_vsd.flags.send_version = false;
+	_uart_rx_dispatch(ID_GET_VERSION, data, 0);
+	CHECK(m_vsd.flags.send_version);
+	m_vsd.flags.set_conn_params = false;
+	_uart_rx_dispatch(ID_SET_BLE_CONN_PARAMS, m_conn_params_frame, BLE_PICKIT_CONN_PARAMS_SIZE - 1);
+	CHECK(!m_vsd.flags.set_conn_params);
+	_uart_rx_dispatch(ID_SET_BLE_CONN_PARAMS, m_conn_params_frame, BLE_PICKIT_CONN_PARAMS_SIZE);
+	CHECK(m_vsd.flags.set_conn_params);
+	CHECK(m_vsd.params.preferred_gap_params.conn_params.slave_latency == 0x0102);
+
+	// Params writes: the (sub-command, length) pairs tell the handlers apart.
+	for (i = 0 ; i < ARRAY_SIZE(params_write_schema) ; i++)
+	{
+		for (j = i + 1 ; j < ARRAY_SIZE(params_write_schema) ; j++)
+		{
+			CHECK(	(params_write_schema[i].sub_command != params_write_schema[j].sub_command) ||
+					(params_write_schema[i].length != params_write_schema[j].length));
+		}
+	}
+}
+
+/* Messages */
+
+static void params_encode_run(void)
+{
+	m_sink += ble_pickit_params_encode(&m_vsd.params, m_frame);
+}
+
+static void ble_params_run(void)
+{
+	_ble_params(m_frame);
+}
+
+static void boot_run(void)
+{
+	_boot(m_frame);
+}
+
+/**@brief The boot frame with its CRC16 computed: the cost folded by the constant frame.
+ */
+static void boot_crc_run(void)
+{
+	uint16_t crc;
+
+	m_frame[0] = ID_BOOT_MODE;
+	m_frame[1] = 'N';
+	m_frame[2] = 1;
+	m_frame[3] = 0x23;
+	crc = fu_crc_16_ibm(m_frame, m_frame[2] + 3);
+	m_frame[4] = (crc >> 8) & 0xff;
+	m_frame[5] = (crc >> 0) & 0xff;
+}
+
+static void conn_params_decode_run(void)
+{
+	ble_pickit_conn_params_decode(m_conn_params_frame, &m_conn_params);
+	m_sink += m_conn_params.slave_latency;
+}
+
+static void rx_pa_lna_run(void)
+{
+	_uart_rx_dispatch(ID_PA_LNA, m_frame, 1);
+}
+
+static void rx_set_ble_conn_params_run(void)
+{
+	_uart_rx_dispatch(ID_SET_BLE_CONN_PARAMS, m_conn_params_frame, BLE_PICKIT_CONN_PARAMS_SIZE);
+}
+
+static void rx_unknown_id_run(void)
+{
+	_uart_rx_dispatch(0xfe, m_frame, 1);
+}
+
+static double message_measure(bench_message_t const * p_message)
+{
+	double min = 0;
+	uint64_t start, duration;
+	uint32_t batch = 1;
+	uint32_t repetition;
+	uint32_t i;
+
+	// Calibration (and warm-up): the batch grows until it lasts BENCH_SAMPLE_MIN_NS.
+	do
+	{
+		batch *= 2;
+		start = host_clock_real_ns();
+		for (i = 0 ; i < batch ; i++)
+		{
+			p_message->run();
+		}
+	} while ((host_clock_real_ns() - start) < BENCH_SAMPLE_MIN_NS);
+
+	for (repetition = 0 ; repetition < BENCH_REPETITIONS ; repetition++)
+	{
+		start = host_clock_real_ns();
+		for (i = 0 ; i < batch ; i++)
+		{
+			p_message->run();
+		}
+		duration = host_clock_real_ns() - start;
+		if ((repetition == 0) || (((double) duration / batch) < min))
+		{
+			min = (double) duration / batch;
+		}
+	}
+	printf("{\"test\":\"schema\",\"message\":\"%s\",\"bytes\":%u,\"batch\":%u,\"ns_per_call\":%.1f}\n",
+			p_message->p_name, p_message->bytes, batch, min);
+	return min;
+}
+
+int main(void)
+{
+	bench_message_t const messages[] =
+	{
+		{"params_encode",			BLE_PICKIT_PARAMS_SIZE,			params_encode_run},
+		{"ble_params_frame",		BLE_PICKIT_PARAMS_SIZE + 5,		ble_params_run},
+		{"boot_frame_folded",		BOOT_FRAME_LENGTH,				boot_run},
+		{"boot_frame_crc",			BOOT_FRAME_LENGTH,				boot_crc_run},
+		{"conn_params_decode",		BLE_PICKIT_CONN_PARAMS_SIZE,	conn_params_decode_run},
+		{"rx_pa_lna",				1,								rx_pa_lna_run},
+		{"rx_set_ble_conn_params",	BLE_PICKIT_CONN_PARAMS_SIZE,	rx_set_ble_conn_params_run},
+		{"rx_unknown_id",			1,								rx_unknown_id_run},
+	};
+	uint32_t i;
+
+	p_vsd = &m_vsd;
+
+	params_round_trip_check();
+	conn_params_round_trip_check();
+	constant_frame_check();
+	dispatch_check();
+
+	for (i = 0 ; i < ARRAY_SIZE(messages) ; i++)
+	{
+		CHECK(message_measure(&messages[i]) > 0);
+	}
+
+	return TEST_RESULT();
+}
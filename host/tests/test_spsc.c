@@ -0,0 +1,291 @@
+/*
+ * Concurrency stress of the main loop queues (producer and consumer in two threads, like the SoftDevice observer
+ * interrupt and the main loop):
+ *  - nrf_atfifo: every item received once, in order, the queue holds its declared number of items.
+ *  - on_service_event_handler() vs main_evt_process(): no event lost, the written data intact through the data pool,
+ *    SERVICE_EVT_TX_COMPLETE counted apart (never fills the queue).
+ *  - Service events beyond MAIN_EVT_SERVICE_MAX or beyond the data pool: dropped without error and resynchronized (credits
+ *    notified again), the GAP events keep their MAIN_EVT_GAP_MAX entries, a full queue for a GAP event is a fatal error.
+ * The test includes bridge.c for the static functions and variables of main.c.
+ */
+#include <pthread.h>
+#include <setjmp.h>
+#include <sched.h>
+#include "host_clock.h"
+#include "../bridge.c"
+#include "tests/test.h"
+
+#define FIFO_ITEMS							8
+#define FIFO_TRANSFERS						200000
+#define SERVICE_EVENTS						50000
+#define TX_COMPLETE_PER_EVENT				4
+#define WRITE_SIZE_MAX						16									// MAIN_EVT_SERVICE_MAX writes fit in the channel queue
+#define POOL_WRITE_SIZE						(NRF_SDH_BLE_GATT_MAX_MTU_SIZE - 3)
+
+NRF_ATFIFO_DEF(m_test_fifo, uint32_t, FIFO_ITEMS);
+
+static volatile bool m_is_producer_done = false;
+static uint8_t m_last_channel_state[BLE_PICKIT_CHANNEL_COUNT];
+static jmp_buf m_error_jump;
+static ret_code_t m_error_code = NRF_SUCCESS;
+
+static uint32_t fifo_count(nrf_atfifo_t * p_fifo)
+{
+	nrf_atfifo_postag_t tail = {.tag = __atomic_load_n(&p_fifo->tail.tag, __ATOMIC_SEQ_CST)};
+	nrf_atfifo_postag_t head = {.tag = __atomic_load_n(&p_fifo->head.tag, __ATOMIC_SEQ_CST)};
+	int32_t bytes = (int32_t) tail.pos.rd - (int32_t) head.pos.wr;
+
+	if (bytes < 0)
+	{
+		bytes += p_fifo->buf_size;
+	}
+	return bytes / p_fifo->item_size;
+}
+
+static void * fifo_producer(void * p_context)
+{
+	uint32_t value;
+
+	for (value = 1 ; value <= FIFO_TRANSFERS ; value++)
+	{
+		while (nrf_atfifo_alloc_put(m_test_fifo, &value, sizeof(value), NULL) != NRF_SUCCESS)
+		{
+			sched_yield();
+		}
+	}
+	return NULL;
+}
+
+static void test_atfifo(void)
+{
+	pthread_t producer;
+	uint32_t expected = 1;
+	uint32_t errors = 0;
+	uint32_t value;
+	uint32_t i;
+
+	CHECK(NRF_ATFIFO_INIT(m_test_fifo) == NRF_SUCCESS);
+
+	// Capacity: FIFO_ITEMS items, the next one is refused.
+	for (i = 0 ; i < FIFO_ITEMS ; i++)
+	{
+		CHECK(nrf_atfifo_alloc_put(m_test_fifo, &i, sizeof(i), NULL) == NRF_SUCCESS);
+	}
+	CHECK(nrf_atfifo_alloc_put(m_test_fifo, &i, sizeof(i), NULL) == NRF_ERROR_NO_MEM);
+	for (i = 0 ; i < FIFO_ITEMS ; i++)
+	{
+		CHECK((nrf_atfifo_get_free(m_test_fifo, &value, sizeof(value), NULL) == NRF_SUCCESS) && (value == i));
+	}
+	CHECK(nrf_atfifo_get_free(m_test_fifo, &value, sizeof(value), NULL) == NRF_ERROR_NOT_FOUND);
+
+	CHECK(pthread_create(&producer, NULL, fifo_producer, NULL) == 0);
+	while (expected <= FIFO_TRANSFERS)
+	{
+		if (nrf_atfifo_get_free(m_test_fifo, &value, sizeof(value), NULL) == NRF_SUCCESS)
+		{
+			errors += (value != expected);
+			expected = value + 1;
+		}
+		else
+		{
+			sched_yield();
+		}
+	}
+	CHECK(pthread_join(producer, NULL) == 0);
+	CHECK(errors == 0);
+	CHECK(nrf_atfifo_get_free(m_test_fifo, &value, sizeof(value), NULL) == NRF_ERROR_NOT_FOUND);
+}
+
+static uint8_t write_length(uint32_t sequence)
+{
+	return (sequence % WRITE_SIZE_MAX) + 1;
+}
+
+static void write_fill(uint8_t * p_data, uint32_t sequence)
+{
+	uint8_t i;
+
+	for (i = 0 ; i < write_length(sequence) ; i++)
+	{
+		p_data[i] = (uint8_t) (sequence + i);
+	}
+}
+
+/**@brief Waits while MAIN_EVT_SERVICE_MAX service events are queued: the firmware would drop the next one.
+ */
+static void service_producer_wait(void)
+{
+	while ((__atomic_load_n(&m_service_evt_queued, __ATOMIC_SEQ_CST) - __atomic_load_n(&m_service_evt_processed, __ATOMIC_SEQ_CST)) >= MAIN_EVT_SERVICE_MAX)
+	{
+		sched_yield();
+	}
+}
+
+/**@brief SoftDevice observer side: writes of the channel CCCDs and of the channel 0 (data of 1 to WRITE_SIZE_MAX bytes,
+ *        the pool wraps at varying offsets), both queued, and bursts of TX complete (counted).
+ */
+static void * service_producer(void * p_context)
+{
+	uint8_t data[WRITE_SIZE_MAX];
+	ble_msg_evt_t evt;
+	uint32_t i;
+	uint32_t j;
+
+	for (i = 0 ; i < SERVICE_EVENTS ; i++)
+	{
+		service_producer_wait();
+		evt.channel = i % BLE_PICKIT_CHANNEL_COUNT;
+		evt.evt_type = ((i / BLE_PICKIT_CHANNEL_COUNT) & 1) ? SERVICE_EVT_CHANNEL_NOTIFICATION_DISABLED : SERVICE_EVT_CHANNEL_NOTIFICATION_ENABLED;
+		m_last_channel_state[evt.channel] = (evt.evt_type == SERVICE_EVT_CHANNEL_NOTIFICATION_ENABLED);
+		on_service_event_handler(&m_msg, &evt, NULL, 0);
+
+		service_producer_wait();
+		evt.channel = 0;
+		evt.evt_type = SERVICE_EVT_CHANNEL_WRITE;
+		write_fill(data, i);
+		on_service_event_handler(&m_msg, &evt, data, write_length(i));
+
+		evt.evt_type = SERVICE_EVT_TX_COMPLETE;
+		for (j = 0 ; j < TX_COMPLETE_PER_EVENT ; j++)
+		{
+			on_service_event_handler(&m_msg, &evt, NULL, 0);
+		}
+	}
+	__atomic_store_n(&m_is_producer_done, true, __ATOMIC_SEQ_CST);
+	return NULL;
+}
+
+/**@brief Main loop side: the channel writes reach the channel queue in order and intact.
+ */
+static void channel_writes_check(uint32_t * p_received, uint32_t * p_errors)
+{
+	uint8_t data[UINT8_MAX];
+	uint8_t expected[WRITE_SIZE_MAX];
+	uint8_t channel;
+	uint8_t length;
+
+	while (ble_pickit_channel_uart_is_pending())
+	{
+		length = ble_pickit_channel_uart_peek(&channel, data);
+		write_fill(expected, *p_received);
+		*p_errors += (channel != 0) || (length != write_length(*p_received)) || (memcmp(data, expected, length) != 0);
+		ble_pickit_channel_uart_consume();
+		(*p_received)++;
+	}
+}
+
+static void test_service_events(void)
+{
+	pthread_t producer;
+	uint32_t received = 0;
+	uint32_t errors = 0;
+	uint32_t i;
+
+	m_tx_complete_count = 0;
+	m_tx_complete_processed = 0;
+	CHECK(pthread_create(&producer, NULL, service_producer, NULL) == 0);
+	while (!__atomic_load_n(&m_is_producer_done, __ATOMIC_SEQ_CST))
+	{
+		main_evt_process();
+		channel_writes_check(&received, &errors);
+		sched_yield();
+	}
+	CHECK(pthread_join(producer, NULL) == 0);
+	main_evt_process();
+	channel_writes_check(&received, &errors);
+
+	CHECK(fifo_count(m_main_evt_fifo) == 0);
+	CHECK(m_service_evt_dropped == 0);
+	CHECK(received == SERVICE_EVENTS);
+	CHECK(errors == 0);
+	CHECK(m_tx_complete_count == (SERVICE_EVENTS * TX_COMPLETE_PER_EVENT));
+	CHECK(m_tx_complete_processed == m_tx_complete_count);
+	for (i = 0 ; i < BLE_PICKIT_CHANNEL_COUNT ; i++)
+	{
+		CHECK(m_msg.char_channel[i].is_notification_enabled == m_last_channel_state[i]);
+	}
+}
+
+static void error_hook(ret_code_t error_code, uint32_t line_num, const uint8_t * p_file_name)
+{
+	m_error_code = error_code;
+	longjmp(m_error_jump, 1);
+}
+
+static void test_queue_full(void)
+{
+	ble_msg_evt_t evt = {.evt_type = SERVICE_EVT_CHANNEL_NOTIFICATION_ENABLED};
+	nrf_atfifo_item_put_t context;
+	uint8_t data[POOL_WRITE_SIZE] = {ID_CHAR_BUFFER, POOL_WRITE_SIZE - 2};
+	volatile uint32_t queued = 0;
+	uint32_t accepted;
+
+	// Service events: the next ones are dropped, no error.
+	host_app_error_hook_set(error_hook);
+	for (queued = 0 ; queued < (2 * MAIN_EVT_SERVICE_MAX) ; queued++)
+	{
+		on_service_event_handler(&m_msg, &evt, NULL, 0);
+	}
+	CHECK(fifo_count(m_main_evt_fifo) == MAIN_EVT_SERVICE_MAX);
+	CHECK(m_service_evt_dropped == (1UL << SERVICE_EVT_CHANNEL_NOTIFICATION_ENABLED));
+	CHECK(m_error_code == NRF_SUCCESS);
+
+	// GAP events: MAIN_EVT_GAP_MAX entries left, a full queue is fatal.
+	if (setjmp(m_error_jump) == 0)
+	{
+		for (queued = 0 ; queued <= MAIN_EVT_GAP_MAX ; queued++)
+		{
+			CHECK(main_evt_alloc(&context, MAIN_EVT_SOURCE_GAP, BLE_GAP_EVT_PHY_UPDATE_REQUEST) != NULL);
+			(void) nrf_atfifo_item_put(m_main_evt_fifo, &context);
+		}
+	}
+	host_app_error_hook_set(NULL);
+	CHECK(queued == MAIN_EVT_GAP_MAX);
+	CHECK(m_error_code == NRF_ERROR_NO_MEM);
+	main_evt_process();
+	CHECK(fifo_count(m_main_evt_fifo) == 0);
+	CHECK(m_service_evt_dropped == 0);
+
+	// Data pool: full before MAIN_EVT_SERVICE_MAX writes of POOL_WRITE_SIZE bytes, the credits of the central fit in it.
+	// The dropped writes give the credits back.
+	evt.evt_type = SERVICE_EVT_APP_WRITE;
+	for (accepted = 0 ; (accepted < MAIN_EVT_SERVICE_MAX) && (m_service_evt_dropped == 0) ; accepted++)
+	{
+		on_service_event_handler(&m_msg, &evt, data, sizeof(data));
+	}
+	CHECK(m_service_evt_dropped == (1UL << SERVICE_EVT_APP_WRITE));
+	CHECK(fifo_count(m_main_evt_fifo) == (accepted - 1));
+	CHECK((accepted - 1) >= OUTGOING_MESSAGE_RING_SIZE);
+	ble_pickit.flags.send_credits = false;
+	main_evt_process();
+	CHECK(ble_pickit.flags.send_credits);
+	CHECK(fifo_count(m_main_evt_fifo) == 0);
+	CHECK(m_evt_data_head == m_evt_data_tail);
+
+	// TX complete never fills the queue.
+	evt.evt_type = SERVICE_EVT_TX_COMPLETE;
+	for (queued = 0 ; queued < 1000 ; queued++)
+	{
+		on_service_event_handler(&m_msg, &evt, NULL, 0);
+	}
+	main_evt_process();
+	CHECK(fifo_count(m_main_evt_fifo) == 0);
+	CHECK(m_tx_complete_processed == m_tx_complete_count);
+}
+
+int main(void)
+{
+	host_sd_config_t const config = HOST_SD_CONFIG_DEFAULT;
+
+	test_atfifo();
+
+	host_clock_virtual_set(true);
+	bridge_init(&config);
+	bridge_run_for(600000000ULL);
+	CHECK(bridge_is_started());
+
+	test_service_events();
+	test_queue_full();
+
+	return TEST_RESULT();
+}
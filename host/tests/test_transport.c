@@ -0,0 +1,157 @@
+/*
+ * Transport fake: UART protocol between the host MCU (host_mcu.c) and the bridge over the fake UART, in virtual time.
+ *  - Frame of the bridge (boot frame) refused by the host MCU and sent again by the bridge.
+ *  - Frame of the host MCU acknowledged and forwarded to the central as an app notification.
+ *  - Frame with a corrupted CRC refused (NACK) and sent again.
+ *  - Frame without data (5 bytes: ID - 'W' - Length (0) - CRC) acknowledged.
+ */
+#include <string.h>
+#include "host_clock.h"
+#include "fake_uart.h"
+#include "host_mcu.h"
+#include "bridge.h"
+#include "ble_vsd.h"
+#include "ble_pickit_board.h"
+#include "ble_pickit_service.h"
+#include "tests/test.h"
+
+#define TIMEOUT_NS							2000000000ULL
+#define CCCD_WRITE_NS						200000000ULL						// Writes of the central: one per connection event
+
+static host_mcu_t m_mcu;
+static uint32_t m_notifications = 0;
+static uint8_t m_notification[256];
+static uint16_t m_notification_length = 0;
+static uint32_t m_frames[256];
+
+static uint32_t mcu_write(uint8_t const * p_data, uint32_t length, void * p_context)
+{
+	fake_uart_host_write(p_data, length);
+	return length;
+}
+
+static uint32_t mcu_read(uint8_t * p_data, uint32_t length, void * p_context)
+{
+	return fake_uart_host_read(p_data, length);
+}
+
+static void mcu_on_frame(host_mcu_t * p_mcu, uint8_t id, uint8_t const * p_data, uint16_t length, void * p_context)
+{
+	m_frames[id]++;
+}
+
+static void central_on_notification(uint16_t handle, uint8_t const * p_data, uint16_t length, void * p_context)
+{
+	if (handle == host_sd_value_handle(MESSAGE_APP_CHAR_UUID))
+	{
+		m_notifications++;
+		memcpy(m_notification, p_data, length);
+		m_notification_length = length;
+	}
+}
+
+static void hook(void * p_context)
+{
+	host_mcu_process(&m_mcu);
+}
+
+static bool is_started(void * p_context)
+{
+	return bridge_is_started();
+}
+
+static bool is_connected(void * p_context)
+{
+	return bridge_is_connected();
+}
+
+static bool is_mcu_idle(void * p_context)
+{
+	return host_mcu_is_idle(&m_mcu) && fake_uart_is_idle();
+}
+
+static bool is_nack_sent(void * p_context)
+{
+	return m_mcu.stats.nacks_sent > 0;
+}
+
+static bool is_boot_received(void * p_context)
+{
+	return m_frames[ID_BOOT_MODE] > 0;
+}
+
+static bool is_notified(void * p_context)
+{
+	return m_notifications >= *(uint32_t const *) p_context;
+}
+
+int main(void)
+{
+	host_sd_config_t const config = HOST_SD_CONFIG_DEFAULT;
+	host_sd_central_t const central = {.on_notification = central_on_notification};
+	host_mcu_init_t mcu_init = {.write = mcu_write, .read = mcu_read, .on_frame = mcu_on_frame, .baud_rate = FAKE_UART_BAUD_RATE};
+	uint8_t const payload[] = {0x10, 0x20, 0x30, 0x40, 0x50};
+	uint32_t expected;
+
+	host_clock_virtual_set(true);
+	bridge_init(&config);
+	host_mcu_init(&m_mcu, &mcu_init);
+	bridge_hook_set(hook, NULL);
+	host_sd_central_set(&central);
+
+	// Retransmission of the bridge: the boot frame is refused once by the host MCU.
+	m_mcu.init.nack_every = 1;
+	CHECK(bridge_run_until(is_nack_sent, NULL, TIMEOUT_NS));
+	m_mcu.init.nack_every = 0;
+	CHECK(m_frames[ID_BOOT_MODE] == 0);
+	CHECK(bridge_run_until(is_boot_received, NULL, TIMEOUT_NS));
+	CHECK(bridge_run_until(is_mcu_idle, NULL, TIMEOUT_NS));
+	CHECK(m_mcu.stats.nacks_sent == 1);
+	CHECK(m_mcu.stats.acks_sent == 1);
+
+	CHECK(bridge_run_until(is_started, NULL, TIMEOUT_NS));
+	host_sd_connect();
+	CHECK(bridge_run_until(is_connected, NULL, TIMEOUT_NS));
+	CHECK(host_sd_notification_enable(MESSAGE_APP_CHAR_UUID, true));
+	CHECK(host_sd_notification_enable(MESSAGE_PARAMS_UUID, true));
+	bridge_run_for(CCCD_WRITE_NS);
+	CHECK(bridge_run_until(is_mcu_idle, NULL, TIMEOUT_NS));
+
+	// ACK: the frame is forwarded as one app notification (ID - Length - Data).
+	CHECK(host_mcu_send(&m_mcu, ID_CHAR_BUFFER, payload, sizeof(payload)));
+	expected = m_notifications + 1;
+	CHECK(bridge_run_until(is_notified, &expected, TIMEOUT_NS));
+	CHECK(bridge_run_until(is_mcu_idle, NULL, TIMEOUT_NS));
+	CHECK(m_mcu.stats.frames_acked == 1);
+	CHECK(m_mcu.stats.retransmissions == 0);
+	CHECK(m_notification_length == (sizeof(payload) + 2));
+	CHECK((m_notification[0] == ID_CHAR_BUFFER) && (m_notification[1] == sizeof(payload)));
+	CHECK(memcmp(&m_notification[2], payload, sizeof(payload)) == 0);
+
+	// NACK: the first transmission has a wrong CRC, the bridge refuses it and the host MCU sends it again.
+	m_mcu.init.corrupt_every = m_mcu.stats.transmissions + 1;
+	CHECK(host_mcu_send(&m_mcu, ID_CHAR_BUFFER, payload, sizeof(payload)));
+	expected = m_notifications + 1;
+	CHECK(bridge_run_until(is_notified, &expected, TIMEOUT_NS));
+	CHECK(bridge_run_until(is_mcu_idle, NULL, TIMEOUT_NS));
+	m_mcu.init.corrupt_every = 0;
+	CHECK(m_mcu.stats.nacks_received == 1);
+	CHECK(m_mcu.stats.retransmissions == 1);
+	CHECK(m_mcu.stats.frames_acked == 2);
+	CHECK(m_notifications == expected);
+
+	// Shortest frame: without data, it is classified and acknowledged like the others (empty record notified).
+	CHECK(host_mcu_send(&m_mcu, ID_CHAR_BUFFER, NULL, 0));
+	expected = m_notifications + 1;
+	CHECK(bridge_run_until(is_notified, &expected, TIMEOUT_NS));
+	CHECK(bridge_run_until(is_mcu_idle, NULL, TIMEOUT_NS));
+	CHECK(m_mcu.stats.frames_acked == 3);
+	CHECK(m_mcu.stats.retransmissions == 1);
+	CHECK(m_notification_length == 2);
+	CHECK((m_notification[0] == ID_CHAR_BUFFER) && (m_notification[1] == 0));
+
+	CHECK(m_mcu.stats.crc_errors == 0);
+	CHECK(fake_uart_stats_get()->rx_overflows == 0);
+
+	return TEST_RESULT();
+}
@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+"""Decoder of the binary trace of the bridge (ble_pickit_trace.h).
+
+    trace_decode.py [--header ../ble_pickit_trace.h] [--check] FILE
+
+FILE: the params notifications 0x08 - Length - Lost (2B) - Records read by the central, one after the other
+(e2e_bench --trace FILE). The module and event names come from the trace_module_t and trace_event_t enums of the
+header, the arguments from the comment of each event: the table follows the firmware without being copied here.
+
+Output: one JSON line per record (time in seconds from the first record, 24 bits timestamp unwrapped) and per drain
+reporting lost records, then a summary line. --check: exit status 1 if a record has an unknown module or event, or if
+the file is not a trace dump.
+"""
+
+import json
+import os
+import re
+import sys
+
+RECORD_SIZE = 12
+SUB_COMMAND = 0x08
+RTC_FREQUENCY = 32768
+TICK_MASK = 0x00FFFFFF
+
+
+def enum_parse(text, name):
+    """Return {value: (identifier, comment)} of the typedef enum name of a C header."""
+    match = re.search(r"typedef\s+enum\s*\{([^{}]*)\}\s*" + name + r"\s*;", text)
+    if match is None:
+        raise ValueError("enum %s not found" % name)
+    table = {}
+    value = 0
+    for line in match.group(1).splitlines():
+        entry = re.match(r"\s*([A-Z_][A-Z0-9_]*)\s*(?:=\s*([0-9xXa-fA-F]+))?\s*,?\s*(?:/\*\*<\s*(.*?)\s*\*/)?\s*$", line)
+        if entry is None:
+            continue
+        if entry.group(2) is not None:
+            value = int(entry.group(2), 0)
+        table[value] = (entry.group(1), entry.group(3) or "")
+        value += 1
+    return table
+
+
+def tables_load(path):
+    with open(path, encoding="latin-1") as header:
+        text = header.read()
+    return enum_parse(text, "trace_module_t"), enum_parse(text, "trace_event_t")
+
+
+def drains_parse(data):
+    """Yield (lost, records) of each notification of the dump."""
+    offset = 0
+    while offset < len(data):
+        if (offset + 4) > len(data) or data[offset] != SUB_COMMAND or data[offset + 1] < 2:
+            raise ValueError("not a trace dump at offset %d" % offset)
+        length = data[offset + 1]
+        if (offset + 2 + length) > len(data) or ((length - 2) % RECORD_SIZE) != 0:
+            raise ValueError("truncated notification at offset %d" % offset)
+        block = data[offset + 2:offset + 2 + length]
+        records = [block[i:i + RECORD_SIZE] for i in range(2, length, RECORD_SIZE)]
+        yield int.from_bytes(block[0:2], "big"), records
+        offset += 2 + length
+
+
+def main(argv):
+    header = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "ble_pickit_trace.h")
+    is_check = False
+    path = None
+    args = iter(argv[1:])
+    for arg in args:
+        if arg == "--header":
+            header = next(args, None)
+        elif arg == "--check":
+            is_check = True
+        elif path is None and not arg.startswith("--"):
+            path = arg
+        else:
+            path = None
+            break
+    if path is None or header is None:
+        sys.stderr.write("usage: trace_decode.py [--header ble_pickit_trace.h] [--check] FILE\n")
+        return 1
+
+    modules, events = tables_load(header)
+    with open(path, "rb") as dump:
+        data = dump.read()
+
+    count = 0
+    lost = 0
+    unknown = 0
+    ticks = 0
+    last = None
+    try:
+        for drain_lost, records in drains_parse(data):
+            if drain_lost > 0:
+                lost += drain_lost
+                print(json.dumps({"lost": drain_lost}))
+            for record in records:
+                timestamp = int.from_bytes(record[0:4], "big") & TICK_MASK
+                module, event = record[4], record[5]
+                if last is not None:
+                    ticks += (timestamp - last) & TICK_MASK
+                last = timestamp
+                if module not in modules or event not in events:
+                    unknown += 1
+                module_name = modules.get(module, ("MODULE_%d" % module, ""))[0]
+                event_name, event_args = events.get(event, ("EVT_%d" % event, ""))
+                print(json.dumps({
+                    "time_s": round(ticks / RTC_FREQUENCY, 6),
+                    "module": module_name.replace("TRACE_MODULE_", ""),
+                    "event": event_name.replace("TRACE_EVT_", ""),
+                    "arg0": int.from_bytes(record[6:8], "big"),
+                    "arg1": int.from_bytes(record[8:12], "big"),
+                    "args": event_args,
+                }))
+                count += 1
+    except ValueError as error:
+        sys.stderr.write("trace_decode.py: %s\n" % error)
+        return 1
+
+    print(json.dumps({"records": count, "lost": lost, "unknown": unknown,
+                      "modules": len(modules), "events": len(events)}))
+    return 1 if (is_check and (unknown > 0 or count == 0)) else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
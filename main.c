@@ -25,6 +25,7 @@
 #include "nrf_ble_qwr.h"
 #include "nrf_pwr_mgmt.h"
 
+#include "nrf_atfifo.h"
 #include "nrf_log.h"
 #include "nrf_log_ctrl.h"
 #include "nrf_log_default_backends.h"
@@ -33,6 +34,16 @@
 #include "ble_vsd.h"
 #include "ble_pickit_board.h"
 #include "ble_pickit_service.h"
+#include "ble_pickit_broadcast.h"
+#include "ble_pickit_transport.h"
+#include "ble_pickit_cache.h"
+#include "ble_pickit_schema.h"
+#include "ble_pickit_profiler.h"
+#include "ble_pickit_trace.h"
+#include "ble_pickit_capture.h"
+#include "ble_pickit_stats.h"
+#include "ble_pickit_link_adapt.h"
+#include "ble_pickit_leds.h"
 
 
 #define APP_BLE_OBSERVER_PRIO           3                                       /**< Application's BLE observer priority. You shouldn't need to modify this value. */
@@ -51,6 +62,15 @@
 #define SEC_PARAM_MIN_KEY_SIZE          7                                       /**< Minimum encryption key size. */
 #define SEC_PARAM_MAX_KEY_SIZE          16                                      /**< Maximum encryption key size. */
 
+#define FAST_RECONNECT_WHITELIST_TIMEOUT APP_TIMER_TICKS(5000)                 /**< Duration of the whitelisted fast advertising (following the high duty directed advertising) before accepting any central (5 seconds). */
+
+#define MAIN_EVT_GAP_MAX                10                                      /**< GAP and advertising events of one connection (connection, 3 updates with their requests, disconnection) and SERVICE_EVT_CONNECTED / DISCONNECTED. */
+#define MAIN_EVT_SERVICE_MAX            (OUTGOING_MESSAGE_RING_SIZE + 16)       /**< Service events: app writes within the credits of the central, CCCD / params / test / cache writes and margin (more are dropped). */
+#define MAIN_EVT_QUEUE_SIZE             (MAIN_EVT_GAP_MAX + MAIN_EVT_SERVICE_MAX)  /**< Events of the SoftDevice observers waiting for the main loop (SERVICE_EVT_TX_COMPLETE counted apart). */
+#define MAIN_EVT_DATA_MAX               NRF_SDH_BLE_GATT_MAX_MTU_SIZE           /**< Written data of a service event. */
+#define MAIN_EVT_DATA_POOL_SIZE         ((OUTGOING_MESSAGE_RING_SIZE + 2) * MAIN_EVT_DATA_MAX)  /**< Written data of the queued service events (at least 2 * MAIN_EVT_DATA_MAX, see evt_data_alloc()). */
+#define IRQ_EVT_QUEUE_SIZE              8                                       /**< Events of the interrupts (UART, buttons) waiting for the main loop. */
+
 #define DEAD_BEEF                       0xDEADBEEF                              /**< Value used as error code on stack dump, can be used to identify stack location on stack unwind. */
 
 
@@ -60,6 +80,64 @@ NRF_BLE_QWR_DEF(m_qwr);
 BLE_ADVERTISING_DEF(m_advertising);                                             /**< Advertising module instance. */
 BLE_PICKIT_SERVICE_DEF(m_msg);
 static uint16_t m_conn_handle = BLE_CONN_HANDLE_INVALID;                        /**< Handle of the current connection. */
+static pm_peer_id_t m_peer_id = PM_PEER_ID_INVALID;                             /**< Peer ID of the last bonded central (target of the fast reconnection). */
+APP_TIMER_DEF(m_whitelist_timer_id);                                            /**< Timer ending the whitelisted fast advertising. */
+
+/*
+ * The SoftDevice observers and the interrupts do not modify ble_pickit (flags, status and current GAP parameters share
+ * the same words as the main loop): they queue an event processed by main_evt_process() in the main loop.
+ * One queue per producer context, nrf_atfifo makes the put / get lock-free. SERVICE_EVT_TX_COMPLETE, up to one per
+ * connection event, is only counted (m_tx_complete_count) so that it cannot fill the queue.
+ * The central decides how fast it writes: the service events beyond MAIN_EVT_SERVICE_MAX (or beyond the data pool) are
+ * dropped and the central is resynchronized by the main loop (service_evt_resync), the GAP events keep their
+ * MAIN_EVT_GAP_MAX entries. A full queue for a GAP event (or an interrupt event) is a fatal error.
+ * The written data are copied in m_evt_data (only their length), freed in order by the main loop.
+ */
+typedef enum
+{
+	MAIN_EVT_SOURCE_GAP,
+	MAIN_EVT_SOURCE_ADV,
+	MAIN_EVT_SOURCE_SERVICE,
+} main_evt_source_t;
+
+typedef struct
+{
+	uint8_t							source;
+	uint16_t						type;								/**< BLE_GAP_EVT_xxx, ble_adv_evt_t or service_evt_type_t. */
+	uint8_t							channel;
+	uint8_t							length;
+	uint16_t						offset;								/**< Written data of the service events in m_evt_data. */
+	union
+	{
+		ble_gap_conn_params_t			conn_params;
+		ble_gap_evt_phy_update_t		phy;
+		ble_gap_data_length_params_t	data_length;
+	} params;
+} main_evt_t;
+
+typedef enum
+{
+	IRQ_EVT_UART_TX_EMPTY,
+	IRQ_EVT_BUTTON,
+} irq_evt_type_t;
+
+typedef struct
+{
+	uint8_t							type;
+	uint8_t							pin;
+	bool							action;
+} irq_evt_t;
+
+NRF_ATFIFO_DEF(m_main_evt_fifo, main_evt_t, MAIN_EVT_QUEUE_SIZE);
+NRF_ATFIFO_DEF(m_irq_evt_fifo, irq_evt_t, IRQ_EVT_QUEUE_SIZE);
+static volatile uint32_t m_tx_complete_count = 0;                               /**< SERVICE_EVT_TX_COMPLETE events (one per BLE_GATTS_EVT_HVN_TX_COMPLETE), never lost. */
+static uint32_t m_tx_complete_processed = 0;                                    /**< SERVICE_EVT_TX_COMPLETE events processed by the main loop. */
+static volatile uint32_t m_service_evt_queued = 0;                              /**< Service events queued by the SoftDevice observers. */
+static volatile uint32_t m_service_evt_processed = 0;                           /**< Service events processed by the main loop. */
+static volatile uint32_t m_service_evt_dropped = 0;                             /**< Types of the dropped service events (bit n: service_evt_type_t n), cleared by the main loop. */
+static uint8_t m_evt_data[MAIN_EVT_DATA_POOL_SIZE];                             /**< Written data of the queued service events. */
+static volatile uint16_t m_evt_data_head = 0;                                   /**< Next free byte (SoftDevice observers). */
+static volatile uint16_t m_evt_data_tail = 0;                                   /**< First byte in use (main loop), empty if equal to the head. */
 extern uint8_t __data_start__;
 
 
@@ -75,6 +153,9 @@ static void advertising_init(void);
 static void services_init(void);
 static void conn_params_init(void);
 static void peer_manager_init(void);
+static main_evt_t * main_evt_alloc(nrf_atfifo_item_put_t * p_context, main_evt_source_t source, uint16_t type);
+static void main_evt_process(void);
+static void on_service_event_handler(ble_msg_t * p_msg, ble_msg_evt_t * p_evt, const uint8_t *buffer, uint8_t length);
 
 
 /**@brief Callback function for asserts in the SoftDevice.
@@ -94,6 +175,30 @@ void assert_nrf_callback(uint16_t line_num, const uint8_t * p_file_name)
 }
 
 
+/**@brief Function for selecting the bonded central targeted by the fast reconnection.
+ *
+ * @details The peer is used for the high duty directed advertising (BLE_ADV_EVT_PEER_ADDR_REQUEST)
+ *          and is the only entry of the whitelist (BLE_ADV_EVT_WHITELIST_REQUEST).
+ *
+ * @param[in] peer_id  Peer ID of the bonded central (PM_PEER_ID_INVALID to disable the fast reconnection).
+ */
+static void fast_reconnect_peer_set(pm_peer_id_t peer_id)
+{
+	ret_code_t err_code;
+
+	m_peer_id = peer_id;
+
+	if (m_peer_id != PM_PEER_ID_INVALID)
+	{
+		err_code = pm_whitelist_set(&m_peer_id, 1);
+	}
+	else
+	{
+		err_code = pm_whitelist_set(NULL, 0);
+	}
+	APP_ERROR_CHECK(err_code);
+}
+
 /**@brief Function for handling Peer Manager events.
  *
  * @param[in] p_evt  Peer Manager event.
@@ -107,7 +212,27 @@ static void pm_evt_handler(pm_evt_t const * p_evt)
 
     switch (p_evt->evt_id)
     {
+        case PM_EVT_CONN_SEC_SUCCEEDED:
+        	// The last secured central becomes the target of the next reconnection.
+        	if (p_evt->peer_id != m_peer_id)
+        	{
+        		fast_reconnect_peer_set(p_evt->peer_id);
+        	}
+        	err_code = pm_peer_rank_highest(p_evt->peer_id);
+        	if ((err_code != NRF_ERROR_BUSY) && (err_code != NRF_ERROR_RESOURCES))
+        	{
+        		APP_ERROR_CHECK(err_code);
+        	}
+            break;
+
+        case PM_EVT_LOCAL_DB_CACHE_APPLIED:
+        	// CCCDs of a bonded central are restored from flash without any GATTS write event.
+        	ble_pickit_service_cccd_restore(on_service_event_handler);
+        	NRF_LOG_INFO("CCCD restored from bonding data.");
+            break;
+
         case PM_EVT_PEERS_DELETE_SUCCEEDED:
+        	fast_reconnect_peer_set(PM_PEER_ID_INVALID);
         	err_code = ble_advertising_start(&m_advertising, BLE_ADV_MODE_FAST);
 			APP_ERROR_CHECK(err_code);
             break;
@@ -165,16 +290,79 @@ static void adv_err_evt_handler(uint32_t nrf_error)
 	NRF_LOG_INFO("on_adv_err: %d", nrf_error);
 }
 
-static void adv_evt_handler(ble_adv_evt_t ble_adv_evt)
+static void whitelist_timeout_handler(void * p_context)
 {
 	ret_code_t err_code;
 
+	UNUSED_PARAMETER(p_context);
+
+	if (!ble_pickit.status.is_connected_to_a_central)
+	{
+		// The bonded central did not come back: accept any central.
+		NRF_LOG_INFO("Whitelist advertising timeout");
+		err_code = ble_advertising_restart_without_whitelist(&m_advertising);
+		if (err_code != NRF_ERROR_INVALID_STATE)
+		{
+			APP_ERROR_CHECK(err_code);
+		}
+	}
+}
+
+/**@brief Function for handling the advertising state in the main loop.
+ */
+static void adv_evt_process(ble_adv_evt_t ble_adv_evt)
+{
 	switch (ble_adv_evt)
 	{
-		case BLE_ADV_EVT_IDLE:                /**< Idle; no connectable advertising is ongoing.*/
+		case BLE_ADV_EVT_IDLE:
 			NRF_LOG_INFO("Idle advertising");
 			ble_pickit.status.is_in_advertising_mode = false;
 			ble_pickit.flags.send_conn_status = true;
+			ble_pickit_leds_event(LEDS_EVT_ADVERTISING_STOP);
+			break;
+		case BLE_ADV_EVT_DIRECTED_HIGH_DUTY:
+			ble_pickit.status.is_in_advertising_mode = true;
+			ble_pickit.flags.send_conn_status = true;
+			ble_pickit_leds_event(LEDS_EVT_ADVERTISING_START);
+			NRF_LOG_INFO("Directed advertising (high duty)");
+			break;
+		case BLE_ADV_EVT_FAST:
+			ble_pickit.status.is_in_advertising_mode = true;
+			ble_pickit.flags.send_conn_status = true;
+			ble_pickit_leds_event(LEDS_EVT_ADVERTISING_START);
+			NRF_LOG_INFO("Fast advertising");
+			break;
+		case BLE_ADV_EVT_SLOW:
+			NRF_LOG_INFO("Slow advertising");
+			break;
+		case BLE_ADV_EVT_FAST_WHITELIST:
+			ble_pickit.status.is_in_advertising_mode = true;
+			ble_pickit.flags.send_conn_status = true;
+			ble_pickit_leds_event(LEDS_EVT_ADVERTISING_START);
+			NRF_LOG_INFO("Fast advertising (whitelist)");
+			break;
+		default:
+			break;
+	}
+}
+
+/**@brief Function for handling the advertising events (SoftDevice observer context).
+ *
+ * @details The state of the advertising is updated by adv_evt_process() in the main loop.
+ */
+static void adv_evt_handler(ble_adv_evt_t ble_adv_evt)
+{
+	ret_code_t err_code;
+	nrf_atfifo_item_put_t context;
+
+	if (main_evt_alloc(&context, MAIN_EVT_SOURCE_ADV, ble_adv_evt) != NULL)
+	{
+		(void) nrf_atfifo_item_put(m_main_evt_fifo, &context);
+	}
+
+	switch (ble_adv_evt)
+	{
+		case BLE_ADV_EVT_IDLE:                /**< Idle; no connectable advertising is ongoing.*/
 			err_code = ble_advertising_start(&m_advertising, BLE_ADV_MODE_FAST);
 			APP_ERROR_CHECK(err_code);
 			break;
@@ -183,38 +371,97 @@ static void adv_evt_handler(ble_adv_evt_t ble_adv_evt)
 		case BLE_ADV_EVT_DIRECTED:            /**< Directed advertising (low duty cycle) has started. */
 			break;
 		case BLE_ADV_EVT_FAST:                /**< Fast advertising mode has started. */
-			ble_pickit.status.is_in_advertising_mode = true;
-			ble_pickit.flags.send_conn_status = true;
-			NRF_LOG_INFO("Fast advertising");
 			break;
 		case BLE_ADV_EVT_SLOW:                /**< Slow advertising mode has started. */
-			NRF_LOG_INFO("Slow advertising");
 			break;
 		case BLE_ADV_EVT_FAST_WHITELIST:      /**< Fast advertising mode using the whitelist has started. */
+			err_code = app_timer_start(m_whitelist_timer_id, FAST_RECONNECT_WHITELIST_TIMEOUT, NULL);
+			APP_ERROR_CHECK(err_code);
 			break;
 		case BLE_ADV_EVT_SLOW_WHITELIST:      /**< Slow advertising mode using the whitelist has started. */
 			break;
 		case BLE_ADV_EVT_WHITELIST_REQUEST:   /**< Request a whitelist from the main application. For whitelist advertising to work, the whitelist must be set when this event occurs. */
+		{
+			ble_gap_addr_t whitelist_addrs[BLE_GAP_WHITELIST_ADDR_MAX_COUNT];
+			ble_gap_irk_t  whitelist_irks[BLE_GAP_WHITELIST_ADDR_MAX_COUNT];
+			uint32_t       addr_cnt = BLE_GAP_WHITELIST_ADDR_MAX_COUNT;
+			uint32_t       irk_cnt  = BLE_GAP_WHITELIST_ADDR_MAX_COUNT;
+
+			err_code = pm_whitelist_get(whitelist_addrs, &addr_cnt, whitelist_irks, &irk_cnt);
+			APP_ERROR_CHECK(err_code);
+
+			// An empty whitelist makes the module fall back to the regular fast advertising.
+			err_code = ble_advertising_whitelist_reply(&m_advertising, whitelist_addrs, addr_cnt, whitelist_irks, irk_cnt);
+			APP_ERROR_CHECK(err_code);
 			break;
-		case BLE_ADV_EVT_PEER_ADDR_REQUEST:
+		}
+		case BLE_ADV_EVT_PEER_ADDR_REQUEST:   /**< Request the address of the bonded central targeted by the directed advertising. */
+			if (m_peer_id != PM_PEER_ID_INVALID)
+			{
+				pm_peer_data_bonding_t peer_bonding_data;
+
+				err_code = pm_peer_data_bonding_load(m_peer_id, &peer_bonding_data);
+				if (err_code != NRF_ERROR_NOT_FOUND)
+				{
+					APP_ERROR_CHECK(err_code);
+
+					err_code = ble_advertising_peer_addr_reply(&m_advertising, &peer_bonding_data.peer_ble_id.id_addr_info);
+					APP_ERROR_CHECK(err_code);
+				}
+			}
 			break;
 		default:
 			break;
 	}
 }
 
-static void ble_evt_handler(ble_evt_t const * p_ble_evt, void * p_context)
+/**@brief Function for allocating an event of the main loop queue.
+ *
+ * @details Producer side (SoftDevice observer context): the event is filled and then queued with nrf_atfifo_item_put().
+ *
+ * @return The event (NRF_ERROR_NO_MEM error if the queue is full: the GAP events have MAIN_EVT_GAP_MAX entries for
+ *         them, the service events are dropped before filling the queue).
+ */
+static main_evt_t * main_evt_alloc(nrf_atfifo_item_put_t * p_context, main_evt_source_t source, uint16_t type)
 {
-    ret_code_t err_code = NRF_SUCCESS;
-    ble_gap_conn_params_t _t_conn_params = p_ble_evt->evt.gap_evt.params.connected.conn_params;
-    ble_gap_conn_params_t _t_conn_params_update_request = p_ble_evt->evt.gap_evt.params.conn_param_update_request.conn_params;
+	main_evt_t * p_evt = nrf_atfifo_item_alloc(m_main_evt_fifo, p_context);
 
-    switch (p_ble_evt->header.evt_id)
-    {
-        case BLE_GAP_EVT_DISCONNECTED:
-            NRF_LOG_INFO("DISCONNECTED.");
+	if (p_evt == NULL)
+	{
+		NRF_LOG_ERROR("Event queue full (source %d, type %d).", source, type);
+		APP_ERROR_HANDLER(NRF_ERROR_NO_MEM);
+		return NULL;
+	}
 
-            ble_pickit.params.current_gap_params.conn_params.min_conn_interval = 0;
+	p_evt->source = source;
+	p_evt->type = type;
+	p_evt->channel = 0;
+	p_evt->length = 0;
+
+	return p_evt;
+}
+
+static void irq_evt_post(irq_evt_type_t type, uint8_t pin, bool action)
+{
+	irq_evt_t evt = {.type = type, .pin = pin, .action = action};
+
+	if (nrf_atfifo_alloc_put(m_irq_evt_fifo, &evt, sizeof(evt), NULL) != NRF_SUCCESS)
+	{
+		NRF_LOG_ERROR("Interrupt event queue full (type %d).", type);
+		APP_ERROR_HANDLER(NRF_ERROR_NO_MEM);
+	}
+}
+
+/**@brief Function for handling the GAP events in the main loop (state of the link and parameters notification).
+ */
+static void gap_evt_process(main_evt_t const * p_evt)
+{
+	switch (p_evt->type)
+	{
+		case BLE_GAP_EVT_DISCONNECTED:
+			NRF_LOG_INFO("DISCONNECTED.");
+
+			ble_pickit.params.current_gap_params.conn_params.min_conn_interval = 0;
 			ble_pickit.params.current_gap_params.conn_params.max_conn_interval = 0;
 			ble_pickit.params.current_gap_params.conn_params.slave_latency = 0;
 			ble_pickit.params.current_gap_params.conn_params.conn_sup_timeout = 0;
@@ -223,26 +470,102 @@ static void ble_evt_handler(ble_evt_t const * p_ble_evt, void * p_context)
 			ble_pickit.params.current_gap_params.mtu_size_params.max_tx_octets = 0;
 			ble_pickit.params.current_gap_params.mtu_size_params.max_rx_octets = 0;
 
-            ble_pickit.status.is_connected_to_a_central = false;
-            ble_pickit.flags.send_conn_status = true;
-            break;
+			ble_pickit.status.is_connected_to_a_central = false;
+			ble_pickit.flags.send_conn_status = true;
+			ble_pickit_link_adapt_stop(&ble_pickit.params);
+			ble_pickit_leds_event(LEDS_EVT_DISCONNECTED);
+			break;
 
-        case BLE_GAP_EVT_CONNECTED:
-            NRF_LOG_INFO("CONNECTED.");
-            NRF_LOG_INFO("	min_conn_param: " NRF_LOG_FLOAT_MARKER " ms", NRF_LOG_FLOAT((float)(_t_conn_params.min_conn_interval)*UNIT_1_25_MS/1000));
-			NRF_LOG_INFO("	max_conn_param: " NRF_LOG_FLOAT_MARKER " ms", NRF_LOG_FLOAT((float)(_t_conn_params.max_conn_interval)*UNIT_1_25_MS/1000));
-			NRF_LOG_INFO("	slave_latency: %d", _t_conn_params.slave_latency);
-			NRF_LOG_INFO("	timeout: %d ms", (_t_conn_params.conn_sup_timeout*UNIT_10_MS/1000));
+		case BLE_GAP_EVT_CONNECTED:
+			NRF_LOG_INFO("CONNECTED.");
+			NRF_LOG_INFO("	min_conn_param: " NRF_LOG_FLOAT_MARKER " ms", NRF_LOG_FLOAT((float)(p_evt->params.conn_params.min_conn_interval)*UNIT_1_25_MS/1000));
+			NRF_LOG_INFO("	max_conn_param: " NRF_LOG_FLOAT_MARKER " ms", NRF_LOG_FLOAT((float)(p_evt->params.conn_params.max_conn_interval)*UNIT_1_25_MS/1000));
+			NRF_LOG_INFO("	slave_latency: %d", p_evt->params.conn_params.slave_latency);
+			NRF_LOG_INFO("	timeout: %d ms", (p_evt->params.conn_params.conn_sup_timeout*UNIT_10_MS/1000));
 			ble_pickit.status.is_in_advertising_mode = false;
 			ble_pickit.status.is_connected_to_a_central = true;
 			ble_pickit.flags.send_conn_status = true;
-            m_conn_handle = p_ble_evt->evt.gap_evt.conn_handle;
-            err_code = nrf_ble_qwr_conn_handle_assign(&m_qwr, m_conn_handle);
-            APP_ERROR_CHECK(err_code);
+			ble_pickit_leds_event(LEDS_EVT_CONNECTED);
+
+			ble_pickit.flags.set_conn_params = false;
+			ble_pickit.flags.set_phy_params = false;
+			ble_pickit.flags.set_att_size_params = false;
+			ble_pickit_link_adapt_start(m_conn_handle);
+			break;
+
+		case BLE_GAP_EVT_CONN_PARAM_UPDATE_REQUEST:
+			NRF_LOG_INFO("CONN PARAMS UPDATE REQUEST (accept parameters requested by the peer): ");
+			NRF_LOG_INFO("	min_conn_param: " NRF_LOG_FLOAT_MARKER " ms", NRF_LOG_FLOAT((float)(p_evt->params.conn_params.min_conn_interval)*UNIT_1_25_MS/1000));
+			NRF_LOG_INFO("	max_conn_param: " NRF_LOG_FLOAT_MARKER " ms", NRF_LOG_FLOAT((float)(p_evt->params.conn_params.max_conn_interval)*UNIT_1_25_MS/1000));
+			ble_pickit.flags.set_conn_params = false;
+			break;
+
+		case BLE_GAP_EVT_CONN_PARAM_UPDATE:
+			NRF_LOG_INFO("CONN PARAMS UPDATED: ");
+			NRF_LOG_INFO("	min_conn_param: " NRF_LOG_FLOAT_MARKER " ms", NRF_LOG_FLOAT((float)(p_evt->params.conn_params.min_conn_interval)*UNIT_1_25_MS/1000));
+			NRF_LOG_INFO("	max_conn_param: " NRF_LOG_FLOAT_MARKER " ms", NRF_LOG_FLOAT((float)(p_evt->params.conn_params.max_conn_interval)*UNIT_1_25_MS/1000));
+			NRF_LOG_INFO("	slave_latency: %d", p_evt->params.conn_params.slave_latency);
+			NRF_LOG_INFO("	timeout: %d ms", (p_evt->params.conn_params.conn_sup_timeout*UNIT_10_MS/1000));
+			ble_pickit.params.current_gap_params.conn_params = p_evt->params.conn_params;
+
+			ble_pickit_parameters_changed();
+			break;
 
-            ble_pickit.flags.set_conn_params = false;
+		case BLE_GAP_EVT_PHY_UPDATE_REQUEST:
 			ble_pickit.flags.set_phy_params = false;
+			break;
+
+		case BLE_GAP_EVT_PHY_UPDATE:
+			NRF_LOG_INFO("PHY UPDATED: TX = %d / RX = %d", p_evt->params.phy.tx_phy, p_evt->params.phy.rx_phy);
+			ble_pickit.params.current_gap_params.phys_params.tx_phys = p_evt->params.phy.tx_phy;
+			ble_pickit.params.current_gap_params.phys_params.rx_phys = p_evt->params.phy.rx_phy;
+
+			ble_pickit_parameters_changed();
+			break;
+
+		case BLE_GAP_EVT_DATA_LENGTH_UPDATE_REQUEST:
 			ble_pickit.flags.set_att_size_params = false;
+			break;
+
+		case BLE_GAP_EVT_DATA_LENGTH_UPDATE:
+			NRF_LOG_INFO("DATA LEN UPDATED: TX = %d / RX = %d", p_evt->params.data_length.max_tx_octets-4, p_evt->params.data_length.max_rx_octets-4);
+			ble_pickit.params.current_gap_params.mtu_size_params.max_tx_octets = p_evt->params.data_length.max_tx_octets-4;
+			ble_pickit.params.current_gap_params.mtu_size_params.max_rx_octets = p_evt->params.data_length.max_rx_octets-4;
+			ble_pickit.params.current_gap_params.mtu_size_params.max_tx_time_us = p_evt->params.data_length.max_tx_time_us;
+			ble_pickit.params.current_gap_params.mtu_size_params.max_rx_time_us = p_evt->params.data_length.max_rx_time_us;
+
+			ble_pickit_parameters_changed();
+			break;
+
+		default:
+			break;
+	}
+}
+
+/**@brief Function for handling the BLE events (SoftDevice observer context).
+ *
+ * @details Only the replies expected by the SoftDevice are done here. The state of the link is updated
+ *          by gap_evt_process() in the main loop.
+ */
+static void ble_evt_handler(ble_evt_t const * p_ble_evt, void * p_context)
+{
+    ret_code_t err_code = NRF_SUCCESS;
+    nrf_atfifo_item_put_t context;
+    main_evt_t * p_evt = NULL;
+    PROFILER_BEGIN(PROFILER_REGION_BLE_EVT);
+
+    switch (p_ble_evt->header.evt_id)
+    {
+        case BLE_GAP_EVT_DISCONNECTED:
+        	p_evt = main_evt_alloc(&context, MAIN_EVT_SOURCE_GAP, p_ble_evt->header.evt_id);
+            break;
+
+        case BLE_GAP_EVT_CONNECTED:
+            m_conn_handle = p_ble_evt->evt.gap_evt.conn_handle;
+            err_code = nrf_ble_qwr_conn_handle_assign(&m_qwr, m_conn_handle);
+            APP_ERROR_CHECK(err_code);
+            err_code = app_timer_stop(m_whitelist_timer_id);
+            APP_ERROR_CHECK(err_code);
 
             err_code = sd_ble_gap_conn_param_update(m_conn_handle, &ble_pickit.params.preferred_gap_params.conn_params);
 			APP_ERROR_CHECK(err_code);
@@ -250,64 +573,63 @@ static void ble_evt_handler(ble_evt_t const * p_ble_evt, void * p_context)
 			APP_ERROR_CHECK(err_code);
             err_code = sd_ble_gap_data_length_update(m_conn_handle, &ble_pickit.params.preferred_gap_params.mtu_size_params, NULL);
 			APP_ERROR_CHECK(err_code);
+
+			p_evt = main_evt_alloc(&context, MAIN_EVT_SOURCE_GAP, p_ble_evt->header.evt_id);
+			if (p_evt != NULL)
+			{
+				p_evt->params.conn_params = p_ble_evt->evt.gap_evt.params.connected.conn_params;
+			}
             break;
 
 		case BLE_GAP_EVT_CONN_PARAM_UPDATE_REQUEST:
-			NRF_LOG_INFO("CONN PARAMS UPDATE REQUEST (accept parameters requested by the peer): ");
-			NRF_LOG_INFO("	min_conn_param: " NRF_LOG_FLOAT_MARKER " ms", NRF_LOG_FLOAT((float)(p_ble_evt->evt.gap_evt.params.conn_param_update_request.conn_params.min_conn_interval)*UNIT_1_25_MS/1000));
-			NRF_LOG_INFO("	max_conn_param: " NRF_LOG_FLOAT_MARKER " ms", NRF_LOG_FLOAT((float)(p_ble_evt->evt.gap_evt.params.conn_param_update_request.conn_params.max_conn_interval)*UNIT_1_25_MS/1000));
-			ble_pickit.flags.set_conn_params = false;
-			err_code = sd_ble_gap_conn_param_update(p_ble_evt->evt.gap_evt.conn_handle, &_t_conn_params_update_request);
+			err_code = sd_ble_gap_conn_param_update(p_ble_evt->evt.gap_evt.conn_handle, &p_ble_evt->evt.gap_evt.params.conn_param_update_request.conn_params);
 			APP_ERROR_CHECK(err_code);
+
+			p_evt = main_evt_alloc(&context, MAIN_EVT_SOURCE_GAP, p_ble_evt->header.evt_id);
+			if (p_evt != NULL)
+			{
+				p_evt->params.conn_params = p_ble_evt->evt.gap_evt.params.conn_param_update_request.conn_params;
+			}
 			break;
 
         case BLE_GAP_EVT_CONN_PARAM_UPDATE:
-			NRF_LOG_INFO("CONN PARAMS UPDATED: ");
-			NRF_LOG_INFO("	min_conn_param: " NRF_LOG_FLOAT_MARKER " ms", NRF_LOG_FLOAT((float)(p_ble_evt->evt.gap_evt.params.conn_param_update.conn_params.min_conn_interval)*UNIT_1_25_MS/1000));
-			NRF_LOG_INFO("	max_conn_param: " NRF_LOG_FLOAT_MARKER " ms", NRF_LOG_FLOAT((float)(p_ble_evt->evt.gap_evt.params.conn_param_update.conn_params.max_conn_interval)*UNIT_1_25_MS/1000));
-			NRF_LOG_INFO("	slave_latency: %d", p_ble_evt->evt.gap_evt.params.conn_param_update.conn_params.slave_latency);
-			NRF_LOG_INFO("	timeout: %d ms", (p_ble_evt->evt.gap_evt.params.conn_param_update.conn_params.conn_sup_timeout*UNIT_10_MS/1000));
-			ble_pickit.params.current_gap_params.conn_params.min_conn_interval = p_ble_evt->evt.gap_evt.params.conn_param_update.conn_params.min_conn_interval;
-			ble_pickit.params.current_gap_params.conn_params.max_conn_interval = p_ble_evt->evt.gap_evt.params.conn_param_update.conn_params.max_conn_interval;
-			ble_pickit.params.current_gap_params.conn_params.slave_latency = p_ble_evt->evt.gap_evt.params.conn_param_update.conn_params.slave_latency;
-			ble_pickit.params.current_gap_params.conn_params.conn_sup_timeout = p_ble_evt->evt.gap_evt.params.conn_param_update.conn_params.conn_sup_timeout;
-
-			ble_pickit.flags.send_ble_params = true;
-			ble_pickit_parameters_notification_send();
+        	p_evt = main_evt_alloc(&context, MAIN_EVT_SOURCE_GAP, p_ble_evt->header.evt_id);
+			if (p_evt != NULL)
+			{
+				p_evt->params.conn_params = p_ble_evt->evt.gap_evt.params.conn_param_update.conn_params;
+			}
 			break;
 
         case BLE_GAP_EVT_PHY_UPDATE_REQUEST:
 			NRF_LOG_DEBUG("PHY UPDATE REQUEST: TX = %d / RX = %d", p_ble_evt->evt.gap_evt.params.phy_update_request.peer_preferred_phys.tx_phys, p_ble_evt->evt.gap_evt.params.phy_update_request.peer_preferred_phys.rx_phys);
-			ble_pickit.flags.set_phy_params = false;
 			err_code = sd_ble_gap_phy_update(p_ble_evt->evt.gap_evt.conn_handle, &(p_ble_evt->evt.gap_evt.params.phy_update_request.peer_preferred_phys));
 			APP_ERROR_CHECK(err_code);
+
+			p_evt = main_evt_alloc(&context, MAIN_EVT_SOURCE_GAP, p_ble_evt->header.evt_id);
 			break;
 
         case BLE_GAP_EVT_PHY_UPDATE:
-			NRF_LOG_INFO("PHY UPDATED: TX = %d / RX = %d", p_ble_evt->evt.gap_evt.params.phy_update.tx_phy, p_ble_evt->evt.gap_evt.params.phy_update.rx_phy);
-			ble_pickit.params.current_gap_params.phys_params.tx_phys = p_ble_evt->evt.gap_evt.params.phy_update.tx_phy;
-			ble_pickit.params.current_gap_params.phys_params.rx_phys = p_ble_evt->evt.gap_evt.params.phy_update.rx_phy;
-
-			ble_pickit.flags.send_ble_params = true;
-			ble_pickit_parameters_notification_send();
+        	p_evt = main_evt_alloc(&context, MAIN_EVT_SOURCE_GAP, p_ble_evt->header.evt_id);
+			if (p_evt != NULL)
+			{
+				p_evt->params.phy = p_ble_evt->evt.gap_evt.params.phy_update;
+			}
 			break;
 
         case BLE_GAP_EVT_DATA_LENGTH_UPDATE_REQUEST:
 			NRF_LOG_INFO("DATA LEN UPDATE REQUEST: TX = %d / RX = %d", p_ble_evt->evt.gap_evt.params.data_length_update_request.peer_params.max_tx_octets-4, p_ble_evt->evt.gap_evt.params.data_length_update_request.peer_params.max_rx_octets-4);
-			ble_pickit.flags.set_att_size_params = false;
 			err_code = sd_ble_gap_data_length_update(p_ble_evt->evt.gap_evt.conn_handle, &p_ble_evt->evt.gap_evt.params.data_length_update_request.peer_params, NULL);
 			APP_ERROR_CHECK(err_code);
+
+			p_evt = main_evt_alloc(&context, MAIN_EVT_SOURCE_GAP, p_ble_evt->header.evt_id);
 			break;
 
         case BLE_GAP_EVT_DATA_LENGTH_UPDATE:
-			NRF_LOG_INFO("DATA LEN UPDATED: TX = %d / RX = %d", p_ble_evt->evt.gap_evt.params.data_length_update.effective_params.max_tx_octets-4, p_ble_evt->evt.gap_evt.params.data_length_update.effective_params.max_rx_octets-4);
-			ble_pickit.params.current_gap_params.mtu_size_params.max_tx_octets = p_ble_evt->evt.gap_evt.params.data_length_update.effective_params.max_tx_octets-4;
-			ble_pickit.params.current_gap_params.mtu_size_params.max_rx_octets = p_ble_evt->evt.gap_evt.params.data_length_update.effective_params.max_rx_octets-4;
-			ble_pickit.params.current_gap_params.mtu_size_params.max_tx_time_us = p_ble_evt->evt.gap_evt.params.data_length_update.effective_params.max_tx_time_us;
-			ble_pickit.params.current_gap_params.mtu_size_params.max_rx_time_us = p_ble_evt->evt.gap_evt.params.data_length_update.effective_params.max_rx_time_us;
-
-			ble_pickit.flags.send_ble_params = true;
-			ble_pickit_parameters_notification_send();
+        	p_evt = main_evt_alloc(&context, MAIN_EVT_SOURCE_GAP, p_ble_evt->header.evt_id);
+			if (p_evt != NULL)
+			{
+				p_evt->params.data_length = p_ble_evt->evt.gap_evt.params.data_length_update.effective_params;
+			}
 			break;
 
         case BLE_GATTC_EVT_TIMEOUT:
@@ -328,9 +650,200 @@ static void ble_evt_handler(ble_evt_t const * p_ble_evt, void * p_context)
             // No implementation needed.
             break;
     }
+
+    if (p_evt != NULL)
+    {
+    	(void) nrf_atfifo_item_put(m_main_evt_fifo, &context);
+    }
+    PROFILER_END(PROFILER_REGION_BLE_EVT);
 }
 
+/**@brief Function for reserving the written data of a service event in m_evt_data (SoftDevice observer context).
+ *
+ * @details The data of an event are contiguous: a block which does not fit before the end of the pool starts at 0 (the
+ *          end is skipped). The block never reaches the tail (equal head and tail: empty pool), so a pool of
+ *          2 * MAIN_EVT_DATA_MAX always takes a block once empty.
+ *
+ * @return false if the pool is full.
+ */
+static bool evt_data_alloc(uint8_t length, uint16_t * p_offset)
+{
+	uint16_t tail = m_evt_data_tail;
+	uint16_t offset = m_evt_data_head;
+
+	if (offset >= tail)
+	{
+		if (((MAIN_EVT_DATA_POOL_SIZE - offset) < length) || (((MAIN_EVT_DATA_POOL_SIZE - offset) == length) && (tail == 0)))
+		{
+			if (tail <= length)
+			{
+				return false;
+			}
+			offset = 0;
+		}
+	}
+	else if ((tail - offset) <= length)
+	{
+		return false;
+	}
+
+	*p_offset = offset;
+	m_evt_data_head = (offset + length) % MAIN_EVT_DATA_POOL_SIZE;
+
+	return true;
+}
+
+/**@brief Function for queuing the Message Service events (SoftDevice observer context).
+ *
+ * @details The written data are copied in m_evt_data: the events are processed by service_evt_process() in the main loop.
+ *          An event without room (MAIN_EVT_SERVICE_MAX events or the data pool) is dropped, except
+ *          SERVICE_EVT_CONNECTED / DISCONNECTED (counted in MAIN_EVT_GAP_MAX).
+ */
 static void on_service_event_handler(ble_msg_t * p_msg, ble_msg_evt_t * p_evt, const uint8_t *buffer, uint8_t length)
+{
+	nrf_atfifo_item_put_t context;
+	main_evt_t * p_main_evt;
+	bool is_link_evt = (p_evt->evt_type == SERVICE_EVT_CONNECTED) || (p_evt->evt_type == SERVICE_EVT_DISCONNECTED);
+	uint16_t offset = 0;
+
+	UNUSED_PARAMETER(p_msg);
+
+	if (p_evt->evt_type == SERVICE_EVT_TX_COMPLETE)
+	{
+		// Single producer (SoftDevice observer), the main loop only reads the counter.
+		m_tx_complete_count++;
+		return;
+	}
+
+	length = (buffer != NULL) ? MIN(length, MAIN_EVT_DATA_MAX) : 0;
+	if (!is_link_evt && (((m_service_evt_queued - m_service_evt_processed) >= MAIN_EVT_SERVICE_MAX) || ((length > 0) && !evt_data_alloc(length, &offset))))
+	{
+		// Resynchronized by the main loop (service_evt_resync).
+		m_service_evt_dropped |= (1UL << p_evt->evt_type);
+		return;
+	}
+
+	p_main_evt = main_evt_alloc(&context, MAIN_EVT_SOURCE_SERVICE, p_evt->evt_type);
+	if (p_main_evt != NULL)
+	{
+		p_main_evt->channel = p_evt->channel;
+		p_main_evt->length = length;
+		p_main_evt->offset = offset;
+		if (length > 0)
+		{
+			memcpy(&m_evt_data[offset], buffer, length);
+		}
+		m_service_evt_queued++;
+		(void) nrf_atfifo_item_put(m_main_evt_fifo, &context);
+	}
+}
+
+static void params_write_all(ble_msg_t * p_msg, uint8_t const * p_data)
+{
+	// Return all parameters by notifying the client.
+	ble_pickit_parameters_changed();
+}
+
+static void params_write_conn(ble_msg_t * p_msg, uint8_t const * p_data)
+{
+	// Change preferred BLE_CONN_PARAMS
+	ble_pickit_conn_params_decode(p_data, &ble_pickit.params.preferred_gap_params.conn_params);
+	p_msg->ble_params.change_conn_params_request = true;
+}
+
+static void params_write_phy(ble_msg_t * p_msg, uint8_t const * p_data)
+{
+	// Change preferred BLE_PHY_PARAM
+	ble_pickit.params.preferred_gap_params.phys_params.tx_phys = (p_data[0] & 0x03);
+	ble_pickit.params.preferred_gap_params.phys_params.rx_phys = (p_data[0] & 0x03);
+	p_msg->ble_params.change_phy_param_request = true;
+}
+
+static void params_write_att_size(ble_msg_t * p_msg, uint8_t const * p_data)
+{
+	// Change preferred BLE_ATT_SIZE_PARAM
+	ble_pickit.params.preferred_gap_params.mtu_size_params.max_rx_octets = p_data[0] + 4;
+	ble_pickit.params.preferred_gap_params.mtu_size_params.max_tx_octets = p_data[1] + 4;
+	p_msg->ble_params.change_mtu_size_params_request = true;
+}
+
+static void params_write_pa_lna(ble_msg_t * p_msg, uint8_t const * p_data)
+{
+	// Change PA/LNA parameter
+	ble_pickit.params.pa_lna_enable = p_data[0] & 0x01;
+	ble_pickit.flags.send_pa_lna_param = true;
+}
+
+static void params_write_leds(ble_msg_t * p_msg, uint8_t const * p_data)
+{
+	// Change LED STATUS
+	ble_pickit.params.leds_status_enable = p_data[0] & 0x01;
+	ble_pickit_leds_enable(ble_pickit.params.leds_status_enable);
+	ble_pickit_parameters_changed();
+}
+
+static void params_write_transparent(ble_msg_t * p_msg, uint8_t const * p_data)
+{
+	// Enter / exit the transparent mode
+	ble_pickit_transparent_set(p_data[0] & 0x01);
+}
+
+static void params_write_credits(ble_msg_t * p_msg, uint8_t const * p_data)
+{
+	// Return the credits (free messages / free extended messages)
+	ble_pickit.flags.send_credits = true;
+}
+
+static void params_write_capture(ble_msg_t * p_msg, uint8_t const * p_data)
+{
+	// Frame capture (ble_pickit_capture.h): CAPTURE_CMD_READ is answered by a params notification
+	if (p_data[0] == CAPTURE_CMD_READ)
+	{
+		ble_pickit.flags.send_capture_notif = true;
+	}
+	else
+	{
+		ble_pickit_capture_control(p_data[0]);
+	}
+}
+
+static void params_write_trace(ble_msg_t * p_msg, uint8_t const * p_data)
+{
+	// Binary trace (ble_pickit_trace.h): answered by a params notification
+	ble_pickit.flags.send_trace_notif = true;
+}
+
+typedef struct
+{
+	uint8_t							sub_command;
+	uint8_t							length;
+	void							(*handler)(ble_msg_t * p_msg, uint8_t const * p_data);
+} params_write_schema_t;
+
+#define _PARAMS_WRITE_ENTRY(_sub_command, _length, _handler)		{_sub_command, _length, _handler},
+
+/**@brief Writes of the params characteristic (generated from BLE_PICKIT_PARAMS_WRITE_SCHEMA). */
+static const params_write_schema_t m_params_write_schema[] =
+{
+	BLE_PICKIT_PARAMS_WRITE_SCHEMA(_PARAMS_WRITE_ENTRY)
+};
+
+static void params_write_dispatch(ble_msg_t * p_msg, uint8_t const * buffer, uint8_t length)
+{
+	uint8_t i;
+
+	for (i = 0 ; i < ARRAY_SIZE(m_params_write_schema) ; i++)
+	{
+		if (	(length == m_params_write_schema[i].length) && (buffer[0] == m_params_write_schema[i].sub_command) &&
+				((length == 1) || (buffer[1] == (length - 2))))
+		{
+			(*m_params_write_schema[i].handler)(p_msg, &buffer[2]);
+			return;
+		}
+	}
+}
+
+static void service_evt_process(ble_msg_t * p_msg, ble_msg_evt_t * p_evt, const uint8_t *buffer, uint8_t length)
 {
 //	ret_code_t err_code;
 
@@ -344,6 +857,14 @@ static void on_service_event_handler(ble_msg_t * p_msg, ble_msg_evt_t * p_evt, c
 			p_msg->char_app.is_notification_enabled = false;
 			p_msg->char_test.is_notification_enabled = false;
 			p_msg->char_params.is_notification_enabled = false;
+			p_msg->char_app.is_hvx_stalled = false;
+			p_msg->char_test.is_hvx_stalled = false;
+			p_msg->char_params.is_hvx_stalled = false;
+			for (uint8_t i = 0 ; i < BLE_PICKIT_CHANNEL_COUNT ; i++)
+			{
+				p_msg->char_channel[i].is_notification_enabled = false;
+				p_msg->char_channel[i].is_hvx_stalled = false;
+			}
 			break;
 
         case SERVICE_EVT_APP_NOTIFICATION_ENABLED:
@@ -364,65 +885,111 @@ static void on_service_event_handler(ble_msg_t * p_msg, ble_msg_evt_t * p_evt, c
 
 		case SERVICE_EVT_PARAMS_NOTIFICATION_ENABLED:
 			p_msg->char_params.is_notification_enabled = true;
+			ble_pickit_parameters_notification_enabled();
 			break;
 
 		case SERVICE_EVT_PARAMS_NOTIFICATION_DISABLED:
 			p_msg->char_params.is_notification_enabled = false;
 			break;
 
+		case SERVICE_EVT_CHANNEL_NOTIFICATION_ENABLED:
+			p_msg->char_channel[p_evt->channel].is_notification_enabled = true;
+			break;
+
+		case SERVICE_EVT_CHANNEL_NOTIFICATION_DISABLED:
+			p_msg->char_channel[p_evt->channel].is_notification_enabled = false;
+			break;
+
+		case SERVICE_EVT_CHANNEL_WRITE:
+			// Forwarded to the UART by ble_stack_tasks() (frame ID_CHANNEL_BUFFER | channel).
+			ble_pickit_channel_ble_receive(p_evt->channel, buffer, length);
+			break;
+
+		case SERVICE_EVT_CACHE_WRITE:
+			if (length == 1)
+			{
+				ble_pickit_cache_select(buffer[0]);
+			}
+			break;
+
+		case SERVICE_EVT_CACHE_READ:
+			ble_pickit_cache_read();
+			break;
+
         case SERVICE_EVT_APP_WRITE:
-        	if ((length > 2) && (length == (buffer[1] + 2)))
+        	if (ble_pickit.params.transparent_enable)
+        	{
+        		// Transparent mode: the payload is forwarded to the UART as is (no ID / Length / CRC).
+        		ble_pickit_transparent_write(buffer, length);
+        	}
+        	else if ((length > 2) && (length == (buffer[1] + 2)))
 			{
 
-        		if (buffer[0] == ID_CHAR_EXT_BUFFER_NO_CRC)
+        		if ((buffer[0] == ID_CHAR_EXT_BUFFER_NO_CRC) || (buffer[0] == ID_CHAR_EXT_BUFFER_LZ) || (buffer[0] == ID_CHAR_EXT_BUFFER_CRC))
+        		{
+        			// Fragment of an extended message: reassembled (and repaired) by ble_vsd.c.
+        			ble_pickit_ext_fragment_receive(buffer, length);
+        		}
+        		else
         		{
 
-					if (buffer[3] == 1)
-					{
-						memset(&ble_pickit.outgoing_uart_extended_message, 0, sizeof(ble_serial_extended_message_t));
+					// One credit per write: the previous writes may still be waiting for the UART.
+					ble_serial_message_t * p_message = ble_pickit_outgoing_message_alloc();
 
-						ble_pickit.outgoing_uart_extended_message.id = ID_CHAR_EXT_BUFFER_NO_CRC;
-						ble_pickit.outgoing_uart_extended_message.type = 'N';
-						ble_pickit.outgoing_uart_extended_message.length = 0;
+					if (p_message == NULL)
+					{
+						NRF_LOG_INFO("SERVICE_EVT_APP_WRITE: no credit left, write dropped");
+						break;
+					}
+					else if (buffer[1] > sizeof(p_message->data))
+					{
+						// The credit of the write is not used: the central is given its credits back.
+						NRF_LOG_INFO("SERVICE_EVT_APP_WRITE: %d data bytes, write dropped", buffer[1]);
+						ble_pickit.flags.send_credits = true;
+						break;
 					}
 
-					memcpy(&ble_pickit.outgoing_uart_extended_message.data[ble_pickit.outgoing_uart_extended_message.length], &buffer[4], (buffer[1] - 2));
-
-					ble_pickit.outgoing_uart_extended_message.length += (buffer[1] - 2);		// ID (1B) - Length (1B) - [ Total Packet (1B) - Current Packet (1B) - Data ]
-
-					// If Current Packet == Total Packet then operate the UART transfer
-					if (buffer[3] == buffer[2])
+					// RPC: the Request ID is tracked until the response of the host MCU (or its timeout).
+					if ((buffer[0] == ID_RPC_REQUEST) && !ble_pickit_rpc_register(buffer[2]))
 					{
-						ble_pickit.flags.extended_transfer_ble_to_uart = true;
+						ble_pickit.flags.send_credits = true;
+						break;
 					}
-        		}
-        		else
-        		{
 
-					memset(&ble_pickit.outgoing_uart_message, 0, sizeof(ble_serial_message_t));
+					memset(p_message, 0, sizeof(ble_serial_message_t));
 
-					ble_pickit.outgoing_uart_message.id = buffer[0];
-					ble_pickit.outgoing_uart_message.type = 'N';
-					ble_pickit.outgoing_uart_message.length = buffer[1];
+					p_message->id = buffer[0];
+					p_message->type = 'N';
+					p_message->length = buffer[1];
 					for (uint8_t i = 0 ; i < buffer[1] ; i++)
 					{
-						ble_pickit.outgoing_uart_message.data[i] = buffer[i+2];
+						p_message->data[i] = buffer[i+2];
 					}
 
-					if (	(ble_pickit.outgoing_uart_message.id == ID_SOFTWARE_RESET) 	&& 	\
-							(ble_pickit.outgoing_uart_message.type == 'N') 				&& 	\
-							(ble_pickit.outgoing_uart_message.length == 1) 				&&	\
-							((ble_pickit.outgoing_uart_message.data[0] == RESET_BLE_PICKIT) || (ble_pickit.outgoing_uart_message.data[0] == RESET_ALL)))
+					if (	(p_message->id == ID_SOFTWARE_RESET) 	&& 	\
+							(p_message->type == 'N') 				&& 	\
+							(p_message->length == 1) 				&&	\
+							((p_message->data[0] == RESET_BLE_PICKIT) || (p_message->data[0] == RESET_ALL)))
 					{
 						ble_pickit.flags.exec_reset = true;
 					}
 
-					ble_pickit.flags.transfer_ble_to_uart = true;
+					ble_pickit_outgoing_message_commit();
 
         		}
 			}
         	break;
 
+        case SERVICE_EVT_TX_COMPLETE:
+        	ble_pickit_notif_flow_release();
+        	ble_pickit_parameters_tx_complete();
+        	if (p_msg->char_test.notifications_on_going > 0)
+        	{
+        		p_msg->char_test.notifications_on_going--;
+        		ble_pickit_throughput_notification_send(p_msg);
+        	}
+        	break;
+
         case SERVICE_EVT_TEST_WRITE:
         	if (p_msg->char_test.is_notification_enabled && (length == 1))
         	{
@@ -441,51 +1008,7 @@ static void on_service_event_handler(ble_msg_t * p_msg, ble_msg_evt_t * p_evt, c
         case SERVICE_EVT_PARAMS_WRITE:
         	if (p_msg->char_params.is_notification_enabled)
 			{
-        		if ((length == 1) && (buffer[0] == 0x00))
-        		{
-        			// Return all parameters by notifying the client.
-        			ble_pickit.flags.send_ble_params = true;
-        			ble_pickit_parameters_notification_send();
-        		}
-        		else if ((length == 10) && (buffer[0] == 0x01) && (buffer[1] == 8))
-        		{
-					// Change preferred BLE_CONN_PARAMS
-        			ble_pickit.params.preferred_gap_params.conn_params.min_conn_interval = (uint16_t) ((buffer[2] << 8) | (buffer[3] << 0));
-        			ble_pickit.params.preferred_gap_params.conn_params.max_conn_interval = (uint16_t) ((buffer[4] << 8) | (buffer[5] << 0));
-        			ble_pickit.params.preferred_gap_params.conn_params.slave_latency = (uint16_t) ((buffer[6] << 8) | (buffer[7] << 0));
-        			ble_pickit.params.preferred_gap_params.conn_params.conn_sup_timeout = (uint16_t) ((buffer[8] << 8) | (buffer[9] << 0));
-
-        			p_msg->ble_params.change_conn_params_request = true;
-        		}
-        		else if ((length == 3) && (buffer[0] == 0x02) && (buffer[1] == 1))
-				{
-        			// Change preferred BLE_PHY_PARAM
-        			ble_pickit.params.preferred_gap_params.phys_params.tx_phys = (buffer[2] & 0x03);
-        			ble_pickit.params.preferred_gap_params.phys_params.rx_phys = (buffer[2] & 0x03);
-
-        			p_msg->ble_params.change_phy_param_request = true;
-				}
-        		else if ((length == 4) && (buffer[0] == 0x03) && (buffer[1] == 2))
-				{
-        			// Change preferred BLE_ATT_SIZE_PARAM
-        			ble_pickit.params.preferred_gap_params.mtu_size_params.max_rx_octets = buffer[2] + 4;
-					ble_pickit.params.preferred_gap_params.mtu_size_params.max_tx_octets = buffer[3] + 4;
-
-					p_msg->ble_params.change_mtu_size_params_request = true;
-				}
-        		else if ((length == 3) && (buffer[0] == 0x01) && (buffer[1] == 1))
-				{
-        			// Change PA/LNA parameter
-        			ble_pickit.params.pa_lna_enable = buffer[2] & 0x01;
-					ble_pickit.flags.send_pa_lna_param = true;
-				}
-        		else if ((length == 3) && (buffer[0] == 0x04) && (buffer[1] == 1))
-				{
-        			// Change LED STATUS
-        			ble_pickit.params.leds_status_enable = buffer[2] & 0x01;
-					ble_pickit.flags.send_ble_params = true;
-					ble_pickit_parameters_notification_send();
-				}
+        		params_write_dispatch(p_msg, buffer, length);
 			}
 			else
 			{
@@ -500,7 +1023,40 @@ static void on_service_event_handler(ble_msg_t * p_msg, ble_msg_evt_t * p_evt, c
     }
 }
 
-static void button_event_handler(uint8_t pin_no, bool button_action)
+/**@brief Function for resynchronizing the central and the notification states after dropped service events (main loop).
+ *
+ * @param[in] dropped  Types of the dropped events (bit n: service_evt_type_t n).
+ */
+static void service_evt_resync(uint32_t dropped)
+{
+	NRF_LOG_WARNING("Event queue full: service events dropped (types 0x%x).", dropped);
+
+	if (dropped & (1UL << SERVICE_EVT_APP_WRITE))
+	{
+		// The credits of the dropped writes are given back: the central counts its credits again from this notification.
+		ble_pickit.flags.send_credits = true;
+	}
+	if (dropped & (1UL << SERVICE_EVT_PARAMS_WRITE))
+	{
+		// The snapshot shows the central the parameters actually in use.
+		ble_pickit_parameters_changed();
+	}
+	if (dropped & (	(1UL << SERVICE_EVT_APP_NOTIFICATION_ENABLED) | (1UL << SERVICE_EVT_APP_NOTIFICATION_DISABLED) |			\
+					(1UL << SERVICE_EVT_TEST_NOTIFICATION_ENABLED) | (1UL << SERVICE_EVT_TEST_NOTIFICATION_DISABLED) |			\
+					(1UL << SERVICE_EVT_PARAMS_NOTIFICATION_ENABLED) | (1UL << SERVICE_EVT_PARAMS_NOTIFICATION_DISABLED) |		\
+					(1UL << SERVICE_EVT_CHANNEL_NOTIFICATION_ENABLED) | (1UL << SERVICE_EVT_CHANNEL_NOTIFICATION_DISABLED)))
+	{
+		ble_pickit_service_cccd_restore(service_evt_process);
+	}
+	if (dropped & (1UL << SERVICE_EVT_CACHE_READ))
+	{
+		// The authorized read waits for its reply.
+		ble_pickit_cache_read();
+	}
+	// SERVICE_EVT_CHANNEL_WRITE, SERVICE_EVT_TEST_WRITE and SERVICE_EVT_CACHE_WRITE are lost, like a write to a full channel queue.
+}
+
+static void button_evt_process(uint8_t pin_no, bool button_action)
 {
 
 	if(pin_no == BUTTON_1)
@@ -520,8 +1076,8 @@ static void button_event_handler(uint8_t pin_no, bool button_action)
 		if (button_action == 1)
 		{
 			ble_pickit.params.leds_status_enable = !ble_pickit.params.leds_status_enable;
-			ble_pickit.flags.send_ble_params = true;
-			ble_pickit_parameters_notification_send();
+			ble_pickit_leds_enable(ble_pickit.params.leds_status_enable);
+			ble_pickit_parameters_changed();
 		}
 		else
 		{
@@ -530,6 +1086,93 @@ static void button_event_handler(uint8_t pin_no, bool button_action)
 	}
 }
 
+/**@brief Function for handling the buttons (app_timer context): processed by button_evt_process() in the main loop.
+ */
+static void button_event_handler(uint8_t pin_no, bool button_action)
+{
+	irq_evt_post(IRQ_EVT_BUTTON, pin_no, button_action);
+}
+
+/**@brief Function for processing the events queued by the SoftDevice observers and the interrupts (main loop).
+ */
+static void main_evt_process(void)
+{
+	nrf_atfifo_item_get_t context;
+	irq_evt_t * p_irq_evt;
+	main_evt_t * p_evt;
+	PROFILER_BEGIN(PROFILER_REGION_MAIN_EVT);
+
+	while ((p_irq_evt = nrf_atfifo_item_get(m_irq_evt_fifo, &context)) != NULL)
+	{
+		if (p_irq_evt->type == IRQ_EVT_UART_TX_EMPTY)
+		{
+			ble_pickit.uart.transmit_in_progress = false;
+			ble_pickit_leds_event(LEDS_EVT_UART_TX_DONE);
+		}
+		else
+		{
+			button_evt_process(p_irq_evt->pin, p_irq_evt->action);
+		}
+		(void) nrf_atfifo_item_free(m_irq_evt_fifo, &context);
+	}
+
+	while ((p_evt = nrf_atfifo_item_get(m_main_evt_fifo, &context)) != NULL)
+	{
+		if (p_evt->source == MAIN_EVT_SOURCE_GAP)
+		{
+			gap_evt_process(p_evt);
+		}
+		else if (p_evt->source == MAIN_EVT_SOURCE_ADV)
+		{
+			adv_evt_process((ble_adv_evt_t) p_evt->type);
+		}
+		else
+		{
+			ble_msg_evt_t evt = {.evt_type = (service_evt_type_t) p_evt->type, .channel = p_evt->channel};
+
+			ble_pickit_leds_event(LEDS_EVT_BLE_ACTIVITY);
+			service_evt_process(&m_msg, &evt, &m_evt_data[p_evt->offset], p_evt->length);
+			if (p_evt->length > 0)
+			{
+				m_evt_data_tail = (p_evt->offset + p_evt->length) % MAIN_EVT_DATA_POOL_SIZE;
+			}
+			m_service_evt_processed++;
+		}
+		(void) nrf_atfifo_item_free(m_main_evt_fifo, &context);
+	}
+
+	if (m_service_evt_dropped != 0)
+	{
+		uint32_t dropped;
+
+		CRITICAL_REGION_ENTER();
+		dropped = m_service_evt_dropped;
+		m_service_evt_dropped = 0;
+		CRITICAL_REGION_EXIT();
+		service_evt_resync(dropped);
+	}
+
+	while (m_tx_complete_processed != m_tx_complete_count)
+	{
+		ble_msg_evt_t evt = {.evt_type = SERVICE_EVT_TX_COMPLETE};
+
+		m_tx_complete_processed++;
+		ble_pickit_leds_event(LEDS_EVT_BLE_ACTIVITY);
+		service_evt_process(&m_msg, &evt, NULL, 0);
+	}
+	PROFILER_END(PROFILER_REGION_MAIN_EVT);
+}
+
+#if defined(SPIS_CSN_PIN)
+/**@brief Function for handling the end of the SPIS transmissions (called from the main loop).
+ */
+static void transport_tx_empty_handler(void)
+{
+	ble_pickit.uart.transmit_in_progress = false;
+	ble_pickit_leds_event(LEDS_EVT_UART_TX_DONE);
+}
+#endif
+
 void uart_event_handle(app_uart_evt_t * p_event)
 {
 	switch (p_event->evt_type)
@@ -550,7 +1193,7 @@ void uart_event_handle(app_uart_evt_t * p_event)
 
 		case APP_UART_TX_EMPTY:
 
-			ble_pickit.uart.transmit_in_progress = false;
+			irq_evt_post(IRQ_EVT_UART_TX_EMPTY, 0, false);
 			break;
 
 		default:
@@ -559,39 +1202,63 @@ void uart_event_handle(app_uart_evt_t * p_event)
 }
 
 
-/**@brief Function for application main entry.
+/**@brief Function for initializing the modules and the SoftDevice (before the initialization sequence).
  */
-int main(void)
+static void main_init(bool pwr_mgmt_enable)
 {
-	bool pwr_mgmt_enable = false;
-	ret_code_t err_code;
-
     // Initialize.
     log_init();
+    APP_ERROR_CHECK(NRF_ATFIFO_INIT(m_main_evt_fifo));
+    APP_ERROR_CHECK(NRF_ATFIFO_INIT(m_irq_evt_fifo));
     timers_init();
     rtc_init();
+    ble_pickit_profiler_init();
+    ble_pickit_trace_init();
+    ble_pickit_capture_init();
+    ble_pickit_stats_reset();
+#if defined(SPIS_CSN_PIN)
+	// Several frames may be exchanged in one SPI transaction: frames delimited by their length.
+	ble_pickit.params.uart_full_duplex = true;
+	ble_pickit_transport_spis_init(transport_tx_empty_handler);
+#else
 	uart_init();
+#endif
     power_management_init(pwr_mgmt_enable);
     board_init(button_event_handler);
+    ble_pickit_leds_init(ble_pickit.params.leds_status_enable);
 	ble_init(&ble_pickit);
     ble_stack_init();
+}
 
-	// Initialization sequence
-	// Get the name by the client (PIC or other) before initializing BLE module
-	while (1)
-	{
-		static uint64_t tick_init = 0;
+/**@brief Function for running one pass of the initialization sequence: the name is got from the client (PIC or
+ *        other) before initializing the BLE module.
+ *
+ * @return True once the sequence is over (500 ms).
+ */
+static bool main_init_tasks(void)
+{
+	static uint64_t tick_init = 0;
 
-		ble_pickit.params.pa_lna_enable |= (ble_pickit.params.pa_lna_enable | board_button_get(BUTTON_1));
+	ble_pickit.params.pa_lna_enable |= (ble_pickit.params.pa_lna_enable | board_button_get(BUTTON_1));
 
-		ble_stack_tasks();
+	main_evt_process();
+	ble_stack_tasks();
 
-		if (mTickCompare(tick_init) >= TICK_500MS)
-		{
-			ble_pickit.status.is_init_done = true;
-			break;
-		}
+	if (mTickCompare(tick_init) >= TICK_500MS)
+	{
+		ble_pickit.status.is_init_done = true;
+		ble_pickit_leds_event(LEDS_EVT_INIT_DONE);
+		return true;
 	}
+	return false;
+}
+
+/**@brief Function for initializing the BLE module with the parameters got during the initialization sequence and
+ *        starting the advertising.
+ */
+static void main_start(void)
+{
+	ret_code_t err_code;
 
 	board_pa_lna_init(ble_pickit.params.pa_lna_enable);
     gap_init();
@@ -611,63 +1278,96 @@ int main(void)
 	NRF_LOG_INFO("	timeout: %d ms", (ble_pickit.params.preferred_gap_params.conn_params.conn_sup_timeout*UNIT_10_MS/1000));
 	NRF_LOG_INFO("	Preferred PHY parameter: TX = %d / RX = %d", ble_pickit.params.preferred_gap_params.phys_params.tx_phys, ble_pickit.params.preferred_gap_params.phys_params.rx_phys);
 	NRF_LOG_INFO("	Preferred MTU size: TX = %d / RX = %d", ble_pickit.params.preferred_gap_params.mtu_size_params.max_tx_octets-4, ble_pickit.params.preferred_gap_params.mtu_size_params.max_rx_octets-4);
-	err_code = ble_advertising_start(&m_advertising, BLE_ADV_MODE_FAST);
+	// Start with the high duty directed advertising if a bonded central is known (falls back to fast advertising otherwise).
+	err_code = ble_advertising_start(&m_advertising, (m_peer_id != PM_PEER_ID_INVALID) ? BLE_ADV_MODE_DIRECTED_HIGH_DUTY : BLE_ADV_MODE_FAST);
 	APP_ERROR_CHECK(err_code);
+}
 
-    // Enter main loop.
-	while (1)
-	{
+/**@brief Function for running one pass of the main loop.
+ */
+static void main_tasks(void)
+{
+	ret_code_t err_code;
 
-		ble_stack_tasks();
+	PROFILER_BEGIN(PROFILER_REGION_MAIN_LOOP);
 
+	main_evt_process();
+	ble_stack_tasks();
+	ble_pickit_parameters_tasks();
 
-		if (ble_pickit.status.is_connected_to_a_central)
+	if (ble_pickit.status.is_connected_to_a_central)
+	{
+		if (ble_pickit.flags.set_conn_params)
 		{
-			if (ble_pickit.flags.set_conn_params)
-			{
-				m_msg.ble_params.change_conn_params_request = true;
-				ble_pickit.flags.set_conn_params = false;
-			}
-			else if (ble_pickit.flags.set_phy_params)
-			{
-				m_msg.ble_params.change_phy_param_request = true;
-				ble_pickit.flags.set_phy_params = false;
-			}
-			else if (ble_pickit.flags.set_att_size_params)
-			{
-				m_msg.ble_params.change_mtu_size_params_request = true;
-				ble_pickit.flags.set_att_size_params = false;
-			}
+			m_msg.ble_params.change_conn_params_request = true;
+			ble_pickit.flags.set_conn_params = false;
+		}
+		else if (ble_pickit.flags.set_phy_params)
+		{
+			m_msg.ble_params.change_phy_param_request = true;
+			ble_pickit.flags.set_phy_params = false;
+		}
+		else if (ble_pickit.flags.set_att_size_params)
+		{
+			m_msg.ble_params.change_mtu_size_params_request = true;
+			ble_pickit.flags.set_att_size_params = false;
+		}
 
-			if (m_msg.ble_params.change_conn_params_request)
+		if (m_msg.ble_params.change_conn_params_request)
+		{
+			err_code = sd_ble_gap_conn_param_update(m_conn_handle, &ble_pickit.params.preferred_gap_params.conn_params);
+			if ((err_code != NRF_SUCCESS) && (err_code != NRF_ERROR_BUSY))
 			{
-				err_code = sd_ble_gap_conn_param_update(m_conn_handle, &ble_pickit.params.preferred_gap_params.conn_params);
-				if ((err_code != NRF_SUCCESS) && (err_code != NRF_ERROR_BUSY))
-				{
-					APP_ERROR_CHECK(err_code);
-				}
-				m_msg.ble_params.change_conn_params_request = false;
+				APP_ERROR_CHECK(err_code);
 			}
-			else if (m_msg.ble_params.change_phy_param_request)
+			m_msg.ble_params.change_conn_params_request = false;
+		}
+		else if (m_msg.ble_params.change_phy_param_request)
+		{
+			err_code = sd_ble_gap_phy_update(m_conn_handle, &ble_pickit.params.preferred_gap_params.phys_params);
+			if ((err_code != NRF_SUCCESS) && (err_code != NRF_ERROR_BUSY))
 			{
-				err_code = sd_ble_gap_phy_update(m_conn_handle, &ble_pickit.params.preferred_gap_params.phys_params);
-				if ((err_code != NRF_SUCCESS) && (err_code != NRF_ERROR_BUSY))
-				{
-					APP_ERROR_CHECK(err_code);
-				}
-				m_msg.ble_params.change_phy_param_request = false;
+				APP_ERROR_CHECK(err_code);
 			}
-			else if (m_msg.ble_params.change_mtu_size_params_request)
+			m_msg.ble_params.change_phy_param_request = false;
+		}
+		else if (m_msg.ble_params.change_mtu_size_params_request)
+		{
+			err_code = sd_ble_gap_data_length_update(m_conn_handle, &ble_pickit.params.preferred_gap_params.mtu_size_params, NULL);
+			if ((err_code != NRF_SUCCESS) && (err_code != NRF_ERROR_BUSY))
 			{
-				err_code = sd_ble_gap_data_length_update(m_conn_handle, &ble_pickit.params.preferred_gap_params.mtu_size_params, NULL);
-				if ((err_code != NRF_SUCCESS) && (err_code != NRF_ERROR_BUSY))
-				{
-					APP_ERROR_CHECK(err_code);
-				}
-				m_msg.ble_params.change_mtu_size_params_request = false;
+				APP_ERROR_CHECK(err_code);
 			}
+			m_msg.ble_params.change_mtu_size_params_request = false;
 		}
 
+		ble_pickit_link_adapt_tasks(&ble_pickit.params);
+	}
+
+	PROFILER_END(PROFILER_REGION_MAIN_LOOP);
+}
+
+/**@brief Function for application main entry.
+ *
+ * @details The steps are run one pass at a time by the host build as well (host/bridge.c).
+ */
+int main(void)
+{
+	bool pwr_mgmt_enable = false;
+
+	main_init(pwr_mgmt_enable);
+
+	// Initialization sequence
+	while (!main_init_tasks())
+	{
+	}
+
+	main_start();
+
+    // Enter main loop.
+	while (1)
+	{
+		main_tasks();
 
 		if ((NRF_LOG_PROCESS() == false) && pwr_mgmt_enable)
 		{
@@ -722,7 +1422,7 @@ static void uart_init(void)
         .tx_pin_no    = TX_PIN_NUMBER,
         .rts_pin_no   = RTS_PIN_NUMBER,
         .cts_pin_no   = CTS_PIN_NUMBER,
-        .flow_control = APP_UART_FLOW_CONTROL_DISABLED,
+        .flow_control = (RTS_PIN_NUMBER != UART_PIN_DISCONNECTED) ? APP_UART_FLOW_CONTROL_ENABLED : APP_UART_FLOW_CONTROL_DISABLED,
         .use_parity   = false,
         .baud_rate    = NRF_UART_BAUDRATE_1000000
     };
@@ -762,7 +1462,7 @@ static void ble_stack_init(void)
 	memset(&ble_cfg, 0x00, sizeof(ble_cfg));
 	ble_cfg.conn_cfg.conn_cfg_tag                     	= APP_BLE_CONN_CFG_TAG;
 	ble_cfg.conn_cfg.params.gatt_conn_cfg.att_mtu		= NRF_SDH_BLE_GATT_MAX_MTU_SIZE;
-	ble_cfg.conn_cfg.params.gap_conn_cfg.event_length 	= 320;
+	ble_cfg.conn_cfg.params.gap_conn_cfg.event_length 	= CONN_EVENT_LENGTH;
 	ble_cfg.conn_cfg.params.gap_conn_cfg.conn_count   	= BLE_GAP_CONN_COUNT_DEFAULT;
 	err_code = sd_ble_cfg_set(BLE_CONN_CFG_GAP, &ble_cfg, ram_start);
 	APP_ERROR_CHECK(err_code);
@@ -832,20 +1532,15 @@ static void advertising_init(void)
     ret_code_t err_code;
     ble_advertising_init_t init;
 
-    ble_advdata_manuf_data_t manuf_data;
-    uint8_t data_array[] =
-    {
-    		(ble_pickit.infos.vsd_version[0]),
-			(ble_pickit.infos.vsd_version[1]),
-			(ble_pickit.infos.vsd_version[2]),
-			(ble_pickit.infos.vsd_version[3]),
-			(ble_pickit.infos.vsd_version[4]),
-			(ble_pickit.infos.vsd_version[5]),
-			(ble_pickit.infos.vsd_version[6]),
-			ble_pickit.params.pa_lna_enable & 0x01,
-			ble_pickit.params.leds_status_enable & 0x01
-    };
-    manuf_data.company_identifier = 0x01ee;				// Valeo Service company ID
+    // Static: the scan response data is encoded again on each broadcast update (see ble_pickit_broadcast).
+    static ble_advdata_manuf_data_t manuf_data;
+    static uint8_t data_array[9];
+
+    memcpy(data_array, ble_pickit.infos.vsd_version, 7);
+    data_array[7] = ble_pickit.params.pa_lna_enable & 0x01;
+    data_array[8] = ble_pickit.params.leds_status_enable & 0x01;
+
+    manuf_data.company_identifier = BLE_PICKIT_COMPANY_IDENTIFIER;
     manuf_data.data.p_data = data_array;
     manuf_data.data.size = sizeof(data_array);
 
@@ -864,8 +1559,7 @@ static void advertising_init(void)
     init.advdata.uuids_complete.p_uuids  				= NULL;
     init.advdata.uuids_solicited.uuid_cnt 				= 0;
     init.advdata.uuids_solicited.p_uuids 				= NULL;
-    init.advdata.p_slave_conn_int->min_conn_interval	= ble_pickit.params.preferred_gap_params.conn_params.min_conn_interval;
-    init.advdata.p_slave_conn_int->max_conn_interval	= ble_pickit.params.preferred_gap_params.conn_params.max_conn_interval;
+    init.advdata.p_slave_conn_int						= NULL;		// Not advertised (the preferred parameters are requested once connected)
     init.advdata.p_manuf_specific_data					= NULL;
     init.advdata.p_service_data_array					= NULL;
     init.advdata.service_data_count						= 0;
@@ -885,7 +1579,7 @@ static void advertising_init(void)
      * Set of ble_adv_modes_config_t
      */
     init.config.ble_adv_on_disconnect_disabled			= false;
-    init.config.ble_adv_whitelist_enabled 				= false;
+    init.config.ble_adv_whitelist_enabled 				= true;		// Fast reconnection: whitelist filled with the last bonded central (see BLE_ADV_EVT_WHITELIST_REQUEST)
     init.config.ble_adv_extended_enabled				= false;
 
     init.config.ble_adv_fast_enabled  					= true;
@@ -896,7 +1590,7 @@ static void advertising_init(void)
     init.config.ble_adv_slow_interval 					= 0;			// in units of 0.625 ms (1000ms to 10240ms)
     init.config.ble_adv_slow_timeout  					= 0;			// in units of 10 ms
 
-    init.config.ble_adv_directed_high_duty_enabled 		= false;
+    init.config.ble_adv_directed_high_duty_enabled 		= true;		// Fast reconnection: 1.28 s of high duty directed advertising towards the last bonded central
     init.config.ble_adv_directed_enabled				= false;
     init.config.ble_adv_directed_interval 				= 0;			// in units of 0.625 ms
     init.config.ble_adv_directed_timeout  				= 0;			// in units of 10 ms
@@ -911,6 +1605,11 @@ static void advertising_init(void)
     APP_ERROR_CHECK(err_code);
 
     ble_advertising_conn_cfg_tag_set(&m_advertising, APP_BLE_CONN_CFG_TAG);
+
+    ble_pickit_broadcast_init(&m_advertising, &init.advdata, &init.srdata, ble_pickit.params.preferred_gap_params.adv_interval);
+
+    err_code = app_timer_create(&m_whitelist_timer_id, APP_TIMER_MODE_SINGLE_SHOT, whitelist_timeout_handler);
+    APP_ERROR_CHECK(err_code);
 }
 
 static void services_init(void)
@@ -1004,4 +1703,13 @@ static void peer_manager_init(void)
 
     err_code = pm_register(pm_evt_handler);
     APP_ERROR_CHECK(err_code);
+
+    // The most recently secured central (highest rank) is the target of the fast reconnection.
+    pm_peer_id_t highest_ranked_peer = PM_PEER_ID_INVALID;
+    err_code = pm_peer_ranks_get(&highest_ranked_peer, NULL, NULL, NULL);
+    if (err_code != NRF_ERROR_NOT_FOUND)
+    {
+    	APP_ERROR_CHECK(err_code);
+    }
+    fast_reconnect_peer_set(highest_ranked_peer);
 }